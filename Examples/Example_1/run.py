@@ -22,3 +22,5 @@ oreex.plot("swaption_npv.csv", 3, 4, 'g', "NPV Swaptions", marker='s')
 oreex.decorate_plot(title="Example 1 - Simulated exposures vs analytical swaption prices")
 oreex.save_plot_to_file()
 
+oreex.print_headline("Run ORE on a compressed portfolio of two swaps")
+oreex.run("Input/ore_compression.xml")
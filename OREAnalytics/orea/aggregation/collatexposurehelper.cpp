@@ -19,6 +19,11 @@
 #include <orea/aggregation/collatexposurehelper.hpp>
 #include <ql/errors.hpp>
 
+#include <boost/make_shared.hpp>
+
+#include <algorithm>
+#include <map>
+
 using namespace std;
 using namespace QuantLib;
 
@@ -28,6 +33,118 @@ namespace ore {
 using namespace data;
 namespace analytics {
 
+namespace {
+
+// Margin requirement given the uncollateralised value, the collateral balance and the open margin calls
+Real deliveryAmount(const NettingSetDefinition& csaDef, Real uncollatValue, Real collatBalance, Real openMargins) {
+    Real ia = csaDef.independentAmountHeld();
+    Real threshold, mta, creditSupportAmount;
+    if (uncollatValue - ia >= 0) {
+        threshold = csaDef.thresholdRcv();
+        creditSupportAmount = max(uncollatValue - ia - threshold, 0.0);
+    } else {
+        threshold = csaDef.thresholdPay();
+        // N.B. the min and change of sign on threshold.
+        creditSupportAmount = min(uncollatValue - ia + threshold, 0.0);
+    }
+
+    Real collatShortfall = creditSupportAmount - collatBalance - openMargins;
+
+    if (collatShortfall >= 0.0)
+        mta = csaDef.mtaRcv();
+    else
+        mta = csaDef.mtaPay();
+
+    return fabs(collatShortfall) >= mta ? (collatShortfall) : 0.0;
+}
+
+// Collateral balance accrued over the given number of days, compounded daily
+Real accruedBalance(const NettingSetDefinition& csaDef, Real balance, Real annualisedZeroRate, int accrualDays) {
+    // apply "effective" accrual rate (i.e. adjust for spread specified in netting set definition)
+    Real accrualRate = (balance >= 0.0) ? (annualisedZeroRate - csaDef.collatSpreadRcv())
+                                        : (annualisedZeroRate - csaDef.collatSpreadPay());
+    return balance * std::pow(1.0 + accrualRate / 365.0, accrualDays);
+}
+
+// Position of a collateral simulation date relative to today and the exposure date grid, this is the same
+// for all samples and follows CollateralExposureHelper::estimateUncollatValue()
+struct GridLocation {
+    bool today = false;       // value as of today
+    bool interpolate = false; // linear interpolation between pos1 (or today) and pos2, otherwise value at pos1
+    bool fromToday = false;   // interpolation between today and the first grid date
+    Size pos1 = 0, pos2 = 0;
+    Date t1, t2;
+    Real weight = 0.0;
+};
+
+GridLocation locate(const Date& simulationDate, const Date& date_t0, const vector<Date>& dateGrid) {
+    QL_REQUIRE(simulationDate >= date_t0, "CollatExposureHelper error: simulation date < start date");
+    QL_REQUIRE(dateGrid[0] >= date_t0, "CollatExposureHelper error: cube dateGrid starts before t0");
+
+    GridLocation l;
+    if (simulationDate >= dateGrid.back()) {
+        l.pos1 = dateGrid.size() - 1; // flat extrapolation
+        return l;
+    }
+    if (simulationDate == date_t0) {
+        l.today = true;
+        return l;
+    }
+    for (unsigned i = 0; i < dateGrid.size(); i++) {
+        if (dateGrid[i] == simulationDate) {
+            l.pos1 = i;
+            return l;
+        }
+#ifdef FLAT_INTERPOLATION
+        else if (simulationDate < dateGrid.front()) {
+            l.pos1 = 0;
+            return l;
+        } else if (i < dateGrid.size() - 1 && simulationDate > dateGrid[i] && simulationDate < dateGrid[i + 1]) {
+            l.pos1 = i + 1;
+            return l;
+        }
+#endif
+    }
+
+    l.interpolate = true;
+    if (simulationDate <= dateGrid[0]) {
+        l.fromToday = true;
+        l.t1 = date_t0;
+        l.t2 = dateGrid[0];
+        l.pos2 = 0;
+    } else {
+        vector<Date>::const_iterator it = lower_bound(dateGrid.begin(), dateGrid.end(), simulationDate);
+        QL_REQUIRE(it != dateGrid.end(), "CollatExposureHelper error; "
+                                             << "date interpolation points not found (it.end())");
+        QL_REQUIRE(it != dateGrid.begin(), "CollatExposureHelper error; "
+                                               << "date interpolation points not found (it.begin())");
+        l.pos1 = (it - 1) - dateGrid.begin();
+        l.pos2 = it - dateGrid.begin();
+        l.t1 = dateGrid[l.pos1];
+        l.t2 = dateGrid[l.pos2];
+    }
+    l.weight = double(simulationDate - l.t1) / double(l.t2 - l.t1);
+    return l;
+}
+
+Real gridValue(const GridLocation& l, const Date& simulationDate, Real value_t0,
+               const vector<vector<Real>>& scenValues, Size scenIndex) {
+    if (l.today)
+        return value_t0;
+    if (!l.interpolate)
+        return scenValues[l.pos1][scenIndex];
+    Real v1 = l.fromToday ? value_t0 : scenValues[l.pos1][scenIndex];
+    Real v2 = scenValues[l.pos2][scenIndex];
+    Real v = v1 + ((v2 - v1) * l.weight);
+    QL_REQUIRE((v1 <= v && v <= v2) || (v1 >= v && v >= v2),
+               "CollatExposureHelper error; "
+                   << "interpolated Pv value " << v << " out of range (" << v1 << " " << v2 << ") "
+                   << "for simulation date " << simulationDate << " between " << l.t1 << " and " << l.t2);
+    return v;
+}
+
+} // namespace
+
 CollateralExposureHelper::CalculationType parseCollateralCalculationType(const string& s) {
     static map<string, CollateralExposureHelper::CalculationType> m = {
         {"Symmetric", CollateralExposureHelper::Symmetric},
@@ -59,29 +176,8 @@ Real CollateralExposureHelper::marginRequirementCalc(const boost::shared_ptr<Col
     // first step, make sure collateral balance is up to date.
     //        collat->updateAccountBalance(simulationDate);
 
-    Real collatBalance = collat->accountBalance();
-    Real ia = collat->csaDef()->independentAmountHeld();
-    Real threshold, mta, creditSupportAmount;
-    if (uncollatValue - ia >= 0) {
-        threshold = collat->csaDef()->thresholdRcv();
-        creditSupportAmount = max(uncollatValue - ia - threshold, 0.0);
-    } else {
-        threshold = collat->csaDef()->thresholdPay();
-        // N.B. the min and change of sign on threshold.
-        creditSupportAmount = min(uncollatValue - ia + threshold, 0.0);
-    }
-
-    Real openMargins = collat->outstandingMarginAmount(simulationDate);
-    Real collatShortfall = creditSupportAmount - collatBalance - openMargins;
-
-    if (collatShortfall >= 0.0)
-        mta = collat->csaDef()->mtaRcv();
-    else
-        mta = collat->csaDef()->mtaPay();
-
-    Real deliveryAmount = fabs(collatShortfall) >= mta ? (collatShortfall) : 0.0;
-
-    return deliveryAmount;
+    return deliveryAmount(*collat->csaDef(), uncollatValue, collat->accountBalance(),
+                          collat->outstandingMarginAmount(simulationDate));
 }
 
 template <class T>
@@ -226,5 +322,132 @@ boost::shared_ptr<vector<boost::shared_ptr<CollateralAccount>>> CollateralExposu
         QL_FAIL("CollateralExposureHelper - unknown error when generating collateralBalancePaths");
     }
 }
+
+boost::shared_ptr<vector<vector<Real>>> CollateralExposureHelper::collateralBalances(
+    const boost::shared_ptr<NettingSetDefinition>& csaDef, const Real& nettingSetPv, const Date& date_t0,
+    const vector<vector<Real>>& nettingSetValues, const Date& nettingSet_maturity, const vector<Date>& dateGrid,
+    const Real& csaFxTodayRate, const vector<vector<Real>>& csaFxScenarioRates, const Real& csaTodayCollatCurve,
+    const vector<vector<Real>>& csaScenCollatCurves, const CalculationType& calcType) {
+    try {
+        const NettingSetDefinition& csa = *csaDef;
+        Size numScenarios = nettingSetValues.front().size();
+        QL_REQUIRE(numScenarios == csaFxScenarioRates.front().size(), "netting values -v- scenario FX rate mismatch");
+
+        // t0 balance, i.e. the margin requirement for a zero balance without open margin calls
+        Real bal_t0 = deliveryAmount(csa, nettingSetPv, 0.0, 0.0);
+
+        // The account state of all samples: latest balance and balance date, and the next date grid index to be
+        // filled in the result. A balance is written to the result for all grid dates before the next balance date.
+        boost::shared_ptr<vector<vector<Real>>> result =
+            boost::make_shared<vector<vector<Real>>>(dateGrid.size(), vector<Real>(numScenarios, 0.0));
+        vector<vector<Real>>& balances = *result;
+        vector<Real> balance(numScenarios, bal_t0);
+        vector<Date> balanceDate(numScenarios, date_t0);
+        vector<Size> gridIndex(numScenarios, 0);
+        auto newBalance = [&](Size k, const Date& d, Real b) {
+            while (gridIndex[k] < dateGrid.size() && dateGrid[gridIndex[k]] < d)
+                balances[gridIndex[k]++][k] = balance[k];
+            balance[k] = b;
+            balanceDate[k] = d;
+        };
+
+        // Open margin calls by pay date, with the call amount per sample (zero if the sample has no call). Within a
+        // sample, there is at most one open call per pay date.
+        std::map<Date, vector<Real>> marginCalls;
+        vector<Real> newCalls(numScenarios), newPostings(numScenarios);
+
+        Date simEndDate = std::min(nettingSet_maturity, dateGrid.back()) + csa.marginPeriodOfRisk();
+        Date tmpDate = date_t0; // the date which gets evolved
+        Date nextMarginReqDateUs = date_t0;
+        Date nextMarginReqDateCtp = date_t0;
+        Date callPayDate, postPayDate;
+        while (tmpDate <= simEndDate) {
+            QL_REQUIRE(tmpDate <= nextMarginReqDateUs && tmpDate <= nextMarginReqDateCtp &&
+                           (tmpDate == nextMarginReqDateUs || tmpDate == nextMarginReqDateCtp),
+                       "collateral balance path generation error; invalid time stepping");
+            bool eligMarginReqDateUs = tmpDate == nextMarginReqDateUs ? true : false;
+            bool eligMarginReqDateCtp = tmpDate == nextMarginReqDateCtp ? true : false;
+            // settle margin calls on appropriate date
+            // (dependent upon MPR and collateralised calculation methodology)
+            callPayDate = calcType == AsymmetricDVA ? tmpDate : tmpDate + csa.marginPeriodOfRisk();
+            postPayDate = calcType == AsymmetricCVA ? tmpDate : tmpDate + csa.marginPeriodOfRisk();
+            GridLocation location = locate(tmpDate, date_t0, dateGrid);
+            auto firstOpen = marginCalls.upper_bound(tmpDate);
+            std::fill(newCalls.begin(), newCalls.end(), 0.0);
+            std::fill(newPostings.begin(), newPostings.end(), 0.0);
+
+            for (Size k = 0; k < numScenarios; ++k) {
+                Real uncollatVal = gridValue(location, tmpDate, nettingSetPv, nettingSetValues, k);
+                Real fxValue = gridValue(location, tmpDate, csaFxTodayRate, csaFxScenarioRates, k);
+                Real annualisedZeroRate = gridValue(location, tmpDate, csaTodayCollatCurve, csaScenCollatCurves, k);
+                uncollatVal /= fxValue;
+
+                // settle the margin calls due and bring the balance up to the simulation date
+                for (auto mc = marginCalls.begin(); mc != firstOpen; ++mc) {
+                    Real amount = mc->second[k];
+                    if (amount == 0.0)
+                        continue;
+                    if (mc->first == balanceDate[k]) {
+                        balance[k] += amount;
+                    } else {
+                        QL_REQUIRE(mc->first > balanceDate[k],
+                                   "CollateralAccount error; balance update failed due to invalid dates");
+                        newBalance(k, mc->first,
+                                   accruedBalance(csa, balance[k], annualisedZeroRate, mc->first - balanceDate[k]) +
+                                       amount);
+                    }
+                }
+                if (tmpDate > balanceDate[k])
+                    newBalance(k, tmpDate,
+                               accruedBalance(csa, balance[k], annualisedZeroRate, tmpDate - balanceDate[k]));
+
+                Real openMargins = 0.0;
+                for (auto mc = firstOpen; mc != marginCalls.end(); ++mc) {
+                    if (mc->second[k] != 0.0)
+                        openMargins += mc->second[k];
+                }
+
+                Real margin = deliveryAmount(csa, uncollatVal, balance[k], openMargins);
+                if (margin > 0.0 && eligMarginReqDateUs)
+                    newCalls[k] = margin;
+                else if (margin < 0.0 && eligMarginReqDateCtp)
+                    newPostings[k] = margin;
+            }
+
+            marginCalls.erase(marginCalls.begin(), firstOpen);
+            for (auto const& c : {std::make_pair(callPayDate, &newCalls), std::make_pair(postPayDate, &newPostings)}) {
+                if (std::any_of(c.second->begin(), c.second->end(), [](Real x) { return x != 0.0; })) {
+                    vector<Real>& amounts = marginCalls.insert(std::make_pair(c.first, vector<Real>(numScenarios)))
+                                                .first->second;
+                    for (Size k = 0; k < numScenarios; ++k) {
+                        if ((*c.second)[k] != 0.0)
+                            amounts[k] = (*c.second)[k];
+                    }
+                }
+            }
+
+            if (nextMarginReqDateUs == tmpDate)
+                nextMarginReqDateUs = tmpDate + csa.marginCallFrequency();
+            if (nextMarginReqDateCtp == tmpDate)
+                nextMarginReqDateCtp = tmpDate + csa.marginPostFrequency();
+            tmpDate = std::min(nextMarginReqDateUs, nextMarginReqDateCtp);
+        }
+        QL_REQUIRE(tmpDate > simEndDate, "collateral balance path generation error; while loop terminated too early. ("
+                                             << tmpDate << ", " << simEndDate << ")");
+
+        // set account balance to zero after maturity of portfolio, flat extrapolation at far end
+        for (Size k = 0; k < numScenarios; ++k) {
+            newBalance(k, simEndDate + Period(1, Days), 0.0);
+            while (gridIndex[k] < dateGrid.size())
+                balances[gridIndex[k]++][k] = 0.0;
+        }
+        return result;
+    } catch (const std::exception& e) {
+        QL_FAIL(e.what());
+    } catch (...) {
+        QL_FAIL("CollateralExposureHelper - unknown error when generating collateralBalances");
+    }
+}
+
 } // namespace analytics
 } // namespace ore
@@ -99,6 +99,21 @@ public:
         const vector<vector<Real>>& nettingSetValues, const Date& nettingSet_maturity, const vector<Date>& dateGrid,
         const Real& csaFxTodayRate, const vector<vector<Real>>& csaFxScenarioRates, const Real& csaTodayCollatCurve,
         const vector<vector<Real>>& csaScenCollatCurves, const CalculationType& calcType = Symmetric);
+
+    /*!
+      Takes a netting set (and scenario exposures) as input and returns the collateral
+      balances by date grid point and scenario, i.e. the balances that the accounts
+      returned by collateralBalancePaths() show as of the date grid points.
+
+      All scenarios are evolved together through the margining dates, with the account
+      balances and open margin calls held per scenario, which avoids building an account
+      object per scenario.
+    */
+    static boost::shared_ptr<vector<vector<Real>>> collateralBalances(
+        const boost::shared_ptr<NettingSetDefinition>& csaDef, const Real& nettingSetPv, const Date& date_t0,
+        const vector<vector<Real>>& nettingSetValues, const Date& nettingSet_maturity, const vector<Date>& dateGrid,
+        const Real& csaFxTodayRate, const vector<vector<Real>>& csaFxScenarioRates, const Real& csaTodayCollatCurve,
+        const vector<vector<Real>>& csaScenCollatCurves, const CalculationType& calcType = Symmetric);
 };
 
 //! Convert text representation to CollateralExposureHelper::CalculationType
@@ -0,0 +1,98 @@
+/*
+ Copyright (C) 2020 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <orea/aggregation/exposurestatistics.hpp>
+
+#include <ql/errors.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+using QuantLib::Real;
+using QuantLib::Size;
+using std::vector;
+
+namespace ore {
+namespace analytics {
+
+Size quantileIndex(Real quantile, Size n) {
+    QL_REQUIRE(quantile >= 0.0 && quantile <= 1.0, "quantile " << quantile << " out of range [0, 1]");
+    QL_REQUIRE(n > 0, "quantileIndex(): empty sample");
+    return Size(std::floor(quantile * (n - 1) + 0.5));
+}
+
+vector<Real> orderStatistics(vector<Real>& x, const vector<Size>& indices) {
+    vector<Size> order(indices.size());
+    for (Size i = 0; i < order.size(); ++i) {
+        QL_REQUIRE(indices[i] < x.size(), "order statistic " << indices[i] << " out of range, sample size is "
+                                                             << x.size());
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&indices](Size a, Size b) { return indices[a] < indices[b]; });
+    // after selecting index m, the elements above m are not smaller than x[m], so the next selection is restricted to
+    // these elements
+    vector<Real> result(indices.size());
+    Size begin = 0;
+    for (Size i : order) {
+        Size m = indices[i];
+        if (m >= begin) {
+            std::nth_element(x.begin() + begin, x.begin() + m, x.end());
+            begin = m + 1;
+        }
+        result[i] = x[m];
+    }
+    return result;
+}
+
+ExposureStatistics::ExposureStatistics(const vector<Real>& quantiles)
+    : levels_(quantiles), quantiles_(quantiles.size(), 0.0), mean_(0.0), positiveMean_(0.0), negativeMean_(0.0) {
+    for (auto q : levels_)
+        QL_REQUIRE(q >= 0.0 && q <= 1.0, "quantile " << q << " out of range [0, 1]");
+}
+
+void ExposureStatistics::update(const vector<Real>& x) {
+    Size n = x.size();
+    QL_REQUIRE(n > 0, "ExposureStatistics::update(): empty sample");
+    Real mean = 0.0, positiveMean = 0.0, negativeMean = 0.0;
+    for (Size k = 0; k < n; ++k) {
+        mean += x[k] / n;
+        positiveMean += std::max(x[k], 0.0) / n;
+        negativeMean += std::max(-x[k], 0.0) / n;
+    }
+    mean_ = mean;
+    positiveMean_ = positiveMean;
+    negativeMean_ = negativeMean;
+
+    if (levels_.empty())
+        return;
+    if (indices_.size() != levels_.size() || buffer_.size() != n) {
+        indices_.resize(levels_.size());
+        for (Size i = 0; i < levels_.size(); ++i)
+            indices_[i] = quantileIndex(levels_[i], n);
+    }
+    buffer_.assign(x.begin(), x.end());
+    quantiles_ = orderStatistics(buffer_, indices_);
+}
+
+Real ExposureStatistics::quantile(Size i) const {
+    QL_REQUIRE(i < quantiles_.size(), "quantile " << i << " not computed, " << quantiles_.size() << " requested");
+    return quantiles_[i];
+}
+
+} // namespace analytics
+} // namespace ore
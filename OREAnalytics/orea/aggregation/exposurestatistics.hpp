@@ -0,0 +1,81 @@
+/*
+ Copyright (C) 2020 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file orea/aggregation/exposurestatistics.hpp
+    \brief Statistics of exposure samples without sorting
+    \ingroup analytics
+*/
+
+#pragma once
+
+#include <ql/types.hpp>
+
+#include <vector>
+
+namespace ore {
+namespace analytics {
+
+//! Index of the \p quantile in a sorted sample of size \p n
+/*! This is the index floor(quantile * (n - 1) + 0.5) used for the PFE and the simple DIM.
+
+    \ingroup analytics
+*/
+QuantLib::Size quantileIndex(QuantLib::Real quantile, QuantLib::Size n);
+
+//! Order statistics of a sample without a full sort
+/*! Returns the values at the given \p indices of the sorted sample \p x. The sample is reordered in place by one
+    selection per distinct index, in ascending order of the indices, each restricted to the part of the sample above
+    the previous index.
+
+    \ingroup analytics
+*/
+std::vector<QuantLib::Real> orderStatistics(std::vector<QuantLib::Real>& x, const std::vector<QuantLib::Size>& indices);
+
+//! Mean, expected positive and negative part and quantiles of exposure samples
+/*! One pass over the sample gives the mean and the expected positive and negative parts (e.g. the EPE and ENE of a
+    trade, each term is divided by the sample size as in the post processor), the requested quantiles (e.g. the PFE)
+    are then computed by orderStatistics() on an internal copy of the sample. The copy is reused by subsequent updates,
+    so that one instance should be used per thread for all dates of a profile.
+
+    \ingroup analytics
+*/
+class ExposureStatistics {
+public:
+    //! \p quantiles are the levels in [0, 1] computed by each update
+    explicit ExposureStatistics(const std::vector<QuantLib::Real>& quantiles = std::vector<QuantLib::Real>());
+
+    //! Compute the statistics of the sample \p x
+    void update(const std::vector<QuantLib::Real>& x);
+
+    //! Inspectors, valid after update()
+    //@{
+    QuantLib::Real mean() const { return mean_; }
+    QuantLib::Real positiveMean() const { return positiveMean_; }
+    QuantLib::Real negativeMean() const { return negativeMean_; }
+    //! the sample value for the i-th requested quantile level, see quantileIndex()
+    QuantLib::Real quantile(QuantLib::Size i) const;
+    //@}
+
+private:
+    std::vector<QuantLib::Real> levels_, quantiles_, buffer_;
+    std::vector<QuantLib::Size> indices_;
+    QuantLib::Real mean_, positiveMean_, negativeMean_;
+};
+
+} // namespace analytics
+} // namespace ore
@@ -16,8 +16,10 @@
  FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
 */
 
+#include <orea/aggregation/exposurestatistics.hpp>
 #include <orea/aggregation/postprocess.hpp>
 #include <ored/utilities/log.hpp>
+#include <ored/utilities/parallel.hpp>
 #include <ored/utilities/vectorutils.hpp>
 #include <ql/errors.hpp>
 #include <ql/time/calendars/weekendsonly.hpp>
@@ -30,6 +32,7 @@
 #include <ql/time/daycounters/actualactual.hpp>
 
 #include <qle/math/nadarayawatson.hpp>
+#include <qle/math/polynomialregression.hpp>
 #include <qle/math/stabilisedglls.hpp>
 
 #include <boost/accumulators/accumulators.hpp>
@@ -37,6 +40,9 @@
 #include <boost/accumulators/statistics/mean.hpp>
 #include <boost/accumulators/statistics/stats.hpp>
 
+#include <array>
+#include <numeric>
+
 using namespace std;
 using namespace QuantLib;
 
@@ -45,6 +51,46 @@ using namespace boost::accumulators;
 namespace ore {
 namespace analytics {
 
+namespace {
+
+// Exposure profiles of a single trade, computed concurrently per netting set
+struct TradeExposure {
+    vector<Real> epe, ene, ee_b, eee_b, pfe;
+    Real epe_b, eepe_b;
+};
+
+// Exposure profiles and COLVA of a single netting set, computed concurrently
+struct NettingSetExposure {
+    vector<Real> epe, ene, ee_b, eee_b, eab, pfe, colvaInc, eoniaFloorInc;
+    Real epe_b, eepe_b, colva, collateralFloor;
+};
+
+// Basel EPE_B and EEPE_B as time weighted averages of EE_B and EEE_B up to the given maturity time
+void timeAverage(const vector<Real>& times, Real maturityTime, const vector<Real>& ee_b, const vector<Real>& eee_b,
+                 Real& epe_b, Real& eepe_b) {
+    Size dates = times.size();
+    Size t = 0;
+    while (t < dates && times[t] <= maturityTime)
+        ++t;
+
+    if (t > 0) {
+        vector<double> weights(t);
+        weights[0] = times[0];
+        for (Size k = 1; k < t; k++)
+            weights[k] = times[k] - times[k - 1];
+        double totalWeights = std::accumulate(weights.begin(), weights.end(), 0.0);
+        for (Size k = 0; k < t; k++)
+            weights[k] /= totalWeights;
+
+        for (Size k = 0; k < t; k++) {
+            epe_b += ee_b[k] * weights[k];
+            eepe_b += eee_b[k] * weights[k];
+        }
+    }
+}
+
+} // namespace
+
 AllocationMethod parseAllocationMethod(const string& s) {
     static map<string, AllocationMethod> m = {
         {"None", AllocationMethod::None},
@@ -78,6 +124,36 @@ std::ostream& operator<<(std::ostream& out, AllocationMethod m) {
     return out;
 }
 
+DimRegressionMethod parseDimRegressionMethod(const string& s) {
+    static map<string, DimRegressionMethod> m = {
+        {"StabilisedGLLS", DimRegressionMethod::StabilisedGLLS},
+        {"NormalEquations", DimRegressionMethod::NormalEquations},
+        {"QR", DimRegressionMethod::QR},
+        {"NadarayaWatson", DimRegressionMethod::NadarayaWatson},
+    };
+
+    auto it = m.find(s);
+    if (it != m.end()) {
+        return it->second;
+    } else {
+        QL_FAIL("DimRegressionMethod \"" << s << "\" not recognized");
+    }
+}
+
+std::ostream& operator<<(std::ostream& out, DimRegressionMethod m) {
+    if (m == DimRegressionMethod::StabilisedGLLS)
+        out << "StabilisedGLLS";
+    else if (m == DimRegressionMethod::NormalEquations)
+        out << "NormalEquations";
+    else if (m == DimRegressionMethod::QR)
+        out << "QR";
+    else if (m == DimRegressionMethod::NadarayaWatson)
+        out << "NadarayaWatson";
+    else
+        QL_FAIL("DIM regression method not covered");
+    return out;
+}
+
 PostProcess::PostProcess(const boost::shared_ptr<Portfolio>& portfolio,
                          const boost::shared_ptr<NettingSetManager>& nettingSetManager,
                          const boost::shared_ptr<Market>& market, const std::string& configuration,
@@ -90,7 +166,8 @@ PostProcess::PostProcess(const boost::shared_ptr<Portfolio>& portfolio,
                          vector<string> dimRegressors, Size dimLocalRegressionEvaluations,
                          Real dimLocalRegressionBandwidth, Real dimScaling, bool fullInitialCollateralisation,
                          Real kvaCapitalDiscountRate, Real kvaAlpha, Real kvaRegAdjustment, Real kvaCapitalHurdle,
-                         Real kvaOurPdFloor, Real kvaTheirPdFloor, Real kvaOurCvaRiskWeight, Real kvaTheirCvaRiskWeight)
+                         Real kvaOurPdFloor, Real kvaTheirPdFloor, Real kvaOurCvaRiskWeight, Real kvaTheirCvaRiskWeight,
+                         Size nThreads, const string& dimRegressionMethod)
     : portfolio_(portfolio), nettingSetManager_(nettingSetManager), market_(market), cube_(cube),
       scenarioData_(scenarioData), analytics_(analytics), baseCurrency_(baseCurrency), quantile_(quantile),
       calcType_(parseCollateralCalculationType(calculationType)), dvaName_(dvaName),
@@ -101,7 +178,8 @@ PostProcess::PostProcess(const boost::shared_ptr<Portfolio>& portfolio,
       fullInitialCollateralisation_(fullInitialCollateralisation), kvaCapitalDiscountRate_(kvaCapitalDiscountRate),
       kvaAlpha_(kvaAlpha), kvaRegAdjustment_(kvaRegAdjustment), kvaCapitalHurdle_(kvaCapitalHurdle),
       kvaOurPdFloor_(kvaOurPdFloor), kvaTheirPdFloor_(kvaTheirPdFloor), kvaOurCvaRiskWeight_(kvaOurCvaRiskWeight),
-      kvaTheirCvaRiskWeight_(kvaTheirCvaRiskWeight) {
+      kvaTheirCvaRiskWeight_(kvaTheirCvaRiskWeight), nThreads_(nThreads),
+      dimRegressionMethod_(parseDimRegressionMethod(dimRegressionMethod)) {
 
     QL_REQUIRE(marginalAllocationLimit > 0.0, "positive allocationLimit expected");
 
@@ -205,10 +283,10 @@ PostProcess::PostProcess(const boost::shared_ptr<Portfolio>& portfolio,
     map<string, Size> nettingSetSize;
     set<string> nettingSets;
     bool exerciseNextBreak = analytics_["exerciseNextBreak"];
+    vector<Date> nextBreakDates(trades);
     for (Size i = 0; i < portfolio->size(); ++i) {
         string tradeId = portfolio->trades()[i]->id();
         string nettingSetId = portfolio->trades()[i]->envelope().nettingSetId();
-        LOG("Aggregate exposure for trade " << tradeId);
         if (nettingSets.find(nettingSetId) == nettingSets.end()) {
             nettingSetValue[nettingSetId] = vector<vector<Real>>(dates, vector<Real>(samples, 0.0));
             nettingSets.insert(nettingSetId);
@@ -242,78 +320,100 @@ PostProcess::PostProcess(const boost::shared_ptr<Portfolio>& portfolio,
                 }
             }
         }
+        nextBreakDates[i] = nextBreakDate;
+    }
 
-        Handle<YieldTermStructure> curve = market_->discountCurve(baseCurrency_, configuration_);
-        Real npv0 = tradeValueToday[tradeId];
-        vector<Real> epe(dates + 1, 0.0);
-        vector<Real> ene(dates + 1, 0.0);
-        vector<Real> ee_b(dates + 1);
-        vector<Real> eee_b(dates + 1);
-        vector<Real> pfe(dates + 1, 0.0);
-        epe[0] = std::max(npv0, 0.0);
-        ene[0] = std::max(-npv0, 0.0);
-        ee_b[0] = epe[0];
-        eee_b[0] = ee_b[0];
-        pfe[0] = std::max(npv0, 0.0);
-        for (Size j = 0; j < dates; ++j) {
-            Date d = cube_->dates()[j];
+    for (auto n : nettingSetValue)
+        nettingSetIds_.push_back(n.first);
+
+    // trades per netting set in portfolio order, so that the netting set values are summed in the same order
+    // regardless of the number of threads
+    vector<vector<Size>> nettingSetTradeIndices(nettingSetIds_.size());
+    for (Size i = 0; i < trades; ++i) {
+        string nettingSetId = portfolio->trades()[i]->envelope().nettingSetId();
+        Size n = std::distance(nettingSetIds_.begin(),
+                               std::lower_bound(nettingSetIds_.begin(), nettingSetIds_.end(), nettingSetId));
+        nettingSetTradeIndices[n].push_back(i);
+    }
+
+    // Market data is read here on the calling thread only
+    Handle<YieldTermStructure> curve = market_->discountCurve(baseCurrency_, configuration_);
+    vector<Real> discounts(dates);
+    for (Size j = 0; j < dates; ++j)
+        discounts[j] = curve->discount(cube_->dates()[j]);
+    Calendar cal = WeekendsOnly();
+    /*The time average in the EEPE calculation is taken over the first year of the exposure evolution
+    (or until maturity if all positions of the netting set mature before one year).
+    This one year point is actually taken to be today+1Y+4D, so that the 1Y point on the dateGrid is always
+    included.
+    This may effect DateGrids with daily data points*/
+    Date oneYear = cal.adjust(today + 1 * Years + 4 * Days);
+
+    vector<TradeExposure> tradeExposures(trades);
+    parallelFor(
+        nettingSetIds_.size(),
+        [&](Size n) {
+            vector<vector<Real>>& value = nettingSetValue.at(nettingSetIds_[n]);
+            ExposureStatistics stats({quantile_});
             vector<Real> distribution(samples, 0.0);
-            for (Size k = 0; k < samples; ++k) {
-                Real npv = d > nextBreakDate && exerciseNextBreak ? 0.0 : cube->get(i, j, k);
-                epe[j + 1] += max(npv, 0.0) / samples;
-                ene[j + 1] += max(-npv, 0.0) / samples;
-                nettingSetValue[nettingSetId][j][k] += npv;
-                distribution[k] = npv;
+            for (Size i : nettingSetTradeIndices[n]) {
+                LOG("Aggregate exposure for trade " << portfolio->trades()[i]->id());
+                Real npv0 = cube_->getT0(i);
+                TradeExposure& e = tradeExposures[i];
+                e.epe = vector<Real>(dates + 1, 0.0);
+                e.ene = vector<Real>(dates + 1, 0.0);
+                e.ee_b = vector<Real>(dates + 1);
+                e.eee_b = vector<Real>(dates + 1);
+                e.pfe = vector<Real>(dates + 1, 0.0);
+                e.epe[0] = std::max(npv0, 0.0);
+                e.ene[0] = std::max(-npv0, 0.0);
+                e.ee_b[0] = e.epe[0];
+                e.eee_b[0] = e.ee_b[0];
+                e.pfe[0] = std::max(npv0, 0.0);
+                // the trade values are zero after its live dates, so that these only roll the EEE_B forward
+                Size liveDates = cube_->numLiveDates(i);
+                for (Size j = 0; j < dates; ++j) {
+                    if (j >= liveDates) {
+                        e.ee_b[j + 1] = 0.0;
+                        e.eee_b[j + 1] = e.eee_b[j];
+                        continue;
+                    }
+                    Date d = cube_->dates()[j];
+                    for (Size k = 0; k < samples; ++k) {
+                        Real npv = d > nextBreakDates[i] && exerciseNextBreak ? 0.0 : cube_->get(i, j, k);
+                        value[j][k] += npv;
+                        distribution[k] = npv;
+                    }
+                    stats.update(distribution);
+                    e.epe[j + 1] = stats.positiveMean();
+                    e.ene[j + 1] = stats.negativeMean();
+                    e.ee_b[j + 1] = e.epe[j + 1] / discounts[j];
+                    e.eee_b[j + 1] = std::max(e.eee_b[j], e.ee_b[j + 1]);
+                    e.pfe[j + 1] = std::max(stats.quantile(0), 0.0);
+                }
+                e.epe_b = 0.0;
+                e.eepe_b = 0.0;
+                Date maturity = std::min(oneYear, portfolio->trades()[i]->maturity());
+                timeAverage(times, dc.yearFraction(today, maturity), e.ee_b, e.eee_b, e.epe_b, e.eepe_b);
             }
-            ee_b[j + 1] = epe[j + 1] / curve->discount(cube_->dates()[j]);
-            eee_b[j + 1] = std::max(eee_b[j], ee_b[j + 1]);
-            std::sort(distribution.begin(), distribution.end());
-            Size index = Size(floor(quantile_ * (samples - 1) + 0.5));
-            pfe[j + 1] = std::max(distribution[index], 0.0);
-        }
+        },
+        nThreads_);
+
+    for (Size i = 0; i < trades; ++i) {
+        string tradeId = portfolio->trades()[i]->id();
         tradeIds_.push_back(tradeId);
-        tradeEPE_[tradeId] = epe;
-        tradeENE_[tradeId] = ene;
-        tradeEE_B_[tradeId] = ee_b;
-        tradeEEE_B_[tradeId] = eee_b;
-        tradePFE_[tradeId] = pfe;
-
-        Real epe_b = 0.0;
-        Real eepe_b = 0.0;
-
-        Size t = 0;
-        Calendar cal = WeekendsOnly();
-        /*The time average in the EEPE calculation is taken over the first year of the exposure evolution
-        (or until maturity if all positions of the netting set mature before one year).
-        This one year point is actually taken to be today+1Y+4D, so that the 1Y point on the dateGrid is always
-        included.
-        This may effect DateGrids with daily data points*/
-        Date maturity = std::min(cal.adjust(today + 1 * Years + 4 * Days), portfolio->trades()[i]->maturity());
-        QuantLib::Real maturityTime = dc.yearFraction(today, maturity);
-
-        while (t < dates && times[t] <= maturityTime)
-            ++t;
-
-        if (t > 0) {
-            vector<double> weights(t);
-            weights[0] = times[0];
-            for (Size k = 1; k < t; k++)
-                weights[k] = times[k] - times[k - 1];
-            double totalWeights = std::accumulate(weights.begin(), weights.end(), 0.0);
-            for (Size k = 0; k < t; k++)
-                weights[k] /= totalWeights;
-
-            for (Size k = 0; k < t; k++) {
-                epe_b += ee_b[k] * weights[k];
-                eepe_b += eee_b[k] * weights[k];
-            }
-        }
-        tradeEPE_B_[tradeId] = epe_b;
-        tradeEEPE_B_[tradeId] = eepe_b;
+        tradeEPE_[tradeId] = tradeExposures[i].epe;
+        tradeENE_[tradeId] = tradeExposures[i].ene;
+        tradeEE_B_[tradeId] = tradeExposures[i].ee_b;
+        tradeEEE_B_[tradeId] = tradeExposures[i].eee_b;
+        tradePFE_[tradeId] = tradeExposures[i].pfe;
+        tradeEPE_B_[tradeId] = tradeExposures[i].epe_b;
+        tradeEEPE_B_[tradeId] = tradeExposures[i].eepe_b;
         // Allocated exposures will be populated in step 3 below
         allocatedTradeEPE_[tradeId] = vector<Real>(dates + 1, 0.0);
         allocatedTradeENE_[tradeId] = vector<Real>(dates + 1, 0.0);
     }
+    tradeExposures.clear();
 
     /******************************************************************
      * Step 3: Netting set exposure and allocation to trades
@@ -330,192 +430,207 @@ PostProcess::PostProcess(const boost::shared_ptr<Portfolio>& portfolio,
      */
     LOG("Compute netting set exposure profiles");
 
-    for (auto n : nettingSetValue)
-        nettingSetIds_.push_back(n.first);
-
     // FIXME: Why is this not passed in? why are we hardcoding a cube instance here?
     nettedCube_ = boost::make_shared<SinglePrecisionInMemoryCube>(today, nettingSetIds_, cube_->dates(), samples);
 
     bool applyInitialMargin = analytics_["dim"];
-
-    Size nettingSetCount = 0;
-    for (auto n : nettingSetValue) {
-        string nettingSetId = n.first;
-        Size nettingSetTrades = nettingSetSize[nettingSetId];
-
-        LOG("Aggregate exposure for netting set " << nettingSetId);
-        vector<vector<Real>> data = n.second;
-
-        // Get the collateral account balance paths for the netting set.
-        // The pointer may remain empty if there is no CSA or if it is inactive.
-        boost::shared_ptr<vector<boost::shared_ptr<CollateralAccount>>> collateral = collateralPaths(
-            nettingSetId, nettingSetManager, market, configuration, scenarioData, dates, samples,
-            nettingSetValue[nettingSetId], nettingSetValueToday[nettingSetId], nettingSetMaturity[nettingSetId]);
-
-        // Get the CSA index for Eonia Floor calculation below
-        nettingSetCOLVA_[nettingSetId] = 0.0;
-        nettingSetCollateralFloor_[nettingSetId] = 0.0;
+    Size pfeIndex = quantileIndex(quantile_, samples);
+
+    // Collect the CSA market data on the calling thread
+    vector<Real> csaFxRatesToday(nettingSetIds_.size(), 1.0), csaRatesToday(nettingSetIds_.size(), 0.0);
+    vector<DayCounter> csaDayCounters(nettingSetIds_.size(), ActualActual());
+    for (Size n = 0; n < nettingSetIds_.size(); ++n) {
+        string nettingSetId = nettingSetIds_[n];
+        if (!nettingSetManager->has(nettingSetId) || !nettingSetManager->get(nettingSetId)->activeCsaFlag())
+            continue;
         boost::shared_ptr<NettingSetDefinition> netting = nettingSetManager->get(nettingSetId);
-        string csaIndexName;
-        Handle<IborIndex> csaIndex;
-        if (netting->activeCsaFlag()) {
-            csaIndexName = netting->index();
-            if (csaIndexName != "") {
-                csaIndex = market->iborIndex(csaIndexName);
-                QL_REQUIRE(scenarioData->has(AggregationScenarioDataType::IndexFixing, csaIndexName),
-                           "scenario data does not provide index values for " << csaIndexName);
-            }
+        string csaFxPair = netting->csaCurrency() + baseCurrency_;
+        if (netting->csaCurrency() != baseCurrency_)
+            csaFxRatesToday[n] = market->fxSpot(csaFxPair, configuration)->value();
+        LOG("CSA FX rate for pair " << csaFxPair << " = " << csaFxRatesToday[n]);
+        // Get the CSA index for Eonia Floor calculation below
+        string csaIndexName = netting->index();
+        csaRatesToday[n] = market->iborIndex(csaIndexName, configuration)->fixing(today);
+        LOG("CSA compounding rate for index " << csaIndexName << " = " << csaRatesToday[n]);
+        if (csaIndexName != "") {
+            Handle<IborIndex> csaIndex = market->iborIndex(csaIndexName);
+            QL_REQUIRE(scenarioData->has(AggregationScenarioDataType::IndexFixing, csaIndexName),
+                       "scenario data does not provide index values for " << csaIndexName);
+            csaDayCounters[n] = csaIndex->dayCounter();
         }
+    }
 
-        Handle<YieldTermStructure> curve = market_->discountCurve(baseCurrency_, configuration_);
-        vector<Real> epe(dates + 1, 0.0);
-        vector<Real> ene(dates + 1, 0.0);
-        vector<Real> ee_b(dates + 1, 0.0);
-        vector<Real> eee_b(dates + 1, 0.0);
-        vector<Real> eee_b_kva_1(dates + 1, 0.0);
-        vector<Real> eee_b_kva_2(dates + 1, 0.0);
-        vector<Real> eepe_b_kva_1(dates + 1, 0.0);
-        vector<Real> eepe_b_kva_2(dates + 1, 0.0);
-        vector<Real> eab(dates + 1, 0.0);
-        vector<Real> pfe(dates + 1, 0.0);
-        vector<Real> colvaInc(dates + 1, 0.0);
-        vector<Real> eoniaFloorInc(dates + 1, 0.0);
-        Real npv = nettingSetValueToday[nettingSetId];
-        if ((fullInitialCollateralisation_) & (netting->activeCsaFlag())) {
-            // This assumes that the collateral at t=0 is the same as the npv at t=0.
-            epe[0] = 0;
-            ene[0] = 0;
-            pfe[0] = 0;
-        } else {
-            epe[0] = std::max(npv, 0.0);
-            ene[0] = std::max(-npv, 0.0);
-            pfe[0] = std::max(npv, 0.0);
-        }
-        // The fullInitialCollateralisation flag doesn't affect the eab, which feeds into the "ExpectedCollateral"
-        // column of the 'exposure_nettingset_*' reports.  We always assume the full collateral here.
-        eab[0] = -npv;
-        ee_b[0] = epe[0];
-        eee_b[0] = ee_b[0];
-        nettedCube_->setT0(nettingSetValueToday[nettingSetId], nettingSetCount);
+    vector<NettingSetExposure> nettingSetExposures(nettingSetIds_.size());
+    parallelFor(
+        nettingSetIds_.size(),
+        [&](Size nettingSetCount) {
+            string nettingSetId = nettingSetIds_[nettingSetCount];
+            Size nettingSetTrades = nettingSetSize.at(nettingSetId);
+
+            LOG("Aggregate exposure for netting set " << nettingSetId);
+            const vector<vector<Real>>& data = nettingSetValue.at(nettingSetId);
+
+            // Get the collateral account balance paths for the netting set.
+            // The pointer may remain empty if there is no CSA or if it is inactive.
+            boost::shared_ptr<vector<vector<Real>>> collateral =
+                collateralPaths(nettingSetId, nettingSetManager, csaFxRatesToday[nettingSetCount],
+                                csaRatesToday[nettingSetCount], scenarioData, dates, samples, data,
+                                nettingSetValueToday.at(nettingSetId), nettingSetMaturity.at(nettingSetId));
+
+            NettingSetExposure& e = nettingSetExposures[nettingSetCount];
+            e.colva = 0.0;
+            e.collateralFloor = 0.0;
+            boost::shared_ptr<NettingSetDefinition> netting = nettingSetManager->get(nettingSetId);
+            string csaIndexName = netting->activeCsaFlag() ? netting->index() : "";
+            Size csaIndexKey =
+                csaIndexName != "" ? scenarioData->index(AggregationScenarioDataType::IndexFixing, csaIndexName) : 0;
+
+            e.epe = vector<Real>(dates + 1, 0.0);
+            e.ene = vector<Real>(dates + 1, 0.0);
+            e.ee_b = vector<Real>(dates + 1, 0.0);
+            e.eee_b = vector<Real>(dates + 1, 0.0);
+            e.eab = vector<Real>(dates + 1, 0.0);
+            e.pfe = vector<Real>(dates + 1, 0.0);
+            e.colvaInc = vector<Real>(dates + 1, 0.0);
+            e.eoniaFloorInc = vector<Real>(dates + 1, 0.0);
+            Real npv = nettingSetValueToday.at(nettingSetId);
+            if ((fullInitialCollateralisation_) & (netting->activeCsaFlag())) {
+                // This assumes that the collateral at t=0 is the same as the npv at t=0.
+                e.epe[0] = 0;
+                e.ene[0] = 0;
+                e.pfe[0] = 0;
+            } else {
+                e.epe[0] = std::max(npv, 0.0);
+                e.ene[0] = std::max(-npv, 0.0);
+                e.pfe[0] = std::max(npv, 0.0);
+            }
+            // The fullInitialCollateralisation flag doesn't affect the eab, which feeds into the "ExpectedCollateral"
+            // column of the 'exposure_nettingset_*' reports.  We always assume the full collateral here.
+            e.eab[0] = -npv;
+            e.ee_b[0] = e.epe[0];
+            e.eee_b[0] = e.ee_b[0];
+            nettedCube_->setT0(npv, nettingSetCount);
+
+            // The allocated exposures of the netting set's trades, each trade belongs to exactly one netting set,
+            // so that they are only updated by the thread processing this netting set
+            const vector<Size>& tradeIndices = nettingSetTradeIndices[nettingSetCount];
+            vector<vector<Real>*> allocatedEPEs, allocatedENEs;
+            if (allocationMethod == AllocationMethod::Marginal) {
+                for (Size i : tradeIndices) {
+                    allocatedEPEs.push_back(&allocatedTradeEPE_.at(portfolio->trades()[i]->id()));
+                    allocatedENEs.push_back(&allocatedTradeENE_.at(portfolio->trades()[i]->id()));
+                }
+            }
 
-        for (Size j = 0; j < dates; ++j) {
+            // The exposures and collateral balances of all samples at one date, the exposures are reordered by the
+            // PFE quantile selection after the allocation
+            vector<Real> distribution(samples, 0.0), balances(samples, 0.0);
+            for (Size j = 0; j < dates; ++j) {
 
-            Date date = cube_->dates()[j];
-            Date prevDate = j > 0 ? cube_->dates()[j - 1] : today;
+                Date date = cube_->dates()[j];
+                Date prevDate = j > 0 ? cube_->dates()[j - 1] : today;
 
-            vector<Real> distribution(samples, 0.0);
-            for (Size k = 0; k < samples; ++k) {
-                Real balance = 0.0;
-                if (collateral)
-                    balance = collateral->at(k)->accountBalance(date);
-
-                eab[j + 1] += balance / samples;
-                Real exposure = data[j][k] - balance;
-                Real dim = 0.0;
-                if (applyInitialMargin) {
-                    // Initial Margin
-                    // Use IM (at least one MPR in the past) to reduce today's exposure
-                    // from both parties' perspectives.
-                    // Assume that DIM is symmetric, same amount for both parties
-                    // FIXME: Interpolation to determine DIM at time t - MPOR
-                    //        The following is only correct for a grid with MPOR time steps.
-                    Size dimIndex = j == 0 ? 0 : j - 1;
-                    dim = nettingSetDIM_[nettingSetId][dimIndex][k];
-                    QL_REQUIRE(dim >= 0, "negative DIM for set " << nettingSetId << ", date " << j << ", sample " << k);
-                }
-                epe[j + 1] += std::max(exposure - dim, 0.0) /
-                              samples; // dim here represents the held IM, and is expressed as a positive number
-                ene[j + 1] += std::max(-exposure - dim, 0.0) /
-                              samples; // dim here represents the posted IM, and is expressed as a positive number
-                distribution[k] = exposure;
-                nettedCube_->set(exposure, nettingSetCount, j, k);
-
-                if (netting->activeCsaFlag()) {
-                    Real indexValue = 0.0;
-                    DayCounter dc = ActualActual();
-                    if (csaIndexName != "") {
-                        indexValue = scenarioData->get(j, k, AggregationScenarioDataType::IndexFixing, csaIndexName);
-                        dc = csaIndex->dayCounter();
+                for (Size k = 0; k < samples; ++k) {
+                    Real balance = 0.0;
+                    if (collateral)
+                        balance = (*collateral)[j][k];
+
+                    e.eab[j + 1] += balance / samples;
+                    Real exposure = data[j][k] - balance;
+                    Real dim = 0.0;
+                    if (applyInitialMargin) {
+                        // Initial Margin
+                        // Use IM (at least one MPR in the past) to reduce today's exposure
+                        // from both parties' perspectives.
+                        // Assume that DIM is symmetric, same amount for both parties
+                        // FIXME: Interpolation to determine DIM at time t - MPOR
+                        //        The following is only correct for a grid with MPOR time steps.
+                        Size dimIndex = j == 0 ? 0 : j - 1;
+                        dim = nettingSetDIM_.at(nettingSetId)[dimIndex][k];
+                        QL_REQUIRE(dim >= 0,
+                                   "negative DIM for set " << nettingSetId << ", date " << j << ", sample " << k);
+                    }
+                    e.epe[j + 1] += std::max(exposure - dim, 0.0) /
+                                    samples; // dim here represents the held IM, and is expressed as a positive number
+                    e.ene[j + 1] += std::max(-exposure - dim, 0.0) /
+                                    samples; // dim here represents the posted IM, and is expressed as a positive number
+                    distribution[k] = exposure;
+                    balances[k] = balance;
+                    nettedCube_->set(exposure, nettingSetCount, j, k);
+
+                    if (netting->activeCsaFlag()) {
+                        Real indexValue = 0.0;
+                        if (csaIndexName != "")
+                            indexValue = scenarioData->get(j, k, csaIndexKey);
+                        Real dcf = csaDayCounters[nettingSetCount].yearFraction(prevDate, date);
+                        Real collateralSpread =
+                            (balance >= 0.0 ? netting->collatSpreadRcv() : netting->collatSpreadPay());
+                        Real colvaDelta = -balance * collateralSpread * dcf / samples;
+                        // inutuitive floorDelta including collateralSpread would be:
+                        // -balance * (max(indexValue - collateralSpread,0) - (indexValue - collateralSpread)) * dcf /
+                        // samples
+                        Real floorDelta = -balance * std::max(-(indexValue - collateralSpread), 0.0) * dcf / samples;
+                        e.colvaInc[j + 1] += colvaDelta;
+                        e.colva += colvaDelta;
+                        e.eoniaFloorInc[j + 1] += floorDelta;
+                        e.collateralFloor += floorDelta;
                     }
-                    Real dcf = dc.yearFraction(prevDate, date);
-                    Real collateralSpread = (balance >= 0.0 ? netting->collatSpreadRcv() : netting->collatSpreadPay());
-                    Real colvaDelta = -balance * collateralSpread * dcf / samples;
-                    // inutuitive floorDelta including collateralSpread would be:
-                    // -balance * (max(indexValue - collateralSpread,0) - (indexValue - collateralSpread)) * dcf /
-                    // samples
-                    Real floorDelta = -balance * std::max(-(indexValue - collateralSpread), 0.0) * dcf / samples;
-                    colvaInc[j + 1] += colvaDelta;
-                    nettingSetCOLVA_[nettingSetId] += colvaDelta;
-                    eoniaFloorInc[j + 1] += floorDelta;
-                    nettingSetCollateralFloor_[nettingSetId] += floorDelta;
                 }
 
                 if (allocationMethod == AllocationMethod::Marginal) {
-                    for (Size i = 0; i < trades; ++i) {
-                        string nid = portfolio->trades()[i]->envelope().nettingSetId();
-                        if (nid != nettingSetId)
-                            continue;
-                        string tid = portfolio->trades()[i]->id();
-                        Real allocation = 0.0;
-                        if (balance == 0.0)
-                            allocation = cube->get(i, j, k);
-                        // else if (data[j][k] == 0.0)
-                        else if (fabs(data[j][k]) <= marginalAllocationLimit)
-                            allocation = exposure / nettingSetTrades;
-                        else
-                            allocation = exposure * cube->get(i, j, k) / data[j][k];
-
-                        if (exposure > 0.0)
-                            allocatedTradeEPE_[tid][j + 1] += allocation / samples;
-                        else
-                            allocatedTradeENE_[tid][j + 1] -= allocation / samples;
+                    // Allocate the exposure of all samples to one trade of the netting set at a time
+                    for (Size t = 0; t < tradeIndices.size(); ++t) {
+                        Size i = tradeIndices[t];
+                        Real& allocatedEPE = (*allocatedEPEs[t])[j + 1];
+                        Real& allocatedENE = (*allocatedENEs[t])[j + 1];
+                        for (Size k = 0; k < samples; ++k) {
+                            Real allocation = 0.0;
+                            if (balances[k] == 0.0)
+                                allocation = cube->get(i, j, k);
+                            // else if (data[j][k] == 0.0)
+                            else if (fabs(data[j][k]) <= marginalAllocationLimit)
+                                allocation = distribution[k] / nettingSetTrades;
+                            else
+                                allocation = distribution[k] * cube->get(i, j, k) / data[j][k];
+
+                            if (distribution[k] > 0.0)
+                                allocatedEPE += allocation / samples;
+                            else
+                                allocatedENE -= allocation / samples;
+                        }
                     }
                 }
+
+                e.ee_b[j + 1] = e.epe[j + 1] / discounts[j];
+                e.eee_b[j + 1] = std::max(e.eee_b[j], e.ee_b[j + 1]);
+                e.pfe[j + 1] = std::max(orderStatistics(distribution, {pfeIndex})[0], 0.0);
             }
-            ee_b[j + 1] = epe[j + 1] / curve->discount(cube_->dates()[j]);
-            eee_b[j + 1] = std::max(eee_b[j], ee_b[j + 1]);
-            std::sort(distribution.begin(), distribution.end());
-            Size index = Size(floor(quantile_ * (samples - 1) + 0.5));
-            pfe[j + 1] = std::max(distribution[index], 0.0);
-        }
-        expectedCollateral_[nettingSetId] = eab;
-        netEPE_[nettingSetId] = epe;
-        netENE_[nettingSetId] = ene;
-        netEE_B_[nettingSetId] = ee_b;
-        netEEE_B_[nettingSetId] = eee_b;
-        netPFE_[nettingSetId] = pfe;
-        colvaInc_[nettingSetId] = colvaInc;
-        eoniaFloorInc_[nettingSetId] = eoniaFloorInc;
-        nettingSetCount++;
-
-        Real epe_b = 0;
-        Real eepe_b = 0;
-
-        Size t = 0;
-        Calendar cal = WeekendsOnly();
-        Date maturity = std::min(cal.adjust(today + 1 * Years + 4 * Days), nettingSetMaturity[nettingSetId]);
-        QuantLib::Real maturityTime = dc.yearFraction(today, maturity);
-
-        while (t < dates && times[t] <= maturityTime)
-            ++t;
-
-        if (t > 0) {
-            vector<double> weights(t);
-            weights[0] = times[0];
-            for (Size k = 1; k < t; k++)
-                weights[k] = times[k] - times[k - 1];
-            double totalWeights = std::accumulate(weights.begin(), weights.end(), 0.0);
-            for (Size k = 0; k < t; k++)
-                weights[k] /= totalWeights;
-
-            for (Size k = 0; k < t; k++) {
-                epe_b += ee_b[k] * weights[k];
-                eepe_b += eee_b[k] * weights[k];
-            }
-        }
-        netEPE_B_[nettingSetId] = epe_b;
-        netEEPE_B_[nettingSetId] = eepe_b;
+
+            e.epe_b = 0.0;
+            e.eepe_b = 0.0;
+            Date maturity = std::min(oneYear, nettingSetMaturity.at(nettingSetId));
+            timeAverage(times, dc.yearFraction(today, maturity), e.ee_b, e.eee_b, e.epe_b, e.eepe_b);
+        },
+        nThreads_);
+
+    // Merge the netting set results in netting set order
+    for (Size n = 0; n < nettingSetIds_.size(); ++n) {
+        string nettingSetId = nettingSetIds_[n];
+        NettingSetExposure& e = nettingSetExposures[n];
+        nettingSetCOLVA_[nettingSetId] = e.colva;
+        nettingSetCollateralFloor_[nettingSetId] = e.collateralFloor;
+        expectedCollateral_[nettingSetId] = e.eab;
+        netEPE_[nettingSetId] = e.epe;
+        netENE_[nettingSetId] = e.ene;
+        netEE_B_[nettingSetId] = e.ee_b;
+        netEEE_B_[nettingSetId] = e.eee_b;
+        netPFE_[nettingSetId] = e.pfe;
+        colvaInc_[nettingSetId] = e.colvaInc;
+        eoniaFloorInc_[nettingSetId] = e.eoniaFloorInc;
+        netEPE_B_[nettingSetId] = e.epe_b;
+        netEEPE_B_[nettingSetId] = e.eepe_b;
     }
+    nettingSetExposures.clear();
 
     /********************************************************
      * Update Stand Alone XVAs
@@ -527,13 +642,10 @@ PostProcess::PostProcess(const boost::shared_ptr<Portfolio>& portfolio,
      * Simple allocation methods
      */
     if (allocationMethod != AllocationMethod::Marginal) {
-        for (auto n : nettingSetValue) {
-            string nettingSetId = n.first;
+        for (Size n = 0; n < nettingSetIds_.size(); ++n) {
+            string nid = nettingSetIds_[n];
 
-            for (Size i = 0; i < trades; ++i) {
-                string nid = portfolio->trades()[i]->envelope().nettingSetId();
-                if (nid != nettingSetId)
-                    continue;
+            for (Size i : nettingSetTradeIndices[n]) {
                 string tid = portfolio->trades()[i]->id();
 
                 for (Size j = 0; j < dates; ++j) {
@@ -597,192 +709,224 @@ void PostProcess::updateNettingSetKVA() {
     Handle<YieldTermStructure> discountCurve = market_->discountCurve(baseCurrency_, configuration_);
     DayCounter dc = ActualActual();
 
-    // Loop over all netting sets
-    for (auto n : netEPE_) {
-        string nettingSetId = n.first;
-        string cid = counterpartyId_[nettingSetId];
-        LOG("KVA for netting set " << nettingSetId);
+    // Market data is read here on the calling thread only
+    vector<Real> discounts(dates);
+    for (Size k = 0; k < dates; ++k)
+        discounts[k] = discountCurve->discount(dateVector[k]);
 
-        // Main input are the EPE and ENE profiles, previously computed
-        vector<Real> epe = netEPE_[nettingSetId];
-        vector<Real> ene = netENE_[nettingSetId];
+    vector<string> nettingSetIds;
+    for (auto n : netEPE_)
+        nettingSetIds.push_back(n.first);
+    vector<Real> PD1s(nettingSetIds.size()), PD2s(nettingSetIds.size(), 0.0);
+    vector<Real> LGD1s(nettingSetIds.size()), LGD2s(nettingSetIds.size());
+    for (Size n = 0; n < nettingSetIds.size(); ++n) {
+        string nettingSetId = nettingSetIds[n];
+        string cid = counterpartyId_[nettingSetId];
 
         // PD from counterparty Dts, floored to avoid 0 ...
         // Today changed to today+1Y to get the one-year PD
         Handle<DefaultProbabilityTermStructure> cvaDts = market_->defaultCurve(cid, configuration_);
         QL_REQUIRE(!cvaDts.empty(), "Default curve missing for counterparty " << cid);
         Real cvaRR = market_->recoveryRate(cid, configuration_)->value();
-        Real PD1 = std::max(cvaDts->defaultProbability(today + 1 * Years), 0.000000000001);
-        Real LGD1 = (1 - cvaRR);
+        PD1s[n] = std::max(cvaDts->defaultProbability(today + 1 * Years), 0.000000000001);
+        LGD1s[n] = (1 - cvaRR);
 
         Handle<DefaultProbabilityTermStructure> dvaDts;
         Real dvaRR = 0.0;
-        Real PD2 = 0;
         if (dvaName_ != "") {
             dvaDts = market_->defaultCurve(dvaName_, configuration_);
             dvaRR = market_->recoveryRate(dvaName_, configuration_)->value();
-            PD2 = std::max(dvaDts->defaultProbability(today + 1 * Years), 0.000000000001);
+            PD2s[n] = std::max(dvaDts->defaultProbability(today + 1 * Years), 0.000000000001);
         } else {
             ALOG("dvaName not specified, own PD set to zero for their KVA calculation");
         }
-        Real LGD2 = (1 - dvaRR);
-
-        // Granularity adjustment, Gordy (2004):
-        Real rho1 = 0.12 * (1 - std::exp(-50 * PD1)) / (1 - std::exp(-50)) +
-                    0.24 * (1 - (1 - std::exp(-50 * PD1)) / (1 - std::exp(-50)));
-        Real rho2 = 0.12 * (1 - std::exp(-50 * PD2)) / (1 - std::exp(-50)) +
-                    0.24 * (1 - (1 - std::exp(-50 * PD2)) / (1 - std::exp(-50)));
-
-        // Basel II internal rating based (IRB) estimate of worst case PD:
-        // Large homogeneous pool (LHP) approximation of Vasicek (1997)
-        InverseCumulativeNormal icn;
-        CumulativeNormalDistribution cnd;
-        Real PD99_1 = cnd((icn(PD1) + std::sqrt(rho1) * icn(0.999)) / (std::sqrt(1 - rho1))) - PD1;
-        Real PD99_2 = cnd((icn(PD2) + std::sqrt(rho2) * icn(0.999)) / (std::sqrt(1 - rho2))) - PD2;
-
-        // KVA regulatory PD, worst case PD, floored at 0.03 for corporates and banks, not floored for sovereigns
-        Real kva99PD1 = std::max(PD99_1, kvaTheirPdFloor_);
-        Real kva99PD2 = std::max(PD99_2, kvaOurPdFloor_);
-
-        // Factor B(PD) for the maturity adjustment factor, B(PD) = (0.11852 - 0.05478 * ln(PD)) ^ 2
-        Real kvaMatAdjB1 = std::pow((0.11852 - 0.05478 * std::log(PD1)), 2.0);
-        Real kvaMatAdjB2 = std::pow((0.11852 - 0.05478 * std::log(PD2)), 2.0);
-
-        DLOG("Our KVA-CCR " << nettingSetId << ": PD=" << PD1);
-        DLOG("Our KVA-CCR " << nettingSetId << ": LGD=" << LGD1);
-        DLOG("Our KVA-CCR " << nettingSetId << ": rho=" << rho1);
-        DLOG("Our KVA-CCR " << nettingSetId << ": PD99=" << PD99_1);
-        DLOG("Our KVA-CCR " << nettingSetId << ": PD Floor=" << kvaTheirPdFloor_);
-        DLOG("Our KVA-CCR " << nettingSetId << ": Floored PD99=" << kva99PD1);
-        DLOG("Our KVA-CCR " << nettingSetId << ": B(PD)=" << kvaMatAdjB1);
-
-        DLOG("Their KVA-CCR " << nettingSetId << ": PD=" << PD2);
-        DLOG("Their KVA-CCR " << nettingSetId << ": LGD=" << LGD2);
-        DLOG("Their KVA-CCR " << nettingSetId << ": rho=" << rho2);
-        DLOG("Their KVA-CCR " << nettingSetId << ": PD99=" << PD99_2);
-        DLOG("Their KVA-CCR " << nettingSetId << ": PD Floor=" << kvaOurPdFloor_);
-        DLOG("Their KVA-CCR " << nettingSetId << ": Floored PD99=" << kva99PD2);
-        DLOG("Their KVA-CCR " << nettingSetId << ": B(PD)=" << kvaMatAdjB2);
+        LGD2s[n] = (1 - dvaRR);
+    }
 
-        for (Size j = 0; j < dates; ++j) {
-            Date d0 = j == 0 ? today : cube_->dates()[j - 1];
-            Date d1 = cube_->dates()[j];
+    // Our and their KVA-CCR and KVA-CVA per netting set
+    vector<std::array<Real, 4>> kva(nettingSetIds.size(), {{0.0, 0.0, 0.0, 0.0}});
 
-            // Preprocess:
-            // 1) Effective maturity from effective expected exposure as of time j
-            //    Index _1 corresponds to our perspective, index _2 to their perspective.
-            // 2) Basel EEPE as of time j, i.e. as time averge over EEE, starting at time j
-            // More accuracy may be achieved here by using a Longstaff-Schwartz method / regression
-            Real eee_kva_1 = 0.0, eee_kva_2 = 0.0;
-            Real effMatNumer1 = 0.0, effMatNumer2 = 0.0;
-            Real effMatDenom1 = 0.0, effMatDenom2 = 0.0;
-            Real eepe_kva_1 = 0, eepe_kva_2 = 0.0;
-            Size kmax = j, count = 0;
-            // Cut off index for EEPE/EENE calculation: One year ahead
-            while (dateVector[kmax] < dateVector[j] + 1 * Years + 4 * Days && kmax < dates - 1)
-                kmax++;
-            Real sumdt = 0.0, eee1_b = 0.0, eee2_b = 0.0;
-            for (Size k = j; k < dates; ++k) {
-                Date d2 = cube_->dates()[k];
-                Date prevDate = k == 0 ? today : dateVector[k - 1];
-
-                eee_kva_1 = std::max(eee_kva_1, epe[k + 1]);
-                eee_kva_2 = std::max(eee_kva_2, ene[k + 1]);
-
-                // Components of the KVA maturity adjustment MA as of time j
-                if (dc.yearFraction(d1, d2) > 1.0) {
-                    effMatNumer1 += epe[k + 1] * dc.yearFraction(prevDate, d2);
-                    effMatNumer2 += ene[k + 1] * dc.yearFraction(prevDate, d2);
-                }
-                if (dc.yearFraction(d1, d2) <= 1.0) {
-                    effMatDenom1 += eee_kva_1 * dc.yearFraction(prevDate, d2);
-                    effMatDenom2 += eee_kva_2 * dc.yearFraction(prevDate, d2);
-                }
+    // Loop over all netting sets
+    parallelFor(
+        nettingSetIds.size(),
+        [&](Size n) {
+            string nettingSetId = nettingSetIds[n];
+            LOG("KVA for netting set " << nettingSetId);
+            Real& ourKvaCcr = kva[n][0];
+            Real& theirKvaCcr = kva[n][1];
+            Real& ourKvaCva = kva[n][2];
+            Real& theirKvaCva = kva[n][3];
+
+            // Main input are the EPE and ENE profiles, previously computed
+            const vector<Real>& epe = netEPE_.at(nettingSetId);
+            const vector<Real>& ene = netENE_.at(nettingSetId);
+
+            Real PD1 = PD1s[n], PD2 = PD2s[n], LGD1 = LGD1s[n], LGD2 = LGD2s[n];
+
+            // Granularity adjustment, Gordy (2004):
+            Real rho1 = 0.12 * (1 - std::exp(-50 * PD1)) / (1 - std::exp(-50)) +
+                        0.24 * (1 - (1 - std::exp(-50 * PD1)) / (1 - std::exp(-50)));
+            Real rho2 = 0.12 * (1 - std::exp(-50 * PD2)) / (1 - std::exp(-50)) +
+                        0.24 * (1 - (1 - std::exp(-50 * PD2)) / (1 - std::exp(-50)));
+
+            // Basel II internal rating based (IRB) estimate of worst case PD:
+            // Large homogeneous pool (LHP) approximation of Vasicek (1997)
+            InverseCumulativeNormal icn;
+            CumulativeNormalDistribution cnd;
+            Real PD99_1 = cnd((icn(PD1) + std::sqrt(rho1) * icn(0.999)) / (std::sqrt(1 - rho1))) - PD1;
+            Real PD99_2 = cnd((icn(PD2) + std::sqrt(rho2) * icn(0.999)) / (std::sqrt(1 - rho2))) - PD2;
+
+            // KVA regulatory PD, worst case PD, floored at 0.03 for corporates and banks, not floored for sovereigns
+            Real kva99PD1 = std::max(PD99_1, kvaTheirPdFloor_);
+            Real kva99PD2 = std::max(PD99_2, kvaOurPdFloor_);
+
+            // Factor B(PD) for the maturity adjustment factor, B(PD) = (0.11852 - 0.05478 * ln(PD)) ^ 2
+            Real kvaMatAdjB1 = std::pow((0.11852 - 0.05478 * std::log(PD1)), 2.0);
+            Real kvaMatAdjB2 = std::pow((0.11852 - 0.05478 * std::log(PD2)), 2.0);
+
+            DLOG("Our KVA-CCR " << nettingSetId << ": PD=" << PD1);
+            DLOG("Our KVA-CCR " << nettingSetId << ": LGD=" << LGD1);
+            DLOG("Our KVA-CCR " << nettingSetId << ": rho=" << rho1);
+            DLOG("Our KVA-CCR " << nettingSetId << ": PD99=" << PD99_1);
+            DLOG("Our KVA-CCR " << nettingSetId << ": PD Floor=" << kvaTheirPdFloor_);
+            DLOG("Our KVA-CCR " << nettingSetId << ": Floored PD99=" << kva99PD1);
+            DLOG("Our KVA-CCR " << nettingSetId << ": B(PD)=" << kvaMatAdjB1);
+
+            DLOG("Their KVA-CCR " << nettingSetId << ": PD=" << PD2);
+            DLOG("Their KVA-CCR " << nettingSetId << ": LGD=" << LGD2);
+            DLOG("Their KVA-CCR " << nettingSetId << ": rho=" << rho2);
+            DLOG("Their KVA-CCR " << nettingSetId << ": PD99=" << PD99_2);
+            DLOG("Their KVA-CCR " << nettingSetId << ": PD Floor=" << kvaOurPdFloor_);
+            DLOG("Their KVA-CCR " << nettingSetId << ": Floored PD99=" << kva99PD2);
+            DLOG("Their KVA-CCR " << nettingSetId << ": B(PD)=" << kvaMatAdjB2);
+
+            for (Size j = 0; j < dates; ++j) {
+                Date d0 = j == 0 ? today : cube_->dates()[j - 1];
+                Date d1 = cube_->dates()[j];
+
+                // Preprocess:
+                // 1) Effective maturity from effective expected exposure as of time j
+                //    Index _1 corresponds to our perspective, index _2 to their perspective.
+                // 2) Basel EEPE as of time j, i.e. as time averge over EEE, starting at time j
+                // More accuracy may be achieved here by using a Longstaff-Schwartz method / regression
+                Real eee_kva_1 = 0.0, eee_kva_2 = 0.0;
+                Real effMatNumer1 = 0.0, effMatNumer2 = 0.0;
+                Real effMatDenom1 = 0.0, effMatDenom2 = 0.0;
+                Real eepe_kva_1 = 0, eepe_kva_2 = 0.0;
+                Size kmax = j, count = 0;
+                // Cut off index for EEPE/EENE calculation: One year ahead
+                while (dateVector[kmax] < dateVector[j] + 1 * Years + 4 * Days && kmax < dates - 1)
+                    kmax++;
+                Real sumdt = 0.0, eee1_b = 0.0, eee2_b = 0.0;
+                for (Size k = j; k < dates; ++k) {
+                    Date d2 = cube_->dates()[k];
+                    Date prevDate = k == 0 ? today : dateVector[k - 1];
+
+                    eee_kva_1 = std::max(eee_kva_1, epe[k + 1]);
+                    eee_kva_2 = std::max(eee_kva_2, ene[k + 1]);
+
+                    // Components of the KVA maturity adjustment MA as of time j
+                    if (dc.yearFraction(d1, d2) > 1.0) {
+                        effMatNumer1 += epe[k + 1] * dc.yearFraction(prevDate, d2);
+                        effMatNumer2 += ene[k + 1] * dc.yearFraction(prevDate, d2);
+                    }
+                    if (dc.yearFraction(d1, d2) <= 1.0) {
+                        effMatDenom1 += eee_kva_1 * dc.yearFraction(prevDate, d2);
+                        effMatDenom2 += eee_kva_2 * dc.yearFraction(prevDate, d2);
+                    }
 
-                if (k < kmax) {
-                    Real dt = dc.yearFraction(cube_->dates()[k], cube_->dates()[k + 1]);
-                    sumdt += dt;
-                    Real epe_b = epe[k + 1] / discountCurve->discount(dateVector[k]);
-                    Real ene_b = ene[k + 1] / discountCurve->discount(dateVector[k]);
-                    eee1_b = std::max(epe_b, eee1_b);
-                    eee2_b = std::max(ene_b, eee2_b);
-                    eepe_kva_1 += eee1_b * dt;
-                    eepe_kva_2 += eee2_b * dt;
-                    count++;
+                    if (k < kmax) {
+                        Real dt = dc.yearFraction(cube_->dates()[k], cube_->dates()[k + 1]);
+                        sumdt += dt;
+                        Real epe_b = epe[k + 1] / discounts[k];
+                        Real ene_b = ene[k + 1] / discounts[k];
+                        eee1_b = std::max(epe_b, eee1_b);
+                        eee2_b = std::max(ene_b, eee2_b);
+                        eepe_kva_1 += eee1_b * dt;
+                        eepe_kva_2 += eee2_b * dt;
+                        count++;
+                    }
                 }
-            }
 
-            // Normalize EEPE/EENE calculation
-            eepe_kva_1 = count > 0 ? eepe_kva_1 / sumdt : 0.0;
-            eepe_kva_2 = count > 0 ? eepe_kva_2 / sumdt : 0.0;
-
-            // KVA CCR using the IRB risk weighted asset method and IMM:
-            // KVA effective maturity of the nettingSet, capped at 5
-            Real kvaNWMaturity1 = std::min(1.0 + (effMatDenom1 == 0.0 ? 0.0 : effMatNumer1 / effMatDenom1), 5.0);
-            Real kvaNWMaturity2 = std::min(1.0 + (effMatDenom2 == 0.0 ? 0.0 : effMatNumer2 / effMatDenom2), 5.0);
-
-            // Maturity adjustment factor for the RWA method:
-            // MA(PD, M) = (1 + (M - 2.5) * B(PD)) / (1 - 1.5 * B(PD)), capped at 5, floored at 1, M = effective
-            // maturity
-            Real kvaMatAdj1 =
-                std::max(std::min((1.0 + (kvaNWMaturity1 - 2.5) * kvaMatAdjB1) / (1.0 - 1.5 * kvaMatAdjB1), 5.0), 1.0);
-            Real kvaMatAdj2 =
-                std::max(std::min((1.0 + (kvaNWMaturity2 - 2.5) * kvaMatAdjB2) / (1.0 - 1.5 * kvaMatAdjB2), 5.0), 1.0);
-
-            // CCR Capital: RC = EAD x LGD x PD99.9 x MA(PD, M); EAD = alpha x EEPE(t) (approximated by EPE here);
-            Real kvaRC1 = kvaAlpha_ * eepe_kva_1 * LGD1 * kva99PD1 * kvaMatAdj1;
-            Real kvaRC2 = kvaAlpha_ * eepe_kva_2 * LGD2 * kva99PD2 * kvaMatAdj2;
-
-            // Expected risk capital discounted at capital discount rate
-            Real kvaCapitalDiscount = 1 / std::pow(1 + kvaCapitalDiscountRate_, dc.yearFraction(today, d0));
-            Real kvaCCRIncrement1 =
-                kvaRC1 * kvaCapitalDiscount * dc.yearFraction(d0, d1) * kvaCapitalHurdle_ * kvaRegAdjustment_;
-            Real kvaCCRIncrement2 =
-                kvaRC2 * kvaCapitalDiscount * dc.yearFraction(d0, d1) * kvaCapitalHurdle_ * kvaRegAdjustment_;
-
-            ourNettingSetKVACCR_[nettingSetId] += kvaCCRIncrement1;
-            theirNettingSetKVACCR_[nettingSetId] += kvaCCRIncrement2;
-
-            DLOG("Our KVA-CCR for " << nettingSetId << ": " << j << " EEPE=" << setprecision(2) << eepe_kva_1
-                                    << " EPE=" << epe[j] << " RC=" << kvaRC1 << " M=" << setprecision(6)
-                                    << kvaNWMaturity1 << " MA=" << kvaMatAdj1 << " Cost=" << setprecision(2)
-                                    << kvaCCRIncrement1 << " KVA=" << ourNettingSetKVACCR_[nettingSetId]);
-            DLOG("Their KVA-CCR for " << nettingSetId << ": " << j << " EENE=" << eepe_kva_2 << " ENE=" << ene[j]
-                                      << " RC=" << kvaRC2 << " M=" << setprecision(6) << kvaNWMaturity2
-                                      << " MA=" << kvaMatAdj2 << " Cost=" << setprecision(2) << kvaCCRIncrement2
-                                      << " KVA=" << theirNettingSetKVACCR_[nettingSetId]);
-
-            // CVA Capital
-            // effective maturity without cap at 5, DF set to 1 for IMM banks
-            // TODO: Set MA in CCR capital calculation to 1
-            Real kvaCvaMaturity1 = 1.0 + (effMatDenom1 == 0.0 ? 0.0 : effMatNumer1 / effMatDenom1);
-            Real kvaCvaMaturity2 = 1.0 + (effMatDenom2 == 0.0 ? 0.0 : effMatNumer2 / effMatDenom2);
-            Real scva1 = kvaTheirCvaRiskWeight_ * kvaCvaMaturity1 * eepe_kva_1;
-            Real scva2 = kvaOurCvaRiskWeight_ * kvaCvaMaturity2 * eepe_kva_2;
-            Real kvaCVAIncrement1 =
-                scva1 * kvaCapitalDiscount * dc.yearFraction(d0, d1) * kvaCapitalHurdle_ * kvaRegAdjustment_;
-            Real kvaCVAIncrement2 =
-                scva2 * kvaCapitalDiscount * dc.yearFraction(d0, d1) * kvaCapitalHurdle_ * kvaRegAdjustment_;
-
-            DLOG("Our KVA-CVA for " << nettingSetId << ": " << j << " EEPE=" << eepe_kva_1 << " SCVA=" << scva1
-                                    << " Cost=" << kvaCVAIncrement1);
-            DLOG("Their KVA-CVA for " << nettingSetId << ": " << j << " EENE=" << eepe_kva_2 << " SCVA=" << scva2
-                                      << " Cost=" << kvaCVAIncrement2);
-
-            ourNettingSetKVACVA_[nettingSetId] += kvaCVAIncrement1;
-            theirNettingSetKVACVA_[nettingSetId] += kvaCVAIncrement2;
-        }
+                // Normalize EEPE/EENE calculation
+                eepe_kva_1 = count > 0 ? eepe_kva_1 / sumdt : 0.0;
+                eepe_kva_2 = count > 0 ? eepe_kva_2 / sumdt : 0.0;
+
+                // KVA CCR using the IRB risk weighted asset method and IMM:
+                // KVA effective maturity of the nettingSet, capped at 5
+                Real kvaNWMaturity1 = std::min(1.0 + (effMatDenom1 == 0.0 ? 0.0 : effMatNumer1 / effMatDenom1), 5.0);
+                Real kvaNWMaturity2 = std::min(1.0 + (effMatDenom2 == 0.0 ? 0.0 : effMatNumer2 / effMatDenom2), 5.0);
+
+                // Maturity adjustment factor for the RWA method:
+                // MA(PD, M) = (1 + (M - 2.5) * B(PD)) / (1 - 1.5 * B(PD)), capped at 5, floored at 1, M = effective
+                // maturity
+                Real kvaMatAdj1 = std::max(
+                    std::min((1.0 + (kvaNWMaturity1 - 2.5) * kvaMatAdjB1) / (1.0 - 1.5 * kvaMatAdjB1), 5.0), 1.0);
+                Real kvaMatAdj2 = std::max(
+                    std::min((1.0 + (kvaNWMaturity2 - 2.5) * kvaMatAdjB2) / (1.0 - 1.5 * kvaMatAdjB2), 5.0), 1.0);
+
+                // CCR Capital: RC = EAD x LGD x PD99.9 x MA(PD, M); EAD = alpha x EEPE(t) (approximated by EPE here);
+                Real kvaRC1 = kvaAlpha_ * eepe_kva_1 * LGD1 * kva99PD1 * kvaMatAdj1;
+                Real kvaRC2 = kvaAlpha_ * eepe_kva_2 * LGD2 * kva99PD2 * kvaMatAdj2;
+
+                // Expected risk capital discounted at capital discount rate
+                Real kvaCapitalDiscount = 1 / std::pow(1 + kvaCapitalDiscountRate_, dc.yearFraction(today, d0));
+                Real kvaCCRIncrement1 =
+                    kvaRC1 * kvaCapitalDiscount * dc.yearFraction(d0, d1) * kvaCapitalHurdle_ * kvaRegAdjustment_;
+                Real kvaCCRIncrement2 =
+                    kvaRC2 * kvaCapitalDiscount * dc.yearFraction(d0, d1) * kvaCapitalHurdle_ * kvaRegAdjustment_;
+
+                ourKvaCcr += kvaCCRIncrement1;
+                theirKvaCcr += kvaCCRIncrement2;
+
+                DLOG("Our KVA-CCR for " << nettingSetId << ": " << j << " EEPE=" << setprecision(2) << eepe_kva_1
+                                        << " EPE=" << epe[j] << " RC=" << kvaRC1 << " M=" << setprecision(6)
+                                        << kvaNWMaturity1 << " MA=" << kvaMatAdj1 << " Cost=" << setprecision(2)
+                                        << kvaCCRIncrement1 << " KVA=" << ourKvaCcr);
+                DLOG("Their KVA-CCR for " << nettingSetId << ": " << j << " EENE=" << eepe_kva_2 << " ENE=" << ene[j]
+                                          << " RC=" << kvaRC2 << " M=" << setprecision(6) << kvaNWMaturity2
+                                          << " MA=" << kvaMatAdj2 << " Cost=" << setprecision(2) << kvaCCRIncrement2
+                                          << " KVA=" << theirKvaCcr);
+
+                // CVA Capital
+                // effective maturity without cap at 5, DF set to 1 for IMM banks
+                // TODO: Set MA in CCR capital calculation to 1
+                Real kvaCvaMaturity1 = 1.0 + (effMatDenom1 == 0.0 ? 0.0 : effMatNumer1 / effMatDenom1);
+                Real kvaCvaMaturity2 = 1.0 + (effMatDenom2 == 0.0 ? 0.0 : effMatNumer2 / effMatDenom2);
+                Real scva1 = kvaTheirCvaRiskWeight_ * kvaCvaMaturity1 * eepe_kva_1;
+                Real scva2 = kvaOurCvaRiskWeight_ * kvaCvaMaturity2 * eepe_kva_2;
+                Real kvaCVAIncrement1 =
+                    scva1 * kvaCapitalDiscount * dc.yearFraction(d0, d1) * kvaCapitalHurdle_ * kvaRegAdjustment_;
+                Real kvaCVAIncrement2 =
+                    scva2 * kvaCapitalDiscount * dc.yearFraction(d0, d1) * kvaCapitalHurdle_ * kvaRegAdjustment_;
+
+                DLOG("Our KVA-CVA for " << nettingSetId << ": " << j << " EEPE=" << eepe_kva_1 << " SCVA=" << scva1
+                                        << " Cost=" << kvaCVAIncrement1);
+                DLOG("Their KVA-CVA for " << nettingSetId << ": " << j << " EENE=" << eepe_kva_2 << " SCVA=" << scva2
+                                          << " Cost=" << kvaCVAIncrement2);
+
+                ourKvaCva += kvaCVAIncrement1;
+                theirKvaCva += kvaCVAIncrement2;
+            }
+        },
+        nThreads_);
+
+    for (Size n = 0; n < nettingSetIds.size(); ++n) {
+        ourNettingSetKVACCR_[nettingSetIds[n]] = kva[n][0];
+        theirNettingSetKVACCR_[nettingSetIds[n]] = kva[n][1];
+        ourNettingSetKVACVA_[nettingSetIds[n]] = kva[n][2];
+        theirNettingSetKVACVA_[nettingSetIds[n]] = kva[n][3];
     }
 }
 
-boost::shared_ptr<vector<boost::shared_ptr<CollateralAccount>>>
+boost::shared_ptr<vector<vector<Real>>>
 PostProcess::collateralPaths(const string& nettingSetId, const boost::shared_ptr<NettingSetManager>& nettingSetManager,
-                             const boost::shared_ptr<Market>& market, const std::string& configuration,
+                             Real csaFxRateToday, Real csaRateToday,
                              const boost::shared_ptr<AggregationScenarioData>& scenarioData, Size dates, Size samples,
                              const vector<vector<Real>>& nettingSetValue, Real nettingSetValueToday,
                              const Date& nettingSetMaturity) {
 
-    boost::shared_ptr<vector<boost::shared_ptr<CollateralAccount>>> collateral;
+    boost::shared_ptr<vector<vector<Real>>> collateral;
 
     if (!nettingSetManager->has(nettingSetId) || !nettingSetManager->get(nettingSetId)->activeCsaFlag()) {
         LOG("CSA missing or inactive for netting set " << nettingSetId);
@@ -792,16 +936,10 @@ PostProcess::collateralPaths(const string& nettingSetId, const boost::shared_ptr
     LOG("Build collateral account balance paths for netting set " << nettingSetId);
     boost::shared_ptr<NettingSetDefinition> netting = nettingSetManager->get(nettingSetId);
     string csaFxPair = netting->csaCurrency() + baseCurrency_;
-    Real csaFxRateToday = 1.0;
-    if (netting->csaCurrency() != baseCurrency_)
-        csaFxRateToday = market->fxSpot(csaFxPair, configuration)->value();
-    LOG("CSA FX rate for pair " << csaFxPair << " = " << csaFxRateToday);
 
     // Don't use Settings::instance().evaluationDate() here, this has moved to simulation end date.
-    Date today = market->asofDate();
+    Date today = market_->asofDate();
     string csaIndexName = netting->index();
-    Real csaRateToday = market->iborIndex(csaIndexName, configuration)->fixing(today);
-    LOG("CSA compounding rate for index " << csaIndexName << " = " << csaRateToday);
 
     // Copy scenario data to keep the collateral exposure helper unchanged
     vector<vector<Real>> csaScenFxRates(dates, vector<Real>(samples, 0.0));
@@ -814,20 +952,25 @@ PostProcess::collateralPaths(const string& nettingSetId, const boost::shared_ptr
         QL_REQUIRE(scenarioData_->has(AggregationScenarioDataType::IndexFixing, csaIndexName),
                    "scenario data does not provide index values for " << csaIndexName);
     }
+    Size csaFxKey = 0, csaIndexKey = 0;
+    if (netting->csaCurrency() != baseCurrency_)
+        csaFxKey = scenarioData_->index(AggregationScenarioDataType::FXSpot, netting->csaCurrency());
+    if (csaIndexName != "")
+        csaIndexKey = scenarioData_->index(AggregationScenarioDataType::IndexFixing, csaIndexName);
     for (Size j = 0; j < dates; ++j) {
-        for (Size k = 0; k < samples; ++k) {
-            if (netting->csaCurrency() != baseCurrency_)
-                csaScenFxRates[j][k] =
-                    scenarioData_->get(j, k, AggregationScenarioDataType::FXSpot, netting->csaCurrency());
-            else
-                csaScenFxRates[j][k] = 1.0;
-            if (csaIndexName != "") {
-                csaScenRates[j][k] = scenarioData_->get(j, k, AggregationScenarioDataType::IndexFixing, csaIndexName);
-            }
+        if (netting->csaCurrency() != baseCurrency_) {
+            const Real* fx = scenarioData_->samples(j, csaFxKey);
+            csaScenFxRates[j].assign(fx, fx + samples);
+        } else {
+            csaScenFxRates[j].assign(samples, 1.0);
+        }
+        if (csaIndexName != "") {
+            const Real* rates = scenarioData_->samples(j, csaIndexKey);
+            csaScenRates[j].assign(rates, rates + samples);
         }
     }
 
-    collateral = CollateralExposureHelper::collateralBalancePaths(
+    collateral = CollateralExposureHelper::collateralBalances(
         netting,              // this netting set's definition
         nettingSetValueToday, // today's netting set NPV
         today,                // original evaluation date
@@ -844,209 +987,147 @@ PostProcess::collateralPaths(const string& nettingSetId, const boost::shared_ptr
     return collateral;
 }
 
-void PostProcess::updateStandAloneXVA() {
-    Size trades = portfolio_->size();
+const vector<Real>& PostProcess::survivalProbabilities(const string& name, const string& configuration) {
+    auto key = std::make_pair(name, configuration);
+    auto it = survivalProbabilities_.find(key);
+    if (it != survivalProbabilities_.end())
+        return it->second;
+    Handle<DefaultProbabilityTermStructure> dts = market_->defaultCurve(name, configuration);
+    QL_REQUIRE(!dts.empty(), "Default curve missing for " << name);
+    vector<Real> sp(cube_->dates().size() + 1);
+    sp[0] = dts->survivalProbability(market_->asofDate());
+    for (Size j = 0; j < cube_->dates().size(); ++j)
+        sp[j + 1] = dts->survivalProbability(cube_->dates()[j]);
+    return survivalProbabilities_[key] = sp;
+}
+
+const vector<Real>& PostProcess::fundingSpreadDcfs(const string& curve) {
+    auto it = fundingSpreadDcfs_.find(curve);
+    if (it != fundingSpreadDcfs_.end())
+        return it->second;
     Size dates = cube_->dates().size();
-    Date today = market_->asofDate();
+    vector<Real> dcf(dates, 0.0);
+    if (curve != "") {
+        Handle<YieldTermStructure> fundingCurve = market_->yieldCurve(curve, configuration_);
+        Handle<YieldTermStructure> oisCurve = market_->discountCurve(baseCurrency_, configuration_);
+        for (Size j = 0; j < dates; ++j) {
+            Date d0 = j == 0 ? market_->asofDate() : cube_->dates()[j - 1];
+            Date d1 = cube_->dates()[j];
+            dcf[j] = fundingCurve->discount(d0) / fundingCurve->discount(d1) -
+                     oisCurve->discount(d0) / oisCurve->discount(d1);
+        }
+    }
+    return fundingSpreadDcfs_[curve] = dcf;
+}
 
-    // Trade XVA
-    for (Size i = 0; i < trades; ++i) {
+const PostProcess::XvaWeights& PostProcess::xvaWeights(const string& cid, const string& curveConfiguration) {
+    auto key = std::make_pair(cid, curveConfiguration);
+    auto it = xvaWeights_.find(key);
+    if (it != xvaWeights_.end())
+        return it->second;
+
+    Size dates = cube_->dates().size();
+    const vector<Real>& cvaS = survivalProbabilities(cid, curveConfiguration);
+    Real cvaRR = market_->recoveryRate(cid, configuration_)->value();
+    vector<Real> dvaS(dates + 1, 1.0);
+    Real dvaRR = 0.0;
+    if (dvaName_ != "") {
+        dvaS = survivalProbabilities(dvaName_, configuration_);
+        dvaRR = market_->recoveryRate(dvaName_, configuration_)->value();
+    }
+    const vector<Real>& borrowingSpreadDcf = fundingSpreadDcfs(fvaBorrowingCurve_);
+    const vector<Real>& lendingSpreadDcf = fundingSpreadDcfs(fvaLendingCurve_);
+
+    XvaWeights w;
+    w.cva.resize(dates);
+    w.dva.resize(dates);
+    w.fca.resize(dates);
+    w.fcaExOwnSP.resize(dates);
+    w.fba.resize(dates);
+    w.fbaExOwnSP.resize(dates);
+    w.fcaExAllSP = borrowingSpreadDcf;
+    w.fbaExAllSP = lendingSpreadDcf;
+    for (Size j = 0; j < dates; ++j) {
+        w.cva[j] = (1.0 - cvaRR) * (cvaS[j] - cvaS[j + 1]);
+        w.dva[j] = (1.0 - dvaRR) * (dvaS[j] - dvaS[j + 1]);
+        w.fca[j] = cvaS[j] * dvaS[j] * borrowingSpreadDcf[j];
+        w.fcaExOwnSP[j] = cvaS[j] * borrowingSpreadDcf[j];
+        w.fba[j] = cvaS[j] * dvaS[j] * lendingSpreadDcf[j];
+        w.fbaExOwnSP[j] = cvaS[j] * lendingSpreadDcf[j];
+    }
+    return xvaWeights_[key] = w;
+}
+
+namespace {
+// sum of w[j] * x[j + offset]
+Real dot(const vector<Real>& w, const vector<Real>& x, Size offset) {
+    QL_REQUIRE(x.size() >= w.size() + offset, "profile size " << x.size() << " too small for " << w.size() << " dates");
+    return std::inner_product(w.begin(), w.end(), x.begin() + offset, 0.0);
+}
+} // namespace
+
+void PostProcess::updateStandAloneXVA() {
+    // Trade XVA, the profiles hold today's exposure first
+    for (Size i = 0; i < portfolio_->size(); ++i) {
         string tradeId = portfolio_->trades()[i]->id();
         LOG("Update XVA for trade " << tradeId);
-        string cid = portfolio_->trades()[i]->envelope().counterparty();
         string nid = portfolio_->trades()[i]->envelope().nettingSetId();
-        Handle<DefaultProbabilityTermStructure> cvaDts = market_->defaultCurve(cid, configuration_);
-        QL_REQUIRE(!cvaDts.empty(), "Default curve missing for counterparty " << cid);
-        Real cvaRR = market_->recoveryRate(cid, configuration_)->value();
-        Handle<DefaultProbabilityTermStructure> dvaDts;
-        Real dvaRR = 0.0;
-        if (dvaName_ != "") {
-            dvaDts = market_->defaultCurve(dvaName_, configuration_);
-            dvaRR = market_->recoveryRate(dvaName_, configuration_)->value();
-        }
-        Handle<YieldTermStructure> borrowingCurve, lendingCurve;
-        if (fvaBorrowingCurve_ != "")
-            borrowingCurve = market_->yieldCurve(fvaBorrowingCurve_, configuration_);
-        if (fvaLendingCurve_ != "")
-            lendingCurve = market_->yieldCurve(fvaLendingCurve_, configuration_);
-
-        Handle<YieldTermStructure> oisCurve = market_->discountCurve(baseCurrency_, configuration_);
-        tradeCVA_[tradeId] = 0.0;
-        tradeDVA_[tradeId] = 0.0;
-        tradeFBA_[tradeId] = 0.0;
-        tradeFCA_[tradeId] = 0.0;
+        const XvaWeights& w = xvaWeights(portfolio_->trades()[i]->envelope().counterparty(), configuration_);
+        const vector<Real>& epe = tradeEPE_.at(tradeId);
+        const vector<Real>& ene = tradeENE_.at(tradeId);
+        tradeCVA_[tradeId] = dot(w.cva, epe, 1);
+        tradeDVA_[tradeId] = dot(w.dva, ene, 1);
+        tradeFCA_[tradeId] = dot(w.fca, epe, 1);
+        tradeFCA_exOwnSP_[tradeId] = dot(w.fcaExOwnSP, epe, 1);
+        tradeFCA_exAllSP_[tradeId] = dot(w.fcaExAllSP, epe, 1);
+        tradeFBA_[tradeId] = dot(w.fba, ene, 1);
+        tradeFBA_exOwnSP_[tradeId] = dot(w.fbaExOwnSP, ene, 1);
+        tradeFBA_exAllSP_[tradeId] = dot(w.fbaExAllSP, ene, 1);
         tradeMVA_[tradeId] = 0.0; // FIXME: MVA is not computed at trade level yet, remains initialised at 0
-        for (Size j = 0; j < dates; ++j) {
-            Date d0 = j == 0 ? today : cube_->dates()[j - 1];
-            Date d1 = cube_->dates()[j];
-            Real cvaS0 = cvaDts->survivalProbability(d0);
-            Real cvaS1 = cvaDts->survivalProbability(d1);
-            Real dvaS0 = dvaDts.empty() ? 1.0 : dvaDts->survivalProbability(d0);
-            Real dvaS1 = dvaDts.empty() ? 1.0 : dvaDts->survivalProbability(d1);
-            Real cvaIncrement = (1.0 - cvaRR) * (cvaS0 - cvaS1) * tradeEPE_[tradeId][j + 1];
-            Real dvaIncrement = (1.0 - dvaRR) * (dvaS0 - dvaS1) * tradeENE_[tradeId][j + 1];
-            tradeCVA_[tradeId] += cvaIncrement;
-            tradeDVA_[tradeId] += dvaIncrement;
-
-            Real borrowingSpreadDcf = 0.0;
-            if (!borrowingCurve.empty())
-                borrowingSpreadDcf = borrowingCurve->discount(d0) / borrowingCurve->discount(d1) -
-                                     oisCurve->discount(d0) / oisCurve->discount(d1);
-            Real fcaIncrement = cvaS0 * dvaS0 * borrowingSpreadDcf * tradeEPE_[tradeId][j + 1];
-            Real fcaIncrement_exOwnSP = cvaS0 * borrowingSpreadDcf * tradeEPE_[tradeId][j + 1];
-            Real fcaIncrement_exAllSP = borrowingSpreadDcf * tradeEPE_[tradeId][j + 1];
-            tradeFCA_[tradeId] += fcaIncrement;
-            tradeFCA_exOwnSP_[tradeId] += fcaIncrement_exOwnSP;
-            tradeFCA_exAllSP_[tradeId] += fcaIncrement_exAllSP;
-
-            Real lendingSpreadDcf = 0.0;
-            if (!lendingCurve.empty())
-                lendingSpreadDcf = lendingCurve->discount(d0) / lendingCurve->discount(d1) -
-                                   oisCurve->discount(d0) / oisCurve->discount(d1);
-            Real fbaIncrement = cvaS0 * dvaS0 * lendingSpreadDcf * tradeENE_[tradeId][j + 1];
-            Real fbaIncrement_exOwnSP = cvaS0 * lendingSpreadDcf * tradeENE_[tradeId][j + 1];
-            Real fbaIncrement_exAllSP = lendingSpreadDcf * tradeENE_[tradeId][j + 1];
-            tradeFBA_[tradeId] += fbaIncrement;
-            tradeFBA_exOwnSP_[tradeId] += fbaIncrement_exOwnSP;
-            tradeFBA_exAllSP_[tradeId] += fbaIncrement_exAllSP;
-        }
-        if (sumTradeCVA_.find(nid) == sumTradeCVA_.end()) {
-            sumTradeCVA_[nid] = 0.0;
-            sumTradeDVA_[nid] = 0.0;
-        }
         sumTradeCVA_[nid] += tradeCVA_[tradeId];
         sumTradeDVA_[nid] += tradeDVA_[tradeId];
     }
 
     bool applyMVA = analytics_["mva"];
 
-    // Netting Set XVA
-    for (auto n : netEPE_) {
+    // Netting Set XVA, the counterparty default curves are taken from the default market configuration here
+    for (auto const& n : netEPE_) {
         string nettingSetId = n.first;
         LOG("Update XVA for netting set " << nettingSetId);
-        vector<Real> epe = netEPE_[nettingSetId];
-        vector<Real> ene = netENE_[nettingSetId];
-
-        vector<Real> edim;
-        if (applyMVA)
-            edim = nettingSetExpectedDIM_[nettingSetId];
-        string cid = counterpartyId_[nettingSetId];
-        Handle<DefaultProbabilityTermStructure> cvaDts = market_->defaultCurve(cid);
-        QL_REQUIRE(!cvaDts.empty(), "Default curve missing for counterparty " << cid);
-        Real cvaRR = market_->recoveryRate(cid, configuration_)->value();
-        Handle<DefaultProbabilityTermStructure> dvaDts;
-        Real dvaRR = 0.0;
-        if (dvaName_ != "") {
-            dvaDts = market_->defaultCurve(dvaName_, configuration_);
-            dvaRR = market_->recoveryRate(dvaName_, configuration_)->value();
-        }
-
-        Handle<YieldTermStructure> borrowingCurve, lendingCurve;
-        if (fvaBorrowingCurve_ != "")
-            borrowingCurve = market_->yieldCurve(fvaBorrowingCurve_, configuration_);
-        if (fvaLendingCurve_ != "")
-            lendingCurve = market_->yieldCurve(fvaLendingCurve_, configuration_);
-
-        Handle<YieldTermStructure> oisCurve = market_->discountCurve(baseCurrency_, configuration_);
-        nettingSetCVA_[nettingSetId] = 0.0;
-        nettingSetDVA_[nettingSetId] = 0.0;
-        nettingSetFBA_[nettingSetId] = 0.0;
-        nettingSetFCA_[nettingSetId] = 0.0;
-        nettingSetMVA_[nettingSetId] = 0.0;
-        for (Size j = 0; j < dates; ++j) {
-            Date d0 = j == 0 ? today : cube_->dates()[j - 1];
-            Date d1 = cube_->dates()[j];
-            Real cvaS0 = cvaDts->survivalProbability(d0);
-            Real cvaS1 = cvaDts->survivalProbability(d1);
-            Real dvaS0 = dvaDts.empty() ? 1.0 : dvaDts->survivalProbability(d0);
-            Real dvaS1 = dvaDts.empty() ? 1.0 : dvaDts->survivalProbability(d1);
-            Real cvaIncrement = (1.0 - cvaRR) * (cvaS0 - cvaS1) * epe[j + 1];
-            Real dvaIncrement = (1.0 - dvaRR) * (dvaS0 - dvaS1) * ene[j + 1];
-            nettingSetCVA_[nettingSetId] += cvaIncrement;
-            nettingSetDVA_[nettingSetId] += dvaIncrement;
-
-            Real borrowingSpreadDcf = 0.0;
-            if (!borrowingCurve.empty())
-                borrowingSpreadDcf = borrowingCurve->discount(d0) / borrowingCurve->discount(d1) -
-                                     oisCurve->discount(d0) / oisCurve->discount(d1);
-            Real fcaIncrement = cvaS0 * dvaS0 * borrowingSpreadDcf * epe[j + 1];
-            Real fcaIncrement_exOwnSP = cvaS0 * borrowingSpreadDcf * epe[j + 1];
-            Real fcaIncrement_exAllSP = borrowingSpreadDcf * epe[j + 1];
-            nettingSetFCA_[nettingSetId] += fcaIncrement;
-            nettingSetFCA_exOwnSP_[nettingSetId] += fcaIncrement_exOwnSP;
-            nettingSetFCA_exAllSP_[nettingSetId] += fcaIncrement_exAllSP;
-
-            Real lendingSpreadDcf = 0.0;
-            if (!lendingCurve.empty())
-                lendingSpreadDcf = lendingCurve->discount(d0) / lendingCurve->discount(d1) -
-                                   oisCurve->discount(d0) / oisCurve->discount(d1);
-            Real fbaIncrement = cvaS0 * dvaS0 * lendingSpreadDcf * ene[j + 1];
-            Real fbaIncrement_exOwnSP = cvaS0 * lendingSpreadDcf * ene[j + 1];
-            Real fbaIncrement_exAllSP = lendingSpreadDcf * ene[j + 1];
-            nettingSetFBA_[nettingSetId] += fbaIncrement;
-            nettingSetFBA_exOwnSP_[nettingSetId] += fbaIncrement_exOwnSP;
-            nettingSetFBA_exAllSP_[nettingSetId] += fbaIncrement_exAllSP;
-
-            // FIXME: Subtract the spread received on posted IM in MVA calculation
-            if (applyMVA) {
-                Real mvaIncrement = cvaS0 * dvaS0 * borrowingSpreadDcf * edim[j];
-                nettingSetMVA_[nettingSetId] += mvaIncrement;
-            }
-        }
+        const XvaWeights& w = xvaWeights(counterpartyId_[nettingSetId], Market::defaultConfiguration);
+        const vector<Real>& epe = n.second;
+        const vector<Real>& ene = netENE_.at(nettingSetId);
+        nettingSetCVA_[nettingSetId] = dot(w.cva, epe, 1);
+        nettingSetDVA_[nettingSetId] = dot(w.dva, ene, 1);
+        nettingSetFCA_[nettingSetId] = dot(w.fca, epe, 1);
+        nettingSetFCA_exOwnSP_[nettingSetId] = dot(w.fcaExOwnSP, epe, 1);
+        nettingSetFCA_exAllSP_[nettingSetId] = dot(w.fcaExAllSP, epe, 1);
+        nettingSetFBA_[nettingSetId] = dot(w.fba, ene, 1);
+        nettingSetFBA_exOwnSP_[nettingSetId] = dot(w.fbaExOwnSP, ene, 1);
+        nettingSetFBA_exAllSP_[nettingSetId] = dot(w.fbaExAllSP, ene, 1);
+        // FIXME: Subtract the spread received on posted IM in MVA calculation
+        nettingSetMVA_[nettingSetId] = applyMVA ? dot(w.fca, nettingSetExpectedDIM_.at(nettingSetId), 0) : 0.0;
     }
 }
 
 void PostProcess::updateAllocatedXVA() {
-    Size trades = portfolio_->size();
-    Size dates = cube_->dates().size();
-    Date today = market_->asofDate();
-
     // Allocated Trade XVA
-    for (Size i = 0; i < trades; ++i) {
+    for (Size i = 0; i < portfolio_->size(); ++i) {
         string tradeId = portfolio_->trades()[i]->id();
         LOG("Update XVA for trade " << tradeId);
-        string cid = portfolio_->trades()[i]->envelope().counterparty();
-        Handle<DefaultProbabilityTermStructure> cvaDts = market_->defaultCurve(cid, configuration_);
-        QL_REQUIRE(!cvaDts.empty(), "Default curve missing for counterparty " << cid);
-        Real cvaRR = market_->recoveryRate(cid, configuration_)->value();
-        Handle<DefaultProbabilityTermStructure> dvaDts;
-        Real dvaRR = 0.0;
-        if (dvaName_ != "") {
-            dvaDts = market_->defaultCurve(dvaName_, configuration_);
-            dvaRR = market_->recoveryRate(dvaName_, configuration_)->value();
-        }
-        allocatedTradeCVA_[tradeId] = 0.0;
-        allocatedTradeDVA_[tradeId] = 0.0;
-        for (Size j = 0; j < dates; ++j) {
-            Date d0 = j == 0 ? today : cube_->dates()[j - 1];
-            Date d1 = cube_->dates()[j];
-            Real cvaS0 = cvaDts->survivalProbability(d0);
-            Real cvaS1 = cvaDts->survivalProbability(d1);
-            Real dvaS0 = dvaDts.empty() ? 1.0 : dvaDts->survivalProbability(d0);
-            Real dvaS1 = dvaDts.empty() ? 1.0 : dvaDts->survivalProbability(d1);
-            Real allocatedCvaIncrement = (1.0 - cvaRR) * (cvaS0 - cvaS1) * allocatedTradeEPE_[tradeId][j + 1];
-            Real allocatedDvaIncrement = (1.0 - dvaRR) * (dvaS0 - dvaS1) * allocatedTradeENE_[tradeId][j + 1];
-            allocatedTradeCVA_[tradeId] += allocatedCvaIncrement;
-            allocatedTradeDVA_[tradeId] += allocatedDvaIncrement;
-        }
+        const XvaWeights& w = xvaWeights(portfolio_->trades()[i]->envelope().counterparty(), configuration_);
+        allocatedTradeCVA_[tradeId] = dot(w.cva, allocatedTradeEPE_.at(tradeId), 1);
+        allocatedTradeDVA_[tradeId] = dot(w.dva, allocatedTradeENE_.at(tradeId), 1);
     }
 }
 
 Disposable<Array> PostProcess::regressorArray(string nettingSet, Size dateIndex, Size sampleIndex) {
     Array a(dimRegressors_.size());
     for (Size i = 0; i < dimRegressors_.size(); ++i) {
-        string variable = dimRegressors_[i];
-        if (boost::to_upper_copy(variable) ==
-            "NPV") // this allows possibility to include NPV as a regressor alongside more fundamental risk factors
-            a[i] = nettingSetNPV_[nettingSet][dateIndex][sampleIndex];
-        else if (scenarioData_->has(AggregationScenarioDataType::IndexFixing, variable))
-            a[i] = scenarioData_->get(dateIndex, sampleIndex, AggregationScenarioDataType::IndexFixing, variable);
-        else if (scenarioData_->has(AggregationScenarioDataType::FXSpot, variable))
-            a[i] = scenarioData_->get(dateIndex, sampleIndex, AggregationScenarioDataType::FXSpot, variable);
-        else if (scenarioData_->has(AggregationScenarioDataType::Generic, variable))
-            a[i] = scenarioData_->get(dateIndex, sampleIndex, AggregationScenarioDataType::Generic, variable);
+        if (dimRegressorKeys_[i] == Null<Size>())
+            a[i] = nettingSetNPV_.at(nettingSet)[dateIndex][sampleIndex];
         else
-            QL_FAIL("scenario data does not provide data for " << variable);
+            a[i] = scenarioData_->get(dateIndex, sampleIndex, dimRegressorKeys_[i]);
     }
     return a;
 }
@@ -1081,10 +1162,11 @@ void PostProcess::dynamicInitialMargin() {
         }
         nettingSetSize[nettingSetId]++;
 
-        for (Size j = 0; j < dates; ++j) {
+        QL_REQUIRE(cube_->depth() > 1, "cube depth > 1 expected for DIM, found depth " << cube_->depth());
+        // matured trades do not contribute to the netting set NPV and flows
+        for (Size j = 0; j < cube_->numLiveDates(i); ++j) {
             for (Size k = 0; k < samples; ++k) {
                 Real npv = cube_->get(i, j, k);
-                QL_REQUIRE(cube_->depth() > 1, "cube depth > 1 expected for DIM, found depth " << cube_->depth());
                 Real flow = cube_->get(i, j, k, 1);
                 nettingSetNPV_[nettingSetId][j][k] += npv;
                 nettingSetFLOW_[nettingSetId][j][k] += flow;
@@ -1096,6 +1178,22 @@ void PostProcess::dynamicInitialMargin() {
     for (auto n : nettingSets)
         nettingSetIds.push_back(n);
 
+    // Resolve the scenario data keys of the regressors once, Null<Size>() stands for the netting set NPV
+    dimRegressorKeys_.clear();
+    for (auto const& variable : dimRegressors_) {
+        if (boost::to_upper_copy(variable) ==
+            "NPV") // this allows possibility to include NPV as a regressor alongside more fundamental risk factors
+            dimRegressorKeys_.push_back(Null<Size>());
+        else if (scenarioData_->has(AggregationScenarioDataType::IndexFixing, variable))
+            dimRegressorKeys_.push_back(scenarioData_->index(AggregationScenarioDataType::IndexFixing, variable));
+        else if (scenarioData_->has(AggregationScenarioDataType::FXSpot, variable))
+            dimRegressorKeys_.push_back(scenarioData_->index(AggregationScenarioDataType::FXSpot, variable));
+        else if (scenarioData_->has(AggregationScenarioDataType::Generic, variable))
+            dimRegressorKeys_.push_back(scenarioData_->index(AggregationScenarioDataType::Generic, variable));
+        else
+            QL_FAIL("scenario data does not provide data for " << variable);
+    }
+
     // Perform the T0 calculation
     performT0DimCalc();
 
@@ -1117,29 +1215,52 @@ void PostProcess::dynamicInitialMargin() {
     Real confidenceLevel = QuantLib::InverseCumulativeNormal()(dimQuantile_);
     LOG("DIM confidence level " << confidenceLevel);
 
-    Size simple_dim_index_h = Size(floor(dimQuantile_ * (samples - 1) + 0.5));
-    Size simple_dim_index_p = Size(floor((1.0 - dimQuantile_) * (samples - 1) + 0.5));
+    Size simple_dim_index_h = quantileIndex(dimQuantile_, samples);
+    Size simple_dim_index_p = quantileIndex(1.0 - dimQuantile_, samples);
 
-    Size nettingSetCount = 0;
-    for (auto n : nettingSets) {
+    Size numeraireKey = scenarioData_->index(AggregationScenarioDataType::Numeraire);
+
+    LOG("DIM regression method = " << dimRegressionMethod_);
+    for (auto const& n : nettingSetIds)
         LOG("Process netting set " << n);
-        // Set last date's IM to zero for all samples
-        for (Size k = 0; k < samples; ++k) {
-            nettingSetDIM_[n][dates - 1][k] = 0.0;
-            nettingSetLocalDIM_[n][dates - 1][k] = 0.0;
-            nettingSetDeltaNPV_[n][dates - 1][k] = 0.0;
-        }
-        for (Size j = 0; j < dates - 1; ++j) {
+
+    // The regressions for each pair of netting set and date are independent and processed concurrently, each task
+    // writes to its own date slice of the (existing) map entries only
+    parallelFor(
+        nettingSetIds.size() * dates,
+        [&](Size task) {
+            Size nettingSetCount = task / dates;
+            Size j = task % dates;
+            const string& n = nettingSetIds[nettingSetCount];
+            auto& nettingSetNPV = nettingSetNPV_.at(n);
+            auto& nettingSetFLOW = nettingSetFLOW_.at(n);
+            auto& nettingSetDIM = nettingSetDIM_.at(n);
+            auto& nettingSetLocalDIM = nettingSetLocalDIM_.at(n);
+            auto& nettingSetDeltaNPV = nettingSetDeltaNPV_.at(n);
+            auto& regressors = regressorArray_.at(n);
+            auto& nettingSetExpectedDIM = nettingSetExpectedDIM_.at(n);
+            auto& nettingSetZeroOrderDIM = nettingSetZeroOrderDIM_.at(n);
+            auto& nettingSetSimpleDIMh = nettingSetSimpleDIMh_.at(n);
+            auto& nettingSetSimpleDIMp = nettingSetSimpleDIMp_.at(n);
+            if (j == dates - 1) {
+                // Set last date's IM to zero for all samples
+                for (Size k = 0; k < samples; ++k) {
+                    nettingSetDIM[j][k] = 0.0;
+                    nettingSetLocalDIM[j][k] = 0.0;
+                    nettingSetDeltaNPV[j][k] = 0.0;
+                }
+                return;
+            }
+            const Real* num1 = scenarioData_->samples(j, numeraireKey);
+            const Real* num2 = scenarioData_->samples(j + 1, numeraireKey);
             accumulator_set<double, stats<tag::mean, tag::variance>> accDiff;
             accumulator_set<double, stats<tag::mean>> accOneOverNumeraire;
             for (Size k = 0; k < samples; ++k) {
-                Real num1 = scenarioData_->get(j, k, AggregationScenarioDataType::Numeraire);
-                Real num2 = scenarioData_->get(j + 1, k, AggregationScenarioDataType::Numeraire);
-                Real npv1 = nettingSetNPV_[n][j][k];
-                Real flow = nettingSetFLOW_[n][j][k];
-                Real npv2 = nettingSetNPV_[n][j + 1][k];
-                accDiff(npv2 * num2 + flow * num1 - npv1 * num1);
-                accOneOverNumeraire(1.0 / num1);
+                Real npv1 = nettingSetNPV[j][k];
+                Real flow = nettingSetFLOW[j][k];
+                Real npv2 = nettingSetNPV[j + 1][k];
+                accDiff(npv2 * num2[k] + flow * num1[k] - npv1 * num1[k]);
+                accOneOverNumeraire(1.0 / num1[k]);
             }
 
             Date d1 = cube_->dates()[j];
@@ -1149,73 +1270,108 @@ void PostProcess::dynamicInitialMargin() {
             Real E_OneOverNumeraire =
                 mean(accOneOverNumeraire); // "re-discount" (the stdev is calculated on non-discounted deltaNPVs)
 
-            nettingSetZeroOrderDIM_[n][j] = stdevDiff * horizonScaling * confidenceLevel;
-            nettingSetZeroOrderDIM_[n][j] *= E_OneOverNumeraire;
+            nettingSetZeroOrderDIM[j] = stdevDiff * horizonScaling * confidenceLevel;
+            nettingSetZeroOrderDIM[j] *= E_OneOverNumeraire;
 
             vector<Real> rx0(samples, 0.0);
             vector<Array> rx(samples, Array());
             vector<Real> ry1(samples, 0.0);
             vector<Real> ry2(samples, 0.0);
             for (Size k = 0; k < samples; ++k) {
-                Real num1 = scenarioData_->get(j, k, AggregationScenarioDataType::Numeraire);
-                Real num2 = scenarioData_->get(j + 1, k, AggregationScenarioDataType::Numeraire);
-                Real x = nettingSetNPV_[n][j][k] * num1;
-                Real f = nettingSetFLOW_[n][j][k] * num1;
-                Real y = nettingSetNPV_[n][j + 1][k] * num2;
+                Real x = nettingSetNPV[j][k] * num1[k];
+                Real f = nettingSetFLOW[j][k] * num1[k];
+                Real y = nettingSetNPV[j + 1][k] * num2[k];
                 Real z = (y + f - x);
-                rx[k] = dimRegressors_.empty() ? Array(1, nettingSetNPV_[n][j][k]) : regressorArray(n, j, k);
+                rx[k] = dimRegressors_.empty() ? Array(1, nettingSetNPV[j][k]) : regressorArray(n, j, k);
                 rx0[k] = rx[k][0];
                 ry1[k] = z;     // for local regression
                 ry2[k] = z * z; // for least squares regression
-                nettingSetDeltaNPV_[n][j][k] = z;
-                regressorArray_[n][j][k] = rx[k];
+                nettingSetDeltaNPV[j][k] = z;
+                regressors[j][k] = rx[k];
             }
-            vector<Real> delNpvVec_copy = nettingSetDeltaNPV_[n][j];
-            sort(delNpvVec_copy.begin(), delNpvVec_copy.end());
-            Real simpleDim_h = delNpvVec_copy[simple_dim_index_h];
-            Real simpleDim_p = delNpvVec_copy[simple_dim_index_p];
-            simpleDim_h *= horizonScaling;                                  // the usual scaling factors
-            simpleDim_p *= horizonScaling;                                  // the usual scaling factors
-            nettingSetSimpleDIMh_[n][j] = simpleDim_h * E_OneOverNumeraire; // discounted DIM
-            nettingSetSimpleDIMp_[n][j] = simpleDim_p * E_OneOverNumeraire; // discounted DIM
+            // We only need two order statistics, so that a selection is sufficient
+            vector<Real> delNpvVec_copy = nettingSetDeltaNPV[j];
+            vector<Real> simpleDim = orderStatistics(delNpvVec_copy, {simple_dim_index_h, simple_dim_index_p});
+            Real simpleDim_h = simpleDim[0];
+            Real simpleDim_p = simpleDim[1];
+            simpleDim_h *= horizonScaling;                              // the usual scaling factors
+            simpleDim_p *= horizonScaling;                              // the usual scaling factors
+            nettingSetSimpleDIMh[j] = simpleDim_h * E_OneOverNumeraire; // discounted DIM
+            nettingSetSimpleDIMp[j] = simpleDim_p * E_OneOverNumeraire; // discounted DIM
 
             QL_REQUIRE(rx.size() > v.size(), "not enough points for regression with polynom order " << polynomOrder);
             if (close_enough(stdevDiff, 0.0)) {
                 LOG("DIM: Zero std dev estimation at step " << j);
                 // Skip IM calculation if all samples have zero NPV (e.g. after latest maturity)
                 for (Size k = 0; k < samples; ++k) {
-                    nettingSetDIM_[n][j][k] = 0.0;
-                    nettingSetLocalDIM_[n][j][k] = 0.0;
+                    nettingSetDIM[j][k] = 0.0;
+                    nettingSetLocalDIM[j][k] = 0.0;
                 }
-            } else {
+                return;
+            }
+
+            // Conditional variance of z given the regressors, evaluated at the sample points
+            vector<Real> variances(samples);
+            if (dimRegressionMethod_ == DimRegressionMethod::StabilisedGLLS) {
                 // Least squares polynomial regression with specified polynom order
                 QuantExt::StabilisedGLLS ls(rx, ry2, v, QuantExt::StabilisedGLLS::MeanStdDev);
                 LOG("DIM data normalisation at time step "
-                    << j << ": " << scientific << setprecision(6) << " x-shift = " << ls.xShift() << " x-multiplier = "
-                    << ls.xMultiplier() << " y-shift = " << ls.yShift() << " y-multiplier = " << ls.yMultiplier());
+                    << j << ": " << scientific << setprecision(6) << " x-shift = " << ls.xShift()
+                    << " x-multiplier = " << ls.xMultiplier() << " y-shift = " << ls.yShift()
+                    << " y-multiplier = " << ls.yMultiplier());
+                LOG("DIM regression coefficients at time step " << j << ": " << fixed << setprecision(6)
+                                                                << ls.transformedCoefficients());
+                for (Size k = 0; k < samples; ++k)
+                    variances[k] = ls.eval(rx[k], v);
+            } else if (dimRegressionMethod_ == DimRegressionMethod::NormalEquations ||
+                       dimRegressionMethod_ == DimRegressionMethod::QR) {
+                // The same regression on a contiguous design matrix, which is reused for the evaluation
+                QuantExt::PolynomialRegression ls(polynomOrder, regressionDimension,
+                                                  dimRegressionMethod_ == DimRegressionMethod::QR
+                                                      ? QuantExt::PolynomialRegression::Solver::QR
+                                                      : QuantExt::PolynomialRegression::Solver::NormalEquations);
+                ls.fit(rx, ry2);
+                LOG("DIM data normalisation at time step "
+                    << j << ": " << scientific << setprecision(6) << " x-shift = " << ls.xShift()
+                    << " x-multiplier = " << ls.xMultiplier() << " y-shift = " << ls.yShift()
+                    << " y-multiplier = " << ls.yMultiplier());
                 LOG("DIM regression coefficients at time step " << j << ": " << fixed << setprecision(6)
                                                                 << ls.transformedCoefficients());
+                for (Size k = 0; k < samples; ++k)
+                    variances[k] = ls.fittedValue(k);
+            }
 
-                // Local regression versus first regression variable (i.e. we do not perform a
-                // multidimensional local regression):
-                // We evaluate this at a limited number of samples only for validation purposes.
-                // Note that computational effort scales quadratically with number of samples.
-                // NadarayaWatson needs a large number of samples for good results.
-                QuantExt::NadarayaWatson lr(rx0.begin(), rx0.end(), ry1.begin(),
-                                            GaussianKernel(0.0, dimLocalRegressionBandwidth_));
-                Size localRegressionSamples = samples;
-                if (dimLocalRegressionEvaluations_ > 0)
-                    localRegressionSamples = Size(floor(1.0 * samples / dimLocalRegressionEvaluations_ + .5));
-
-                // Evaluate regression function to compute DIM for each scenario
-                for (Size k = 0; k < samples; ++k) {
-                    Real num1 = scenarioData_->get(j, k, AggregationScenarioDataType::Numeraire);
-                    Array regressor =
-                        dimRegressors_.empty() ? Array(1, nettingSetNPV_[n][j][k]) : regressorArray(n, j, k);
-                    Real e = ls.eval(regressor, v);
+            // Local regression versus first regression variable (i.e. we do not perform a
+            // multidimensional local regression):
+            // Unless it is the selected DIM estimator, we evaluate this at a limited number of samples
+            // only for validation purposes.
+            // Note that computational effort scales quadratically with number of samples.
+            // NadarayaWatson needs a large number of samples for good results.
+            QuantExt::NadarayaWatson lr(rx0.begin(), rx0.end(), ry1.begin(),
+                                        GaussianKernel(0.0, dimLocalRegressionBandwidth_));
+            Size localRegressionSamples = samples;
+            if (dimRegressionMethod_ == DimRegressionMethod::NadarayaWatson)
+                localRegressionSamples = 1;
+            else if (dimLocalRegressionEvaluations_ > 0)
+                localRegressionSamples = Size(floor(1.0 * samples / dimLocalRegressionEvaluations_ + .5));
+
+            // Evaluate regression function to compute DIM for each scenario
+            Real scalingFactor = horizonScaling * confidenceLevel * dimScaling_;
+            for (Size k = 0; k < samples; ++k) {
+                // Evaluate the Kernel regression for a subset of the samples only (performance)
+                if (k % localRegressionSamples == 0)
+                    nettingSetLocalDIM[j][k] = lr.standardDeviation(rx0[k]) * scalingFactor / num1[k];
+                else
+                    nettingSetLocalDIM[j][k] = 0.0;
+
+                Real dim;
+                if (dimRegressionMethod_ == DimRegressionMethod::NadarayaWatson) {
+                    dim = nettingSetLocalDIM[j][k];
+                } else {
+                    Real e = variances[k];
                     if (e < 0.0)
                         LOG("Negative variance regression for date " << j << ", sample " << k
-                                                                     << ", regressor = " << regressor);
+                                                                     << ", regressor = " << rx[k]);
 
                     // Note:
                     // 1) We assume vanishing mean of "z", because the drift over a MPOR is usually small,
@@ -1224,23 +1380,14 @@ void PostProcess::dynamicInitialMargin() {
                     //    extreme scenarios where an exact analytical or delta VaR calculation would yield a
                     //    variance aproaching zero. We correct this here by taking the positive part.
                     Real std = sqrt(std::max(e, 0.0));
-                    Real scalingFactor = horizonScaling * confidenceLevel * dimScaling_;
-                    Real dim = std * scalingFactor / num1;
-                    dimCube_->set(dim, nettingSetCount, j, k);
-                    nettingSetDIM_[n][j][k] = dim;
-                    nettingSetExpectedDIM_[n][j] += dim / samples;
-
-                    // Evaluate the Kernel regression for a subset of the samples only (performance)
-                    if (k % localRegressionSamples == 0)
-                        nettingSetLocalDIM_[n][j][k] = lr.standardDeviation(regressor[0]) * scalingFactor / num1;
-                    else
-                        nettingSetLocalDIM_[n][j][k] = 0.0;
+                    dim = std * scalingFactor / num1[k];
                 }
+                dimCube_->set(dim, nettingSetCount, j, k);
+                nettingSetDIM[j][k] = dim;
+                nettingSetExpectedDIM[j] += dim / samples;
             }
-        }
-
-        nettingSetCount++;
-    }
+        },
+        nThreads_);
     LOG("DIM by regression done");
 }
 
@@ -1542,7 +1689,7 @@ void PostProcess::performT0DimCalc() {
     // TODO: Ensure that the simulation containers read-from below are indeed populated
 
     Real confidenceLevel = QuantLib::InverseCumulativeNormal()(dimQuantile_);
-    Size simple_dim_index_h = Size(floor(dimQuantile_ * (cube_->samples() - 1) + 0.5));
+    Size simple_dim_index_h = quantileIndex(dimQuantile_, cube_->samples());
     for (auto it_map = nettingSetNPV_.begin(); it_map != nettingSetNPV_.end(); ++it_map) {
         string key = it_map->first;
         boost::shared_ptr<NettingSetDefinition> nettingObj = nettingSetManager_->get(key);
@@ -1555,8 +1702,10 @@ void PostProcess::performT0DimCalc() {
         vector<Real> t0_delMtM_dist(dist_size, 0.0);
         accumulator_set<double, stats<tag::mean, tag::variance>> acc_delMtm;
         accumulator_set<double, stats<tag::mean>> acc_OneOverNum;
+        const Real* numeraires =
+            scenarioData_->samples(relevantDateIdx, scenarioData_->index(AggregationScenarioDataType::Numeraire));
         for (Size i = 0; i < dist_size; ++i) {
-            Real numeraire = scenarioData_->get(relevantDateIdx, i, AggregationScenarioDataType::Numeraire);
+            Real numeraire = numeraires[i];
             Real deltaMtmFromMean = numeraire * (t0_dist[i] - mean_t0_dist) * sqrtTimeScaling;
             t0_delMtM_dist[i] = deltaMtmFromMean;
             acc_delMtm(deltaMtmFromMean);
@@ -1566,8 +1715,7 @@ void PostProcess::performT0DimCalc() {
         Real variance_t0 = variance(acc_delMtm);
         Real sqrt_t0 = sqrt(variance_t0);
         net_t0_im_reg_h_[key] = (sqrt_t0 * confidenceLevel * E_OneOverNumeraire);
-        std::sort(t0_delMtM_dist.begin(), t0_delMtM_dist.end());
-        net_t0_im_simple_h_[key] = (t0_delMtM_dist[simple_dim_index_h] * E_OneOverNumeraire);
+        net_t0_im_simple_h_[key] = (orderStatistics(t0_delMtM_dist, {simple_dim_index_h})[0] * E_OneOverNumeraire);
 
         LOG("T0 IM (Reg) - {" << key << "} = " << net_t0_im_reg_h_[key]);
         LOG("T0 IM (Simple) - {" << key << "} = " << net_t0_im_simple_h_[key]);
@@ -1647,9 +1795,9 @@ void PostProcess::exportDimRegression(const std::string& nettingSet, const std::
         QL_REQUIRE(timeStep < dates - 1, "selected time step " << timeStep << " out of range [0, " << dates - 1 << "]");
 
         Size samples = cube_->samples();
-        vector<Real> numeraires(samples, 0.0);
-        for (Size k = 0; k < samples; ++k)
-            numeraires[k] = scenarioData_->get(timeStep, k, AggregationScenarioDataType::Numeraire);
+        const Real* numeraireSamples =
+            scenarioData_->samples(timeStep, scenarioData_->index(AggregationScenarioDataType::Numeraire));
+        vector<Real> numeraires(numeraireSamples, numeraireSamples + samples);
 
         auto p = sort_permutation(regressorArray_[nettingSet][timeStep], lessThan);
         vector<Array> reg = apply_permutation(regressorArray_[nettingSet][timeStep], p);
@@ -52,6 +52,17 @@ std::ostream& operator<<(std::ostream& out, AllocationMethod m);
 
 AllocationMethod parseAllocationMethod(const string& s);
 
+enum class DimRegressionMethod {
+    StabilisedGLLS,  // QuantExt::StabilisedGLLS
+    NormalEquations, // QuantExt::PolynomialRegression, Cholesky decomposition of the normal equations
+    QR,              // QuantExt::PolynomialRegression, QR decomposition of the design matrix
+    NadarayaWatson   // QuantExt::NadarayaWatson local regression versus the first regressor
+};
+
+std::ostream& operator<<(std::ostream& out, DimRegressionMethod m);
+
+DimRegressionMethod parseDimRegressionMethod(const string& s);
+
 //! Exposure Aggregation and XVA Calculation
 /*!
   This class aggregates NPV cube data, computes exposure statistics
@@ -83,6 +94,12 @@ AllocationMethod parseAllocationMethod(const string& s);
   All analytics are precomputed when the class constructor is called.
   A number of inspectors described below then return the individual analytics results.
 
+  Netting sets are independent of each other, so that the trade and netting set exposures, the DIM
+  regression and the KVA can be computed for several netting sets concurrently. Market data is
+  only accessed on the calling thread and the results are merged in a fixed order, so that they
+  do not depend on the number of threads. The DIM regressions are moreover independent across
+  simulation dates, so that they are run concurrently for all pairs of netting set and date.
+
   Note:
   - exposures are discounted at the numeraire N(t) used in the
   Monte Carlo simulation which produces the NPV cube.
@@ -160,7 +177,11 @@ public:
         //! Our KVA CVA Risk Weight
         Real kvaOurCvaRiskWeight = 0.05,
         //! Their KVA CVA Risk Weight,
-        Real kvaTheirCvaRiskWeight = 0.05);
+        Real kvaTheirCvaRiskWeight = 0.05,
+        //! Number of threads used to process netting sets concurrently, zero means one per hardware thread
+        Size nThreads = 1,
+        //! Estimator of the conditional variance in the DIM calculation, see DimRegressionMethod
+        const string& dimRegressionMethod = "StabilisedGLLS");
 
     //! Return list of Trade IDs in the portfolio
     const vector<string>& tradeIds() { return tradeIds_; }
@@ -277,18 +298,33 @@ public:
                              const std::vector<boost::shared_ptr<ore::data::Report>>& dimRegReports);
 
 private:
-    //! Helper function to return the collateral account evolution for a given netting set
-    boost::shared_ptr<vector<boost::shared_ptr<CollateralAccount>>>
+    //! Helper function to return the collateral account balances by date and sample for a given netting set
+    boost::shared_ptr<vector<vector<Real>>>
     collateralPaths(const string& nettingSetId, const boost::shared_ptr<NettingSetManager>& nettingSetManager,
-                    const boost::shared_ptr<Market>& market, const std::string& configuration,
+                    Real csaFxRateToday, Real csaRateToday,
                     const boost::shared_ptr<AggregationScenarioData>& scenarioData, Size dates, Size samples,
                     const vector<vector<Real>>& nettingSetValue, Real nettingSetValueToday,
                     const Date& nettingSetMaturity);
 
+    //! XVA integration weights per cube date of a counterparty
+    /*! The XVAs are the dot products of these weights with the exposure profiles at the cube dates, i.e. CVA with the
+        EPE, DVA with the ENE, FCA with the EPE and FBA with the ENE. The MVA weights are the FCA weights.
+    */
+    struct XvaWeights {
+        vector<Real> cva, dva, fca, fcaExOwnSP, fcaExAllSP, fba, fbaExOwnSP, fbaExAllSP;
+    };
+
     void updateNettingSetKVA();
     void updateStandAloneXVA();
     void updateAllocatedXVA();
 
+    //! Survival probabilities of \p name on today and the cube dates, computed once per curve and configuration
+    const vector<Real>& survivalProbabilities(const string& name, const string& configuration);
+    //! Funding spread discount factors of \p curve over the periods between today and the cube dates, cached
+    const vector<Real>& fundingSpreadDcfs(const string& curve);
+    //! XVA weights of counterparty \p cid using its default curve in \p curveConfiguration, cached
+    const XvaWeights& xvaWeights(const string& cid, const string& curveConfiguration);
+
     //! Fill dynamic initial margin cube (per netting set, date and sample)
     void dynamicInitialMargin();
     //! Compile the array of DIM regressors for the specified netting set, date and sample index
@@ -307,6 +343,8 @@ private:
     map<string, vector<vector<Real>>> nettingSetNPV_, nettingSetFLOW_, nettingSetDIM_, nettingSetLocalDIM_,
         nettingSetDeltaNPV_;
     map<string, vector<vector<Array>>> regressorArray_;
+    // scenario data key handles of the DIM regressors, Null<Size>() for the netting set NPV
+    vector<Size> dimRegressorKeys_;
     map<string, vector<Real>> nettingSetExpectedDIM_, nettingSetZeroOrderDIM_, nettingSetSimpleDIMh_,
         nettingSetSimpleDIMp_;
     map<string, vector<Real>> tradeEPE_, tradeENE_, tradeEE_B_, tradeEEE_B_, tradePFE_, tradeVAR_;
@@ -327,6 +365,9 @@ private:
     boost::shared_ptr<NPVCube> nettedCube_;
     boost::shared_ptr<NPVCube> dimCube_;
     map<string, Real> net_t0_im_reg_h_, net_t0_im_simple_h_;
+    map<std::pair<string, string>, vector<Real>> survivalProbabilities_;
+    map<string, vector<Real>> fundingSpreadDcfs_;
+    map<std::pair<string, string>, XvaWeights> xvaWeights_;
 
     vector<string> tradeIds_;
     vector<string> nettingSetIds_;
@@ -353,6 +394,8 @@ private:
     Real kvaTheirPdFloor_;
     Real kvaOurCvaRiskWeight_;
     Real kvaTheirCvaRiskWeight_;
+    Size nThreads_;
+    DimRegressionMethod dimRegressionMethod_;
 };
 } // namespace analytics
 } // namespace ore
@@ -63,7 +63,7 @@ namespace analytics {
 
 OREApp::OREApp(boost::shared_ptr<Parameters> params, ostream& out)
     : tab_(40), progressBarWidth_(72 - std::min<Size>(tab_, 67)), params_(params),
-      asof_(parseDate(params_->get("setup", "asofDate"))), out_(out), cubeDepth_(0) {
+      asof_(parseDate(params_->get("setup", "asofDate"))), out_(out), cubeDepth_(0), sparseCube_(false) {
 
     // Set global evaluation date
     Settings::instance().evaluationDate() = asof_;
@@ -198,9 +198,9 @@ int OREApp::run() {
             if (!cube_)
                 loadCube();
 
-            QL_REQUIRE(cube_->numIds() == portfolio_->size(),
+            QL_REQUIRE(cube_->numIds() == cubePortfolio()->size(),
                        "cube x dimension (" << cube_->numIds() << ") does not match portfolio size ("
-                                            << portfolio_->size() << ")");
+                                            << cubePortfolio()->size() << ")");
 
             // Use pre-generared scenarios
             if (!scenarioData_)
@@ -211,13 +211,23 @@ int OREApp::run() {
             QL_REQUIRE(scenarioData_->dimSamples() == cube_->samples(),
                        "scenario sample size does not match cube sample size");
 
-            runPostProcessor();
-            out_ << "OK" << endl;
-            out_ << setw(tab_) << left << "Write Reports... " << flush;
-            writeXVAReports();
-            if (writeDIMReport_)
-                writeDIMReport();
-            out_ << "OK" << endl;
+            if (params_->has("xva", "incrementalPortfolioFile") &&
+                params_->get("xva", "incrementalPortfolioFile") != "") {
+                runIncrementalXVA();
+                out_ << "OK" << endl;
+            } else if (params_->has("xva", "updatedPortfolioFile") &&
+                       params_->get("xva", "updatedPortfolioFile") != "") {
+                runUpdatedPortfolioXVA();
+                out_ << "OK" << endl;
+            } else {
+                runPostProcessor();
+                out_ << "OK" << endl;
+                out_ << setw(tab_) << left << "Write Reports... " << flush;
+                writeXVAReports();
+                if (writeDIMReport_)
+                    writeDIMReport();
+                out_ << "OK" << endl;
+            }
         } else {
             LOG("skip XVA reports");
             out_ << "SKIP" << endl;
@@ -274,6 +284,10 @@ void OREApp::readSetup() {
     continueOnError_ = false;
     if (params_->has("setup", "continueOnError"))
         continueOnError_ = parseBool(params_->get("setup", "continueOnError"));
+
+    nThreads_ = 1;
+    if (params_->has("setup", "nThreads") && params_->get("setup", "nThreads") != "")
+        nThreads_ = static_cast<Size>(parseInteger(params_->get("setup", "nThreads")));
 }
 
 void OREApp::setupLog() {
@@ -366,13 +380,26 @@ boost::shared_ptr<Portfolio> OREApp::buildPortfolio(const boost::shared_ptr<Engi
 
 boost::shared_ptr<Portfolio> OREApp::loadPortfolio() {
     string portfoliosString = params_->get("setup", "portfolioFile");
-    boost::shared_ptr<Portfolio> portfolio = boost::make_shared<Portfolio>();
+    boost::shared_ptr<Portfolio> portfolio = boost::make_shared<Portfolio>(nThreads_);
     if (params_->get("setup", "portfolioFile") == "")
         return portfolio;
     vector<string> portfolioFiles = getFilenames(portfoliosString, inputPath_);
+
+    // optional binary cache of the portfolio, it is used as long as the portfolio files do not change
+    string cacheFile, sourceHash;
+    if (params_->has("setup", "portfolioCacheFile") && params_->get("setup", "portfolioCacheFile") != "") {
+        cacheFile = outputPath_ + "/" + params_->get("setup", "portfolioCacheFile");
+        sourceHash = Portfolio::contentHash(portfolioFiles);
+        if (portfolio->loadCache(cacheFile, sourceHash, buildTradeFactory()))
+            return portfolio;
+    }
+
     for (auto portfolioFile : portfolioFiles) {
-        portfolio->load(portfolioFile, buildTradeFactory());
+        portfolio->loadStreaming(portfolioFile, buildTradeFactory());
     }
+
+    if (cacheFile != "")
+        portfolio->saveCache(cacheFile, sourceHash);
     return portfolio;
 }
 
@@ -658,6 +685,16 @@ void OREApp::initCube(boost::shared_ptr<NPVCube>& cube, const std::vector<std::s
     }
 }
 
+void OREApp::initCube(boost::shared_ptr<NPVCube>& cube, const boost::shared_ptr<Portfolio>& portfolio) {
+    if (sparseCube_) {
+        QL_REQUIRE(cubeDepth_ == 1 || cubeDepth_ == 2, "cube depth 1 or 2 expected");
+        cube = boost::make_shared<SinglePrecisionSparseInMemoryCube>(
+            asof_, portfolio->ids(), grid_->dates(), samples_, tradeLiveDates(*portfolio, grid_->dates()), cubeDepth_);
+    } else {
+        initCube(cube, portfolio->ids());
+    }
+}
+
 void OREApp::buildNPVCube() {
     LOG("Build valuation cube engine");
     // Valuation calculators
@@ -666,8 +703,13 @@ void OREApp::buildNPVCube() {
     calculators.push_back(boost::make_shared<NPVCalculator>(baseCurrency));
     if (cubeDepth_ > 1)
         calculators.push_back(boost::make_shared<CashflowCalculator>(baseCurrency, asof_, grid_, 1));
+    bool useCashflowKernel =
+        params_->has("simulation", "cashflowKernel") && parseBool(params_->get("simulation", "cashflowKernel"));
+    bool groupTrades =
+        params_->has("simulation", "groupTrades") && parseBool(params_->get("simulation", "groupTrades"));
     LOG("Build cube");
-    ValuationEngine engine(asof_, grid_, simMarket_);
+    ValuationEngine engine(asof_, grid_, simMarket_, set<std::pair<string, boost::shared_ptr<ModelBuilder>>>(),
+                           useCashflowKernel, groupTrades);
     ostringstream o;
     o.str("");
     o << "Build Cube " << simPortfolio_->size() << " x " << grid_->size() << " x " << samples_ << "... ";
@@ -680,7 +722,7 @@ void OREApp::buildNPVCube() {
     out_ << "OK" << endl;
 }
 
-void OREApp::initialiseNPVCubeGeneration(boost::shared_ptr<Portfolio> portfolio) {
+void OREApp::initialiseNPVCubeGeneration(boost::shared_ptr<Portfolio> portfolio, const string& scenarioReplayFile) {
     out_ << setw(tab_) << left << "Simulation Setup... ";
     LOG("Load Simulation Market Parameters");
     boost::shared_ptr<ScenarioSimMarketParameters> simMarketData = getSimMarketData();
@@ -697,11 +739,18 @@ void OREApp::initialiseNPVCubeGeneration(boost::shared_ptr<Portfolio> portfolio)
         string groupName = "simulation";
         boost::shared_ptr<EngineFactory> simFactory = buildEngineFactory(simMarket_, groupName);
 
-        auto continueOnCalErr = simFactory->engineData()->globalParameters().find("ContinueOnCalibrationError");
-        boost::shared_ptr<ScenarioGenerator> sg =
-            buildScenarioGenerator(market_, simMarketData, sgd,
-                                   continueOnCalErr != simFactory->engineData()->globalParameters().end() &&
-                                       parseBool(continueOnCalErr->second));
+        boost::shared_ptr<ScenarioGenerator> sg;
+        if (scenarioReplayFile != "") {
+            LOG("Replay scenarios from file " << scenarioReplayFile);
+            sg = boost::make_shared<ReplayScenarioGenerator>(scenarioReplayFile,
+                                                             boost::make_shared<SimpleScenarioFactory>());
+        } else {
+            auto continueOnCalErr =
+                simFactory->engineData()->globalParameters().find("ContinueOnCalibrationError");
+            sg = buildScenarioGenerator(market_, simMarketData, sgd,
+                                        continueOnCalErr != simFactory->engineData()->globalParameters().end() &&
+                                            parseBool(continueOnCalErr->second));
+        }
         simMarket_->scenarioGenerator() = sg;
 
         LOG("Build portfolio linked to sim market");
@@ -712,6 +761,16 @@ void OREApp::initialiseNPVCubeGeneration(boost::shared_ptr<Portfolio> portfolio)
             ALOG("There were errors during the sim portfolio building - check the sim market setup? Could build "
                  << simPortfolio_->size() << " trades out of " << n);
         }
+        if (params_->has("simulation", "compressPortfolio") &&
+            parseBool(params_->get("simulation", "compressPortfolio"))) {
+            LOG("Compress portfolio linked to sim market");
+            simPortfolio_ = compressPortfolio(simPortfolio_, simFactory);
+            if (params_->has("simulation", "compressionFile")) {
+                string fileName = outputPath_ + "/" + params_->get("simulation", "compressionFile");
+                CSVFileReport report(fileName);
+                getReportWriter()->writePortfolioCompression(report, *simPortfolio_);
+            }
+        }
         out_ << "OK" << endl;
     }
 
@@ -719,6 +778,7 @@ void OREApp::initialiseNPVCubeGeneration(boost::shared_ptr<Portfolio> portfolio)
         cubeDepth_ = 2; // NPV and FLOW
     else
         cubeDepth_ = 1; // NPV only
+    sparseCube_ = params_->has("simulation", "sparseCube") && parseBool(params_->get("simulation", "sparseCube"));
 
     ostringstream o;
     o << "Aggregation Scenario Data " << grid_->size() << " x " << samples_ << "... ";
@@ -729,7 +789,7 @@ void OREApp::initialiseNPVCubeGeneration(boost::shared_ptr<Portfolio> portfolio)
     simMarket_->aggregationScenarioData() = scenarioData_;
     out_ << "OK" << endl;
 
-    initCube(cube_, simPortfolio_->ids());
+    initCube(cube_, simPortfolio_);
 }
 
 void OREApp::generateNPVCube() {
@@ -738,6 +798,8 @@ void OREApp::generateNPVCube() {
 
     boost::shared_ptr<Portfolio> portfolio = loadPortfolio();
     initialiseNPVCubeGeneration(portfolio);
+    if (simPortfolio_ != portfolio)
+        cubePortfolio_ = simPortfolio_;
     buildNPVCube();
     writeCube(cube_);
     writeScenarioData();
@@ -751,7 +813,16 @@ void OREApp::writeCube(boost::shared_ptr<NPVCube> cube) {
     LOG("Write cube");
     if (params_->has("simulation", "cubeFile")) {
         string cubeFileName = outputPath_ + "/" + params_->get("simulation", "cubeFile");
-        cube->save(cubeFileName);
+        if (params_->has("simulation", "cubeCodec") && params_->get("simulation", "cubeCodec") != "") {
+            CubeCodec codec = parseCubeCodec(params_->get("simulation", "cubeCodec"));
+            Real tolerance = 0.0;
+            if (params_->has("simulation", "cubeCodecTolerance"))
+                tolerance = parseReal(params_->get("simulation", "cubeCodecTolerance"));
+            LOG("Write compressed cube, codec " << codec << ", tolerance " << tolerance);
+            saveCompressedCube(*cube, cubeFileName, codec, tolerance, nThreads_);
+        } else {
+            cube->save(cubeFileName);
+        }
         out_ << "OK" << endl;
     } else
         out_ << "SKIP" << endl;
@@ -793,7 +864,44 @@ void OREApp::loadCube() {
     if (params_->has("xva", "hyperCube"))
         cubeDepth_ = parseBool(params_->get("xva", "hyperCube")) ? 2 : 1;
 
-    if (cubeDepth_ > 1)
+    bool sparseCube = params_->has("xva", "sparseCube") && parseBool(params_->get("xva", "sparseCube"));
+
+    if (CompressedCubeReader::isCompressedCube(cubeFile)) {
+        LOG("Load compressed cube from file " << cubeFile);
+        CompressedCubeReader reader(cubeFile);
+        cubeDepth_ = reader.depth();
+        map<string, Size> index;
+        for (Size i = 0; i < reader.numIds(); ++i)
+            index[reader.ids()[i]] = i;
+        // read the trades of the portfolio only, if the cube file contains all of them, all their dates are decoded
+        // into an in-memory cube, since the post processor needs random access to the full cube
+        vector<string> ids = reader.ids();
+        if (portfolio_ && portfolio_->size() > 0) {
+            vector<string> portfolioIds = cubePortfolio()->ids();
+            if (std::all_of(portfolioIds.begin(), portfolioIds.end(),
+                            [&index](const string& id) { return index.find(id) != index.end(); }))
+                ids = portfolioIds;
+        }
+        vector<Size> liveDates;
+        for (auto const& id : ids)
+            liveDates.push_back(reader.numLiveDates(index.at(id)));
+        if (sparseCube)
+            cube_ = boost::make_shared<SinglePrecisionSparseInMemoryCube>(reader.asof(), ids, reader.dates(),
+                                                                          reader.samples(), liveDates, cubeDepth_);
+        else if (cubeDepth_ > 1)
+            cube_ = boost::make_shared<SinglePrecisionInMemoryCubeN>(reader.asof(), ids, reader.dates(),
+                                                                     reader.samples(), cubeDepth_);
+        else
+            cube_ = boost::make_shared<SinglePrecisionInMemoryCube>(reader.asof(), ids, reader.dates(),
+                                                                    reader.samples());
+        Size loaded = reader.load(*cube_, set<string>(ids.begin(), ids.end()), nThreads_);
+        LOG("Cube loading done, " << loaded << " out of " << reader.numIds() << " trades read");
+        return;
+    }
+
+    if (sparseCube)
+        cube_ = boost::make_shared<SinglePrecisionSparseInMemoryCube>();
+    else if (cubeDepth_ > 1)
         cube_ = boost::make_shared<SinglePrecisionInMemoryCubeN>();
     else
         cube_ = boost::make_shared<SinglePrecisionInMemoryCube>();
@@ -802,6 +910,182 @@ void OREApp::loadCube() {
     LOG("Cube loading done");
 }
 
+void OREApp::runIncrementalXVA() {
+    MEM_LOG;
+    LOG("Running incremental XVA");
+
+    boost::shared_ptr<NPVCube> storedCube = cube_;
+    boost::shared_ptr<AggregationScenarioData> storedScenarioData = scenarioData_;
+
+    string portfolioFile = inputPath_ + "/" + params_->get("xva", "incrementalPortfolioFile");
+    LOG("Load new trades from file " << portfolioFile);
+    boost::shared_ptr<Portfolio> newTrades = boost::make_shared<Portfolio>();
+    newTrades->load(portfolioFile, buildTradeFactory());
+    QL_REQUIRE(newTrades->size() > 0, "no new trades found in " << portfolioFile);
+    set<string> storedIds(storedCube->ids().begin(), storedCube->ids().end());
+    for (auto const& t : newTrades->trades())
+        QL_REQUIRE(storedIds.find(t->id()) == storedIds.end(),
+                   "new trade " << t->id() << " is already contained in the stored cube");
+
+    // Value the new trades only, on the scenarios of the run that produced the stored cube
+    string scenarioReplayFile = outputPath_ + "/" + params_->get("xva", "scenarioReplayFile");
+    initialiseNPVCubeGeneration(newTrades, scenarioReplayFile);
+    buildNPVCube();
+    boost::shared_ptr<NPVCube> newCube = cube_;
+    cube_ = storedCube;
+    scenarioData_ = storedScenarioData;
+    QL_REQUIRE(newCube->dates() == storedCube->dates(), "simulation dates do not match the stored cube dates");
+    QL_REQUIRE(newCube->samples() == storedCube->samples(), "number of samples (" << newCube->samples()
+                                                                                  << ") does not match stored cube ("
+                                                                                  << storedCube->samples() << ")");
+    QL_REQUIRE(newCube->depth() == storedCube->depth(), "cube depth (" << newCube->depth()
+                                                                       << ") does not match stored cube ("
+                                                                       << storedCube->depth() << ")");
+
+    // Restrict the stored portfolio to the netting sets of the new trades
+    set<string> nettingSets;
+    for (auto const& t : simPortfolio_->trades())
+        nettingSets.insert(t->envelope().nettingSetId());
+    boost::shared_ptr<Portfolio> basePortfolio = boost::make_shared<Portfolio>();
+    boost::shared_ptr<Portfolio> whatIfPortfolio = boost::make_shared<Portfolio>();
+    for (auto const& t : cubePortfolio()->trades()) {
+        if (nettingSets.find(t->envelope().nettingSetId()) != nettingSets.end()) {
+            basePortfolio->add(t);
+            whatIfPortfolio->add(t);
+        }
+    }
+    for (auto const& t : simPortfolio_->trades())
+        whatIfPortfolio->add(t);
+    vector<string> baseIds = basePortfolio->ids(), newIds = simPortfolio_->ids();
+    // compressed new trades may share their id with a compressed trade of the stored cube
+    for (auto const& id : newIds)
+        QL_REQUIRE(storedIds.find(id) == storedIds.end(),
+                   "new trade " << id << " is already contained in the stored cube");
+    LOG("Incremental XVA for " << newIds.size() << " new and " << baseIds.size() << " existing trades in "
+                               << nettingSets.size() << " netting sets");
+
+    boost::shared_ptr<PostProcess> basePostProcess;
+    if (basePortfolio->size() > 0) {
+        boost::shared_ptr<NPVCube> baseCube;
+        initCube(baseCube, basePortfolio);
+        QL_REQUIRE(copyCubeTrades(*storedCube, *baseCube, set<string>(baseIds.begin(), baseIds.end())) ==
+                       baseIds.size(),
+                   "stored cube does not contain all trades of the affected netting sets");
+        basePostProcess = buildPostProcess(basePortfolio, baseCube);
+    }
+    boost::shared_ptr<NPVCube> whatIfCube;
+    initCube(whatIfCube, whatIfPortfolio);
+    QL_REQUIRE(copyCubeTrades(*storedCube, *whatIfCube, set<string>(baseIds.begin(), baseIds.end())) ==
+                   baseIds.size(),
+               "stored cube does not contain all trades of the affected netting sets");
+    QL_REQUIRE(copyCubeTrades(*newCube, *whatIfCube, set<string>(newIds.begin(), newIds.end())) == newIds.size(),
+               "cube of the new trades does not contain all new trades");
+    postProcess_ = buildPostProcess(whatIfPortfolio, whatIfCube);
+
+    string fileName = "xva_incremental.csv";
+    if (params_->has("xva", "incrementalXvaFile") && params_->get("xva", "incrementalXvaFile") != "")
+        fileName = params_->get("xva", "incrementalXvaFile");
+    CSVFileReport report(outputPath_ + "/" + fileName);
+    getReportWriter()->writeIncrementalXVA(report, basePostProcess, postProcess_);
+
+    LOG("Incremental XVA done");
+    MEM_LOG;
+}
+
+void OREApp::runUpdatedPortfolioXVA() {
+    MEM_LOG;
+    LOG("Running XVA for an updated portfolio");
+
+    QL_REQUIRE(!params_->has("simulation", "compressPortfolio") ||
+                   !parseBool(params_->get("simulation", "compressPortfolio")),
+               "updatedPortfolioFile is not supported with compressPortfolio");
+    boost::shared_ptr<NPVCube> storedCube = cube_;
+    boost::shared_ptr<AggregationScenarioData> storedScenarioData = scenarioData_;
+
+    string portfolioFile = inputPath_ + "/" + params_->get("xva", "updatedPortfolioFile");
+    LOG("Load updated portfolio from file " << portfolioFile);
+    Portfolio amended;
+    amended.load(portfolioFile, buildTradeFactory());
+
+    // Match the portfolio and the stored cube by id. Trades without cube values are left out of the base portfolio,
+    // so that they are valued as added trades if they are in the updated portfolio.
+    set<string> storedIds(storedCube->ids().begin(), storedCube->ids().end());
+    boost::shared_ptr<Portfolio> updated = boost::make_shared<Portfolio>(nThreads_);
+    for (auto const& t : portfolio_->trades()) {
+        if (storedIds.erase(t->id()) == 0)
+            WLOG("Trade " << t->id() << " is not contained in the stored cube, it is valued as a new trade");
+        else
+            updated->add(t);
+    }
+    for (auto const& id : storedIds)
+        WLOG("Trade " << id << " of the stored cube is not contained in the portfolio, it is ignored");
+
+    // Keep the unchanged trades and build the added and modified ones only
+    PortfolioDiff diff = updated->update(amended, engineFactory_);
+    string fileName = "portfolio_diff.csv";
+    if (params_->has("xva", "portfolioDiffFile") && params_->get("xva", "portfolioDiffFile") != "")
+        fileName = params_->get("xva", "portfolioDiffFile");
+    CSVFileReport diffReport(outputPath_ + "/" + fileName);
+    getReportWriter()->writePortfolioDiff(diffReport, diff);
+
+    // Value the added and modified trades on the scenarios of the run that produced the stored cube
+    boost::shared_ptr<Portfolio> changed = boost::make_shared<Portfolio>();
+    for (auto const& ids : {diff.added, diff.modified}) {
+        for (auto const& id : ids) {
+            if (updated->has(id))
+                changed->add(updated->get(id));
+        }
+    }
+    boost::shared_ptr<NPVCube> changedCube;
+    vector<string> changedIds = changed->ids();
+    if (changed->size() > 0) {
+        string scenarioReplayFile = outputPath_ + "/" + params_->get("xva", "scenarioReplayFile");
+        initialiseNPVCubeGeneration(changed, scenarioReplayFile);
+        buildNPVCube();
+        changedCube = cube_;
+        QL_REQUIRE(changedCube->dates() == storedCube->dates(), "simulation dates do not match the stored cube dates");
+        QL_REQUIRE(changedCube->samples() == storedCube->samples(),
+                   "number of samples (" << changedCube->samples() << ") does not match stored cube ("
+                                         << storedCube->samples() << ")");
+        QL_REQUIRE(changedCube->depth() == storedCube->depth(), "cube depth (" << changedCube->depth()
+                                                                             << ") does not match stored cube ("
+                                                                             << storedCube->depth() << ")");
+        // trades which could not be built against the simulation market have no cube values
+        for (auto const& id : changedIds) {
+            if (!simPortfolio_->has(id)) {
+                ALOG("Trade " << id << " could not be built against the simulation market, it is removed");
+                updated->remove(id);
+            }
+        }
+        changedIds = simPortfolio_->ids();
+    }
+    scenarioData_ = storedScenarioData;
+    LOG("Updated portfolio XVA for " << changedIds.size() << " added or modified and " << diff.unchanged.size()
+                                     << " unchanged trades");
+
+    boost::shared_ptr<NPVCube> updatedCube;
+    initCube(updatedCube, updated);
+    QL_REQUIRE(copyCubeTrades(*storedCube, *updatedCube, set<string>(diff.unchanged.begin(), diff.unchanged.end())) ==
+                   diff.unchanged.size(),
+               "stored cube does not contain all unchanged trades");
+    if (changedCube) {
+        QL_REQUIRE(copyCubeTrades(*changedCube, *updatedCube, set<string>(changedIds.begin(), changedIds.end())) ==
+                       changedIds.size(),
+                   "cube of the changed trades does not contain all changed trades");
+    }
+
+    portfolio_ = updated;
+    cubePortfolio_ = updated;
+    cube_ = updatedCube;
+    runPostProcessor();
+    writeXVAReports();
+    if (writeDIMReport_)
+        writeDIMReport();
+
+    LOG("Updated portfolio XVA done");
+    MEM_LOG;
+}
+
 boost::shared_ptr<NettingSetManager> OREApp::initNettingSetManager() {
     string csaFile = inputPath_ + "/" + params_->get("xva", "csaFile");
     boost::shared_ptr<NettingSetManager> netting = boost::make_shared<NettingSetManager>();
@@ -809,7 +1093,23 @@ boost::shared_ptr<NettingSetManager> OREApp::initNettingSetManager() {
     return netting;
 }
 
-void OREApp::runPostProcessor() {
+void OREApp::runPostProcessor() { postProcess_ = buildPostProcess(cubePortfolio(), cube_); }
+
+boost::shared_ptr<Portfolio> OREApp::cubePortfolio() {
+    if (cubePortfolio_)
+        return cubePortfolio_;
+    if (params_->has("simulation", "compressPortfolio") &&
+        parseBool(params_->get("simulation", "compressPortfolio"))) {
+        LOG("Compress portfolio linked to T0 market to match the cube trades");
+        cubePortfolio_ = compressPortfolio(portfolio_, engineFactory_);
+    } else {
+        cubePortfolio_ = portfolio_;
+    }
+    return cubePortfolio_;
+}
+
+boost::shared_ptr<PostProcess> OREApp::buildPostProcess(const boost::shared_ptr<Portfolio>& portfolio,
+                                                        const boost::shared_ptr<NPVCube>& cube) {
     boost::shared_ptr<NettingSetManager> netting = initNettingSetManager();
     map<string, bool> analytics;
     analytics["exerciseNextBreak"] = parseBool(params_->get("xva", "exerciseNextBreak"));
@@ -848,6 +1148,7 @@ void OREApp::runPostProcessor() {
     Real dimScaling = 1.0;
     Size dimLocalRegressionEvaluations = 0;
     Real dimLocalRegressionBandwidth = 0.25;
+    string dimRegressionMethod = "StabilisedGLLS";
 
     Real kvaCapitalDiscountRate = 0.10;
     Real kvaAlpha = 1.4;
@@ -877,6 +1178,8 @@ void OREApp::runPostProcessor() {
         dimScaling = parseReal(params_->get("xva", "dimScaling"));
         dimLocalRegressionEvaluations = parseInteger(params_->get("xva", "dimLocalRegressionEvaluations"));
         dimLocalRegressionBandwidth = parseReal(params_->get("xva", "dimLocalRegressionBandwidth"));
+        if (params_->has("xva", "dimRegressionMethod") && params_->get("xva", "dimRegressionMethod") != "")
+            dimRegressionMethod = params_->get("xva", "dimRegressionMethod");
     }
 
     string marketConfiguration = params_->get("markets", "simulation");
@@ -886,13 +1189,14 @@ void OREApp::runPostProcessor() {
         fullInitialCollateralisation = parseBool(params_->get("xva", "fullInitialCollateralisation"));
     }
 
-    postProcess_ = boost::make_shared<PostProcess>(
-        portfolio_, netting, market_, marketConfiguration, cube_, scenarioData_, analytics, baseCurrency,
+
+    return boost::make_shared<PostProcess>(
+        portfolio, netting, market_, marketConfiguration, cube, scenarioData_, analytics, baseCurrency,
         allocationMethod, marginalAllocationLimit, quantile, calculationType, dvaName, fvaBorrowingCurve,
         fvaLendingCurve, dimQuantile, dimHorizonCalendarDays, dimRegressionOrder, dimRegressors,
         dimLocalRegressionEvaluations, dimLocalRegressionBandwidth, dimScaling, fullInitialCollateralisation,
         kvaCapitalDiscountRate, kvaAlpha, kvaRegAdjustment, kvaCapitalHurdle, kvaOurPdFloor, kvaTheirPdFloor,
-        kvaOurCvaRiskWeight, kvaTheirCvaRiskWeight);
+        kvaOurCvaRiskWeight, kvaTheirCvaRiskWeight, nThreads_, dimRegressionMethod);
 }
 
 void OREApp::writeXVAReports() {
@@ -928,11 +1232,11 @@ void OREApp::writeXVAReports() {
 
     string XvaFile = outputPath_ + "/xva.csv";
     CSVFileReport xvaReport(XvaFile);
-    getReportWriter()->writeXVA(xvaReport, params_->get("xva", "allocationMethod"), portfolio_, postProcess_);
+    getReportWriter()->writeXVA(xvaReport, params_->get("xva", "allocationMethod"), cubePortfolio(), postProcess_);
 
     string rawCubeOutputFile = params_->get("xva", "rawCubeOutputFile");
     CubeWriter cw1(outputPath_ + "/" + rawCubeOutputFile);
-    map<string, string> nettingSetMap = portfolio_->nettingSetMap();
+    map<string, string> nettingSetMap = cubePortfolio()->nettingSetMap();
     cw1.write(cube_, nettingSetMap);
 
     string netCubeOutputFile = params_->get("xva", "netCubeOutputFile");
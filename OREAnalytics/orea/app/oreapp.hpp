@@ -104,10 +104,16 @@ protected:
     virtual void initAggregationScenarioData();
     //! get an instance of a cube class
     virtual void initCube(boost::shared_ptr<NPVCube>& cube, const std::vector<std::string>& ids);
+    //! get an instance of a cube class for the trades of a portfolio
+    /*! If sparse cubes are enabled, the cube does not store the values of the trades after their maturity */
+    virtual void initCube(boost::shared_ptr<NPVCube>& cube, const boost::shared_ptr<Portfolio>& portfolio);
     //! build an NPV cube
     virtual void buildNPVCube();
     //! initialise NPV cube generation
-    void initialiseNPVCubeGeneration(boost::shared_ptr<Portfolio> portfolio);
+    /*! If a scenario replay file is given, the scenarios are read from this file (as written by the ScenarioWriter)
+        instead of being generated by a cross asset model */
+    void initialiseNPVCubeGeneration(boost::shared_ptr<Portfolio> portfolio,
+                                     const std::string& scenarioReplayFile = "");
     //! load simMarketData
     boost::shared_ptr<ScenarioSimMarketParameters> getSimMarketData();
     //! load scenarioGeneratorData
@@ -127,6 +133,17 @@ protected:
     virtual void loadCube();
     //! run postProcessor to generate reports from cube
     void runPostProcessor();
+    //! portfolio whose trades make up the cube
+    /*! This is the compressed portfolio if the simulation parameter compressPortfolio is set. If the cube was not
+        generated in this run, the compressed portfolio is derived from the T0 portfolio. */
+    boost::shared_ptr<Portfolio> cubePortfolio();
+    //! build a postProcessor for the given portfolio and cube
+    boost::shared_ptr<PostProcess> buildPostProcess(const boost::shared_ptr<Portfolio>& portfolio,
+                                                    const boost::shared_ptr<NPVCube>& cube);
+    //! value new trades on the stored scenarios and write the XVA increments of their netting sets
+    void runIncrementalXVA();
+    //! update the portfolio to an amended one, value the added and modified trades only and write the XVA reports
+    void runUpdatedPortfolioXVA();
 
     //! run stress tests and write out report
     virtual void runStressTest();
@@ -211,6 +228,8 @@ protected:
     bool parametricVar_;
     bool writeBaseScenario_;
     bool continueOnError_;
+    //! number of threads from the optional setup parameter nThreads, default 1
+    Size nThreads_;
     std::string inputPath_;
     std::string outputPath_;
 
@@ -223,11 +242,13 @@ protected:
 
     boost::shared_ptr<ScenarioSimMarket> simMarket_; // sim market
     boost::shared_ptr<Portfolio> simPortfolio_;      // portfolio linked to sim market
+    boost::shared_ptr<Portfolio> cubePortfolio_;     // portfolio whose trades make up the cube
 
     boost::shared_ptr<DateGrid> grid_;
     Size samples_;
 
     Size cubeDepth_;
+    bool sparseCube_;
     boost::shared_ptr<NPVCube> cube_;
     boost::shared_ptr<AggregationScenarioData> scenarioData_;
     boost::shared_ptr<PostProcess> postProcess_;
@@ -634,24 +634,90 @@ void ReportWriter::writeNettingSetColva(ore::data::Report& report, boost::shared
     report.end();
 }
 
+void ReportWriter::writeIncrementalXVA(ore::data::Report& report, boost::shared_ptr<PostProcess> basePostProcess,
+                                       boost::shared_ptr<PostProcess> postProcess) {
+    report.addColumn("NettingSetId", string())
+        .addColumn("CVA", double(), 2)
+        .addColumn("IncrementalCVA", double(), 2)
+        .addColumn("DVA", double(), 2)
+        .addColumn("IncrementalDVA", double(), 2)
+        .addColumn("FBA", double(), 2)
+        .addColumn("IncrementalFBA", double(), 2)
+        .addColumn("FCA", double(), 2)
+        .addColumn("IncrementalFCA", double(), 2);
+
+    vector<string> baseNettingSetIds;
+    if (basePostProcess)
+        baseNettingSetIds = basePostProcess->nettingSetIds();
+
+    for (auto const& n : postProcess->nettingSetIds()) {
+        Real baseCva = 0.0, baseDva = 0.0, baseFba = 0.0, baseFca = 0.0;
+        if (std::find(baseNettingSetIds.begin(), baseNettingSetIds.end(), n) != baseNettingSetIds.end()) {
+            baseCva = basePostProcess->nettingSetCVA(n);
+            baseDva = basePostProcess->nettingSetDVA(n);
+            baseFba = basePostProcess->nettingSetFBA(n);
+            baseFca = basePostProcess->nettingSetFCA(n);
+        }
+        Real cva = postProcess->nettingSetCVA(n);
+        Real dva = postProcess->nettingSetDVA(n);
+        Real fba = postProcess->nettingSetFBA(n);
+        Real fca = postProcess->nettingSetFCA(n);
+        report.next()
+            .add(n)
+            .add(cva)
+            .add(cva - baseCva)
+            .add(dva)
+            .add(dva - baseDva)
+            .add(fba)
+            .add(fba - baseFba)
+            .add(fca)
+            .add(fca - baseFca);
+    }
+    report.end();
+}
+
 void ReportWriter::writeAggregationScenarioData(ore::data::Report& report, const AggregationScenarioData& data) {
     report.addColumn("Date", Size()).addColumn("Scenario", Size());
+    vector<Size> keyIndices;
     for (auto const& k : data.keys()) {
         std::string tmp = ore::data::to_string(k.first) + k.second;
         report.addColumn(tmp.c_str(), double(), 8);
+        keyIndices.push_back(data.index(k.first, k.second));
     }
     for (Size d = 0; d < data.dimDates(); ++d) {
         for (Size s = 0; s < data.dimSamples(); ++s) {
             report.next();
             report.add(d).add(s);
-            for (auto const& k : data.keys()) {
-                report.add(data.get(d, s, k.first, k.second));
+            for (auto const& k : keyIndices) {
+                report.add(data.get(d, s, k));
             }
         }
     }
     report.end();
 }
 
+void ReportWriter::writePortfolioDiff(ore::data::Report& report, const ore::data::PortfolioDiff& diff) {
+    LOG("Writing portfolio diff report");
+    report.addColumn("TradeId", string()).addColumn("Change", string());
+    for (auto const& id : diff.added)
+        report.next().add(id).add("Added");
+    for (auto const& id : diff.modified)
+        report.next().add(id).add("Modified");
+    for (auto const& id : diff.removed)
+        report.next().add(id).add("Removed");
+    report.end();
+    LOG("Portfolio diff report written");
+}
+
+void ReportWriter::writePortfolioCompression(ore::data::Report& report, const ore::data::Portfolio& portfolio) {
+    LOG("Writing portfolio compression report");
+    report.addColumn("TradeId", string()).addColumn("CompressedTradeId", string());
+    for (auto const& m : ore::data::compressionMap(portfolio))
+        report.next().add(m.first).add(m.second);
+    report.end();
+    LOG("Portfolio compression report written");
+}
+
 void ReportWriter::writeScenarioReport(ore::data::Report& report,
                                        const boost::shared_ptr<SensitivityCube>& sensitivityCube,
                                        Real outputThreshold) {
@@ -76,8 +76,19 @@ public:
     virtual void writeXVA(ore::data::Report& report, const string& allocationMethod,
                           boost::shared_ptr<Portfolio> portfolio, boost::shared_ptr<PostProcess> postProcess);
 
+    //! Write the netting set XVAs after adding new trades and the increments versus the XVAs without them
+    /*! The base post processor can be null if the new trades are the only ones in their netting sets */
+    virtual void writeIncrementalXVA(ore::data::Report& report, boost::shared_ptr<PostProcess> basePostProcess,
+                                     boost::shared_ptr<PostProcess> postProcess);
+
     virtual void writeAggregationScenarioData(ore::data::Report& report, const AggregationScenarioData& data);
 
+    //! Write the trades added, modified and removed by a portfolio update, unchanged trades are omitted
+    virtual void writePortfolioDiff(ore::data::Report& report, const ore::data::PortfolioDiff& diff);
+
+    //! Write the original trades represented by the compressed trades of a portfolio
+    virtual void writePortfolioCompression(ore::data::Report& report, const ore::data::Portfolio& portfolio);
+
     virtual void writeScenarioReport(ore::data::Report& report,
                                      const boost::shared_ptr<SensitivityCube>& sensitivityCube,
                                      QuantLib::Real outputThreshold = 0.0);
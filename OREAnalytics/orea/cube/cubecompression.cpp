@@ -0,0 +1,433 @@
+/*
+ Copyright (C) 2020 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <orea/cube/cubecompression.hpp>
+#include <ored/utilities/parallel.hpp>
+
+#include <ql/errors.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <map>
+
+using QuantLib::Real;
+using QuantLib::Size;
+using std::string;
+using std::vector;
+
+namespace ore {
+namespace analytics {
+
+namespace {
+
+const char signature[8] = {'O', 'R', 'E', 'C', 'U', 'B', 'E', 'Z'};
+const std::uint32_t formatVersion = 1;
+
+// encoding of a chunk in the file
+enum ChunkEncoding : unsigned char { ZeroChunk = 0, ShuffledChunk = 1, CompressedChunk = 2 };
+
+// LZ block format: sequences of a token (number of literals in the high, match length - minMatch in the low four bits,
+// 15 meaning that further length bytes follow), the literals, the two byte match offset and the further match length
+// bytes. The last sequence has literals only.
+const Size minMatch = 4;
+const Size maxOffset = 65535;
+const Size hashBits = 14;
+
+template <class T> void write(std::ostream& out, const T& v) {
+    out.write(reinterpret_cast<const char*>(&v), sizeof(T));
+}
+
+template <class T> T read(std::istream& in) {
+    T v;
+    in.read(reinterpret_cast<char*>(&v), sizeof(T));
+    QL_REQUIRE(in, "unexpected end of compressed cube file");
+    return v;
+}
+
+void writeString(std::ostream& out, const string& s) {
+    write<std::uint64_t>(out, s.size());
+    out.write(s.data(), s.size());
+}
+
+string readString(std::istream& in) {
+    string s(read<std::uint64_t>(in), ' ');
+    in.read(&s[0], s.size());
+    QL_REQUIRE(in, "unexpected end of compressed cube file");
+    return s;
+}
+
+void writeLength(vector<unsigned char>& out, Size len) {
+    for (; len >= 255; len -= 255)
+        out.push_back(255);
+    out.push_back(static_cast<unsigned char>(len));
+}
+
+void writeLiterals(vector<unsigned char>& out, const vector<unsigned char>& in, Size begin, Size end,
+                   unsigned char matchToken) {
+    Size lit = end - begin;
+    out.push_back(static_cast<unsigned char>((std::min<Size>(lit, 15) << 4) | matchToken));
+    if (lit >= 15)
+        writeLength(out, lit - 15);
+    out.insert(out.end(), in.begin() + begin, in.begin() + end);
+}
+
+void lzCompress(const vector<unsigned char>& in, vector<unsigned char>& out) {
+    out.clear();
+    Size n = in.size(), pos = 0, anchor = 0;
+    // last position + 1 of each hashed four byte sequence, 0 if none
+    vector<std::uint32_t> table(Size(1) << hashBits, 0);
+    while (pos + minMatch <= n) {
+        std::uint32_t v;
+        std::memcpy(&v, &in[pos], sizeof(v));
+        std::uint32_t h = (v * 2654435761u) >> (32 - hashBits);
+        Size candidate = table[h];
+        table[h] = static_cast<std::uint32_t>(pos + 1);
+        if (candidate == 0 || pos + 1 - candidate > maxOffset ||
+            std::memcmp(&in[candidate - 1], &in[pos], minMatch) != 0) {
+            ++pos;
+            continue;
+        }
+        Size match = candidate - 1, len = minMatch;
+        while (pos + len < n && in[match + len] == in[pos + len])
+            ++len;
+        Size ml = len - minMatch;
+        writeLiterals(out, in, anchor, pos, static_cast<unsigned char>(std::min<Size>(ml, 15)));
+        Size offset = pos - match;
+        out.push_back(static_cast<unsigned char>(offset & 0xff));
+        out.push_back(static_cast<unsigned char>(offset >> 8));
+        if (ml >= 15)
+            writeLength(out, ml - 15);
+        pos += len;
+        anchor = pos;
+    }
+    writeLiterals(out, in, anchor, n, 0);
+}
+
+void lzDecompress(const vector<unsigned char>& in, vector<unsigned char>& out) {
+    Size n = in.size(), ip = 0, op = 0;
+    auto readLength = [&in, &ip, n](Size len) {
+        if (len == 15) {
+            unsigned char b;
+            do {
+                QL_REQUIRE(ip < n, "corrupt compressed cube chunk");
+                b = in[ip++];
+                len += b;
+            } while (b == 255);
+        }
+        return len;
+    };
+    while (ip < n) {
+        unsigned char token = in[ip++];
+        Size lit = readLength(token >> 4);
+        QL_REQUIRE(ip + lit <= n && op + lit <= out.size(), "corrupt compressed cube chunk");
+        std::copy(in.begin() + ip, in.begin() + ip + lit, out.begin() + op);
+        ip += lit;
+        op += lit;
+        if (ip == n)
+            break;
+        QL_REQUIRE(ip + 2 <= n, "corrupt compressed cube chunk");
+        Size offset = in[ip] | (Size(in[ip + 1]) << 8);
+        ip += 2;
+        Size len = readLength(token & 15) + minMatch;
+        QL_REQUIRE(offset > 0 && offset <= op && op + len <= out.size(), "corrupt compressed cube chunk");
+        // the match can overlap the output, so copy byte by byte
+        for (Size m = 0; m < len; ++m, ++op)
+            out[op] = out[op - offset];
+    }
+    QL_REQUIRE(op == out.size(), "corrupt compressed cube chunk, " << op << " bytes decoded, " << out.size()
+                                                                   << " expected");
+}
+
+// Encode the values of trade i on date j as 8 byte words, grouped by byte position so that the (mostly equal) high
+// order bytes of the values are adjacent, and compress them. Returns the chunk encoding.
+unsigned char encodeChunk(const NPVCube& cube, Size i, Size j, CubeCodec codec, Real tolerance,
+                          vector<unsigned char>& buffer) {
+    Size samples = cube.samples(), n = samples * cube.depth();
+    vector<std::uint64_t> words(n);
+    bool zero = true;
+    for (Size d = 0; d < cube.depth(); ++d) {
+        for (Size k = 0; k < samples; ++k) {
+            double v = cube.get(i, j, k, d);
+            std::uint64_t& w = words[d * samples + k];
+            if (codec == CubeCodec::Lossless) {
+                std::memcpy(&w, &v, sizeof(w));
+            } else {
+                Real q = std::round(v / (2.0 * tolerance));
+                QL_REQUIRE(std::fabs(q) < 9.0e18, "value " << v << " of trade " << cube.ids()[i] << " too large for "
+                                                            << "quantisation with tolerance " << tolerance);
+                std::int64_t l = static_cast<std::int64_t>(q);
+                // zigzag encoding, small absolute values have zero high order bytes
+                w = (static_cast<std::uint64_t>(l) << 1) ^ static_cast<std::uint64_t>(l >> 63);
+            }
+            zero = zero && w == 0;
+        }
+    }
+    buffer.clear();
+    if (zero)
+        return ZeroChunk;
+    vector<unsigned char> shuffled(n * sizeof(std::uint64_t));
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(words.data());
+    for (Size b = 0; b < sizeof(std::uint64_t); ++b) {
+        for (Size p = 0; p < n; ++p)
+            shuffled[b * n + p] = bytes[p * sizeof(std::uint64_t) + b];
+    }
+    lzCompress(shuffled, buffer);
+    if (buffer.size() < shuffled.size())
+        return CompressedChunk;
+    buffer.swap(shuffled);
+    return ShuffledChunk;
+}
+
+} // namespace
+
+std::ostream& operator<<(std::ostream& out, CubeCodec c) {
+    if (c == CubeCodec::Lossless)
+        out << "Lossless";
+    else if (c == CubeCodec::Quantised)
+        out << "Quantised";
+    else
+        QL_FAIL("Cube codec not covered");
+    return out;
+}
+
+CubeCodec parseCubeCodec(const string& s) {
+    static std::map<string, CubeCodec> m = {
+        {"Lossless", CubeCodec::Lossless},
+        {"Quantised", CubeCodec::Quantised},
+    };
+
+    auto it = m.find(s);
+    if (it != m.end()) {
+        return it->second;
+    } else {
+        QL_FAIL("CubeCodec \"" << s << "\" not recognized");
+    }
+}
+
+void saveCompressedCube(const NPVCube& cube, const string& fileName, CubeCodec codec, Real tolerance, Size nThreads) {
+    QL_REQUIRE(codec != CubeCodec::Quantised || tolerance > 0.0,
+               "saveCompressedCube(): positive tolerance required for quantised values, got " << tolerance);
+    std::ofstream out(fileName.c_str(), std::fstream::binary);
+    QL_REQUIRE(out.is_open(), "error opening file " << fileName);
+
+    Size ids = cube.numIds(), dates = cube.numDates();
+    out.write(signature, sizeof(signature));
+    write<std::uint32_t>(out, formatVersion);
+    write<std::uint32_t>(out, static_cast<std::uint32_t>(codec));
+    write<double>(out, tolerance);
+    write<std::int64_t>(out, cube.asof().serialNumber());
+    write<std::uint64_t>(out, ids);
+    for (auto const& id : cube.ids())
+        writeString(out, id);
+    write<std::uint64_t>(out, dates);
+    for (auto const& d : cube.dates())
+        write<std::int64_t>(out, d.serialNumber());
+    write<std::uint64_t>(out, cube.samples());
+    write<std::uint64_t>(out, cube.depth());
+    for (Size i = 0; i < ids; ++i) {
+        for (Size d = 0; d < cube.depth(); ++d)
+            write<double>(out, cube.getT0(i, d));
+    }
+
+    // chunk index (offset, size, encoding), written once the chunk sizes are known
+    std::streampos indexPos = out.tellp();
+    vector<std::uint64_t> offsets(ids * dates, 0), sizes(ids * dates, 0);
+    vector<unsigned char> encodings(ids * dates, ZeroChunk);
+    for (Size c = 0; c < ids * dates; ++c) {
+        write<std::uint64_t>(out, 0);
+        write<std::uint64_t>(out, 0);
+        write<unsigned char>(out, ZeroChunk);
+    }
+
+    // encode blocks of trades in parallel and write them in trade order
+    std::uint64_t offset = 0;
+    Size block = ore::data::numberOfThreads(ids, nThreads) * 16;
+    for (Size begin = 0; begin < ids; begin += block) {
+        Size end = std::min(begin + block, ids);
+        vector<vector<unsigned char>> buffers((end - begin) * dates);
+        ore::data::parallelFor(
+            end - begin,
+            [&](Size t) {
+                for (Size j = 0; j < dates; ++j)
+                    encodings[(begin + t) * dates + j] =
+                        encodeChunk(cube, begin + t, j, codec, tolerance, buffers[t * dates + j]);
+            },
+            nThreads);
+        for (Size c = 0; c < buffers.size(); ++c) {
+            offsets[begin * dates + c] = offset;
+            sizes[begin * dates + c] = buffers[c].size();
+            out.write(reinterpret_cast<const char*>(buffers[c].data()), buffers[c].size());
+            offset += buffers[c].size();
+        }
+    }
+
+    out.seekp(indexPos);
+    for (Size c = 0; c < ids * dates; ++c) {
+        write<std::uint64_t>(out, offsets[c]);
+        write<std::uint64_t>(out, sizes[c]);
+        write<unsigned char>(out, encodings[c]);
+    }
+    QL_REQUIRE(out, "error writing compressed cube to file " << fileName);
+}
+
+CompressedCubeReader::CompressedCubeReader(const string& fileName) : fileName_(fileName) {
+    QL_REQUIRE(isCompressedCube(fileName), "file " << fileName << " is not a compressed cube");
+    std::ifstream in(fileName.c_str(), std::fstream::binary);
+    in.seekg(sizeof(signature));
+    std::uint32_t version = read<std::uint32_t>(in);
+    QL_REQUIRE(version == formatVersion, "compressed cube format version " << version << " not supported");
+    std::uint32_t codec = read<std::uint32_t>(in);
+    QL_REQUIRE(codec <= static_cast<std::uint32_t>(CubeCodec::Quantised), "unknown cube codec " << codec);
+    codec_ = static_cast<CubeCodec>(codec);
+    tolerance_ = read<double>(in);
+    asof_ = QuantLib::Date(static_cast<QuantLib::Date::serial_type>(read<std::int64_t>(in)));
+    ids_.resize(read<std::uint64_t>(in));
+    for (auto& id : ids_)
+        id = readString(in);
+    dates_.resize(read<std::uint64_t>(in));
+    for (auto& d : dates_)
+        d = QuantLib::Date(static_cast<QuantLib::Date::serial_type>(read<std::int64_t>(in)));
+    samples_ = read<std::uint64_t>(in);
+    depth_ = read<std::uint64_t>(in);
+    t0Data_.resize(ids_.size() * depth_);
+    for (auto& v : t0Data_)
+        v = read<double>(in);
+    chunks_.resize(ids_.size() * dates_.size());
+    liveDates_.resize(ids_.size(), 0);
+    for (Size c = 0; c < chunks_.size(); ++c) {
+        chunks_[c].offset = read<std::uint64_t>(in);
+        chunks_[c].size = read<std::uint64_t>(in);
+        chunks_[c].encoding = read<unsigned char>(in);
+        QL_REQUIRE(chunks_[c].encoding <= CompressedChunk, "unknown chunk encoding in " << fileName);
+        if (chunks_[c].encoding != ZeroChunk)
+            liveDates_[c / dates_.size()] = c % dates_.size() + 1;
+    }
+    dataOffset_ = static_cast<std::uint64_t>(in.tellg());
+}
+
+bool CompressedCubeReader::isCompressedCube(const string& fileName) {
+    std::ifstream in(fileName.c_str(), std::fstream::binary);
+    char s[sizeof(signature)];
+    return in.read(s, sizeof(s)) && std::equal(s, s + sizeof(s), signature);
+}
+
+Size CompressedCubeReader::numLiveDates(Size id) const {
+    QL_REQUIRE(id < numIds(), "Out of bounds on ids (id=" << id << ")");
+    return liveDates_[id];
+}
+
+Real CompressedCubeReader::getT0(Size id, Size depth) const {
+    QL_REQUIRE(id < numIds(), "Out of bounds on ids (id=" << id << ")");
+    QL_REQUIRE(depth < depth_, "Out of bounds on depth (depth=" << depth << ")");
+    return t0Data_[id * depth_ + depth];
+}
+
+vector<Real> CompressedCubeReader::values(Size id, Size date) const {
+    std::ifstream in(fileName_.c_str(), std::fstream::binary);
+    QL_REQUIRE(in.is_open(), "error opening file " << fileName_);
+    vector<Real> result;
+    decode(in, id, date, result);
+    return result;
+}
+
+void CompressedCubeReader::decode(std::istream& in, Size id, Size date, vector<Real>& values) const {
+    QL_REQUIRE(id < numIds(), "Out of bounds on ids (id=" << id << ")");
+    QL_REQUIRE(date < numDates(), "Out of bounds on dates (date=" << date << ")");
+    Size n = samples_ * depth_;
+    const Chunk& chunk = chunks_[id * dates_.size() + date];
+    values.assign(n, 0.0);
+    if (chunk.encoding == ZeroChunk)
+        return;
+
+    vector<unsigned char> buffer(chunk.size), shuffled;
+    in.seekg(dataOffset_ + chunk.offset);
+    in.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+    QL_REQUIRE(in, "unexpected end of compressed cube file " << fileName_);
+    if (chunk.encoding == CompressedChunk) {
+        shuffled.resize(n * sizeof(std::uint64_t));
+        lzDecompress(buffer, shuffled);
+    } else {
+        QL_REQUIRE(buffer.size() == n * sizeof(std::uint64_t), "corrupt compressed cube chunk");
+        shuffled.swap(buffer);
+    }
+
+    vector<std::uint64_t> words(n);
+    unsigned char* bytes = reinterpret_cast<unsigned char*>(words.data());
+    for (Size b = 0; b < sizeof(std::uint64_t); ++b) {
+        for (Size p = 0; p < n; ++p)
+            bytes[p * sizeof(std::uint64_t) + b] = shuffled[b * n + p];
+    }
+    for (Size p = 0; p < n; ++p) {
+        if (codec_ == CubeCodec::Lossless) {
+            double v;
+            std::memcpy(&v, &words[p], sizeof(v));
+            values[p] = v;
+        } else {
+            std::int64_t l = static_cast<std::int64_t>(words[p] >> 1) ^ -static_cast<std::int64_t>(words[p] & 1);
+            values[p] = static_cast<Real>(l) * 2.0 * tolerance_;
+        }
+    }
+}
+
+Size CompressedCubeReader::load(NPVCube& target, const std::set<string>& ids, Size nThreads) const {
+    QL_REQUIRE(target.dates() == dates_, "CompressedCubeReader::load(): cube has different dates");
+    QL_REQUIRE(target.samples() == samples_, "CompressedCubeReader::load(): cube has different samples ("
+                                                 << samples_ << ", " << target.samples() << ")");
+    QL_REQUIRE(target.depth() == depth_,
+               "CompressedCubeReader::load(): cube has different depth (" << depth_ << ", " << target.depth() << ")");
+
+    std::map<string, Size> sourceIndex;
+    for (Size i = 0; i < ids_.size(); ++i) {
+        if (ids.empty() || ids.count(ids_[i]) > 0)
+            sourceIndex[ids_[i]] = i;
+    }
+    // pairs of source and target trade index
+    vector<std::pair<Size, Size>> copies;
+    for (Size t = 0; t < target.numIds(); ++t) {
+        auto it = sourceIndex.find(target.ids()[t]);
+        if (it != sourceIndex.end())
+            copies.push_back(std::make_pair(it->second, t));
+    }
+
+    ore::data::parallelFor(
+        copies.size(),
+        [&](Size c) {
+            Size s = copies[c].first, t = copies[c].second;
+            std::ifstream in(fileName_.c_str(), std::fstream::binary);
+            QL_REQUIRE(in.is_open(), "error opening file " << fileName_);
+            for (Size d = 0; d < depth_; ++d)
+                target.setT0(t0Data_[s * depth_ + d], t, d);
+            // both the file and the target are zero after their live dates
+            Size liveDates = std::max(liveDates_[s], target.numLiveDates(t));
+            vector<Real> values;
+            for (Size j = 0; j < liveDates; ++j) {
+                decode(in, s, j, values);
+                for (Size d = 0; d < depth_; ++d) {
+                    for (Size k = 0; k < samples_; ++k)
+                        target.set(values[d * samples_ + k], t, j, k, d);
+                }
+            }
+        },
+        nThreads);
+    return copies.size();
+}
+
+} // namespace analytics
+} // namespace ore
@@ -0,0 +1,130 @@
+/*
+ Copyright (C) 2020 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file orea/cube/cubecompression.hpp
+    \brief Compressed file format for NPV cubes with random access by trade and date
+    \ingroup cube
+*/
+
+#pragma once
+
+#include <orea/cube/npvcube.hpp>
+
+#include <cstdint>
+#include <ostream>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace ore {
+namespace analytics {
+
+//! Codec for the future values of a compressed cube file
+enum class CubeCodec {
+    Lossless, // doubles, byte shuffled and LZ compressed
+    Quantised // values rounded to multiples of twice the tolerance, stored as integers and compressed as above
+};
+
+std::ostream& operator<<(std::ostream& out, CubeCodec c);
+
+CubeCodec parseCubeCodec(const std::string& s);
+
+//! Write the \p cube to \p fileName in the compressed cube format
+/*! The future values are stored in one chunk per trade and date holding all samples and depths. Each chunk is
+    compressed separately, so that CompressedCubeReader can decode single trades or dates, and chunks without non-zero
+    values, e.g. after the trade maturity, take no space. With the Quantised codec the absolute error of each value is
+    at most \p tolerance, the T0 values are always stored exactly.
+
+    The chunks are encoded on up to \p nThreads threads (the hardware threads if zero), the cube is only read. Like the
+    boost binary archives, the file can not be read on a platform of different endianness.
+
+    \ingroup cube
+*/
+void saveCompressedCube(const NPVCube& cube, const std::string& fileName, CubeCodec codec = CubeCodec::Lossless,
+                        QuantLib::Real tolerance = 0.0, QuantLib::Size nThreads = 1);
+
+//! Random access to a cube file written by saveCompressedCube()
+/*! The constructor reads the header, the T0 values and the chunk index only, the future values of a trade and date are
+    read and decoded on request. All methods are const and can be called concurrently.
+
+    Note that OREApp uses load() to decode all dates of the portfolio trades into an in-memory cube for the post
+    processor, which does not read the values of single trades or dates on demand.
+
+    \ingroup cube
+*/
+class CompressedCubeReader {
+public:
+    //! Read the header of \p fileName
+    explicit CompressedCubeReader(const std::string& fileName);
+
+    //! true if \p fileName starts with the signature of the compressed cube format
+    static bool isCompressedCube(const std::string& fileName);
+
+    //! Inspectors
+    //@{
+    const std::string& fileName() const { return fileName_; }
+    QuantLib::Date asof() const { return asof_; }
+    const std::vector<std::string>& ids() const { return ids_; }
+    const std::vector<QuantLib::Date>& dates() const { return dates_; }
+    QuantLib::Size numIds() const { return ids_.size(); }
+    QuantLib::Size numDates() const { return dates_.size(); }
+    QuantLib::Size samples() const { return samples_; }
+    QuantLib::Size depth() const { return depth_; }
+    CubeCodec codec() const { return codec_; }
+    QuantLib::Real tolerance() const { return tolerance_; }
+    //@}
+
+    //! Number of leading dates on which trade \p id has non-zero values
+    QuantLib::Size numLiveDates(QuantLib::Size id) const;
+    //! T0 value of trade \p id
+    QuantLib::Real getT0(QuantLib::Size id, QuantLib::Size depth = 0) const;
+    //! Future values of trade \p id on \p date, indexed by depth * samples() + sample
+    std::vector<QuantLib::Real> values(QuantLib::Size id, QuantLib::Size date) const;
+
+    //! Copy the values of the trades with the given \p ids into \p target, all trades if \p ids is empty
+    /*! As in copyCubeTrades(), the trades are matched by id, the target must have the same dates, samples and depth and
+        the number of trades copied is returned. Only the chunks of the copied trades are read, the trades are decoded
+        on up to \p nThreads threads (the hardware threads if zero). target.set() is called concurrently for different
+        trades.
+    */
+    QuantLib::Size load(NPVCube& target, const std::set<std::string>& ids = std::set<std::string>(),
+                        QuantLib::Size nThreads = 1) const;
+
+private:
+    struct Chunk {
+        std::uint64_t offset = 0;
+        std::uint64_t size = 0;
+        unsigned char encoding = 0;
+    };
+    void decode(std::istream& in, QuantLib::Size id, QuantLib::Size date, std::vector<QuantLib::Real>& values) const;
+
+    std::string fileName_;
+    QuantLib::Date asof_;
+    std::vector<std::string> ids_;
+    std::vector<QuantLib::Date> dates_;
+    QuantLib::Size samples_, depth_;
+    CubeCodec codec_;
+    QuantLib::Real tolerance_;
+    std::vector<QuantLib::Real> t0Data_;
+    std::vector<Chunk> chunks_;
+    std::vector<QuantLib::Size> liveDates_;
+    std::uint64_t dataOffset_;
+};
+
+} // namespace analytics
+} // namespace ore
@@ -0,0 +1,74 @@
+/*
+ Copyright (C) 2020 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <orea/cube/cubeutils.hpp>
+
+#include <algorithm>
+#include <map>
+
+namespace ore {
+namespace analytics {
+
+Size copyCubeTrades(const NPVCube& source, NPVCube& target, const std::set<std::string>& ids) {
+    QL_REQUIRE(source.dates() == target.dates(), "copyCubeTrades(): cubes have different dates");
+    QL_REQUIRE(source.samples() == target.samples(), "copyCubeTrades(): cubes have different samples ("
+                                                         << source.samples() << ", " << target.samples() << ")");
+    QL_REQUIRE(source.depth() == target.depth(),
+               "copyCubeTrades(): cubes have different depth (" << source.depth() << ", " << target.depth() << ")");
+
+    std::map<std::string, Size> sourceIndex;
+    for (Size i = 0; i < source.numIds(); ++i) {
+        if (ids.count(source.ids()[i]) > 0)
+            sourceIndex[source.ids()[i]] = i;
+    }
+
+    Size copied = 0;
+    for (Size t = 0; t < target.numIds(); ++t) {
+        auto it = sourceIndex.find(target.ids()[t]);
+        if (it == sourceIndex.end())
+            continue;
+        Size s = it->second;
+        for (Size d = 0; d < source.depth(); ++d) {
+            target.setT0(source.getT0(s, d), t, d);
+            // both cubes are zero after their live dates
+            Size liveDates = std::max(source.numLiveDates(s), target.numLiveDates(t));
+            for (Size j = 0; j < liveDates; ++j) {
+                for (Size k = 0; k < source.samples(); ++k)
+                    target.set(source.get(s, j, k, d), t, j, k, d);
+            }
+        }
+        ++copied;
+    }
+    return copied;
+}
+
+std::vector<Size> tradeLiveDates(const ore::data::Portfolio& portfolio, const std::vector<QuantLib::Date>& dates) {
+    QL_REQUIRE(std::is_sorted(dates.begin(), dates.end()), "tradeLiveDates(): dates must be sorted");
+    std::vector<Size> liveDates;
+    for (auto const& t : portfolio.trades()) {
+        QuantLib::Date maturity = t->maturity();
+        if (maturity == QuantLib::Date())
+            liveDates.push_back(dates.size());
+        else
+            liveDates.push_back(std::distance(dates.begin(), std::upper_bound(dates.begin(), dates.end(), maturity)));
+    }
+    return liveDates;
+}
+
+} // namespace analytics
+} // namespace ore
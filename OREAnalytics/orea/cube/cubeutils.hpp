@@ -0,0 +1,56 @@
+/*
+ Copyright (C) 2020 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file orea/cube/cubeutils.hpp
+    \brief Utilities to combine NPV cubes
+    \ingroup cube
+*/
+
+#pragma once
+
+#include <orea/cube/npvcube.hpp>
+#include <ored/portfolio/portfolio.hpp>
+
+#include <set>
+#include <string>
+
+namespace ore {
+namespace analytics {
+
+//! Copy the T0 and future values of the trades with the given \p ids from \p source to \p target
+/*! The trades are matched by id, both cubes must have the same dates, number of samples and depth. This can be used
+    to keep the results of unchanged trades after a portfolio update and only simulate the added and modified trades,
+    see ore::data::Portfolio::update().
+
+    Returns the number of trades copied, ids not present in both cubes are skipped.
+
+    \ingroup cube
+*/
+Size copyCubeTrades(const NPVCube& source, NPVCube& target, const std::set<std::string>& ids);
+
+//! Number of leading \p dates on which each trade of the \p portfolio can have non-zero cube values
+/*! These are the dates on or before the trade maturity, the flows up to the maturity are stored on these dates as
+    well. A trade with a null maturity is considered alive on all dates. The result can be passed to a
+    SparseInMemoryCube.
+
+    \ingroup cube
+*/
+std::vector<Size> tradeLiveDates(const ore::data::Portfolio& portfolio, const std::vector<QuantLib::Date>& dates);
+
+} // namespace analytics
+} // namespace ore
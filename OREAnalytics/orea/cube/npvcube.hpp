@@ -58,6 +58,9 @@ public:
     virtual Size numDates() const = 0;
     virtual Size samples() const = 0;
     virtual Size depth() const = 0;
+    //! Return the number of leading dates on which trade \p id can have non-zero values
+    /*! get() returns zero on all later dates, so that aggregations over the cube can skip them */
+    virtual Size numLiveDates(Size id) const { return numDates(); }
 
     //! Get the vector of ids for this cube
     virtual const std::vector<std::string>& ids() const = 0;
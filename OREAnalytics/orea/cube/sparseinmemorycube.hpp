@@ -0,0 +1,186 @@
+/*
+ Copyright (C) 2020 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file orea/cube/sparseinmemorycube.hpp
+    \brief An in memory cube that does not store the values of matured trades
+    \ingroup cube
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <fstream>
+#include <vector>
+
+#include <ql/errors.hpp>
+
+#include <boost/serialization/vector.hpp>
+#include <orea/cube/npvcube.hpp>
+#include <ored/utilities/serializationdate.hpp>
+
+namespace ore {
+namespace analytics {
+using QuantLib::Date;
+using QuantLib::Real;
+using QuantLib::Size;
+using std::vector;
+
+//! In memory cube that only stores the live part of each trade
+/*! For each trade the cube stores the first numLiveDates(i) dates only, typically the dates up to the trade maturity
+    (see tradeLiveDates() in cubeutils.hpp), and returns zero for the later dates. The values of a trade are held in
+    one contiguous block of size numLiveDates(i) x samples x depth.
+
+    The live dates given on construction are a lower bound: setting a non-zero value on a later date extends the live
+    part of the trade, setting a zero value there is a no-op. Hence a trade that is still alive after its reported
+    maturity, e.g. a physically settled swaption, is stored correctly. get() never changes the cube.
+
+    \ingroup cube
+ */
+template <typename T> class SparseInMemoryCube : public NPVCube {
+public:
+    //! ctor
+    SparseInMemoryCube(const Date& asof, const vector<std::string>& ids, const vector<Date>& dates, Size samples,
+                       const vector<Size>& liveDates, Size depth = 1)
+        : asof_(asof), ids_(ids), dates_(dates), samples_(samples), depth_(depth), liveDates_(liveDates),
+          t0Data_(ids.size() * depth, T()), data_(ids.size()) {
+        QL_REQUIRE(ids.size() > 0, "SparseInMemoryCube::SparseInMemoryCube no ids specified");
+        QL_REQUIRE(dates.size() > 0, "SparseInMemoryCube::SparseInMemoryCube no dates specified");
+        QL_REQUIRE(samples > 0, "SparseInMemoryCube::SparseInMemoryCube samples must be > 0");
+        QL_REQUIRE(depth > 0, "SparseInMemoryCube::SparseInMemoryCube depth must be > 0");
+        QL_REQUIRE(liveDates.size() == ids.size(), "SparseInMemoryCube::SparseInMemoryCube live dates size ("
+                                                       << liveDates.size() << ") does not match ids size ("
+                                                       << ids.size() << ")");
+        for (Size i = 0; i < ids.size(); ++i) {
+            liveDates_[i] = std::min(liveDates_[i], dates.size());
+            data_[i].resize(liveDates_[i] * samples * depth, T());
+        }
+    }
+    //! construct from file
+    SparseInMemoryCube(const std::string& fileName) {
+        load(fileName);
+        QL_REQUIRE(numIds() > 0 && numDates() > 0 && samples() > 0,
+                   "SparseInMemoryCube::SparseInMemoryCube failed to load from file " << fileName);
+    }
+
+    //! default constructor
+    SparseInMemoryCube() : samples_(0), depth_(0) {}
+
+    //! load cube from an archive
+    void load(const std::string& fileName) override {
+        std::ifstream ifs(fileName.c_str(), std::fstream::binary);
+        QL_REQUIRE(ifs.is_open(), "error opening file " << fileName);
+        boost::archive::binary_iarchive ia(ifs);
+        ia >> *this;
+    }
+
+    //! write cube to an archive
+    void save(const std::string& fileName) const override {
+        std::ofstream ofs(fileName.c_str(), std::fstream::binary);
+        QL_REQUIRE(ofs.is_open(), "error opening file " << fileName);
+        boost::archive::binary_oarchive oa(ofs);
+        oa << *this;
+    }
+
+    //! Return the length of each dimension
+    Size numIds() const override { return ids_.size(); }
+    Size numDates() const override { return dates_.size(); }
+    Size samples() const override { return samples_; }
+    Size depth() const override { return depth_; }
+    Size numLiveDates(Size i) const override {
+        QL_REQUIRE(i < numIds(), "Out of bounds on ids (i=" << i << ")");
+        return liveDates_[i];
+    }
+
+    //! Get the vector of ids for this cube
+    const std::vector<std::string>& ids() const override { return ids_; }
+    //! Get the vector of dates for this cube
+    const std::vector<QuantLib::Date>& dates() const override { return dates_; }
+
+    //! Return the asof date (T0 date)
+    QuantLib::Date asof() const override { return asof_; }
+
+    //! Get a T0 value from the cube
+    Real getT0(Size i, Size d) const override {
+        check(i, 0, 0, d);
+        return t0Data_[i * depth_ + d];
+    }
+
+    //! Set a T0 value in the cube
+    void setT0(Real value, Size i, Size d) override {
+        check(i, 0, 0, d);
+        t0Data_[i * depth_ + d] = static_cast<T>(value);
+    }
+
+    //! Get a value from the cube, zero on the dates after the live part of the trade
+    Real get(Size i, Size j, Size k, Size d) const override {
+        check(i, j, k, d);
+        if (j >= liveDates_[i])
+            return 0.0;
+        return data_[i][(j * samples_ + k) * depth_ + d];
+    }
+
+    //! Set a value in the cube, a non-zero value after the live part of the trade extends the live part
+    void set(Real value, Size i, Size j, Size k, Size d) override {
+        check(i, j, k, d);
+        if (j >= liveDates_[i]) {
+            if (value == 0.0)
+                return;
+            liveDates_[i] = j + 1;
+            data_[i].resize(liveDates_[i] * samples_ * depth_, T());
+        }
+        data_[i][(j * samples_ + k) * depth_ + d] = static_cast<T>(value);
+    }
+
+protected:
+    void check(Size i, Size j, Size k, Size d) const {
+        QL_REQUIRE(i < numIds(), "Out of bounds on ids (i=" << i << ")");
+        QL_REQUIRE(j < numDates(), "Out of bounds on dates (j=" << j << ")");
+        QL_REQUIRE(k < samples(), "Out of bounds on samples (k=" << k << ")");
+        QL_REQUIRE(d < depth(), "Out of bounds on depth(d=" << d << ")");
+    }
+
+private:
+    friend class boost::serialization::access;
+    template <class Archive> void serialize(Archive& ar, const unsigned int) {
+        ar& asof_;
+        ar& ids_;
+        ar& dates_;
+        ar& samples_;
+        ar& depth_;
+        ar& liveDates_;
+        ar& t0Data_;
+        ar& data_;
+    }
+
+    QuantLib::Date asof_;
+    vector<std::string> ids_;
+    vector<QuantLib::Date> dates_;
+    Size samples_;
+    Size depth_;
+    vector<Size> liveDates_;
+    vector<T> t0Data_;
+    vector<vector<T>> data_;
+};
+
+//! SparseInMemoryCube with single precision floating point numbers.
+using SinglePrecisionSparseInMemoryCube = SparseInMemoryCube<float>;
+
+//! SparseInMemoryCube with double precision floating point numbers.
+using DoublePrecisionSparseInMemoryCube = SparseInMemoryCube<double>;
+} // namespace analytics
+} // namespace ore
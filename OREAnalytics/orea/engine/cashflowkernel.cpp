@@ -0,0 +1,309 @@
+/*
+ Copyright (C) 2020 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <orea/engine/cashflowkernel.hpp>
+#include <ored/portfolio/instrumentwrapper.hpp>
+#include <ored/utilities/log.hpp>
+
+#include <qle/instruments/fxforward.hpp>
+
+#include <ql/cashflows/couponpricer.hpp>
+#include <ql/cashflows/fixedratecoupon.hpp>
+#include <ql/cashflows/iborcoupon.hpp>
+#include <ql/cashflows/simplecashflow.hpp>
+#include <ql/instruments/swap.hpp>
+#include <ql/settings.hpp>
+
+#include <algorithm>
+#include <typeinfo>
+
+using namespace QuantLib;
+using namespace ore::data;
+
+namespace ore {
+namespace analytics {
+
+CashflowKernel::CashflowKernel(const boost::shared_ptr<Market>& market, const std::string& configuration)
+    : market_(market), configuration_(configuration), stamp_(0) {
+    QL_REQUIRE(market_, "CashflowKernel: no market given");
+}
+
+Size CashflowKernel::curveSlot(const std::string& ccy) {
+    auto c = curveIndex_.find(ccy);
+    if (c != curveIndex_.end())
+        return c->second;
+    curve_.push_back(market_->discountCurve(ccy, configuration_));
+    curveRefDate_.push_back(Date());
+    curveRefDiscount_.push_back(1.0);
+    return curveIndex_[ccy] = curve_.size() - 1;
+}
+
+Size CashflowKernel::discountNode(Size curve, const Date& date) {
+    auto key = std::make_pair(curve, date);
+    auto n = nodeIndex_.find(key);
+    if (n != nodeIndex_.end())
+        return n->second;
+    nodeCurve_.push_back(curve);
+    nodeDate_.push_back(date);
+    nodeDiscount_.push_back(0.0);
+    nodeStamp_.push_back(0);
+    return nodeIndex_[key] = nodeDate_.size() - 1;
+}
+
+Size CashflowKernel::fxSlot(const std::string& ccy, const std::string& npvCcy) {
+    if (ccy == npvCcy)
+        return Null<Size>();
+    std::string pair = ccy + npvCcy;
+    auto f = fxIndex_.find(pair);
+    if (f != fxIndex_.end())
+        return f->second;
+    fxPair_.push_back(pair);
+    fxRate_.push_back(1.0);
+    return fxIndex_[pair] = fxPair_.size() - 1;
+}
+
+Size CashflowKernel::projection(const boost::shared_ptr<IborCoupon>& cpn) {
+    boost::shared_ptr<IborIndex> index = cpn->iborIndex();
+    Date fixingDate = cpn->fixingDate();
+    Date start, end;
+    // mimic the fixing estimation in IborCoupon
+    if (IborCoupon::usingAtParCoupons()) {
+        start = index->fixingCalendar().advance(fixingDate, index->fixingDays(), Days);
+        Date nextFixingDate = index->fixingCalendar().advance(cpn->accrualEndDate(),
+                                                               -static_cast<Integer>(cpn->fixingDays()), Days);
+        end = index->fixingCalendar().advance(nextFixingDate, index->fixingDays(), Days);
+        end = std::max(end, start + 1);
+    } else {
+        start = index->valueDate(fixingDate);
+        end = index->maturityDate(start);
+    }
+    std::vector<Date> dates = {fixingDate, start, end};
+    auto key = std::make_pair(index.get(), dates);
+    auto p = projIndex_.find(key);
+    if (p != projIndex_.end())
+        return p->second;
+    projIbor_.push_back(index);
+    projFixingDate_.push_back(fixingDate);
+    projStart_.push_back(start);
+    projEnd_.push_back(end);
+    projTau_.push_back(index->dayCounter().yearFraction(start, end));
+    projRate_.push_back(Null<Real>());
+    projStamp_.push_back(0);
+    return projIndex_[key] = projIbor_.size() - 1;
+}
+
+bool CashflowKernel::addFlow(const boost::shared_ptr<CashFlow>& flow, Real sign, Size curve) {
+    Real amount = 0.0, factor = 0.0;
+    Size proj = Null<Size>();
+    if (auto cpn = boost::dynamic_pointer_cast<FixedRateCoupon>(flow)) {
+        if (cpn->exCouponDate() != Date())
+            return false;
+        amount = sign * cpn->amount();
+    } else if (auto cf = boost::dynamic_pointer_cast<SimpleCashFlow>(flow)) {
+        amount = sign * cf->amount();
+    } else if (typeid(*flow) == typeid(IborCoupon)) {
+        // not in arrears, so that the Black pricer does not apply a convexity adjustment
+        auto cpn = boost::static_pointer_cast<IborCoupon>(flow);
+        if (cpn->isInArrears() || !boost::dynamic_pointer_cast<BlackIborCouponPricer>(cpn->pricer()))
+            return false;
+        Real nominalAccrual = sign * cpn->nominal() * cpn->accrualPeriod();
+        amount = nominalAccrual * cpn->spread();
+        factor = nominalAccrual * cpn->gearing();
+        proj = projection(cpn);
+    } else {
+        return false;
+    }
+    flowNode_.push_back(discountNode(curve, flow->date()));
+    flowProj_.push_back(proj);
+    flowDate_.push_back(flow->date());
+    flowAmount_.push_back(amount);
+    flowFactor_.push_back(factor);
+    return true;
+}
+
+bool CashflowKernel::add(Size tradeIndex, const boost::shared_ptr<Trade>& trade) {
+    QL_REQUIRE(trade, "CashflowKernel: trade is null");
+    QL_REQUIRE(tradeIndex_.find(tradeIndex) == tradeIndex_.end(),
+               "CashflowKernel: trade index " << tradeIndex << " (" << trade->id() << ") added twice");
+
+    auto wrapper = boost::dynamic_pointer_cast<VanillaInstrument>(trade->instrument());
+    if (!wrapper || !wrapper->additionalInstruments().empty())
+        return false;
+
+    bool event;
+    if (boost::dynamic_pointer_cast<QuantExt::FxForward>(wrapper->qlInstrument())) {
+        event = true;
+    } else if (boost::dynamic_pointer_cast<QuantLib::Swap>(wrapper->qlInstrument())) {
+        event = false;
+        for (auto const& ccy : trade->legCurrencies())
+            if (ccy != trade->npvCurrency())
+                return false;
+    } else {
+        return false;
+    }
+
+    const std::vector<Leg>& legs = trade->legs();
+    if (legs.size() != trade->legPayers().size() || legs.size() != trade->legCurrencies().size())
+        return false;
+
+    Size slot = tradeNpv_.size();
+    Size nFlows = flowAmount_.size(), nSegs = segBegin_.size();
+    bool supported = true;
+    try {
+        for (Size i = 0; i < legs.size() && supported; ++i) {
+            Size curve = curveSlot(trade->legCurrencies()[i]);
+            Real sign = (trade->legPayers()[i] ? -1.0 : 1.0) * wrapper->multiplier();
+            segTrade_.push_back(slot);
+            segCurve_.push_back(curve);
+            segFx_.push_back(fxSlot(trade->legCurrencies()[i], trade->npvCurrency()));
+            segEvent_.push_back(event);
+            segBegin_.push_back(flowAmount_.size());
+            for (Size j = 0; j < legs[i].size() && supported; ++j)
+                supported = addFlow(legs[i][j], sign, curve);
+            segEnd_.push_back(flowAmount_.size());
+        }
+    } catch (const std::exception& e) {
+        DLOG("CashflowKernel: failed to compile trade " << trade->id() << ": " << e.what());
+        supported = false;
+    }
+
+    if (!supported) {
+        // roll back the flows and segments of this trade, the (shared) nodes and projections are kept
+        flowNode_.resize(nFlows);
+        flowProj_.resize(nFlows);
+        flowDate_.resize(nFlows);
+        flowAmount_.resize(nFlows);
+        flowFactor_.resize(nFlows);
+        segTrade_.resize(nSegs);
+        segCurve_.resize(nSegs);
+        segFx_.resize(nSegs);
+        segEvent_.resize(nSegs);
+        segBegin_.resize(nSegs);
+        segEnd_.resize(nSegs);
+        DLOG("CashflowKernel: trade " << trade->id() << " is not supported");
+        return false;
+    }
+
+    tradeIndex_[tradeIndex] = slot;
+    tradeId_.push_back(trade->id());
+    tradeNpv_.push_back(0.0);
+    tradeValid_.push_back(false);
+    return true;
+}
+
+Real CashflowKernel::discount(Size node) {
+    if (nodeStamp_[node] != stamp_) {
+        nodeDiscount_[node] = curve_[nodeCurve_[node]]->discount(nodeDate_[node]);
+        nodeStamp_[node] = stamp_;
+    }
+    return nodeDiscount_[node];
+}
+
+Real CashflowKernel::forwardRate(Size proj, const Date& today) {
+    if (projStamp_[proj] == stamp_)
+        return projRate_[proj];
+    projStamp_[proj] = stamp_;
+    projRate_[proj] = Null<Real>();
+    const boost::shared_ptr<IborIndex>& index = projIbor_[proj];
+    const Date& fixingDate = projFixingDate_[proj];
+    // same logic as IborCoupon::indexFixing()
+    if (fixingDate <= today) {
+        Real past = Null<Real>();
+        try {
+            past = index->pastFixing(fixingDate);
+        } catch (...) {
+        }
+        if (past != Null<Real>() || fixingDate < today || Settings::instance().enforcesTodaysHistoricFixings()) {
+            projRate_[proj] = past;
+            return past;
+        }
+    }
+    const Handle<YieldTermStructure>& curve = index->forwardingTermStructure();
+    QL_REQUIRE(!curve.empty(), "CashflowKernel: null forwarding curve for index " << index->name());
+    projRate_[proj] = (curve->discount(projStart_[proj]) / curve->discount(projEnd_[proj]) - 1.0) / projTau_[proj];
+    return projRate_[proj];
+}
+
+void CashflowKernel::calculate() {
+    ++stamp_;
+    Date today = Settings::instance().evaluationDate();
+    bool includeRefDateEvents = Settings::instance().includeReferenceDateEvents();
+    boost::optional<bool> includeTodaysCashFlows = Settings::instance().includeTodaysCashFlows();
+
+    std::fill(tradeValid_.begin(), tradeValid_.end(), false);
+    for (Size c = 0; c < curve_.size(); ++c) {
+        curveRefDate_[c] = curve_[c]->referenceDate();
+        curveRefDiscount_[c] = curve_[c]->discount(curveRefDate_[c]);
+    }
+    for (Size k = 0; k < fxPair_.size(); ++k)
+        fxRate_[k] = market_->fxSpot(fxPair_[k], configuration_)->value();
+
+    std::fill(tradeNpv_.begin(), tradeNpv_.end(), 0.0);
+    std::fill(tradeValid_.begin(), tradeValid_.end(), true);
+
+    for (Size s = 0; s < segBegin_.size(); ++s) {
+        Size t = segTrade_[s];
+        if (!tradeValid_[t])
+            continue;
+        Size c = segCurve_[s];
+        const Date& refDate = curveRefDate_[c];
+        // cashflows follow CashFlow::hasOccurred(), fx forward settlements Event::hasOccurred()
+        bool includeRefDate = includeRefDateEvents;
+        if (!segEvent_[s] && refDate == today && includeTodaysCashFlows)
+            includeRefDate = *includeTodaysCashFlows;
+        try {
+            Real value = 0.0;
+            for (Size f = segBegin_[s]; f < segEnd_[s]; ++f) {
+                const Date& d = flowDate_[f];
+                if (d < refDate || (d == refDate && !includeRefDate))
+                    continue;
+                Real amount = flowAmount_[f];
+                if (flowProj_[f] != Null<Size>()) {
+                    Real rate = forwardRate(flowProj_[f], today);
+                    QL_REQUIRE(rate != Null<Real>(), "missing " << projIbor_[flowProj_[f]]->name() << " fixing for "
+                                                                << projFixingDate_[flowProj_[f]]);
+                    amount += flowFactor_[f] * rate;
+                }
+                value += amount * discount(flowNode_[f]);
+            }
+            value /= curveRefDiscount_[c];
+            if (segFx_[s] != Null<Size>())
+                value *= fxRate_[segFx_[s]];
+            tradeNpv_[t] += value;
+        } catch (const std::exception& e) {
+            // the trade is priced by its instrument then, which will report the error
+            DLOG("CashflowKernel: failed to value trade " << tradeId_[t] << ": " << e.what());
+            tradeValid_[t] = false;
+        }
+    }
+}
+
+bool CashflowKernel::has(Size tradeIndex) const {
+    auto t = tradeIndex_.find(tradeIndex);
+    return t != tradeIndex_.end() && tradeValid_[t->second];
+}
+
+Real CashflowKernel::npv(Size tradeIndex) const {
+    auto t = tradeIndex_.find(tradeIndex);
+    QL_REQUIRE(t != tradeIndex_.end(), "CashflowKernel: trade index " << tradeIndex << " not found");
+    QL_REQUIRE(tradeValid_[t->second], "CashflowKernel: no valid npv for trade " << tradeId_[t->second]);
+    return tradeNpv_[t->second];
+}
+
+} // namespace analytics
+} // namespace ore
@@ -0,0 +1,141 @@
+/*
+ Copyright (C) 2020 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file orea/engine/cashflowkernel.hpp
+    \brief Fast pricing of linear trades from their cashflows
+    \ingroup simulation
+*/
+
+#pragma once
+
+#include <ored/marketdata/market.hpp>
+#include <ored/portfolio/trade.hpp>
+
+#include <ql/cashflows/iborcoupon.hpp>
+#include <ql/indexes/iborindex.hpp>
+
+#include <map>
+#include <vector>
+
+namespace ore {
+namespace analytics {
+using QuantLib::Date;
+using QuantLib::Real;
+using QuantLib::Size;
+
+//! Cashflow kernel
+/*! Prices linear trades directly from their cashflows, bypassing the QuantLib instruments, pricing engines and
+    coupon pricers. This is used by the ValuationEngine to avoid the overhead of the instrument and observer
+    machinery for simple trades under each scenario and date.
+
+    The trades are compiled once by add() into flat arrays holding one entry per cashflow. The discount factors and
+    Ibor forward rates needed by the cashflows are deduplicated across all trades, so that calculate() computes each
+    of them only once per market state and then values all trades in a single pass over the cashflow arrays.
+
+    The following trades are supported
+    - Swaps with all legs in one currency (QuantLib::Swap instrument, DiscountingSwapEngine)
+    - FX Forwards (QuantExt::FxForward instrument, DiscountingFxForwardEngine)
+    - Compressed trades representing one of the above, see ore::data::CompressedTrade
+
+    provided their legs consist of fixed rate coupons (without ex coupon date), simple cashflows and Ibor coupons
+    which are not fixed in arrears. add() returns false for other trades, these must be priced as usual. The NPVs are
+    identical to those of the pricing engines given that the trades are priced on the discount curves of the market
+    passed to the constructor.
+
+    \ingroup simulation
+*/
+class CashflowKernel {
+public:
+    CashflowKernel(const boost::shared_ptr<ore::data::Market>& market,
+                   const std::string& configuration = ore::data::Market::defaultConfiguration);
+
+    //! Compile the trade with the given index, returns false if the trade is not supported
+    bool add(Size tradeIndex, const boost::shared_ptr<ore::data::Trade>& trade);
+
+    //! Value all trades on the current market state
+    void calculate();
+
+    //! Number of trades compiled into the kernel
+    Size size() const { return tradeIndex_.size(); }
+    //! Number of cashflows compiled into the kernel
+    Size numberOfFlows() const { return flowAmount_.size(); }
+
+    //! Has the trade with the given index been compiled into the kernel?
+    bool covers(Size tradeIndex) const { return tradeIndex_.find(tradeIndex) != tradeIndex_.end(); }
+
+    //! Does the kernel provide an NPV for the trade with the given index as of the last calculate() call?
+    bool has(Size tradeIndex) const;
+
+    //! NPV in the trade's npv currency as of the last calculate() call, including the instrument multiplier
+    Real npv(Size tradeIndex) const;
+
+private:
+    Size curveSlot(const std::string& ccy);
+    Size discountNode(Size curve, const Date& date);
+    Size fxSlot(const std::string& ccy, const std::string& npvCcy);
+    Size projection(const boost::shared_ptr<QuantLib::IborCoupon>& cpn);
+    bool addFlow(const boost::shared_ptr<QuantLib::CashFlow>& flow, Real sign, Size curve);
+    Real discount(Size node);
+    Real forwardRate(Size proj, const Date& today);
+
+    boost::shared_ptr<ore::data::Market> market_;
+    std::string configuration_;
+    // discount factors and forward rates are computed on demand, once per calculate() call identified by stamp_
+    Size stamp_;
+
+    // trades
+    std::map<Size, Size> tradeIndex_;
+    std::vector<std::string> tradeId_;
+    std::vector<Real> tradeNpv_;
+    std::vector<bool> tradeValid_;
+
+    // segments: the flows of a trade in one currency, [segBegin_, segEnd_) in the flow arrays
+    std::vector<Size> segTrade_, segCurve_, segFx_, segBegin_, segEnd_;
+    std::vector<bool> segEvent_;
+
+    // flows: amount = flowAmount_ + flowFactor_ * forward rate of projection flowProj_
+    std::vector<Size> flowNode_, flowProj_;
+    std::vector<Date> flowDate_;
+    std::vector<Real> flowAmount_, flowFactor_;
+
+    // discount curves per currency and deduplicated discount factors
+    std::map<std::string, Size> curveIndex_;
+    std::vector<QuantLib::Handle<QuantLib::YieldTermStructure>> curve_;
+    std::vector<Date> curveRefDate_;
+    std::vector<Real> curveRefDiscount_;
+    std::map<std::pair<Size, Date>, Size> nodeIndex_;
+    std::vector<Size> nodeCurve_;
+    std::vector<Date> nodeDate_;
+    std::vector<Real> nodeDiscount_;
+    std::vector<Size> nodeStamp_;
+
+    // fx conversions into the npv currency
+    std::map<std::string, Size> fxIndex_;
+    std::vector<std::string> fxPair_;
+    std::vector<Real> fxRate_;
+
+    // deduplicated Ibor projections
+    std::map<std::pair<QuantLib::IborIndex*, std::vector<Date>>, Size> projIndex_;
+    std::vector<boost::shared_ptr<QuantLib::IborIndex>> projIbor_;
+    std::vector<Date> projFixingDate_, projStart_, projEnd_;
+    std::vector<Real> projTau_, projRate_;
+    std::vector<Size> projStamp_;
+};
+
+} // namespace analytics
+} // namespace ore
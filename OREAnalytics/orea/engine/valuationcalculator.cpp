@@ -31,21 +31,22 @@ namespace analytics {
 void NPVCalculator::calculate(const boost::shared_ptr<Trade>& trade, Size tradeIndex,
                               const boost::shared_ptr<SimMarket>& simMarket, boost::shared_ptr<NPVCube>& outputCube,
                               const Date& date, Size dateIndex, Size sample) {
-    outputCube->set(npv(trade, simMarket), tradeIndex, dateIndex, sample, index_);
+    outputCube->set(npv(trade, tradeIndex, simMarket), tradeIndex, dateIndex, sample, index_);
 }
 
 void NPVCalculator::calculateT0(const boost::shared_ptr<Trade>& trade, Size tradeIndex,
                                 const boost::shared_ptr<SimMarket>& simMarket, boost::shared_ptr<NPVCube>& outputCube) {
-    outputCube->setT0(npv(trade, simMarket), tradeIndex, index_);
+    outputCube->setT0(npv(trade, tradeIndex, simMarket), tradeIndex, index_);
 }
 
-Real NPVCalculator::npv(const boost::shared_ptr<Trade>& trade, const boost::shared_ptr<SimMarket>& simMarket) {
+Real NPVCalculator::npv(const boost::shared_ptr<Trade>& trade, Size tradeIndex,
+                        const boost::shared_ptr<SimMarket>& simMarket) {
     Real npv = 0;
     try {
         Real fx = simMarket->fxSpot(trade->npvCurrency() + baseCcyCode_)->value();
         Real numeraire = simMarket->numeraire();
 
-        npv = trade->instrument()->NPV() * fx / numeraire;
+        npv = tradeNpv(trade, tradeIndex) * fx / numeraire;
 
     } catch (std::exception& e) {
         ALOG("Failed to price trade " << trade->id() << " : " << e.what());
@@ -116,16 +117,17 @@ void CashflowCalculator::calculate(const boost::shared_ptr<Trade>& trade, Size t
 void NPVCalculatorFXT0::calculate(const boost::shared_ptr<Trade>& trade, Size tradeIndex,
                                   const boost::shared_ptr<SimMarket>& simMarket, boost::shared_ptr<NPVCube>& outputCube,
                                   const Date& date, Size dateIndex, Size sample) {
-    outputCube->set(npv(trade, simMarket), tradeIndex, dateIndex, sample, index_);
+    outputCube->set(npv(trade, tradeIndex, simMarket), tradeIndex, dateIndex, sample, index_);
 }
 
 void NPVCalculatorFXT0::calculateT0(const boost::shared_ptr<Trade>& trade, Size tradeIndex,
                                     const boost::shared_ptr<SimMarket>& simMarket,
                                     boost::shared_ptr<NPVCube>& outputCube) {
-    outputCube->setT0(npv(trade, simMarket), tradeIndex, index_);
+    outputCube->setT0(npv(trade, tradeIndex, simMarket), tradeIndex, index_);
 }
 
-Real NPVCalculatorFXT0::npv(const boost::shared_ptr<Trade>& trade, const boost::shared_ptr<SimMarket>& simMarket) {
+Real NPVCalculatorFXT0::npv(const boost::shared_ptr<Trade>& trade, Size tradeIndex,
+                            const boost::shared_ptr<SimMarket>& simMarket) {
     Real npv = 0;
     try {
         // Real fx = simMarket->fxSpot(trade->npvCurrency() + baseCcyCode_)->value();
@@ -134,7 +136,7 @@ Real NPVCalculatorFXT0::npv(const boost::shared_ptr<Trade>& trade, const boost::
             fx = t0Market_->fxSpot(trade->npvCurrency() + baseCcyCode_)->value();
         Real numeraire = simMarket->numeraire();
 
-        npv = trade->instrument()->NPV() * fx / numeraire;
+        npv = tradeNpv(trade, tradeIndex) * fx / numeraire;
 
     } catch (std::exception& e) {
         ALOG("Failed to price trade " << trade->id() << " : " << e.what());
@@ -24,6 +24,7 @@
 #pragma once
 
 #include <orea/cube/npvcube.hpp>
+#include <orea/engine/cashflowkernel.hpp>
 #include <orea/simulation/simmarket.hpp>
 #include <ored/portfolio/trade.hpp>
 #include <ored/utilities/dategrid.hpp>
@@ -65,6 +66,19 @@ public:
         const boost::shared_ptr<SimMarket>& simMarket,
         //! The cube
         boost::shared_ptr<NPVCube>& outputCube) = 0;
+
+    //! Set a kernel providing the NPVs of the trades it covers, a null pointer switches the kernel off
+    void setCashflowKernel(const boost::shared_ptr<CashflowKernel>& kernel) { cashflowKernel_ = kernel; }
+
+protected:
+    //! NPV of the trade in its npv currency, taken from the cashflow kernel if it covers the trade
+    Real tradeNpv(const boost::shared_ptr<Trade>& trade, Size tradeIndex) const {
+        if (cashflowKernel_ && cashflowKernel_->has(tradeIndex))
+            return cashflowKernel_->npv(tradeIndex);
+        return trade->instrument()->NPV();
+    }
+
+    boost::shared_ptr<CashflowKernel> cashflowKernel_;
 };
 
 //! NPVCalculator
@@ -85,7 +99,8 @@ public:
                              const boost::shared_ptr<SimMarket>& simMarket, boost::shared_ptr<NPVCube>& outputCube);
 
 protected:
-    virtual Real npv(const boost::shared_ptr<Trade>& trade, const boost::shared_ptr<SimMarket>& simMarket);
+    virtual Real npv(const boost::shared_ptr<Trade>& trade, Size tradeIndex,
+                     const boost::shared_ptr<SimMarket>& simMarket);
 
     std::string baseCcyCode_;
     Size index_;
@@ -138,7 +153,7 @@ public:
                              const boost::shared_ptr<SimMarket>& simMarket, boost::shared_ptr<NPVCube>& outputCube);
 
 private:
-    Real npv(const boost::shared_ptr<Trade>& trade, const boost::shared_ptr<SimMarket>& simMarket);
+    Real npv(const boost::shared_ptr<Trade>& trade, Size tradeIndex, const boost::shared_ptr<SimMarket>& simMarket);
 
     std::string baseCcyCode_;
     boost::shared_ptr<Market> t0Market_;
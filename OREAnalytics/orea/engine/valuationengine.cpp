@@ -16,6 +16,7 @@
  FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
 */
 
+#include <orea/engine/cashflowkernel.hpp>
 #include <orea/engine/observationmode.hpp>
 #include <orea/engine/valuationengine.hpp>
 #include <orea/simulation/simmarket.hpp>
@@ -25,9 +26,12 @@
 #include <ored/utilities/parsers.hpp>
 #include <ored/utilities/progressbar.hpp>
 
+#include <boost/make_shared.hpp>
 #include <boost/timer/timer.hpp>
 #include <ql/errors.hpp>
 
+#include <algorithm>
+
 using namespace QuantLib;
 using namespace QuantExt;
 using namespace std;
@@ -38,10 +42,40 @@ using boost::timer::default_places;
 namespace ore {
 namespace analytics {
 
+namespace {
+// trades in one group share their pricing engine builder (by trade type), currencies and indices
+string groupKey(const boost::shared_ptr<Trade>& trade, bool kernel) {
+    std::set<string> ccys(trade->legCurrencies().begin(), trade->legCurrencies().end());
+    std::set<string> indices;
+    for (const Leg& leg : trade->legs()) {
+        for (auto const& cf : leg) {
+            if (auto frc = boost::dynamic_pointer_cast<FloatingRateCoupon>(cf))
+                indices.insert(frc->index()->name());
+        }
+    }
+    ostringstream key;
+    key << (kernel ? "CashflowKernel " : "") << trade->tradeType() << " " << trade->npvCurrency();
+    for (auto const& c : ccys)
+        if (c != trade->npvCurrency())
+            key << "," << c;
+    for (auto const& i : indices)
+        key << " " << i;
+    return key.str();
+}
+
+struct TradeGroup {
+    string key;
+    Size begin, end;
+    Real time;
+};
+} // namespace
+
 ValuationEngine::ValuationEngine(const Date& today, const boost::shared_ptr<DateGrid>& dg,
                                  const boost::shared_ptr<SimMarket>& simMarket,
-                                 const set<std::pair<string, boost::shared_ptr<ModelBuilder>>>& modelBuilders)
-    : today_(today), dg_(dg), simMarket_(simMarket), modelBuilders_(modelBuilders) {
+                                 const set<std::pair<string, boost::shared_ptr<ModelBuilder>>>& modelBuilders,
+                                 const bool useCashflowKernel, const bool groupTrades)
+    : today_(today), dg_(dg), simMarket_(simMarket), modelBuilders_(modelBuilders),
+      useCashflowKernel_(useCashflowKernel), groupTrades_(groupTrades) {
 
     QL_REQUIRE(dg_->size() > 0, "Error, DateGrid size must be > 0");
     QL_REQUIRE(today <= dg_->dates().front(), "ValuationEngine: Error today ("
@@ -110,7 +144,39 @@ void ValuationEngine::buildCube(const boost::shared_ptr<data::Portfolio>& portfo
 
     simMarket_->fixingManager()->initialise(portfolio);
 
+    boost::shared_ptr<CashflowKernel> kernel;
+    if (useCashflowKernel_) {
+        kernel = boost::make_shared<CashflowKernel>(simMarket_);
+        for (Size i = 0; i < trades.size(); ++i)
+            kernel->add(i, trades[i]);
+        LOG("Cashflow kernel prices " << kernel->size() << " out of " << trades.size() << " trades, "
+                                      << kernel->numberOfFlows() << " cashflows");
+        for (auto calc : calculators)
+            calc->setCashflowKernel(kernel);
+    }
+
+    // the order in which the trades are priced, the cube index of trades[order[k]] is still order[k]
+    vector<Size> order(trades.size());
+    for (Size j = 0; j < trades.size(); ++j)
+        order[j] = j;
+    vector<TradeGroup> groups;
+    if (groupTrades_) {
+        vector<string> keys(trades.size());
+        for (Size j = 0; j < trades.size(); ++j)
+            keys[j] = groupKey(trades[j], kernel && kernel->covers(j));
+        std::stable_sort(order.begin(), order.end(), [&keys](Size a, Size b) { return keys[a] < keys[b]; });
+        for (Size k = 0; k < order.size(); ++k) {
+            if (groups.empty() || keys[order[k]] != groups.back().key)
+                groups.push_back({keys[order[k]], k, k, 0.0});
+            groups.back().end = k + 1;
+        }
+        LOG("Pricing " << trades.size() << " trades in " << groups.size() << " groups");
+    } else {
+        groups.push_back({"All", 0, trades.size(), 0.0});
+    }
+
     cpu_timer timer;
+    cpu_timer groupTimer;
     cpu_timer loopTimer;
 
     // We call Cube::samples() each time her to allow for dynamic stopping times
@@ -141,15 +207,28 @@ void ValuationEngine::buildCube(const boost::shared_ptr<data::Portfolio>& portfo
 
             // loop over trades
             timer.start();
-            for (Size j = 0; j < trades.size(); ++j) {
-                auto trade = trades[j];
-
-                // We can avoid checking mode here and always call updateQlInstruments()
-                if (om == ObservationMode::Mode::Disable)
-                    trade->instrument()->updateQlInstruments();
-
-                for (auto calc : calculators)
-                    calc->calculate(trade, j, simMarket_, outputCube, d, i, sample);
+            if (kernel) {
+                try {
+                    kernel->calculate();
+                } catch (const std::exception& e) {
+                    ALOG("Cashflow kernel failed on " << io::iso_date(d) << ", sample " << sample << ": " << e.what());
+                }
+            }
+            for (auto& g : groups) {
+                groupTimer.start();
+                for (Size k = g.begin; k < g.end; ++k) {
+                    Size j = order[k];
+                    auto trade = trades[j];
+
+                    // We can avoid checking mode here and always call updateQlInstruments()
+                    if (om == ObservationMode::Mode::Disable)
+                        trade->instrument()->updateQlInstruments();
+
+                    for (auto calc : calculators)
+                        calc->calculate(trade, j, simMarket_, outputCube, d, i, sample);
+                }
+                groupTimer.stop();
+                g.time += groupTimer.elapsed().wall * 1e-9;
             }
             timer.stop();
             pricingTime += timer.elapsed().wall * 1e-9;
@@ -160,6 +239,9 @@ void ValuationEngine::buildCube(const boost::shared_ptr<data::Portfolio>& portfo
         fixingTime += timer.elapsed().wall * 1e-9;
     }
 
+    for (auto calc : calculators)
+        calc->setCashflowKernel(nullptr);
+
     simMarket_->reset();
     updateProgress(outputCube->samples(), outputCube->samples());
     loopTimer.stop();
@@ -167,6 +249,17 @@ void ValuationEngine::buildCube(const boost::shared_ptr<data::Portfolio>& portfo
                                            << "pricing " << pricingTime << " sec, "
                                            << "update " << updateTime << " sec "
                                            << "fixing " << fixingTime);
+
+    if (groupTrades_) {
+        std::stable_sort(groups.begin(), groups.end(),
+                         [](const TradeGroup& a, const TradeGroup& b) { return a.time > b.time; });
+        Size valuations = std::max<Size>(dates.size() * outputCube->samples(), 1);
+        for (auto const& g : groups) {
+            Size n = g.end - g.begin;
+            LOG("ValuationEngine group " << g.key << ": " << n << " trades, pricing " << g.time << " sec, "
+                                         << g.time / (n * valuations) * 1e6 << " microsec per trade and date");
+        }
+    }
 }
 } // namespace analytics
 } // namespace ore
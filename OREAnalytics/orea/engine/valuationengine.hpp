@@ -52,6 +52,13 @@ using std::set;
   In addition to storing the resulting NPVs it can be given any number of calculators
   that can store additional values in the cube.
 
+  Optionally, linear trades are priced by a CashflowKernel which values all of them
+  in one pass per date, the other trades are priced by their pricing engines as usual.
+
+  Optionally, the trades are priced grouped by trade type (and hence pricing engine),
+  currencies and indices rather than in portfolio order, so that consecutive trades use
+  the same term structures and engines. The cube index of each trade is not affected.
+
   \ingroup simulation
 */
 class ValuationEngine : public ore::data::ProgressReporter {
@@ -66,7 +73,11 @@ public:
         const boost::shared_ptr<analytics::SimMarket>& simMarket,
         //! model builders to be updated
         const set<std::pair<string, boost::shared_ptr<data::ModelBuilder>>>& modelBuilders =
-            set<std::pair<string, boost::shared_ptr<data::ModelBuilder>>>());
+            set<std::pair<string, boost::shared_ptr<data::ModelBuilder>>>(),
+        //! price supported linear trades with a CashflowKernel instead of their pricing engines
+        const bool useCashflowKernel = false,
+        //! price the trades grouped by trade type, currencies and indices and log the pricing time per group
+        const bool groupTrades = false);
 
     //! Build NPV cube
     void buildCube(
@@ -82,6 +93,8 @@ private:
     boost::shared_ptr<DateGrid> dg_;
     boost::shared_ptr<analytics::SimMarket> simMarket_;
     set<std::pair<string, boost::shared_ptr<data::ModelBuilder>>> modelBuilders_;
+    bool useCashflowKernel_;
+    bool groupTrades_;
 };
 } // namespace analytics
 } // namespace ore
@@ -29,7 +29,10 @@
 #include <boost/archive/binary_iarchive.hpp>
 #include <boost/archive/binary_oarchive.hpp>
 #include <boost/serialization/map.hpp>
+#include <boost/serialization/split_member.hpp>
+#include <boost/serialization/utility.hpp>
 #include <boost/serialization/vector.hpp>
+#include <boost/serialization/version.hpp>
 
 #include <fstream>
 #include <map>
@@ -45,6 +48,8 @@ using std::vector;
 
 enum class AggregationScenarioDataType { IndexFixing, FXSpot, Numeraire, Generic };
 
+std::ostream& operator<<(std::ostream& out, const AggregationScenarioDataType& t);
+
 //! Container for storing simulated marekt data
 /*! The indexes for dates and samples are (by convention) the
     same as in the npv cube
@@ -78,6 +83,14 @@ public:
     // Get available keys (type, qualifier)
     virtual std::vector<std::pair<AggregationScenarioDataType, std::string>> keys() const = 0;
 
+    //! Handle of the given key for the index based accessors below, throws if there is no data for the key
+    /*! The handle remains valid until the data is loaded from disk */
+    virtual Size index(const AggregationScenarioDataType& type, const string& qualifier = "") const = 0;
+    //! Get a value from the cube by key handle, avoids the key lookup in loops over dates and samples
+    virtual Real get(Size dateIndex, Size sampleIndex, Size keyIndex) const = 0;
+    //! Pointer to the values of all dimSamples() samples for the given date and key handle
+    virtual const Real* samples(Size dateIndex, Size keyIndex) const = 0;
+
     //! Load cube contents from disk
     virtual void load(const std::string&) {}
     //! Persist cube contents to disk
@@ -102,7 +115,13 @@ private:
 };
 
 //! A concrete in memory implementation of AggregationScenarioData
-/*! \ingroup scenario
+/*! The values are stored in one contiguous buffer, ordered by key, date and sample, so that the values of all
+    samples for a given key and date are adjacent. The keys are numbered in the order in which they are first set.
+
+    The binary file format stores the dimensions, the keys and the buffer. Files written in the previous format
+    (a map from key to a date x sample matrix) can still be loaded.
+
+    \ingroup scenario
  */
 class InMemoryAggregationScenarioData : public AggregationScenarioData {
 public:
@@ -113,33 +132,49 @@ public:
     Size dimSamples() const override { return dimSamples_; }
 
     bool has(const AggregationScenarioDataType& type, const string& qualifier = "") const override {
-        return data_.find(std::make_pair(type, qualifier)) != data_.end();
+        return index_.find(std::make_pair(type, qualifier)) != index_.end();
     }
 
-    /*! might throw (the underlying's container exception),
-      if type is not known */
+    /*! throws if type is not known */
     Real get(Size dateIndex, Size sampleIndex, const AggregationScenarioDataType& type,
              const string& qualifier = "") const override {
-        check(dateIndex, sampleIndex, type, qualifier);
-        return data_.at(std::make_pair(type, qualifier))[dateIndex][sampleIndex];
+        return get(dateIndex, sampleIndex, index(type, qualifier));
     }
 
     std::vector<std::pair<AggregationScenarioDataType, std::string>> keys() const override {
         std::vector<std::pair<AggregationScenarioDataType, std::string>> res;
-        for (auto const& k : data_)
+        for (auto const& k : index_)
             res.push_back(k.first);
         return res;
     }
 
+    Size index(const AggregationScenarioDataType& type, const string& qualifier = "") const override {
+        auto it = index_.find(std::make_pair(type, qualifier));
+        QL_REQUIRE(it != index_.end(), "no aggregation scenario data for " << type << " " << qualifier);
+        return it->second;
+    }
+
+    Real get(Size dateIndex, Size sampleIndex, Size keyIndex) const override {
+        check(dateIndex, sampleIndex, keyIndex);
+        return data_[offset(dateIndex, keyIndex) + sampleIndex];
+    }
+
+    const Real* samples(Size dateIndex, Size keyIndex) const override {
+        check(dateIndex, 0, keyIndex);
+        return &data_[offset(dateIndex, keyIndex)];
+    }
+
     void set(Size dateIndex, Size sampleIndex, Real value, const AggregationScenarioDataType& type,
              const string& qualifier = "") override {
-        check(dateIndex, sampleIndex, type, qualifier);
+        check(dateIndex, sampleIndex);
         auto key = std::make_pair(type, qualifier);
-        auto it = data_.find(key);
-        if (it == data_.end()) {
-            data_.insert(make_pair(key, vector<vector<Real>>(dimDates_, vector<Real>(dimSamples_, 0.0))));
+        auto it = index_.find(key);
+        if (it == index_.end()) {
+            it = index_.insert(std::make_pair(key, keys_.size())).first;
+            keys_.push_back(key);
+            data_.resize(keys_.size() * dimDates_ * dimSamples_, 0.0);
         }
-        data_[key][dateIndex][sampleIndex] = value;
+        data_[offset(dateIndex, it->second) + sampleIndex] = value;
     }
 
     void load(const std::string& fileName) override {
@@ -158,21 +193,56 @@ public:
 
 private:
     friend class boost::serialization::access;
-    template <class Archive> void serialize(Archive& ar, const unsigned int) {
+    template <class Archive> void save(Archive& ar, const unsigned int) const {
         ar& dimDates_;
         ar& dimSamples_;
+        ar& keys_;
         ar& data_;
     }
+    template <class Archive> void load(Archive& ar, const unsigned int version) {
+        ar& dimDates_;
+        ar& dimSamples_;
+        keys_.clear();
+        index_.clear();
+        data_.clear();
+        if (version == 0) {
+            map<std::pair<AggregationScenarioDataType, string>, vector<vector<Real>>> data;
+            ar& data;
+            data_.reserve(data.size() * dimDates_ * dimSamples_);
+            for (auto const& d : data) {
+                keys_.push_back(d.first);
+                for (auto const& v : d.second)
+                    data_.insert(data_.end(), v.begin(), v.end());
+            }
+        } else {
+            ar& keys_;
+            ar& data_;
+        }
+        QL_REQUIRE(data_.size() == keys_.size() * dimDates_ * dimSamples_,
+                   "InMemoryAggregationScenarioData: buffer size " << data_.size() << " does not match "
+                                                                   << keys_.size() << " keys x " << dimDates_
+                                                                   << " dates x " << dimSamples_ << " samples");
+        for (Size i = 0; i < keys_.size(); ++i)
+            index_[keys_[i]] = i;
+    }
+    BOOST_SERIALIZATION_SPLIT_MEMBER()
+
+    Size offset(Size dateIndex, Size keyIndex) const { return (keyIndex * dimDates_ + dateIndex) * dimSamples_; }
 
-    void check(Size dateIndex, Size sampleIndex, const AggregationScenarioDataType& type,
-               const string& qualifier) const {
+    void check(Size dateIndex, Size sampleIndex) const {
         QL_REQUIRE(dateIndex < dimDates_, "dateIndex (" << dateIndex << ") out of range 0..." << dimDates_ - 1);
         QL_REQUIRE(sampleIndex < dimSamples_,
                    "sampleIndex (" << sampleIndex << ") out of range 0..." << dimSamples_ - 1);
-        return;
+    }
+    void check(Size dateIndex, Size sampleIndex, Size keyIndex) const {
+        check(dateIndex, sampleIndex);
+        QL_REQUIRE(keyIndex < keys_.size(), "keyIndex (" << keyIndex << ") out of range 0..." << keys_.size() - 1);
     }
     Size dimDates_, dimSamples_;
-    map<std::pair<AggregationScenarioDataType, string>, vector<vector<Real>>> data_;
+    vector<std::pair<AggregationScenarioDataType, string>> keys_;
+    map<std::pair<AggregationScenarioDataType, string>, Size> index_;
+    // keys x dates x samples
+    vector<Real> data_;
 };
 
 inline std::ostream& operator<<(std::ostream& out, const AggregationScenarioDataType& t) {
@@ -192,3 +262,6 @@ inline std::ostream& operator<<(std::ostream& out, const AggregationScenarioData
 
 } // namespace analytics
 } // namespace ore
+
+// version 1 stores the data in one contiguous buffer, version 0 as a map of date x sample matrices
+BOOST_CLASS_VERSION(ore::analytics::InMemoryAggregationScenarioData, 1)
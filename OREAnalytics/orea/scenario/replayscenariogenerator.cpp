@@ -0,0 +1,79 @@
+/*
+ Copyright (C) 2020 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <orea/scenario/replayscenariogenerator.hpp>
+#include <ored/utilities/parsers.hpp>
+
+#include <boost/algorithm/string.hpp>
+
+using ore::data::parseDate;
+using ore::data::parseReal;
+
+namespace ore {
+namespace analytics {
+
+ReplayScenarioGenerator::ReplayScenarioGenerator(const std::string& fileName,
+                                                 const boost::shared_ptr<ScenarioFactory>& scenarioFactory,
+                                                 const char sep)
+    : fileName_(fileName), scenarioFactory_(scenarioFactory), sep_(sep) {
+    reset();
+}
+
+void ReplayScenarioGenerator::reset() {
+    if (file_.is_open())
+        file_.close();
+    file_.open(fileName_);
+    QL_REQUIRE(file_.is_open(), "ReplayScenarioGenerator: error opening file " << fileName_);
+
+    std::string line;
+    QL_REQUIRE(std::getline(file_, line), "ReplayScenarioGenerator: no header line in file " << fileName_);
+    boost::trim(line);
+    std::vector<std::string> tokens;
+    boost::split(tokens, line, [this](char c) { return c == sep_; });
+    QL_REQUIRE(tokens.size() > 3 && tokens[0] == "Date" && tokens[1] == "Scenario" && tokens[2] == "Numeraire",
+               "ReplayScenarioGenerator: expected header Date, Scenario, Numeraire, keys... in file " << fileName_);
+    keys_.clear();
+    for (Size i = 3; i < tokens.size(); ++i)
+        keys_.push_back(parseRiskFactorKey(tokens[i]));
+}
+
+boost::shared_ptr<Scenario> ReplayScenarioGenerator::next(const Date& d) {
+    std::string line;
+    QL_REQUIRE(std::getline(file_, line), "ReplayScenarioGenerator: no more scenarios in file " << fileName_
+                                                                                                 << ", requested "
+                                                                                                 << io::iso_date(d));
+    boost::trim(line);
+    std::vector<std::string> tokens;
+    boost::split(tokens, line, [this](char c) { return c == sep_; });
+    QL_REQUIRE(tokens.size() == keys_.size() + 3, "ReplayScenarioGenerator: expected " << keys_.size() + 3
+                                                                                        << " tokens, found "
+                                                                                        << tokens.size() << " in line "
+                                                                                        << line);
+    Date asof = parseDate(tokens[0]);
+    QL_REQUIRE(asof == d, "ReplayScenarioGenerator: requested date " << io::iso_date(d)
+                                                                     << " does not match next scenario date "
+                                                                     << io::iso_date(asof) << " (scenario "
+                                                                     << tokens[1] << ")");
+    boost::shared_ptr<Scenario> scenario = scenarioFactory_->buildScenario(asof, "", parseReal(tokens[2]));
+    for (Size i = 0; i < keys_.size(); ++i)
+        scenario->add(keys_[i], parseReal(tokens[i + 3]));
+    return scenario;
+}
+
+} // namespace analytics
+} // namespace ore
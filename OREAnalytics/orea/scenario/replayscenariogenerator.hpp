@@ -0,0 +1,65 @@
+/*
+ Copyright (C) 2020 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file scenario/replayscenariogenerator.hpp
+    \brief Scenario generator that replays scenarios written by the ScenarioWriter
+    \ingroup scenario
+*/
+
+#pragma once
+
+#include <orea/scenario/scenariofactory.hpp>
+#include <orea/scenario/scenariogenerator.hpp>
+
+#include <fstream>
+
+namespace ore {
+namespace analytics {
+
+//! Scenario generator that replays scenarios written by the ScenarioWriter
+/*! The file has a header line "Date, Scenario, Numeraire, key_1, ..., key_n" followed by one line per date and sample
+    in the order in which the scenarios were generated, i.e. the dates of one sample are followed by the dates of the
+    next sample. The scenarios are read one line at a time, so that the file can be larger than the available memory.
+
+    This allows to value additional trades on exactly the scenarios of a previous simulation without building and
+    calibrating the model again. Note that the ScenarioWriter rounds the values to 8 decimal places.
+
+    \ingroup scenario
+*/
+class ReplayScenarioGenerator : public ScenarioGenerator {
+public:
+    //! Constructor
+    ReplayScenarioGenerator(const std::string& fileName, const boost::shared_ptr<ScenarioFactory>& scenarioFactory,
+                            const char sep = ',');
+
+    //! Return the next scenario from the file, its date must match the given date
+    boost::shared_ptr<Scenario> next(const Date& d) override;
+
+    //! Reset the generator so calls to next() return the first scenario in the file
+    void reset() override;
+
+private:
+    std::string fileName_;
+    boost::shared_ptr<ScenarioFactory> scenarioFactory_;
+    const char sep_;
+    std::ifstream file_;
+    std::vector<RiskFactorKey> keys_;
+};
+
+} // namespace analytics
+} // namespace ore
@@ -47,6 +47,9 @@ namespace analytics {
 
 void FixingManager::initialise(const boost::shared_ptr<Portfolio>& portfolio) {
 
+    // discard the fixings cached for a previous portfolio
+    fixingCache_ = FixingStore();
+
     // loop over all cashflows, populate index map
 
     for (auto trade : portfolio->trades()) {
@@ -59,8 +62,10 @@ void FixingManager::initialise(const boost::shared_ptr<Portfolio>& portfolio) {
     }
 
     // Now cache the original fixings so we can re-write on reset()
-    for (auto m : fixingMap_) {
-        fixingCache_[m.first] = IndexManager::instance().getHistory(m.first->name());
+    for (auto const& m : fixingMap_) {
+        const TimeSeries<Real>& history = IndexManager::instance().getHistory(m.first->name());
+        for (auto const& f : history)
+            fixingCache_.add(f.first, m.first->name(), f.second);
     }
 }
 
@@ -177,8 +182,9 @@ void FixingManager::update(Date d) {
 //! Reset fixings to t0 (today)
 void FixingManager::reset() {
     if (modifiedFixingHistory_) {
-        for (auto& kv : fixingCache_)
-            IndexManager::instance().setHistory(kv.first->name(), kv.second);
+        for (auto const& name : modifiedIndices_)
+            IndexManager::instance().setHistory(name, fixingCache_.timeSeries(name));
+        modifiedIndices_.clear();
         modifiedFixingHistory_ = false;
     }
     fixingsEnd_ = today_;
@@ -219,13 +225,8 @@ void FixingManager::applyFixings(Date start, Date end) {
         }
 
         // Add we have a coupon between start and asof.
-        bool needFixings = false;
-        for (auto const& d : fixingDates) {
-            if (d >= fixStart && d < fixEnd) {
-                needFixings = true;
-                break;
-            }
-        }
+        auto firstFixing = fixingDates.lower_bound(fixStart);
+        bool needFixings = firstFixing != fixingDates.end() && *firstFixing < fixEnd;
 
         if (needFixings) {
             Rate currentFixing = m.first->fixing(currentFixingDate);
@@ -235,14 +236,10 @@ void FixingManager::applyFixings(Date start, Date end) {
                     currentFixing = 1.0 / currentFixing;
             }
             TimeSeries<Real> history;
-            for (auto const& d : fixingDates) {
-                if (d >= fixStart && d < fixEnd) {
-                    history[d] = currentFixing;
-                    modifiedFixingHistory_ = true;
-                }
-                if (d >= fixEnd)
-                    break;
-            }
+            for (auto d = firstFixing; d != fixingDates.end() && *d < fixEnd; ++d)
+                history[*d] = currentFixing;
+            modifiedIndices_.insert(m.first->name());
+            modifiedFixingHistory_ = true;
             m.first->addFixings(history, true);
         }
     }
@@ -22,6 +22,7 @@
  */
 #pragma once
 
+#include <ored/marketdata/fixingstore.hpp>
 #include <ored/portfolio/portfolio.hpp>
 
 namespace ore {
@@ -71,7 +72,10 @@ protected:
             return a->name() < b->name();
         }
     };
-    std::map<boost::shared_ptr<Index>, TimeSeries<Real>, indexComp> fixingCache_;
+    //! original fixings of the indices in fixingMap_, keyed by index name
+    ore::data::FixingStore fixingCache_;
+    //! indices with modified fixing history, to be restored on reset()
+    std::set<std::string> modifiedIndices_;
     std::map<boost::shared_ptr<Index>, std::set<Date>, indexComp> fixingMap_;
 };
 } // namespace analytics
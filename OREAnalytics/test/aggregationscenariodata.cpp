@@ -16,6 +16,7 @@
  FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
 */
 
+#include <boost/filesystem.hpp>
 #include <boost/test/unit_test.hpp>
 #include <orea/scenario/aggregationscenariodata.hpp>
 #include <oret/toplevelfixture.hpp>
@@ -65,6 +66,56 @@ BOOST_AUTO_TEST_CASE(testInMemoryAggregationScenarioData) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(testInMemoryAggregationScenarioDataKeyIndex) {
+    InMemoryAggregationScenarioData data(3, 5);
+
+    for (Size i = 0; i < 3; ++i) {
+        for (Size j = 0; j < 5; ++j) {
+            data.set(i, j, 1.0 + 0.1 * i + 0.01 * j, AggregationScenarioDataType::Numeraire);
+            data.set(i, j, 0.0001 * i + 0.01 * j, AggregationScenarioDataType::IndexFixing, "OIS_EUR");
+            data.set(i, j, i + 0.1 * j, AggregationScenarioDataType::FXSpot, "EURUSD");
+        }
+    }
+
+    BOOST_CHECK_THROW(data.index(AggregationScenarioDataType::Generic, "blabla"), std::exception);
+    Size num = data.index(AggregationScenarioDataType::Numeraire);
+    Size ois = data.index(AggregationScenarioDataType::IndexFixing, "OIS_EUR");
+    Size fx = data.index(AggregationScenarioDataType::FXSpot, "EURUSD");
+    BOOST_CHECK_THROW(data.get(0, 0, 3), std::exception);
+    BOOST_CHECK_THROW(data.samples(3, num), std::exception);
+
+    // save and load the data, the key handles must be preserved
+    std::string filename = boost::filesystem::unique_path().string();
+    data.save(filename);
+    InMemoryAggregationScenarioData data2;
+    data2.load(filename);
+    boost::filesystem::remove(filename);
+
+    BOOST_CHECK_EQUAL(data2.dimDates(), 3);
+    BOOST_CHECK_EQUAL(data2.dimSamples(), 5);
+    BOOST_CHECK(data2.keys() == data.keys());
+    BOOST_CHECK_EQUAL(data2.index(AggregationScenarioDataType::Numeraire), num);
+    BOOST_CHECK_EQUAL(data2.index(AggregationScenarioDataType::IndexFixing, "OIS_EUR"), ois);
+    BOOST_CHECK_EQUAL(data2.index(AggregationScenarioDataType::FXSpot, "EURUSD"), fx);
+
+    Real tol = 1.0E-12;
+    for (auto const* d : {&data, &data2}) {
+        for (Size i = 0; i < 3; ++i) {
+            const Real* numeraires = d->samples(i, num);
+            const Real* rates = d->samples(i, ois);
+            const Real* fxSpots = d->samples(i, fx);
+            for (Size j = 0; j < 5; ++j) {
+                BOOST_CHECK_CLOSE(numeraires[j], 1.0 + 0.1 * i + 0.01 * j, tol);
+                BOOST_CHECK_CLOSE(rates[j], 0.0001 * i + 0.01 * j, tol);
+                BOOST_CHECK_CLOSE(fxSpots[j], i + 0.1 * j, tol);
+                BOOST_CHECK_CLOSE(d->get(i, j, fx), i + 0.1 * j, tol);
+                BOOST_CHECK_CLOSE(d->get(i, j, AggregationScenarioDataType::IndexFixing, "OIS_EUR"),
+                                  0.0001 * i + 0.01 * j, tol);
+            }
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
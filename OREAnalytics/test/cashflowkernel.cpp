@@ -0,0 +1,168 @@
+/*
+ Copyright (C) 2020 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <boost/make_shared.hpp>
+#include <boost/test/unit_test.hpp>
+#include <orea/engine/cashflowkernel.hpp>
+#include <ored/marketdata/marketimpl.hpp>
+#include <ored/portfolio/builders/fxforward.hpp>
+#include <ored/portfolio/builders/swap.hpp>
+#include <ored/portfolio/enginedata.hpp>
+#include <ored/portfolio/fxforward.hpp>
+#include <ored/portfolio/portfoliocompression.hpp>
+#include <ored/portfolio/swap.hpp>
+#include <ored/utilities/indexparser.hpp>
+#include <oret/toplevelfixture.hpp>
+#include <ql/quotes/simplequote.hpp>
+#include <ql/termstructures/yield/flatforward.hpp>
+#include <ql/time/daycounters/actual360.hpp>
+#include <test/oreatoplevelfixture.hpp>
+
+using namespace QuantLib;
+using namespace boost::unit_test_framework;
+using namespace ore::data;
+using namespace ore::analytics;
+using std::string;
+using std::vector;
+
+namespace {
+
+class KernelTestMarket : public MarketImpl {
+public:
+    KernelTestMarket()
+        : eurRate(boost::make_shared<SimpleQuote>(0.01)), euriborRate(boost::make_shared<SimpleQuote>(0.015)),
+          eurUsd(boost::make_shared<SimpleQuote>(1.1)) {
+        asof_ = Date(3, Feb, 2020);
+        yieldCurves_[make_tuple(Market::defaultConfiguration, YieldCurveType::Discount, "EUR")] = flatCurve(eurRate);
+        yieldCurves_[make_tuple(Market::defaultConfiguration, YieldCurveType::Discount, "USD")] =
+            flatCurve(boost::make_shared<SimpleQuote>(0.02));
+        iborIndices_[make_pair(Market::defaultConfiguration, "EUR-EURIBOR-6M")] =
+            Handle<IborIndex>(parseIborIndex("EUR-EURIBOR-6M", flatCurve(euriborRate)));
+        fxSpots_[Market::defaultConfiguration].addQuote("EURUSD", Handle<Quote>(eurUsd));
+    }
+
+    boost::shared_ptr<SimpleQuote> eurRate, euriborRate, eurUsd;
+
+private:
+    Handle<YieldTermStructure> flatCurve(const boost::shared_ptr<SimpleQuote>& rate) {
+        return Handle<YieldTermStructure>(boost::make_shared<FlatForward>(asof_, Handle<Quote>(rate), Actual360()));
+    }
+};
+
+boost::shared_ptr<Trade> swap(const string& id, const string& nettingSet, const string& start, const string& end,
+                              bool payFixed, Real notional, Real rate, Real spread, bool isInArrears = false) {
+    ScheduleData fixedSchedule(ScheduleRules(start, end, "1Y", "TARGET", "MF", "MF", "Forward"));
+    ScheduleData floatSchedule(ScheduleRules(start, end, "6M", "TARGET", "MF", "MF", "Forward"));
+    LegData fixedLeg(boost::make_shared<FixedLegData>(vector<Real>(1, rate)), payFixed, "EUR", fixedSchedule,
+                     "30/360", vector<Real>(1, notional));
+    LegData floatingLeg(boost::make_shared<FloatingLegData>("EUR-EURIBOR-6M", 2, isInArrears, vector<Real>(1, spread)),
+                        !payFixed, "EUR", floatSchedule, "A360", vector<Real>(1, notional));
+    boost::shared_ptr<Trade> trade =
+        boost::make_shared<ore::data::Swap>(Envelope("CP", nettingSet), fixedLeg, floatingLeg);
+    trade->id() = id;
+    return trade;
+}
+
+boost::shared_ptr<Trade> fxForward(const string& id, const string& valueDate, const string& boughtCcy,
+                                   Real boughtAmount, const string& soldCcy, Real soldAmount) {
+    Envelope env("CP", "NS");
+    boost::shared_ptr<Trade> trade =
+        boost::make_shared<FxForward>(env, valueDate, boughtCcy, boughtAmount, soldCcy, soldAmount);
+    trade->id() = id;
+    return trade;
+}
+
+void checkNpvs(const CashflowKernel& kernel, const vector<boost::shared_ptr<Trade>>& trades,
+               const vector<bool>& supported) {
+    for (Size i = 0; i < trades.size(); ++i) {
+        BOOST_REQUIRE_EQUAL(kernel.has(i), supported[i]);
+        if (supported[i]) {
+            Real expected = trades[i]->instrument()->NPV();
+            BOOST_TEST_MESSAGE(trades[i]->id() << ": kernel " << kernel.npv(i) << ", instrument " << expected);
+            BOOST_CHECK_SMALL(kernel.npv(i) - expected, 1E-6);
+        }
+    }
+}
+
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(OREAnalyticsTestSuite, ore::test::OreaTopLevelFixture)
+
+BOOST_AUTO_TEST_SUITE(CashflowKernelTest)
+
+BOOST_AUTO_TEST_CASE(testCashflowKernelNpvs) {
+
+    BOOST_TEST_MESSAGE("Testing cashflow kernel NPVs against pricing engine NPVs...");
+
+    Settings::instance().evaluationDate() = Date(3, Feb, 2020);
+    boost::shared_ptr<KernelTestMarket> market = boost::make_shared<KernelTestMarket>();
+
+    // historical fixings for the seasoned swap
+    boost::shared_ptr<IborIndex> euribor = *market->iborIndex("EUR-EURIBOR-6M");
+    for (Date d = Date(1, Oct, 2019); d < market->asofDate(); ++d)
+        if (euribor->isValidFixingDate(d))
+            euribor->addFixing(d, 0.005);
+
+    boost::shared_ptr<EngineData> data = boost::make_shared<EngineData>();
+    data->model("Swap") = "DiscountedCashflows";
+    data->engine("Swap") = "DiscountingSwapEngine";
+    data->model("FxForward") = "DiscountedCashflows";
+    data->engine("FxForward") = "DiscountingFxForwardEngine";
+    boost::shared_ptr<EngineFactory> factory = boost::make_shared<EngineFactory>(data, market);
+
+    boost::shared_ptr<Portfolio> portfolio = boost::make_shared<Portfolio>();
+    portfolio->add(swap("SwapForward", "NS1", "2020-06-01", "2025-06-01", true, 1000000.0, 0.02, 0.001));
+    portfolio->add(swap("SwapSeasoned", "NS2", "2019-11-04", "2024-11-04", false, 2000000.0, 0.01, 0.0));
+    portfolio->add(swap("SwapInArrears", "NS3", "2020-06-01", "2025-06-01", true, 1000000.0, 0.02, 0.0, true));
+    portfolio->add(fxForward("FxFwd", "2021-02-03", "USD", 1200000.0, "EUR", 1000000.0));
+    portfolio->add(swap("SwapToCompress1", "NS4", "2020-06-01", "2023-06-01", true, 1000000.0, 0.015, 0.0));
+    portfolio->add(swap("SwapToCompress2", "NS4", "2020-06-01", "2023-06-01", false, 500000.0, 0.018, 0.0));
+    portfolio->build(factory);
+    BOOST_REQUIRE_EQUAL(portfolio->size(), 6);
+
+    // compress the last two swaps into a CompressedTrade, the in arrears swap is not supported by the kernel
+    boost::shared_ptr<Portfolio> compressed = compressPortfolio(portfolio, factory);
+    BOOST_REQUIRE_EQUAL(compressed->size(), 5);
+
+    vector<boost::shared_ptr<Trade>> trades = compressed->trades();
+    vector<bool> supported(trades.size());
+    CashflowKernel kernel(market);
+    for (Size i = 0; i < trades.size(); ++i) {
+        supported[i] = trades[i]->id() != "SwapInArrears";
+        BOOST_CHECK_EQUAL(kernel.add(i, trades[i]), supported[i]);
+    }
+    BOOST_CHECK_EQUAL(kernel.size(), 4);
+
+    // no npvs before the first calculation
+    for (Size i = 0; i < trades.size(); ++i)
+        BOOST_CHECK(!kernel.has(i));
+
+    kernel.calculate();
+    checkNpvs(kernel, trades, supported);
+
+    // move the market, the kernel picks up the new discount factors, forward rates and fx spot
+    market->eurRate->setValue(0.02);
+    market->euriborRate->setValue(0.005);
+    market->eurUsd->setValue(1.2);
+    kernel.calculate();
+    checkNpvs(kernel, trades, supported);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,103 @@
+/*
+ Copyright (C) 2020 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <boost/make_shared.hpp>
+#include <boost/test/unit_test.hpp>
+#include <orea/aggregation/collatexposurehelper.hpp>
+#include <oret/toplevelfixture.hpp>
+#include <ql/math/randomnumbers/mt19937uniformrng.hpp>
+#include <test/oreatoplevelfixture.hpp>
+
+using namespace QuantLib;
+using namespace boost::unit_test_framework;
+using namespace ore::data;
+using namespace ore::analytics;
+using std::vector;
+
+BOOST_FIXTURE_TEST_SUITE(OREAnalyticsTestSuite, ore::test::OreaTopLevelFixture)
+
+BOOST_AUTO_TEST_SUITE(CollateralBalancesTest)
+
+BOOST_AUTO_TEST_CASE(testCollateralBalancesVersusAccountPaths) {
+
+    BOOST_TEST_MESSAGE("Testing collateral balances of all samples against the collateral account paths...");
+
+    Date today(15, March, 2019);
+    vector<Date> dateGrid;
+    for (Size i = 1; i <= 20; ++i)
+        dateGrid.push_back(today + (i < 10 ? i * Weeks : 9 * Weeks + (i - 9) * Months));
+    Date maturity = today + 15 * Months;
+    Size samples = 50;
+
+    // netting set values as random walks, fx rates and compounding rates around fixed levels
+    MersenneTwisterUniformRng rng(42);
+    vector<vector<Real>> values(dateGrid.size(), vector<Real>(samples)), fxRates(values), rates(values);
+    Real valueToday = 250000.0;
+    for (Size k = 0; k < samples; ++k) {
+        Real v = valueToday;
+        for (Size j = 0; j < dateGrid.size(); ++j) {
+            v += 400000.0 * (rng.nextReal() - 0.5);
+            values[j][k] = dateGrid[j] > maturity ? 0.0 : v;
+            fxRates[j][k] = 1.1 + 0.2 * (rng.nextReal() - 0.5);
+            rates[j][k] = 0.01 + 0.02 * (rng.nextReal() - 0.5);
+        }
+    }
+
+    vector<boost::shared_ptr<NettingSetDefinition>> csas = {
+        boost::make_shared<NettingSetDefinition>("NS1", "CP", "Bilateral", "USD", "USD-FedFunds", 50000.0, 20000.0,
+                                                 10000.0, 5000.0, 0.0, "FIXED", "1D", "1D", "2W", 0.001, 0.002,
+                                                 vector<string>(1, "USD")),
+        boost::make_shared<NettingSetDefinition>("NS2", "CP", "Bilateral", "USD", "USD-FedFunds", 0.0, 0.0, 0.0, 0.0,
+                                                 30000.0, "FIXED", "1W", "3D", "10D", 0.0, 0.0,
+                                                 vector<string>(1, "USD")),
+        boost::make_shared<NettingSetDefinition>("NS3", "CP", "Bilateral", "USD", "USD-FedFunds", 100000.0, 0.0,
+                                                 25000.0, 0.0, -20000.0, "FIXED", "2W", "1W", "0D", 0.0, -0.001,
+                                                 vector<string>(1, "USD"))};
+
+    vector<CollateralExposureHelper::CalculationType> calcTypes = {CollateralExposureHelper::Symmetric,
+                                                                   CollateralExposureHelper::AsymmetricCVA,
+                                                                   CollateralExposureHelper::AsymmetricDVA};
+
+    for (auto const& csa : csas) {
+        for (auto calcType : calcTypes) {
+            BOOST_TEST_MESSAGE("Netting set " << csa->nettingSetId() << ", calculation type " << calcType);
+            auto paths = CollateralExposureHelper::collateralBalancePaths(csa, valueToday, today, values, maturity,
+                                                                          dateGrid, 1.1, fxRates, 0.01, rates,
+                                                                          calcType);
+            auto balances = CollateralExposureHelper::collateralBalances(csa, valueToday, today, values, maturity,
+                                                                         dateGrid, 1.1, fxRates, 0.01, rates,
+                                                                         calcType);
+            BOOST_REQUIRE_EQUAL(paths->size(), samples);
+            BOOST_REQUIRE_EQUAL(balances->size(), dateGrid.size());
+            bool nonZero = false;
+            for (Size j = 0; j < dateGrid.size(); ++j) {
+                BOOST_REQUIRE_EQUAL(balances->at(j).size(), samples);
+                for (Size k = 0; k < samples; ++k) {
+                    Real expected = paths->at(k)->accountBalance(dateGrid[j]);
+                    BOOST_CHECK_CLOSE((*balances)[j][k], expected, 1.0E-10);
+                    nonZero = nonZero || expected != 0.0;
+                }
+            }
+            BOOST_CHECK(nonZero);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -18,7 +18,10 @@
 
 #include <boost/filesystem.hpp>
 #include <boost/test/unit_test.hpp>
+#include <orea/cube/cubecompression.hpp>
+#include <orea/cube/cubeutils.hpp>
 #include <orea/cube/inmemorycube.hpp>
+#include <orea/cube/sparseinmemorycube.hpp>
 #include <oret/toplevelfixture.hpp>
 #include <test/oreatoplevelfixture.hpp>
 
@@ -200,6 +203,177 @@ BOOST_AUTO_TEST_CASE(testInMemoryCubeGetSetbyDateID) {
     testCubeGetSetbyDateID(cube, 1e-14);
 }
 
+BOOST_AUTO_TEST_CASE(testCopyCubeTrades) {
+    BOOST_TEST_MESSAGE("Testing copying trades between cubes");
+    Date today = Date::todaysDate();
+    vector<Date> dates = {today + QuantLib::Period(1, QuantLib::Days), today + QuantLib::Period(2, QuantLib::Days)};
+    Size samples = 10, depth = 2;
+    DoublePrecisionInMemoryCubeN source(today, { "id1", "id2", "id3" }, dates, samples, depth);
+    DoublePrecisionInMemoryCubeN target(today, { "id3", "id4", "id1" }, dates, samples, depth);
+    initCube(source);
+    for (Size d = 0; d < depth; ++d)
+        source.setT0(100.0 + d, 0, d);
+
+    // id2 is not in the target cube and id4 not in the source cube
+    BOOST_CHECK_EQUAL(copyCubeTrades(source, target, { "id1", "id2", "id4" }), 1);
+    for (Size d = 0; d < depth; ++d) {
+        BOOST_CHECK_EQUAL(target.getT0("id1", d), 100.0 + d);
+        BOOST_CHECK_EQUAL(target.getT0("id3", d), 0.0);
+        for (Size j = 0; j < dates.size(); ++j) {
+            for (Size k = 0; k < samples; ++k) {
+                BOOST_CHECK_EQUAL(target.get(2, j, k, d), source.get(0, j, k, d));
+                BOOST_CHECK_EQUAL(target.get(0, j, k, d), 0.0);
+            }
+        }
+    }
+
+    DoublePrecisionInMemoryCubeN other(today, { "id1" }, dates, samples, depth + 1);
+    BOOST_CHECK_THROW(copyCubeTrades(source, other, { "id1" }), std::exception);
+}
+
+BOOST_AUTO_TEST_CASE(testSparseInMemoryCube) {
+    vector<string> ids(50, string("id"));
+    Date d(1, QuantLib::Jan, 2016);
+    vector<Date> dates(20, d);
+    Size samples = 100;
+    Size depth = 2;
+    // live dates 0, 1, ..., 20, 0, 1, ... the values set by initCube() extend the live dates to all dates
+    vector<Size> liveDates(ids.size());
+    for (Size i = 0; i < ids.size(); ++i)
+        liveDates[i] = i % (dates.size() + 1);
+    SinglePrecisionSparseInMemoryCube c(d, ids, dates, samples, liveDates, depth);
+    testCube(c, "SinglePrecisionSparseInMemoryCube", 1e-5);
+    for (Size i = 0; i < ids.size(); ++i)
+        BOOST_CHECK_EQUAL(c.numLiveDates(i), dates.size());
+    DoublePrecisionSparseInMemoryCube c2(d, ids, dates, samples, liveDates, depth);
+    testCubeFileIO<DoublePrecisionSparseInMemoryCube>(c2, "DoublePrecisionSparseInMemoryCube", 1e-14);
+}
+
+BOOST_AUTO_TEST_CASE(testSparseInMemoryCubeLiveDates) {
+    BOOST_TEST_MESSAGE("Testing live dates of SparseInMemoryCube");
+    Date today = Date::todaysDate();
+    vector<Date> dates;
+    for (Size j = 1; j <= 10; ++j)
+        dates.push_back(today + QuantLib::Period(j, QuantLib::Months));
+    Size samples = 5;
+    DoublePrecisionSparseInMemoryCube cube(today, { "id1", "id2" }, dates, samples, { 3, 20 });
+    BOOST_CHECK_EQUAL(cube.numLiveDates(0), 3);
+    BOOST_CHECK_EQUAL(cube.numLiveDates(1), dates.size());
+
+    // zero values after the live dates are not stored
+    for (Size j = 0; j < dates.size(); ++j) {
+        for (Size k = 0; k < samples; ++k) {
+            cube.set(j < 3 ? 1.0 + j : 0.0, 0, j, k);
+            cube.set(2.0 + j, 1, j, k);
+        }
+    }
+    BOOST_CHECK_EQUAL(cube.numLiveDates(0), 3);
+    for (Size j = 0; j < dates.size(); ++j) {
+        for (Size k = 0; k < samples; ++k) {
+            BOOST_CHECK_EQUAL(cube.get(0, j, k), j < 3 ? 1.0 + j : 0.0);
+            BOOST_CHECK_EQUAL(cube.get(1, j, k), 2.0 + j);
+        }
+    }
+
+    // a non-zero value after the live dates extends them
+    cube.set(5.0, 0, 6, 1);
+    BOOST_CHECK_EQUAL(cube.numLiveDates(0), 7);
+    BOOST_CHECK_EQUAL(cube.get(0, 2, 1), 3.0);
+    BOOST_CHECK_EQUAL(cube.get(0, 5, 1), 0.0);
+    BOOST_CHECK_EQUAL(cube.get(0, 6, 1), 5.0);
+    BOOST_CHECK_EQUAL(cube.get(0, 6, 2), 0.0);
+    BOOST_CHECK_EQUAL(cube.get(0, 7, 1), 0.0);
+    BOOST_CHECK_THROW(cube.get(0, dates.size(), 0), std::exception);
+
+    // copying into a full cube sets the values after the live dates to zero
+    DoublePrecisionInMemoryCube target(today, { "id1" }, dates, samples);
+    for (Size j = 0; j < dates.size(); ++j)
+        target.set(-1.0, 0, j, 0);
+    BOOST_CHECK_EQUAL(copyCubeTrades(cube, target, { "id1" }), 1);
+    for (Size j = 0; j < dates.size(); ++j)
+        BOOST_CHECK_EQUAL(target.get(0, j, 0), cube.get(0, j, 0));
+}
+
+BOOST_AUTO_TEST_CASE(testCompressedCube) {
+    BOOST_TEST_MESSAGE("Testing compressed cube files");
+    Date today(1, QuantLib::Jan, 2016);
+    vector<Date> dates;
+    for (Size j = 1; j <= 12; ++j)
+        dates.push_back(today + QuantLib::Period(j, QuantLib::Months));
+    vector<string> ids = {"id1", "id2", "id3", "id4"};
+    Size samples = 300, depth = 2;
+    // trade i matures after 3 * i dates
+    DoublePrecisionSparseInMemoryCube cube(today, ids, dates, samples, {3, 6, 9, 12}, depth);
+    for (Size i = 0; i < ids.size(); ++i) {
+        for (Size d = 0; d < depth; ++d) {
+            cube.setT0(1000.0 * i + d + 0.123456789, i, d);
+            for (Size j = 0; j < 3 * (i + 1); ++j) {
+                for (Size k = 0; k < samples; ++k)
+                    cube.set(1.0E6 * std::sin(1.0 + i + 0.1 * j + 0.37 * k) + d, i, j, k, d);
+            }
+        }
+    }
+
+    string lossless = boost::filesystem::unique_path().string();
+    string quantised = boost::filesystem::unique_path().string();
+    saveCompressedCube(cube, lossless, CubeCodec::Lossless, 0.0, 2);
+    saveCompressedCube(cube, quantised, CubeCodec::Quantised, 0.01, 2);
+    BOOST_CHECK_THROW(saveCompressedCube(cube, quantised, CubeCodec::Quantised, 0.0), std::exception);
+    BOOST_CHECK(CompressedCubeReader::isCompressedCube(lossless));
+    cube.save(quantised + "_archive");
+    BOOST_CHECK(!CompressedCubeReader::isCompressedCube(quantised + "_archive"));
+    boost::filesystem::remove(quantised + "_archive");
+
+    CompressedCubeReader reader(lossless);
+    BOOST_CHECK(reader.asof() == today);
+    BOOST_CHECK(reader.ids() == ids);
+    BOOST_CHECK(reader.dates() == dates);
+    BOOST_CHECK_EQUAL(reader.samples(), samples);
+    BOOST_CHECK_EQUAL(reader.depth(), depth);
+    for (Size i = 0; i < ids.size(); ++i)
+        BOOST_CHECK_EQUAL(reader.numLiveDates(i), 3 * (i + 1));
+
+    // random access to single chunks
+    vector<Real> values = reader.values(2, 5);
+    BOOST_REQUIRE_EQUAL(values.size(), samples * depth);
+    for (Size d = 0; d < depth; ++d) {
+        for (Size k = 0; k < samples; ++k)
+            BOOST_CHECK_EQUAL(values[d * samples + k], cube.get(2, 5, k, d));
+    }
+    values = reader.values(0, 7);
+    BOOST_CHECK(std::all_of(values.begin(), values.end(), [](Real v) { return v == 0.0; }));
+    BOOST_CHECK_THROW(reader.values(0, dates.size()), std::exception);
+
+    // the lossless codec restores the values exactly, only the requested trades are read
+    DoublePrecisionInMemoryCubeN target(today, {"id4", "id2", "id5"}, dates, samples, depth);
+    BOOST_CHECK_EQUAL(reader.load(target, {"id4"}, 2), 1);
+    BOOST_CHECK_EQUAL(reader.load(target, std::set<string>(), 2), 2);
+    // the quantised codec has an absolute error of at most the tolerance
+    CompressedCubeReader quantisedReader(quantised);
+    BOOST_CHECK(quantisedReader.codec() == CubeCodec::Quantised);
+    DoublePrecisionInMemoryCubeN quantisedTarget(today, {"id4", "id2", "id5"}, dates, samples, depth);
+    BOOST_CHECK_EQUAL(quantisedReader.load(quantisedTarget), 2);
+    for (Size t = 0; t < 2; ++t) {
+        Size i = t == 0 ? 3 : 1;
+        for (Size d = 0; d < depth; ++d) {
+            BOOST_CHECK_EQUAL(target.getT0(t, d), cube.getT0(i, d));
+            BOOST_CHECK_EQUAL(quantisedTarget.getT0(t, d), cube.getT0(i, d));
+            for (Size j = 0; j < dates.size(); ++j) {
+                for (Size k = 0; k < samples; ++k) {
+                    BOOST_CHECK_EQUAL(target.get(t, j, k, d), cube.get(i, j, k, d));
+                    BOOST_CHECK_SMALL(quantisedTarget.get(t, j, k, d) - cube.get(i, j, k, d), 0.01 + 1.0E-8);
+                }
+            }
+        }
+    }
+
+    DoublePrecisionInMemoryCube other(today, ids, dates, samples);
+    BOOST_CHECK_THROW(reader.load(other), std::exception);
+
+    boost::filesystem::remove(lossless);
+    boost::filesystem::remove(quantised);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
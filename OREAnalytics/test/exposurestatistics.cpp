@@ -0,0 +1,100 @@
+/*
+ Copyright (C) 2020 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <boost/test/unit_test.hpp>
+#include <orea/aggregation/exposurestatistics.hpp>
+#include <oret/toplevelfixture.hpp>
+#include <ql/math/randomnumbers/mt19937uniformrng.hpp>
+#include <test/oreatoplevelfixture.hpp>
+
+#include <algorithm>
+
+using namespace QuantLib;
+using namespace boost::unit_test_framework;
+using namespace ore::analytics;
+using std::vector;
+
+BOOST_FIXTURE_TEST_SUITE(OREAnalyticsTestSuite, ore::test::OreaTopLevelFixture)
+
+BOOST_AUTO_TEST_SUITE(ExposureStatisticsTest)
+
+BOOST_AUTO_TEST_CASE(testOrderStatisticsVersusSort) {
+
+    BOOST_TEST_MESSAGE("Testing order statistics by selection against a sorted sample...");
+
+    MersenneTwisterUniformRng rng(42);
+    for (Size n : {1, 2, 7, 100, 1001}) {
+        // include ties
+        vector<Real> x(n);
+        for (Size k = 0; k < n; ++k)
+            x[k] = k % 3 == 0 ? 0.0 : 1000.0 * (rng.nextReal() - 0.5);
+        vector<Real> sorted(x);
+        std::sort(sorted.begin(), sorted.end());
+        vector<Size> indices = {n - 1, 0, n / 2, quantileIndex(0.95, n), n / 2, quantileIndex(0.05, n)};
+        vector<Real> y(x);
+        vector<Real> result = orderStatistics(y, indices);
+        BOOST_REQUIRE_EQUAL(result.size(), indices.size());
+        for (Size i = 0; i < indices.size(); ++i)
+            BOOST_CHECK_EQUAL(result[i], sorted[indices[i]]);
+        // the sample is reordered only
+        std::sort(y.begin(), y.end());
+        BOOST_CHECK(y == sorted);
+    }
+
+    vector<Real> x(10, 1.0);
+    BOOST_CHECK_THROW(orderStatistics(x, {10}), std::exception);
+    BOOST_CHECK_THROW(quantileIndex(1.5, 10), std::exception);
+}
+
+BOOST_AUTO_TEST_CASE(testExposureStatistics) {
+
+    BOOST_TEST_MESSAGE("Testing exposure statistics of a sample...");
+
+    MersenneTwisterUniformRng rng(17);
+    Size n = 5000;
+    vector<Real> quantiles = {0.95, 0.05, 0.5};
+    ExposureStatistics stats(quantiles);
+    for (Size step = 0; step < 3; ++step) {
+        vector<Real> x(n);
+        for (Size k = 0; k < n; ++k)
+            x[k] = 1.0E6 * (rng.nextReal() - 0.4 + 0.1 * step);
+        stats.update(x);
+
+        // the expected positive and negative parts are accumulated as in the post processor
+        Real mean = 0.0, epe = 0.0, ene = 0.0;
+        for (Size k = 0; k < n; ++k) {
+            mean += x[k] / n;
+            epe += std::max(x[k], 0.0) / n;
+            ene += std::max(-x[k], 0.0) / n;
+        }
+        BOOST_CHECK_EQUAL(stats.mean(), mean);
+        BOOST_CHECK_EQUAL(stats.positiveMean(), epe);
+        BOOST_CHECK_EQUAL(stats.negativeMean(), ene);
+        BOOST_CHECK_CLOSE(stats.positiveMean() - stats.negativeMean(), stats.mean(), 1.0E-8);
+
+        std::sort(x.begin(), x.end());
+        for (Size i = 0; i < quantiles.size(); ++i)
+            BOOST_CHECK_EQUAL(stats.quantile(i), x[Size(std::floor(quantiles[i] * (n - 1) + 0.5))]);
+    }
+    BOOST_CHECK_THROW(stats.quantile(quantiles.size()), std::exception);
+    BOOST_CHECK_THROW(ExposureStatistics(vector<Real>(1, -0.1)), std::exception);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,438 @@
+/*
+ Copyright (C) 2020 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <boost/make_shared.hpp>
+#include <boost/test/unit_test.hpp>
+#include <orea/aggregation/collatexposurehelper.hpp>
+#include <orea/aggregation/postprocess.hpp>
+#include <orea/cube/inmemorycube.hpp>
+#include <orea/scenario/aggregationscenariodata.hpp>
+#include <ored/marketdata/marketimpl.hpp>
+#include <ored/portfolio/enginedata.hpp>
+#include <ored/portfolio/enginefactory.hpp>
+#include <ored/portfolio/fxforward.hpp>
+#include <ored/portfolio/nettingsetmanager.hpp>
+#include <ored/portfolio/portfolio.hpp>
+#include <ored/utilities/to_string.hpp>
+#include <oret/toplevelfixture.hpp>
+#include <ql/indexes/ibor/eonia.hpp>
+#include <ql/math/randomnumbers/mt19937uniformrng.hpp>
+#include <ql/termstructures/credit/flathazardrate.hpp>
+#include <ql/termstructures/yield/flatforward.hpp>
+#include <ql/time/daycounters/actual360.hpp>
+#include <ql/time/daycounters/actual365fixed.hpp>
+#include <test/oreatoplevelfixture.hpp>
+
+using namespace QuantLib;
+using namespace boost::unit_test_framework;
+using namespace ore::data;
+using namespace ore::analytics;
+using std::map;
+using std::string;
+using std::vector;
+
+namespace {
+
+// EUR and USD discount curves, funding curves, an EONIA index and the default curves of two counterparties and of
+// the bank, counterparty CP_A has a different default curve and recovery rate in the xva configuration
+class TestMarket : public MarketImpl {
+public:
+    TestMarket() {
+        asof_ = Date(5, February, 2020);
+        const string& config = Market::defaultConfiguration;
+        Handle<YieldTermStructure> eur = flatCurve(0.01);
+        yieldCurves_[std::make_tuple(config, YieldCurveType::Discount, "EUR")] = eur;
+        yieldCurves_[std::make_tuple(config, YieldCurveType::Discount, "USD")] = flatCurve(0.02);
+        yieldCurves_[std::make_tuple(config, YieldCurveType::Yield, "BANK_BORROW")] = flatCurve(0.015);
+        yieldCurves_[std::make_tuple(config, YieldCurveType::Yield, "BANK_LEND")] = flatCurve(0.012);
+        fxSpots_[config].addQuote("EURUSD", Handle<Quote>(boost::make_shared<SimpleQuote>(1.1)));
+        iborIndices_[std::make_pair(config, "EUR-EONIA")] = Handle<IborIndex>(boost::make_shared<Eonia>(eur));
+        addCredit(config, "CP_A", 0.02, 0.4);
+        addCredit(config, "CP_B", 0.03, 0.3);
+        addCredit(config, "BANK", 0.01, 0.4);
+        addCredit("xva", "CP_A", 0.05, 0.35);
+    }
+
+private:
+    Handle<YieldTermStructure> flatCurve(Rate rate) {
+        return Handle<YieldTermStructure>(boost::make_shared<FlatForward>(asof_, rate, Actual360()));
+    }
+    void addCredit(const string& configuration, const string& name, Real hazardRate, Real recoveryRate) {
+        defaultCurves_[std::make_pair(configuration, name)] = Handle<DefaultProbabilityTermStructure>(
+            boost::make_shared<FlatHazardRate>(asof_, hazardRate, Actual365Fixed()));
+        recoveryRates_[std::make_pair(configuration, name)] =
+            Handle<Quote>(boost::make_shared<SimpleQuote>(recoveryRate));
+    }
+};
+
+// Post processor inputs, the portfolio provides the netting sets and maturities, the cube holds synthetic values
+struct TestData {
+    boost::shared_ptr<Market> market;
+    boost::shared_ptr<Portfolio> portfolio;
+    boost::shared_ptr<NettingSetManager> nettingSetManager;
+    boost::shared_ptr<NPVCube> cube;
+    boost::shared_ptr<AggregationScenarioData> scenarioData;
+};
+
+// Nine fx forwards in three netting sets, NS_A1 and NS_A2 (with a CSA) of counterparty CP_A and NS_B of CP_B,
+// trade values as random walks up to maturity and the trade value as a flow on the last date before maturity
+TestData testData() {
+    TestData data;
+    data.market = boost::make_shared<TestMarket>();
+    Date today = data.market->asofDate();
+    Settings::instance().evaluationDate() = today;
+
+    data.nettingSetManager = boost::make_shared<NettingSetManager>();
+    data.nettingSetManager->add(boost::make_shared<NettingSetDefinition>("NS_A1", "CP_A"));
+    data.nettingSetManager->add(boost::make_shared<NettingSetDefinition>(
+        "NS_A2", "CP_A", "Bilateral", "EUR", "EUR-EONIA", 100000.0, 100000.0, 10000.0, 10000.0, 0.0, "FIXED", "1D",
+        "1D", "2W", 0.001, 0.002, vector<string>(1, "EUR")));
+    data.nettingSetManager->add(boost::make_shared<NettingSetDefinition>("NS_B", "CP_B"));
+
+    vector<string> nettingSetIds = {"NS_A1", "NS_A2", "NS_B"};
+    vector<string> counterparties = {"CP_A", "CP_A", "CP_B"};
+    data.portfolio = boost::make_shared<Portfolio>();
+    for (Size i = 0; i < 9; ++i) {
+        Envelope envelope(counterparties[i % 3], nettingSetIds[i % 3]);
+        string maturity = ore::data::to_string(today + (1 + i / 2) * Years);
+        boost::shared_ptr<Trade> trade =
+            i % 2 == 0 ? boost::make_shared<FxForward>(envelope, maturity, "EUR", 1000000.0, "USD", 1100000.0)
+                       : boost::make_shared<FxForward>(envelope, maturity, "USD", 1100000.0, "EUR", 1000000.0);
+        trade->id() = "FXFWD_" + std::to_string(i);
+        data.portfolio->add(trade);
+    }
+    boost::shared_ptr<EngineData> engineData = boost::make_shared<EngineData>();
+    engineData->model("FxForward") = "DiscountedCashflows";
+    engineData->engine("FxForward") = "DiscountingFxForwardEngine";
+    data.portfolio->build(boost::make_shared<EngineFactory>(engineData, data.market));
+    BOOST_REQUIRE_EQUAL(data.portfolio->size(), 9);
+
+    // two weekly steps first, so that the T0 initial margin finds today + 14 days, then quarterly to 5 years
+    vector<Date> dates;
+    for (Size i = 1; i <= 6; ++i)
+        dates.push_back(today + 2 * i * Weeks);
+    for (Size i = 1; i <= 20; ++i)
+        dates.push_back(today + 3 * i * Months);
+    Size samples = 100;
+
+    MersenneTwisterUniformRng rng(42);
+    vector<string> ids;
+    for (auto const& t : data.portfolio->trades())
+        ids.push_back(t->id());
+    data.cube = boost::make_shared<DoublePrecisionInMemoryCubeN>(today, ids, dates, samples, 2);
+    for (Size i = 0; i < ids.size(); ++i) {
+        Date maturity = data.portfolio->trades()[i]->maturity();
+        Real valueToday = 100000.0 * (rng.nextReal() - 0.5);
+        data.cube->setT0(valueToday, i);
+        for (Size k = 0; k < samples; ++k) {
+            Real v = valueToday;
+            for (Size j = 0; j < dates.size() && dates[j] <= maturity; ++j) {
+                v += 60000.0 * (rng.nextReal() - 0.5);
+                data.cube->set(v, i, j, k);
+                if (j + 1 == dates.size() || dates[j + 1] > maturity)
+                    data.cube->set(v, i, j, k, 1);
+            }
+        }
+    }
+
+    boost::shared_ptr<InMemoryAggregationScenarioData> scenarioData =
+        boost::make_shared<InMemoryAggregationScenarioData>(dates.size(), samples);
+    for (Size j = 0; j < dates.size(); ++j) {
+        Real t = Actual365Fixed().yearFraction(today, dates[j]);
+        for (Size k = 0; k < samples; ++k) {
+            scenarioData->set(j, k, std::exp(0.01 * t) * (1.0 + 0.1 * (rng.nextReal() - 0.5)),
+                              AggregationScenarioDataType::Numeraire);
+            scenarioData->set(j, k, 0.005 + 0.02 * (rng.nextReal() - 0.5), AggregationScenarioDataType::IndexFixing,
+                              "EUR-EONIA");
+        }
+    }
+    data.scenarioData = scenarioData;
+
+    return data;
+}
+
+// All analytics including DIM, MVA and KVA, with DVA and FVA on the bank's curves
+boost::shared_ptr<PostProcess> postProcess(const TestData& data, const string& allocationMethod, Size nThreads,
+                                           const string& configuration = Market::defaultConfiguration) {
+    map<string, bool> analytics = {{"exerciseNextBreak", false}, {"exposureProfiles", true}, {"cva", true},
+                                   {"dva", true}, {"fva", true}, {"colva", true}, {"collateralFloor", true},
+                                   {"kva", true}, {"mva", true}, {"dim", true}};
+    return boost::make_shared<PostProcess>(data.portfolio, data.nettingSetManager, data.market, configuration,
+                                           data.cube, data.scenarioData, analytics, "EUR", allocationMethod, 1.0, 0.95,
+                                           "Symmetric", "BANK", "BANK_BORROW", "BANK_LEND", 0.99, 14, 1,
+                                           vector<string>(), 10, 0.25, 1.0, false, 0.10, 1.4, 12.5, 0.012, 0.03, 0.03,
+                                           0.05, 0.05, nThreads);
+}
+
+// XVAs of an exposure profile accumulated date by date, as in the original loops of the post processor, with the
+// counterparty default curve from the given cva configuration
+struct Xva {
+    Real cva = 0.0, dva = 0.0, fca = 0.0, fcaExOwnSP = 0.0, fcaExAllSP = 0.0, fba = 0.0, fbaExOwnSP = 0.0,
+         fbaExAllSP = 0.0;
+};
+
+Xva referenceXva(const TestData& data, const vector<Real>& epe, const vector<Real>& ene, const string& cid,
+                 const string& cvaConfiguration, const string& configuration) {
+    Date today = data.market->asofDate();
+    Handle<DefaultProbabilityTermStructure> cvaDts = data.market->defaultCurve(cid, cvaConfiguration);
+    Real cvaRR = data.market->recoveryRate(cid, configuration)->value();
+    Handle<DefaultProbabilityTermStructure> dvaDts = data.market->defaultCurve("BANK", configuration);
+    Real dvaRR = data.market->recoveryRate("BANK", configuration)->value();
+    Handle<YieldTermStructure> borrowingCurve = data.market->yieldCurve("BANK_BORROW", configuration);
+    Handle<YieldTermStructure> lendingCurve = data.market->yieldCurve("BANK_LEND", configuration);
+    Handle<YieldTermStructure> oisCurve = data.market->discountCurve("EUR", configuration);
+    const vector<Date>& dates = data.cube->dates();
+    Xva xva;
+    for (Size j = 0; j < dates.size(); ++j) {
+        Date d0 = j == 0 ? today : dates[j - 1];
+        Date d1 = dates[j];
+        Real cvaS0 = cvaDts->survivalProbability(d0);
+        Real cvaS1 = cvaDts->survivalProbability(d1);
+        Real dvaS0 = dvaDts->survivalProbability(d0);
+        Real dvaS1 = dvaDts->survivalProbability(d1);
+        xva.cva += (1.0 - cvaRR) * (cvaS0 - cvaS1) * epe[j + 1];
+        xva.dva += (1.0 - dvaRR) * (dvaS0 - dvaS1) * ene[j + 1];
+        Real borrowingSpreadDcf = borrowingCurve->discount(d0) / borrowingCurve->discount(d1) -
+                                  oisCurve->discount(d0) / oisCurve->discount(d1);
+        xva.fca += cvaS0 * dvaS0 * borrowingSpreadDcf * epe[j + 1];
+        xva.fcaExOwnSP += cvaS0 * borrowingSpreadDcf * epe[j + 1];
+        xva.fcaExAllSP += borrowingSpreadDcf * epe[j + 1];
+        Real lendingSpreadDcf = lendingCurve->discount(d0) / lendingCurve->discount(d1) -
+                                oisCurve->discount(d0) / oisCurve->discount(d1);
+        xva.fba += cvaS0 * dvaS0 * lendingSpreadDcf * ene[j + 1];
+        xva.fbaExOwnSP += cvaS0 * lendingSpreadDcf * ene[j + 1];
+        xva.fbaExAllSP += lendingSpreadDcf * ene[j + 1];
+    }
+    return xva;
+}
+
+// Marginal allocation of the netting set exposures to the trades as in the original per sample loop of the post
+// processor, the collateral balances are computed as in PostProcess::collateralPaths
+void referenceMarginalAllocation(const TestData& data, Real marginalAllocationLimit,
+                                 map<string, vector<Real>>& allocatedEPE, map<string, vector<Real>>& allocatedENE) {
+    Date today = data.market->asofDate();
+    const vector<Date>& dates = data.cube->dates();
+    Size samples = data.cube->samples();
+    const vector<boost::shared_ptr<Trade>>& trades = data.portfolio->trades();
+    for (auto const& trade : trades) {
+        allocatedEPE[trade->id()] = vector<Real>(dates.size() + 1, 0.0);
+        allocatedENE[trade->id()] = vector<Real>(dates.size() + 1, 0.0);
+    }
+
+    for (const string& nettingSetId : vector<string>{"NS_A1", "NS_A2", "NS_B"}) {
+        boost::shared_ptr<NettingSetDefinition> netting = data.nettingSetManager->get(nettingSetId);
+        vector<Size> tradeIndices;
+        Real valueToday = 0.0;
+        Date maturity = today;
+        vector<vector<Real>> value(dates.size(), vector<Real>(samples, 0.0));
+        for (Size i = 0; i < trades.size(); ++i) {
+            if (trades[i]->envelope().nettingSetId() != nettingSetId)
+                continue;
+            tradeIndices.push_back(i);
+            valueToday += data.cube->getT0(i);
+            maturity = std::max(maturity, trades[i]->maturity());
+            for (Size j = 0; j < dates.size(); ++j) {
+                for (Size k = 0; k < samples; ++k)
+                    value[j][k] += data.cube->get(i, j, k);
+            }
+        }
+
+        boost::shared_ptr<vector<vector<Real>>> collateral;
+        if (netting->activeCsaFlag()) {
+            vector<vector<Real>> fxRates(dates.size(), vector<Real>(samples, 1.0));
+            vector<vector<Real>> rates(dates.size(), vector<Real>(samples));
+            for (Size j = 0; j < dates.size(); ++j) {
+                for (Size k = 0; k < samples; ++k)
+                    rates[j][k] =
+                        data.scenarioData->get(j, k, AggregationScenarioDataType::IndexFixing, netting->index());
+            }
+            Real rateToday = data.market->iborIndex(netting->index())->fixing(today);
+            collateral = CollateralExposureHelper::collateralBalances(netting, valueToday, today, value, maturity,
+                                                                      dates, 1.0, fxRates, rateToday, rates);
+        }
+
+        for (Size j = 0; j < dates.size(); ++j) {
+            for (Size k = 0; k < samples; ++k) {
+                Real balance = collateral ? (*collateral)[j][k] : 0.0;
+                Real exposure = value[j][k] - balance;
+                for (Size i : tradeIndices) {
+                    Real allocation = 0.0;
+                    if (balance == 0.0)
+                        allocation = data.cube->get(i, j, k);
+                    else if (fabs(value[j][k]) <= marginalAllocationLimit)
+                        allocation = exposure / tradeIndices.size();
+                    else
+                        allocation = exposure * data.cube->get(i, j, k) / value[j][k];
+
+                    if (exposure > 0.0)
+                        allocatedEPE[trades[i]->id()][j + 1] += allocation / samples;
+                    else
+                        allocatedENE[trades[i]->id()][j + 1] -= allocation / samples;
+                }
+            }
+        }
+    }
+}
+
+void checkEqual(const vector<Real>& x, const vector<Real>& y) {
+    BOOST_CHECK_EQUAL_COLLECTIONS(x.begin(), x.end(), y.begin(), y.end());
+}
+
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(OREAnalyticsTestSuite, ore::test::OreaTopLevelFixture)
+
+BOOST_AUTO_TEST_SUITE(PostProcessTest)
+
+BOOST_AUTO_TEST_CASE(testThreadCountIndependence) {
+
+    BOOST_TEST_MESSAGE("Testing that the post processing results do not depend on the number of threads...");
+
+    TestData data = testData();
+    boost::shared_ptr<PostProcess> pp1 = postProcess(data, "Marginal", 1);
+    boost::shared_ptr<PostProcess> pp4 = postProcess(data, "Marginal", 4);
+
+    BOOST_REQUIRE(pp1->nettingSetIds() == pp4->nettingSetIds());
+    BOOST_REQUIRE_EQUAL(pp1->nettingSetIds().size(), 3);
+    for (auto const& n : pp1->nettingSetIds()) {
+        BOOST_TEST_MESSAGE("Netting set " << n);
+        BOOST_CHECK(*std::max_element(pp1->netEPE(n).begin(), pp1->netEPE(n).end()) > 0.0);
+        checkEqual(pp1->netEPE(n), pp4->netEPE(n));
+        checkEqual(pp1->netENE(n), pp4->netENE(n));
+        checkEqual(pp1->netPFE(n), pp4->netPFE(n));
+        checkEqual(pp1->expectedCollateral(n), pp4->expectedCollateral(n));
+        BOOST_CHECK_EQUAL(pp1->nettingSetCVA(n), pp4->nettingSetCVA(n));
+        BOOST_CHECK_EQUAL(pp1->nettingSetDVA(n), pp4->nettingSetDVA(n));
+        BOOST_CHECK_EQUAL(pp1->nettingSetFBA(n), pp4->nettingSetFBA(n));
+        BOOST_CHECK_EQUAL(pp1->nettingSetFCA(n), pp4->nettingSetFCA(n));
+        BOOST_CHECK_EQUAL(pp1->nettingSetMVA(n), pp4->nettingSetMVA(n));
+        BOOST_CHECK_EQUAL(pp1->nettingSetCOLVA(n), pp4->nettingSetCOLVA(n));
+        BOOST_CHECK_EQUAL(pp1->nettingSetOurKVACCR(n), pp4->nettingSetOurKVACCR(n));
+        BOOST_CHECK_EQUAL(pp1->nettingSetTheirKVACCR(n), pp4->nettingSetTheirKVACCR(n));
+        BOOST_CHECK_EQUAL(pp1->nettingSetOurKVACVA(n), pp4->nettingSetOurKVACVA(n));
+        BOOST_CHECK_EQUAL(pp1->nettingSetTheirKVACVA(n), pp4->nettingSetTheirKVACVA(n));
+    }
+
+    for (auto const& t : pp1->tradeIds()) {
+        BOOST_TEST_MESSAGE("Trade " << t);
+        checkEqual(pp1->tradeEPE(t), pp4->tradeEPE(t));
+        checkEqual(pp1->tradeENE(t), pp4->tradeENE(t));
+        checkEqual(pp1->tradePFE(t), pp4->tradePFE(t));
+        checkEqual(pp1->allocatedTradeEPE(t), pp4->allocatedTradeEPE(t));
+        checkEqual(pp1->allocatedTradeENE(t), pp4->allocatedTradeENE(t));
+        BOOST_CHECK_EQUAL(pp1->tradeCVA(t), pp4->tradeCVA(t));
+        BOOST_CHECK_EQUAL(pp1->tradeDVA(t), pp4->tradeDVA(t));
+        BOOST_CHECK_EQUAL(pp1->tradeFBA(t), pp4->tradeFBA(t));
+        BOOST_CHECK_EQUAL(pp1->tradeFCA(t), pp4->tradeFCA(t));
+        BOOST_CHECK_EQUAL(pp1->allocatedTradeCVA(t), pp4->allocatedTradeCVA(t));
+        BOOST_CHECK_EQUAL(pp1->allocatedTradeDVA(t), pp4->allocatedTradeDVA(t));
+    }
+
+    // the DIM profiles by netting set, date and sample
+    const boost::shared_ptr<NPVCube>& dim1 = pp1->dimCube();
+    const boost::shared_ptr<NPVCube>& dim4 = pp4->dimCube();
+    BOOST_REQUIRE(dim1->ids() == dim4->ids());
+    for (Size n = 0; n < dim1->numIds(); ++n) {
+        for (Size j = 0; j < dim1->numDates(); ++j) {
+            for (Size k = 0; k < dim1->samples(); ++k)
+                BOOST_CHECK_EQUAL(dim1->get(n, j, k), dim4->get(n, j, k));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testXvaVersusDateLoop) {
+
+    BOOST_TEST_MESSAGE("Testing the trade and netting set XVAs against their accumulation date by date...");
+
+    // CP_A is shared by the netting sets NS_A1 and NS_A2, its default curve differs between the xva configuration,
+    // used for the trades, and the default configuration, used for the netting sets
+    TestData data = testData();
+    string configuration = "xva";
+    BOOST_REQUIRE(data.market->defaultCurve("CP_A", configuration).currentLink() !=
+                  data.market->defaultCurve("CP_A").currentLink());
+    boost::shared_ptr<PostProcess> pp = postProcess(data, "Marginal", 1, configuration);
+
+    Real tolerance = 1.0E-10;
+    for (auto const& trade : data.portfolio->trades()) {
+        string t = trade->id();
+        BOOST_TEST_MESSAGE("Trade " << t);
+        string cid = trade->envelope().counterparty();
+        Xva xva = referenceXva(data, pp->tradeEPE(t), pp->tradeENE(t), cid, configuration, configuration);
+        BOOST_CHECK(xva.cva > 0.0);
+        BOOST_CHECK_CLOSE(pp->tradeCVA(t), xva.cva, tolerance);
+        BOOST_CHECK_CLOSE(pp->tradeDVA(t), xva.dva, tolerance);
+        BOOST_CHECK_CLOSE(pp->tradeFCA(t), xva.fca, tolerance);
+        BOOST_CHECK_CLOSE(pp->tradeFCA_exOwnSP(t), xva.fcaExOwnSP, tolerance);
+        BOOST_CHECK_CLOSE(pp->tradeFCA_exAllSP(t), xva.fcaExAllSP, tolerance);
+        BOOST_CHECK_CLOSE(pp->tradeFBA(t), xva.fba, tolerance);
+        BOOST_CHECK_CLOSE(pp->tradeFBA_exOwnSP(t), xva.fbaExOwnSP, tolerance);
+        BOOST_CHECK_CLOSE(pp->tradeFBA_exAllSP(t), xva.fbaExAllSP, tolerance);
+        Xva allocated =
+            referenceXva(data, pp->allocatedTradeEPE(t), pp->allocatedTradeENE(t), cid, configuration, configuration);
+        BOOST_CHECK_CLOSE(pp->allocatedTradeCVA(t), allocated.cva, tolerance);
+        BOOST_CHECK_CLOSE(pp->allocatedTradeDVA(t), allocated.dva, tolerance);
+    }
+
+    for (auto const& n : pp->nettingSetIds()) {
+        BOOST_TEST_MESSAGE("Netting set " << n);
+        string cid = data.nettingSetManager->get(n)->counterparty();
+        Xva xva = referenceXva(data, pp->netEPE(n), pp->netENE(n), cid, Market::defaultConfiguration, configuration);
+        BOOST_CHECK(xva.cva > 0.0);
+        BOOST_CHECK_CLOSE(pp->nettingSetCVA(n), xva.cva, tolerance);
+        BOOST_CHECK_CLOSE(pp->nettingSetDVA(n), xva.dva, tolerance);
+        BOOST_CHECK_CLOSE(pp->nettingSetFCA(n), xva.fca, tolerance);
+        BOOST_CHECK_CLOSE(pp->nettingSetFCA_exOwnSP(n), xva.fcaExOwnSP, tolerance);
+        BOOST_CHECK_CLOSE(pp->nettingSetFCA_exAllSP(n), xva.fcaExAllSP, tolerance);
+        BOOST_CHECK_CLOSE(pp->nettingSetFBA(n), xva.fba, tolerance);
+        BOOST_CHECK_CLOSE(pp->nettingSetFBA_exOwnSP(n), xva.fbaExOwnSP, tolerance);
+        BOOST_CHECK_CLOSE(pp->nettingSetFBA_exAllSP(n), xva.fbaExAllSP, tolerance);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testMarginalAllocationVersusSampleLoop) {
+
+    BOOST_TEST_MESSAGE("Testing the marginal allocation of the netting set exposures against the per sample loop...");
+
+    TestData data = testData();
+    boost::shared_ptr<PostProcess> pp = postProcess(data, "Marginal", 1);
+
+    // the netting set with a CSA allocates the collateralised exposure
+    const vector<Real>& collateral = pp->expectedCollateral("NS_A2");
+    BOOST_REQUIRE(std::find_if(collateral.begin() + 1, collateral.end(), [](Real c) { return c != 0.0; }) !=
+                  collateral.end());
+
+    map<string, vector<Real>> allocatedEPE, allocatedENE;
+    referenceMarginalAllocation(data, 1.0, allocatedEPE, allocatedENE);
+
+    Real tolerance = 1.0E-10;
+    for (auto const& t : pp->tradeIds()) {
+        BOOST_TEST_MESSAGE("Trade " << t);
+        const vector<Real>& epe = pp->allocatedTradeEPE(t);
+        const vector<Real>& ene = pp->allocatedTradeENE(t);
+        BOOST_REQUIRE_EQUAL(epe.size(), allocatedEPE.at(t).size());
+        BOOST_REQUIRE_EQUAL(ene.size(), allocatedENE.at(t).size());
+        for (Size j = 0; j < epe.size(); ++j) {
+            BOOST_CHECK_CLOSE(epe[j], allocatedEPE.at(t)[j], tolerance);
+            BOOST_CHECK_CLOSE(ene[j], allocatedENE.at(t)[j], tolerance);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -19,10 +19,12 @@
 #include <boost/test/unit_test.hpp>
 #include <orea/scenario/crossassetmodelscenariogenerator.hpp>
 #include <orea/scenario/lgmscenariogenerator.hpp>
+#include <orea/scenario/replayscenariogenerator.hpp>
 #include <orea/scenario/scenariogeneratorbuilder.hpp>
 #include <orea/scenario/scenariosimmarket.hpp>
 #include <orea/scenario/simplescenario.hpp>
 #include <orea/scenario/simplescenariofactory.hpp>
+#include <orea/scenario/scenariowriter.hpp>
 #include <ored/marketdata/market.hpp>
 #include <ored/marketdata/marketimpl.hpp>
 #include <ored/model/crossassetmodelbuilder.hpp>
@@ -64,6 +66,7 @@
 #include <ql/time/daycounters/thirty360.hpp>
 #include <test/testmarket.hpp>
 
+#include <boost/filesystem.hpp>
 #include <boost/timer/timer.hpp>
 
 using namespace QuantLib;
@@ -1272,6 +1275,58 @@ BOOST_AUTO_TEST_CASE(testCpiSwapExposure) {
                                                     << capNpv << "), tolerance is " << tol);
 }
 
+BOOST_AUTO_TEST_CASE(testReplayScenarioGenerator) {
+
+    BOOST_TEST_MESSAGE("Testing replay of scenarios written by the ScenarioWriter...");
+
+    Date today(15, Jan, 2020);
+    std::vector<Date> dates = {today + 1 * Years, today + 2 * Years, today + 3 * Years};
+    Size samples = 4;
+    std::vector<RiskFactorKey> keys = {RiskFactorKey(RiskFactorKey::KeyType::DiscountCurve, "EUR", 0),
+                                       RiskFactorKey(RiskFactorKey::KeyType::DiscountCurve, "EUR", 1),
+                                       RiskFactorKey(RiskFactorKey::KeyType::FXSpot, "USDEUR", 0)};
+    auto value = [](Size k, Size j, Size i) { return 0.9 + 0.01 * k + 0.001 * j + 0.0001 * i; };
+    auto numeraire = [](Size k, Size j) { return 1.0 + 0.1 * j + 0.01 * k; };
+
+    // write the scenarios in the order of a path generator, i.e. all dates of a sample before the next sample
+    std::string filename = boost::filesystem::unique_path().string();
+    {
+        ScenarioWriter writer(filename);
+        for (Size k = 0; k < samples; ++k) {
+            for (Size j = 0; j < dates.size(); ++j) {
+                boost::shared_ptr<Scenario> s = boost::make_shared<SimpleScenario>(dates[j], "", numeraire(k, j));
+                for (Size i = 0; i < keys.size(); ++i)
+                    s->add(keys[i], value(k, j, i));
+                writer.writeScenario(s, k == 0 && j == 0);
+            }
+        }
+    }
+
+    // the writer rounds to 8 decimal places
+    Real tol = 1.0E-6;
+    ReplayScenarioGenerator replay(filename, boost::make_shared<SimpleScenarioFactory>());
+    for (Size pass = 0; pass < 2; ++pass) {
+        for (Size k = 0; k < samples; ++k) {
+            for (Size j = 0; j < dates.size(); ++j) {
+                boost::shared_ptr<Scenario> s = replay.next(dates[j]);
+                BOOST_CHECK_EQUAL(s->asof(), dates[j]);
+                BOOST_CHECK_CLOSE(s->getNumeraire(), numeraire(k, j), tol);
+                BOOST_CHECK_EQUAL(s->keys().size(), keys.size());
+                for (Size i = 0; i < keys.size(); ++i)
+                    BOOST_CHECK_CLOSE(s->get(keys[i]), value(k, j, i), tol);
+            }
+        }
+        // all scenarios consumed
+        BOOST_CHECK_THROW(replay.next(dates[0]), std::exception);
+        replay.reset();
+    }
+
+    // the requested date must match the next scenario in the file
+    BOOST_CHECK_THROW(replay.next(dates[1]), std::exception);
+
+    boost::filesystem::remove(filename);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
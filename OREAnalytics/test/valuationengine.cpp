@@ -0,0 +1,194 @@
+/*
+ Copyright (C) 2020 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include "testmarket.hpp"
+#include "testportfolio.hpp"
+#include <boost/make_shared.hpp>
+#include <boost/test/unit_test.hpp>
+#include <orea/cube/inmemorycube.hpp>
+#include <orea/engine/valuationcalculator.hpp>
+#include <orea/engine/valuationengine.hpp>
+#include <orea/scenario/crossassetmodelscenariogenerator.hpp>
+#include <orea/scenario/scenariosimmarket.hpp>
+#include <orea/scenario/scenariosimmarketparameters.hpp>
+#include <orea/scenario/simplescenariofactory.hpp>
+#include <ored/model/crossassetmodelbuilder.hpp>
+#include <ored/model/lgmdata.hpp>
+#include <ored/portfolio/builders/fxoption.hpp>
+#include <ored/portfolio/builders/swap.hpp>
+#include <ored/portfolio/builders/swaption.hpp>
+#include <ored/portfolio/portfolio.hpp>
+#include <oret/toplevelfixture.hpp>
+#include <qle/methods/multipathgeneratorbase.hpp>
+#include <test/oreatoplevelfixture.hpp>
+
+using namespace std;
+using namespace QuantLib;
+using namespace QuantExt;
+using namespace boost::unit_test_framework;
+using namespace ore;
+using namespace ore::data;
+using namespace ore::analytics;
+
+using testsuite::TestMarket;
+
+namespace {
+
+// builds a cube for a portfolio of swaps, swaptions and fx options in three currencies, the trades of a type and
+// currency are not adjacent in the portfolio, so that grouping them changes the pricing order
+boost::shared_ptr<NPVCube> buildCube(bool groupTrades, bool useCashflowKernel) {
+
+    Date today = Date(14, April, 2016);
+    Settings::instance().evaluationDate() = today;
+
+    boost::shared_ptr<DateGrid> dg = boost::make_shared<DateGrid>("10,1Y");
+    Size samples = 20;
+
+    boost::shared_ptr<Market> initMarket = boost::make_shared<TestMarket>(today);
+
+    boost::shared_ptr<ScenarioSimMarketParameters> parameters = boost::make_shared<ScenarioSimMarketParameters>();
+    parameters->baseCcy() = "EUR";
+    parameters->setDiscountCurveNames({"EUR", "USD", "GBP"});
+    parameters->setYieldCurveTenors("",
+                                    {1 * Months, 6 * Months, 1 * Years, 2 * Years, 5 * Years, 10 * Years, 20 * Years});
+    parameters->setIndices({"EUR-EURIBOR-6M", "USD-LIBOR-3M", "GBP-LIBOR-6M"});
+    parameters->interpolation() = "LogLinear";
+    parameters->extrapolate() = true;
+    parameters->setSwapVolTerms("", {6 * Months, 1 * Years});
+    parameters->setSwapVolExpiries("", {1 * Years, 2 * Years});
+    parameters->setSwapVolCcys({"EUR", "USD", "GBP"});
+    parameters->swapVolDecayMode() = "ForwardVariance";
+    parameters->setSimulateSwapVols(false);
+    parameters->setFxVolExpiries(vector<Period>{1 * Months, 3 * Months, 6 * Months, 2 * Years, 3 * Years});
+    parameters->setFxVolDecayMode(string("ConstantVariance"));
+    parameters->setSimulateFXVols(false);
+    parameters->setFxVolCcyPairs({"USDEUR", "GBPEUR"});
+    parameters->setFxCcyPairs({"USDEUR", "GBPEUR"});
+    parameters->setYieldCurveDayCounters("", "ACT/ACT");
+
+    vector<string> swaptionExpiries = {"1Y", "2Y", "3Y", "5Y", "7Y", "10Y"};
+    vector<string> swaptionTerms(swaptionExpiries.size(), "5Y");
+    vector<string> swaptionStrikes(swaptionExpiries.size(), "ATM");
+    vector<boost::shared_ptr<IrLgmData>> irConfigs;
+    for (auto const& ccy : vector<string>{"EUR", "USD", "GBP"})
+        irConfigs.push_back(boost::make_shared<IrLgmData>(
+            ccy, CalibrationType::Bootstrap, LgmData::ReversionType::HullWhite, LgmData::VolatilityType::Hagan, false,
+            ParamType::Constant, vector<Time>(), vector<Real>{0.03}, true, ParamType::Piecewise, vector<Time>(),
+            vector<Real>{0.01}, 0.0, 1.0, swaptionExpiries, swaptionTerms, swaptionStrikes));
+    vector<string> optionExpiries = {"1Y", "2Y", "3Y", "5Y"};
+    vector<string> optionStrikes(optionExpiries.size(), "ATMF");
+    vector<boost::shared_ptr<FxBsData>> fxConfigs;
+    for (auto const& ccy : vector<string>{"USD", "GBP"})
+        fxConfigs.push_back(boost::make_shared<FxBsData>(ccy, "EUR", CalibrationType::Bootstrap, true,
+                                                         ParamType::Piecewise, vector<Time>(), vector<Real>{0.15},
+                                                         optionExpiries, optionStrikes));
+    map<pair<string, string>, Handle<Quote>> corr;
+    corr[make_pair("IR:EUR", "IR:USD")] = Handle<Quote>(boost::make_shared<SimpleQuote>(0.6));
+    boost::shared_ptr<CrossAssetModelData> config =
+        boost::make_shared<CrossAssetModelData>(irConfigs, fxConfigs, corr);
+    boost::shared_ptr<QuantExt::CrossAssetModel> model = *CrossAssetModelBuilder(initMarket, config).model();
+
+    boost::shared_ptr<MultiPathGeneratorBase> pathGen =
+        boost::make_shared<MultiPathGeneratorMersenneTwister>(model->stateProcess(), dg->timeGrid(), 42, false);
+    Conventions conventions;
+    boost::shared_ptr<ScenarioSimMarket> simMarket =
+        boost::make_shared<ScenarioSimMarket>(initMarket, parameters, conventions);
+    simMarket->scenarioGenerator() = boost::make_shared<CrossAssetModelScenarioGenerator>(
+        model, pathGen, boost::make_shared<SimpleScenarioFactory>(), parameters, today, dg, initMarket);
+
+    boost::shared_ptr<EngineData> data = boost::make_shared<EngineData>();
+    data->model("Swap") = "DiscountedCashflows";
+    data->engine("Swap") = "DiscountingSwapEngine";
+    data->model("EuropeanSwaption") = "BlackBachelier";
+    data->engine("EuropeanSwaption") = "BlackBachelierSwaptionEngine";
+    data->model("FxOption") = "GarmanKohlhagen";
+    data->engine("FxOption") = "AnalyticEuropeanEngine";
+    boost::shared_ptr<EngineFactory> factory = boost::make_shared<EngineFactory>(data, simMarket);
+    factory->registerBuilder(boost::make_shared<SwapEngineBuilder>());
+    factory->registerBuilder(boost::make_shared<EuropeanSwaptionEngineBuilder>());
+    factory->registerBuilder(boost::make_shared<FxEuropeanOptionEngineBuilder>());
+
+    boost::shared_ptr<Portfolio> portfolio = boost::make_shared<Portfolio>();
+    portfolio->add(buildSwap("1_Swap_EUR", "EUR", true, 10000000.0, 1, 10, 0.03, 0.00, "1Y", "30/360", "6M", "A360",
+                             "EUR-EURIBOR-6M"));
+    portfolio->add(buildSwap("2_Swap_USD", "USD", true, 10000000.0, 1, 15, 0.02, 0.00, "6M", "30/360", "3M", "A360",
+                             "USD-LIBOR-3M"));
+    portfolio->add(buildEuropeanSwaption("3_Swaption_EUR", "Long", "EUR", true, 1000000.0, 2, 5, 0.02, 0.00, "1Y",
+                                         "30/360", "6M", "A360", "EUR-EURIBOR-6M", "Physical"));
+    portfolio->add(buildFxOption("4_FxOption_USD_EUR", "Long", "Call", 3, "USD", 11000000.0, "EUR", 10000000.0));
+    portfolio->add(buildSwap("5_Swap_GBP", "GBP", false, 10000000.0, 1, 20, 0.04, 0.00, "6M", "30/360", "6M", "A360",
+                             "GBP-LIBOR-6M"));
+    portfolio->add(buildSwap("6_Swap_EUR", "EUR", false, 5000000.0, 2, 5, 0.02, 0.001, "1Y", "30/360", "6M", "A360",
+                             "EUR-EURIBOR-6M"));
+    portfolio->add(buildFxOption("7_FxOption_GBP_EUR", "Long", "Put", 2, "GBP", 8000000.0, "EUR", 10000000.0));
+    portfolio->add(buildEuropeanSwaption("8_Swaption_USD", "Short", "USD", false, 1000000.0, 3, 5, 0.025, 0.00, "6M",
+                                         "30/360", "3M", "A360", "USD-LIBOR-3M", "Physical"));
+    portfolio->add(buildSwap("9_Swap_USD", "USD", false, 20000000.0, 1, 7, 0.015, 0.00, "6M", "30/360", "3M", "A360",
+                             "USD-LIBOR-3M"));
+    portfolio->build(factory);
+    BOOST_REQUIRE_EQUAL(portfolio->size(), 9);
+
+    ValuationEngine valEngine(today, dg, simMarket, set<pair<string, boost::shared_ptr<ModelBuilder>>>(),
+                              useCashflowKernel, groupTrades);
+    boost::shared_ptr<NPVCube> cube =
+        boost::make_shared<DoublePrecisionInMemoryCube>(today, portfolio->ids(), dg->dates(), samples);
+    vector<boost::shared_ptr<ValuationCalculator>> calculators;
+    calculators.push_back(boost::make_shared<NPVCalculator>("EUR"));
+    valEngine.buildCube(portfolio, cube, calculators);
+    return cube;
+}
+
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(OREAnalyticsTestSuite, ore::test::OreaTopLevelFixture)
+
+BOOST_AUTO_TEST_SUITE(ValuationEngineTest)
+
+BOOST_AUTO_TEST_CASE(testGroupTrades) {
+
+    for (bool useCashflowKernel : {false, true}) {
+        BOOST_TEST_MESSAGE("Testing that the cube does not depend on the grouping of the trades, cashflow kernel "
+                           << (useCashflowKernel ? "on" : "off") << "...");
+        boost::shared_ptr<NPVCube> cube = buildCube(false, useCashflowKernel);
+        boost::shared_ptr<NPVCube> groupedCube = buildCube(true, useCashflowKernel);
+        BOOST_REQUIRE(cube->ids() == groupedCube->ids());
+        BOOST_REQUIRE_EQUAL(cube->numDates(), groupedCube->numDates());
+        BOOST_REQUIRE_EQUAL(cube->samples(), groupedCube->samples());
+
+        Size mismatches = 0;
+        for (Size i = 0; i < cube->numIds(); ++i) {
+            if (cube->getT0(i) != groupedCube->getT0(i))
+                ++mismatches;
+            for (Size j = 0; j < cube->numDates(); ++j) {
+                for (Size k = 0; k < cube->samples(); ++k) {
+                    if (cube->get(i, j, k) != groupedCube->get(i, j, k)) {
+                        if (mismatches++ == 0)
+                            BOOST_ERROR("trade " << cube->ids()[i] << ", date " << j << ", sample " << k << ": "
+                                                 << cube->get(i, j, k) << " ungrouped, " << groupedCube->get(i, j, k)
+                                                 << " grouped");
+                    }
+                }
+            }
+        }
+        BOOST_CHECK_EQUAL(mismatches, 0);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
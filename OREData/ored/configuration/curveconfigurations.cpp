@@ -90,6 +90,15 @@ void addQuotes(set<string>& quotes, const map<string, boost::shared_ptr<T>>& con
     }
 }
 
+// Utility function for retrieving the quotes needed by a single CurveConfig
+// Used in the quotes(const CurveSpec&) method
+template <class T> set<string> configQuotes(const string& id, const map<string, boost::shared_ptr<T>>& configs) {
+    auto it = configs.find(id);
+    if (it == configs.end())
+        return set<string>();
+    return set<string>(it->second->quotes().begin(), it->second->quotes().end());
+}
+
 boost::shared_ptr<CurveConfigurations>
 CurveConfigurations::minimalCurveConfig(const boost::shared_ptr<TodaysMarketParameters> todaysMarketParams,
                                         const set<string>& configurations) const {
@@ -206,6 +215,55 @@ std::set<string> CurveConfigurations::quotes() const {
     return quotes;
 }
 
+std::set<string> CurveConfigurations::quotes(const CurveSpec& spec) const {
+
+    const string& id = spec.curveConfigID();
+    switch (spec.baseType()) {
+    case CurveSpec::CurveType::Yield:
+        return configQuotes(id, yieldCurveConfigs_);
+    case CurveSpec::CurveType::FX: {
+        // As above, FX spot quotes generally do not come with a curve configuration
+        if (fxSpotConfigs_.count(id) == 1)
+            return configQuotes(id, fxSpotConfigs_);
+        const FXSpotSpec* fxss = dynamic_cast<const FXSpotSpec*>(&spec);
+        QL_REQUIRE(fxss, "Expected an FXSpotSpec but did not get one");
+        return {"FX/RATE/" + fxss->unitCcy() + "/" + fxss->ccy()};
+    }
+    case CurveSpec::CurveType::FXVolatility:
+        return configQuotes(id, fxVolCurveConfigs_);
+    case CurveSpec::CurveType::SwaptionVolatility:
+        return configQuotes(id, swaptionVolCurveConfigs_);
+    case CurveSpec::CurveType::YieldVolatility:
+        return configQuotes(id, yieldVolCurveConfigs_);
+    case CurveSpec::CurveType::CapFloorVolatility:
+        return configQuotes(id, capFloorVolCurveConfigs_);
+    case CurveSpec::CurveType::Default:
+        return configQuotes(id, defaultCurveConfigs_);
+    case CurveSpec::CurveType::CDSVolatility:
+        return configQuotes(id, cdsVolCurveConfigs_);
+    case CurveSpec::CurveType::BaseCorrelation:
+        return configQuotes(id, baseCorrelationCurveConfigs_);
+    case CurveSpec::CurveType::Inflation:
+        return configQuotes(id, inflationCurveConfigs_);
+    case CurveSpec::CurveType::InflationCapFloorVolatility:
+        return configQuotes(id, inflationCapFloorVolCurveConfigs_);
+    case CurveSpec::CurveType::Equity:
+        return configQuotes(id, equityCurveConfigs_);
+    case CurveSpec::CurveType::EquityVolatility:
+        return configQuotes(id, equityVolCurveConfigs_);
+    case CurveSpec::CurveType::Security:
+        return configQuotes(id, securityConfigs_);
+    case CurveSpec::CurveType::Commodity:
+        return configQuotes(id, commodityCurveConfigs_);
+    case CurveSpec::CurveType::CommodityVolatility:
+        return configQuotes(id, commodityVolatilityConfigs_);
+    case CurveSpec::CurveType::Correlation:
+        return configQuotes(id, correlationCurveConfigs_);
+    default:
+        return set<string>();
+    }
+}
+
 std::set<string> CurveConfigurations::conventions(const boost::shared_ptr<TodaysMarketParameters> todaysMarketParams,
                                                   const set<string>& configurations) const {
 
@@ -170,6 +170,13 @@ public:
                             const std::set<std::string>& configurations = {""}) const;
     std::set<string> quotes() const;
 
+    /*! Return the set of quotes that are required by the CurveConfig element used to build the given \p spec.
+
+        Quote names may contain wildcards if the CurveConfig element is set up with them. An empty set is returned
+        if there is no CurveConfig element for the spec.
+    */
+    std::set<string> quotes(const CurveSpec& spec) const;
+
     std::set<string> conventions(const boost::shared_ptr<TodaysMarketParameters> todaysMarketParams,
                                  const std::set<std::string>& configurations = {""}) const;
     std::set<string> conventions() const;
@@ -43,7 +43,7 @@ CSVLoader::CSVLoader(const vector<string>& marketFiles, const vector<string>& fi
 
 CSVLoader::CSVLoader(const string& marketFilename, const string& fixingFilename, const string& dividendFilename,
                      bool implyTodaysFixings)
-    : implyTodaysFixings_(implyTodaysFixings) {
+    : implyTodaysFixings_(implyTodaysFixings), fixings_(boost::make_shared<FixingStore>()) {
 
     // load market data
     loadFile(marketFilename, DataType::Market);
@@ -54,7 +54,7 @@ CSVLoader::CSVLoader(const string& marketFilename, const string& fixingFilename,
 
     // load fixings
     loadFile(fixingFilename, DataType::Fixing);
-    LOG("CSVLoader loaded " << fixings_.size() << " fixings");
+    LOG("CSVLoader loaded " << fixings_->size() << " fixings");
 
     // load dividends
     if (dividendFilename != "") {
@@ -67,7 +67,7 @@ CSVLoader::CSVLoader(const string& marketFilename, const string& fixingFilename,
 
 CSVLoader::CSVLoader(const vector<string>& marketFiles, const vector<string>& fixingFiles,
                      const vector<string>& dividendFiles, bool implyTodaysFixings)
-    : implyTodaysFixings_(implyTodaysFixings) {
+    : implyTodaysFixings_(implyTodaysFixings), fixings_(boost::make_shared<FixingStore>()) {
 
     for (auto marketFile : marketFiles)
         // load market data
@@ -80,7 +80,7 @@ CSVLoader::CSVLoader(const vector<string>& marketFiles, const vector<string>& fi
     for (auto fixingFile : fixingFiles)
         // load fixings
         loadFile(fixingFile, DataType::Fixing);
-    LOG("CSVLoader loaded " << fixings_.size() << " fixings");
+    LOG("CSVLoader loaded " << fixings_->size() << " fixings");
 
     for (auto dividendFile : dividendFiles)
         // load dividends
@@ -128,7 +128,7 @@ void CSVLoader::loadFile(const string& filename, DataType dataType) {
             } else if (dataType == DataType::Fixing) {
                 // process fixings
                 if (date < today || (date == today && !implyTodaysFixings_))
-                    fixings_.emplace_back(Fixing(date, key, value));
+                    fixings_->add(date, key, value);
             } else if (dataType == DataType::Dividend) {
                 // process dividends
                 if (date <= today)
@@ -155,5 +155,11 @@ const boost::shared_ptr<MarketDatum>& CSVLoader::get(const string& name, const Q
     }
     QL_FAIL("No MarketDatum for name " << name << " and date " << d);
 }
+
+const vector<Fixing>& CSVLoader::loadFixings() const {
+    if (fixingsVector_.size() != fixings_->size())
+        fixingsVector_ = fixings_->fixings();
+    return fixingsVector_;
+}
 } // namespace data
 } // namespace ore
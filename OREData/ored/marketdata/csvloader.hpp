@@ -39,7 +39,7 @@ namespace data {
 class CSVLoader : public Loader {
 public:
     //! Constructor
-    CSVLoader() {}
+    CSVLoader() : fixings_(boost::make_shared<FixingStore>()) {}
 
     CSVLoader( //! Quote file name
         const string& marketFilename,
@@ -82,7 +82,9 @@ public:
     const boost::shared_ptr<MarketDatum>& get(const std::string& name, const QuantLib::Date&) const;
 
     //! Load fixings
-    const std::vector<Fixing>& loadFixings() const { return fixings_; }
+    const std::vector<Fixing>& loadFixings() const;
+    //! Load fixings as a columnar store
+    boost::shared_ptr<const FixingStore> loadFixingStore() const { return fixings_; }
     //! Load dividends
     const std::vector<Fixing>& loadDividends() const { return dividends_; }
     //@}
@@ -93,7 +95,9 @@ private:
 
     bool implyTodaysFixings_;
     std::map<QuantLib::Date, std::vector<boost::shared_ptr<MarketDatum>>> data_;
-    std::vector<Fixing> fixings_;
+    boost::shared_ptr<FixingStore> fixings_;
+    //! fixings as a vector, only built if requested via loadFixings()
+    mutable std::vector<Fixing> fixingsVector_;
     std::vector<Fixing> dividends_;
 };
 } // namespace data
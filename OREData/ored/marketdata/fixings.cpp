@@ -23,6 +23,7 @@
 
 #include <boost/timer/timer.hpp>
 #include <ored/marketdata/fixings.hpp>
+#include <ored/marketdata/fixingstore.hpp>
 #include <ored/utilities/indexparser.hpp>
 #include <ored/utilities/log.hpp>
 #include <ql/index.hpp>
@@ -38,24 +39,36 @@ namespace ore {
 namespace data {
 
 void applyFixings(const vector<Fixing>& fixings, const data::Conventions& conventions) {
+    applyFixings(FixingStore(fixings), conventions);
+}
+
+void applyFixings(const FixingStore& fixings, const data::Conventions& conventions) {
     Size count = 0;
-    map<string, boost::shared_ptr<Index>> cache;
     cpu_timer timer;
-    boost::shared_ptr<Index> index;
-    for (auto& f : fixings) {
+    vector<Date> dates;
+    vector<Real> values;
+    for (auto const& name : fixings.names()) {
         try {
-            auto it = cache.find(f.name);
-            if (it == cache.end()) {
-                index = parseIndex(f.name, conventions);
-                cache[f.name] = index;
-            } else {
-                index = it->second;
+            boost::shared_ptr<Index> index = parseIndex(name, conventions);
+            const vector<Date>& d = fixings.dates(name);
+            const vector<Real>& v = fixings.values(name);
+            // skip invalid fixing dates here, so that the valid fixings can be added in one go
+            dates.clear();
+            values.clear();
+            for (Size i = 0; i < d.size(); ++i) {
+                if (index->isValidFixingDate(d[i])) {
+                    dates.push_back(d[i]);
+                    values.push_back(v[i]);
+                } else {
+                    DLOG("Error during adding fixing for " << name << ": invalid fixing date "
+                                                           << io::iso_date(d[i]));
+                }
             }
-            index->addFixing(f.date, f.fixing, true);
-            TLOG("Added fixing for " << f.name << " (" << io::iso_date(f.date) << ") value:" << f.fixing);
-            count++;
+            index->addFixings(dates.begin(), dates.end(), values.begin(), true);
+            TLOG("Added " << dates.size() << " fixings for " << name);
+            count += dates.size();
         } catch (const std::exception& e) {
-            DLOG("Error during adding fixing for " << f.name << ": " << e.what());
+            DLOG("Error during adding fixings for " << name << ": " << e.what());
         }
     }
     timer.stop();
@@ -0,0 +1,125 @@
+/*
+ Copyright (C) 2020 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <ored/marketdata/fixingstore.hpp>
+#include <ored/utilities/log.hpp>
+
+#include <algorithm>
+#include <fstream>
+
+using namespace std;
+using namespace QuantLib;
+
+namespace ore {
+namespace data {
+
+FixingStore::FixingStore(const vector<Fixing>& fixings) : size_(0) { add(fixings); }
+
+FixingStore::FixingStore(const string& fileName) : size_(0) { load(fileName); }
+
+void FixingStore::add(const Date& date, const string& name, Real value) {
+    Column& c = columns_[name];
+    // fixings are usually added in ascending date order per index, so appending is the common case
+    if (c.dates.empty() || date > c.dates.back()) {
+        c.dates.push_back(date);
+        c.values.push_back(value);
+        ++size_;
+        return;
+    }
+    auto it = std::lower_bound(c.dates.begin(), c.dates.end(), date);
+    Size i = std::distance(c.dates.begin(), it);
+    if (*it == date) {
+        c.values[i] = value;
+    } else {
+        c.dates.insert(it, date);
+        c.values.insert(c.values.begin() + i, value);
+        ++size_;
+    }
+}
+
+void FixingStore::add(const vector<Fixing>& fixings) {
+    for (auto const& f : fixings)
+        add(f.date, f.name, f.fixing);
+}
+
+set<string> FixingStore::names() const {
+    set<string> result;
+    for (auto const& c : columns_)
+        result.insert(result.end(), c.first);
+    return result;
+}
+
+const FixingStore::Column& FixingStore::column(const string& name) const {
+    auto c = columns_.find(name);
+    QL_REQUIRE(c != columns_.end(), "FixingStore: no fixings for " << name);
+    return c->second;
+}
+
+const vector<Date>& FixingStore::dates(const string& name) const { return column(name).dates; }
+
+const vector<Real>& FixingStore::values(const string& name) const { return column(name).values; }
+
+Real FixingStore::fixing(const string& name, const Date& date) const {
+    auto c = columns_.find(name);
+    if (c == columns_.end())
+        return Null<Real>();
+    auto it = std::lower_bound(c->second.dates.begin(), c->second.dates.end(), date);
+    if (it == c->second.dates.end() || *it != date)
+        return Null<Real>();
+    return c->second.values[std::distance(c->second.dates.begin(), it)];
+}
+
+TimeSeries<Real> FixingStore::timeSeries(const string& name, const Date& start, const Date& end) const {
+    auto c = columns_.find(name);
+    if (c == columns_.end())
+        return TimeSeries<Real>();
+    const vector<Date>& d = c->second.dates;
+    Size first = std::distance(d.begin(), std::lower_bound(d.begin(), d.end(), start));
+    Size last = std::distance(d.begin(), std::upper_bound(d.begin(), d.end(), end));
+    if (first >= last)
+        return TimeSeries<Real>();
+    return TimeSeries<Real>(d.begin() + first, d.begin() + last, c->second.values.begin() + first);
+}
+
+vector<Fixing> FixingStore::fixings() const {
+    vector<Fixing> result;
+    result.reserve(size_);
+    for (auto const& c : columns_) {
+        for (Size i = 0; i < c.second.dates.size(); ++i)
+            result.emplace_back(c.second.dates[i], c.first, c.second.values[i]);
+    }
+    return result;
+}
+
+void FixingStore::load(const string& fileName) {
+    std::ifstream ifs(fileName.c_str(), std::fstream::binary);
+    QL_REQUIRE(ifs.is_open(), "error opening file " << fileName);
+    boost::archive::binary_iarchive ia(ifs);
+    ia >> *this;
+    LOG("FixingStore loaded " << size_ << " fixings for " << columns_.size() << " indices from " << fileName);
+}
+
+void FixingStore::save(const string& fileName) const {
+    std::ofstream ofs(fileName.c_str(), std::fstream::binary);
+    QL_REQUIRE(ofs.is_open(), "error opening file " << fileName);
+    boost::archive::binary_oarchive oa(ofs);
+    oa << *this;
+}
+
+} // namespace data
+} // namespace ore
@@ -0,0 +1,127 @@
+/*
+ Copyright (C) 2020 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file ored/marketdata/fixingstore.hpp
+    \brief Columnar store of index fixings
+    \ingroup marketdata
+*/
+
+#pragma once
+
+#include <ored/marketdata/fixings.hpp>
+#include <ored/utilities/serializationdate.hpp>
+
+#include <ql/timeseries.hpp>
+
+#include <boost/serialization/map.hpp>
+#include <boost/serialization/string.hpp>
+#include <boost/serialization/vector.hpp>
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace ore {
+namespace data {
+
+//! Columnar store of index fixings
+/*! The fixings are stored per index name as a column of dates and a column of values, sorted by date and
+    without duplicates. If a fixing is added for a date that is already present, the value is overwritten,
+    i.e. the last fixing added wins.
+
+    The store can be saved to and loaded from a binary archive, so that large fixing histories do not need
+    to be parsed from text files on each run.
+
+    \ingroup marketdata
+*/
+class FixingStore {
+public:
+    FixingStore() : size_(0) {}
+    //! Build from a vector of fixings
+    explicit FixingStore(const std::vector<Fixing>& fixings);
+    //! Load from a binary archive written by save()
+    explicit FixingStore(const std::string& fileName);
+
+    //! \name Modifiers
+    //@{
+    void add(const QuantLib::Date& date, const std::string& name, QuantLib::Real value);
+    void add(const std::vector<Fixing>& fixings);
+    //@}
+
+    //! \name Inspectors
+    //@{
+    //! Names of the indices with at least one fixing
+    std::set<std::string> names() const;
+    //! Returns true if there are fixings for the index
+    bool has(const std::string& name) const { return columns_.find(name) != columns_.end(); }
+    //! Total number of fixings
+    QuantLib::Size size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    //! Fixing dates of the index in ascending order
+    const std::vector<QuantLib::Date>& dates(const std::string& name) const;
+    //! Fixing values of the index, in the order of dates()
+    const std::vector<QuantLib::Real>& values(const std::string& name) const;
+    //! Fixing of the index on the given date, Null<Real>() if there is none
+    QuantLib::Real fixing(const std::string& name, const QuantLib::Date& date) const;
+    //! Fixings of the index between start and end, both inclusive
+    QuantLib::TimeSeries<QuantLib::Real> timeSeries(const std::string& name,
+                                                    const QuantLib::Date& start = QuantLib::Date::minDate(),
+                                                    const QuantLib::Date& end = QuantLib::Date::maxDate()) const;
+    //! All fixings, ordered by index name and date
+    std::vector<Fixing> fixings() const;
+    //@}
+
+    //! \name Persistence
+    //@{
+    //! Load from a binary archive, replaces the current content
+    void load(const std::string& fileName);
+    //! Write to a binary archive
+    void save(const std::string& fileName) const;
+    //@}
+
+private:
+    struct Column {
+        std::vector<QuantLib::Date> dates;
+        std::vector<QuantLib::Real> values;
+
+        template <class Archive> void serialize(Archive& ar, const unsigned int) {
+            ar& dates;
+            ar& values;
+        }
+    };
+    const Column& column(const std::string& name) const;
+
+    std::map<std::string, Column> columns_;
+    QuantLib::Size size_;
+
+    friend class boost::serialization::access;
+    template <class Archive> void serialize(Archive& ar, const unsigned int) {
+        ar& columns_;
+        ar& size_;
+    }
+};
+
+//! Utility to write the fixings of a store in the QuantLib index manager's fixing history
+/*! The index is parsed once per index name and its fixings are added in a single call.
+ */
+void applyFixings(const FixingStore& fixings, const data::Conventions& conventions);
+
+} // namespace data
+} // namespace ore
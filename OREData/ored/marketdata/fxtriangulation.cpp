@@ -16,49 +16,96 @@
  FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
 */
 
+#include <algorithm>
 #include <boost/make_shared.hpp>
+#include <deque>
 #include <ored/marketdata/fxtriangulation.hpp>
 #include <ql/errors.hpp>
-#include <ql/quotes/compositequote.hpp>
-#include <ql/quotes/derivedquote.hpp>
 #include <ql/quotes/simplequote.hpp>
+#include <vector>
 
 using namespace QuantLib;
+using std::map;
+using std::pair;
 using std::string;
+using std::vector;
 
 namespace {
-// helper classes to enable the building
-// of composite cross-currency fx quotes
-class Triangulation {
+// helper class to enable the building of composite cross-currency fx quotes,
+// the value is the product of the quotes along a path, each of them possibly inverted
+class PathQuote : public Quote, public Observer {
 public:
-    Triangulation() {}
-    Real operator()(Real a, Real b) const { return a / b; }
-};
-
-class Product {
-public:
-    Product() {}
-    Real operator()(Real a, Real b) const { return a * b; }
-};
-
-class InverseProduct {
-public:
-    InverseProduct() {}
-    Real operator()(Real a, Real b) const { return 1.0 / (a * b); }
-};
+    PathQuote(const vector<pair<Handle<Quote>, bool>>& legs) : legs_(legs) {
+        for (const auto& l : legs_)
+            registerWith(l.first);
+    }
+    Real value() const override {
+        Real v = 1.0;
+        for (const auto& l : legs_) {
+            if (l.second)
+                v /= l.first->value();
+            else
+                v *= l.first->value();
+        }
+        return v;
+    }
+    bool isValid() const override {
+        for (const auto& l : legs_) {
+            if (l.first.empty() || !l.first->isValid())
+                return false;
+        }
+        return true;
+    }
+    void update() override { notifyObservers(); }
 
-// Inverse a single quote
-class Inverse {
-public:
-    Inverse() {}
-    Real operator()(Real a) const { return 1.0 / a; }
+private:
+    vector<pair<Handle<Quote>, bool>> legs_;
 };
 } // namespace
 
 namespace ore {
 namespace data {
 
+FXTriangulation::FXTriangulation(const FXTriangulation& other) {
+    std::lock_guard<std::mutex> lock(other.mutex_);
+    map_ = other.map_;
+    graph_ = other.graph_;
+    paths_ = other.paths_;
+    cache_ = other.cache_;
+}
+
+FXTriangulation& FXTriangulation::operator=(const FXTriangulation& other) {
+    if (this != &other) {
+        std::lock(mutex_, other.mutex_);
+        std::lock_guard<std::mutex> lock1(mutex_, std::adopt_lock);
+        std::lock_guard<std::mutex> lock2(other.mutex_, std::adopt_lock);
+        map_ = other.map_;
+        graph_ = other.graph_;
+        paths_ = other.paths_;
+        cache_ = other.cache_;
+    }
+    return *this;
+}
+
+void FXTriangulation::addQuote(const string& pair, const Handle<Quote>& spot) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    map_[pair] = spot;
+    // only proper ccy pairs make it into the graph, other names can be retrieved directly only
+    if (pair.size() == 6) {
+        string domestic = pair.substr(0, 3);
+        string foreign = pair.substr(3);
+        if (domestic != foreign) {
+            graph_[domestic].insert(foreign);
+            graph_[foreign].insert(domestic);
+        }
+    }
+    paths_.clear();
+    cache_.clear();
+}
+
 Handle<Quote> FXTriangulation::getQuote(const string& pair) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
     // First, look for the pair in the map
     auto it = map_.find(pair);
     if (it != map_.end())
@@ -69,75 +116,72 @@ Handle<Quote> FXTriangulation::getQuote(const string& pair) const {
     string domestic = pair.substr(0, 3);
     string foreign = pair.substr(3);
 
-    // check reverse
-    string reverse = foreign + domestic;
-    it = map_.find(reverse);
-    if (it != map_.end()) {
-        Handle<Quote> invertedQuote(boost::make_shared<DerivedQuote<Inverse>>(it->second, Inverse()));
-        map_[pair] = invertedQuote;
-        return invertedQuote;
-    }
-
     // check EUREUR
     if (foreign == domestic) {
         static Handle<Quote> unity(boost::make_shared<SimpleQuote>(1.0));
         return unity;
     }
 
-    // Now we search for a pair of quotes that we can combine to construct the quote required.
-    // We only search for a pair of quotes a single step apart.
-    //
-    // Suppose we want a USDJPY quote and we have EUR based data, there are 4 combinations to
-    // consider:
-    // EURUSD, EURJPY  => we want EURJPY / EURUSD [Triangulation]
-    // EURUSD, JPYEUR  => we want 1 / (EURUSD * JPYEUR) [InverseProduct]
-    // USDEUR, EURJPY  => we want USDEUR * EURJPY [Product]
-    // USDEUR, JPYEUR  => we want USDEUR / JPYEUR [Triangulation (but in the reverse order)]
-    //
-    // Loop over the map, look for domestic then use the map to find the other side of the pair.
-    for (const auto& kv : map_) {
-        string keyDomestic = kv.first.substr(0, 3);
-        string keyForeign = kv.first.substr(3);
-        const Handle<Quote>& q1 = kv.second;
-
-        if (domestic == keyDomestic) {
-            // we have domestic, now look for foreign/keyForeign
-            // USDEUR, JPYEUR  => we want USDEUR / JPYEUR [Triangulation (but in the reverse order)]
-            it = map_.find(foreign + keyForeign);
-            if (it != map_.end()) {
-                // Here q1 is USDEUR and it->second is JPYEUR
-                map_[pair] =
-                    Handle<Quote>(boost::make_shared<CompositeQuote<Triangulation>>(q1, it->second, Triangulation()));
-                return map_[pair];
-            }
-            // USDEUR, EURJPY  => we want USDEUR * EURJPY [Product]
-            it = map_.find(keyForeign + foreign);
-            if (it != map_.end()) {
-                map_[pair] = Handle<Quote>(boost::make_shared<CompositeQuote<Product>>(q1, it->second, Product()));
-                return map_[pair];
-            }
-        }
+    // check the quotes constructed before
+    it = cache_.find(pair);
+    if (it != cache_.end())
+        return it->second;
 
-        if (domestic == keyForeign) {
-            // EURUSD, JPYEUR  => we want 1 / (EURUSD * JPYEUR) [InverseProduct]
-            it = map_.find(foreign + keyDomestic);
-            if (it != map_.end()) {
-                map_[pair] =
-                    Handle<Quote>(boost::make_shared<CompositeQuote<InverseProduct>>(q1, it->second, InverseProduct()));
-                return map_[pair];
-            }
-            // EURUSD, EURJPY  => we want EURJPY / EURUSD [Triangulation]
-            it = map_.find(keyDomestic + foreign);
-            if (it != map_.end()) {
-                // Here q1 is EURUSD and it->second is EURJPY
-                map_[pair] =
-                    Handle<Quote>(boost::make_shared<CompositeQuote<Triangulation>>(it->second, q1, Triangulation()));
-                return map_[pair];
-            }
+    // Now we follow the shortest path from domestic to foreign, e.g. for USDJPY with EUR based data
+    // USD -> EUR -> JPY, i.e. we want 1 / EURUSD * EURJPY. Each step uses the quote for the step if
+    // we have it and the inverse of the reverse quote otherwise.
+    const map<string, string>& predecessors = paths(domestic);
+    QL_REQUIRE(predecessors.find(foreign) != predecessors.end(), "Unable to build FXQuote for ccy pair " << pair);
+    vector<std::pair<Handle<Quote>, bool>> legs;
+    for (string ccy = foreign; ccy != domestic;) {
+        const string& prev = predecessors.at(ccy);
+        auto q = map_.find(prev + ccy);
+        if (q != map_.end()) {
+            legs.push_back(std::make_pair(q->second, false));
+        } else {
+            q = map_.find(ccy + prev);
+            QL_REQUIRE(q != map_.end(), "FXTriangulation: internal error, no quote for " << prev << ccy);
+            legs.push_back(std::make_pair(q->second, true));
         }
+        ccy = prev;
     }
+    std::reverse(legs.begin(), legs.end());
+
+    Handle<Quote> quote(boost::make_shared<PathQuote>(legs));
+    cache_[pair] = quote;
+    return quote;
+}
+
+map<string, Handle<Quote>> FXTriangulation::quotes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    map<string, Handle<Quote>> result(cache_);
+    for (const auto& kv : map_)
+        result[kv.first] = kv.second;
+    return result;
+}
 
-    QL_FAIL("Unable to build FXQuote for ccy pair " << pair);
+const map<string, string>& FXTriangulation::paths(const string& ccy) const {
+    auto p = paths_.find(ccy);
+    if (p != paths_.end())
+        return p->second;
+
+    // breadth first search, the neighbours are visited in a fixed order so that the paths are deterministic
+    map<string, string>& predecessors = paths_[ccy];
+    std::deque<string> queue(1, ccy);
+    predecessors[ccy] = ccy;
+    while (!queue.empty()) {
+        string current = queue.front();
+        queue.pop_front();
+        auto g = graph_.find(current);
+        if (g == graph_.end())
+            continue;
+        for (const auto& next : g->second) {
+            if (predecessors.insert(std::make_pair(next, current)).second)
+                queue.push_back(next);
+        }
+    }
+    return predecessors;
 }
+
 } // namespace data
 } // namespace ore
@@ -24,9 +24,11 @@
 #pragma once
 
 #include <map>
+#include <mutex>
 #include <ql/handle.hpp>
 #include <ql/quote.hpp>
 #include <ql/types.hpp>
+#include <set>
 
 namespace ore {
 namespace data {
@@ -36,19 +38,25 @@ using QuantLib::Quote;
 //! Intelligent FX price repository
 /*! FX Triangulation is an intelligent price repository that will attempt to calculate FX spot values
  *
- *  As quotes for currency pairs are added to the repository they are stored in an internal map
- *  If the repository is asked for the FX spot price for a given pair it will attempt the following:
+ *  As quotes for currency pairs are added to the repository they are stored in an internal map and
+ *  form the edges of a currency graph. If the repository is asked for the FX spot price for a given pair
+ *  it will attempt the following:
  *  1) Look in the map for the pair
- *  2) Look for the reverse quote (EURUSD -> USDEUR), if found it will return an inverse quote.
- *  3) Look through the map and attempt to find a bridging pair (e.g EURUSD and EURJPY for USDJPY)
- *     and return the required composite quote.
+ *  2) Look for a shortest path from the first to the second currency in the graph, e.g. the reverse quote
+ *     (EURUSD -> USDEUR), a bridging pair (e.g EURUSD and EURJPY for USDJPY) or several bridging pairs
+ *     (e.g. EURUSD, EURAUD and AUDNZD for USDNZD), and return the composite quote along the path.
  *
- *  In cases (2) and (3) the constructed quote is then stored in the map so subsequent calls will hit (1).
+ *  The shortest paths from a currency to all others are computed once, on the first request for that
+ *  currency, and the constructed quotes are cached. Both are reset when a quote is added.
  *
  *  The constructed quotes all reference the original quotes which are added by the addQuote() method
  *  and so if these original quotes change in the future, the constructed quotes will reflect the new
  *  value
  *
+ *  Lookups are synchronised, so that a triangulation can be shared between threads once all quotes are added.
+ *  Note that the constructed quotes register with the original quotes as observers, which is only safe if no
+ *  other thread registers with the original quotes at the same time.
+ *
  *  \ingroup marketdata
  */
 class FXTriangulation {
@@ -56,17 +64,30 @@ public:
     //! Default ctor, once built the repo is empty
     FXTriangulation() {}
 
+    //! \name Copy and assignment
+    //@{
+    FXTriangulation(const FXTriangulation& other);
+    FXTriangulation& operator=(const FXTriangulation& other);
+    //@}
+
     //! Add a quote to the repo
-    void addQuote(const std::string& pair, const Handle<Quote>& spot) { map_[pair] = spot; }
+    void addQuote(const std::string& pair, const Handle<Quote>& spot);
 
     //! Get a quote from the repo, this will follow the algorithm described above
     Handle<Quote> getQuote(const std::string&) const;
 
-    //! Get all quotes currently stored in the triangulation
-    const std::map<std::string, Handle<Quote>>& quotes() const { return map_; }
+    //! Get all quotes currently stored in the triangulation, i.e. the added and the constructed quotes
+    std::map<std::string, Handle<Quote>> quotes() const;
 
 private:
-    mutable std::map<std::string, Handle<Quote>> map_;
+    //! Returns the shortest paths from \p ccy, as a map from each reachable currency to its predecessor
+    const std::map<std::string, std::string>& paths(const std::string& ccy) const;
+
+    std::map<std::string, Handle<Quote>> map_;
+    std::map<std::string, std::set<std::string>> graph_;
+    mutable std::map<std::string, std::map<std::string, std::string>> paths_;
+    mutable std::map<std::string, Handle<Quote>> cache_;
+    mutable std::mutex mutex_;
 };
 } // namespace data
 } // namespace ore
@@ -23,8 +23,10 @@
 
 #pragma once
 
+#include <boost/make_shared.hpp>
 #include <boost/shared_ptr.hpp>
 #include <ored/marketdata/fixings.hpp>
+#include <ored/marketdata/fixingstore.hpp>
 #include <ored/marketdata/marketdatum.hpp>
 #include <ored/utilities/log.hpp>
 #include <ql/time/date.hpp>
@@ -82,6 +84,11 @@ public:
     virtual const std::vector<Fixing>& loadFixings() const = 0;
     //@}
 
+    //! Load fixings as a columnar store, the default implementation builds the store from loadFixings()
+    virtual boost::shared_ptr<const FixingStore> loadFixingStore() const {
+        return boost::make_shared<FixingStore>(loadFixings());
+    }
+
     //! Optional load dividends method
     virtual const std::vector<Fixing>& loadDividends() const {
         static std::vector<Fixing> noFixings;
@@ -21,6 +21,7 @@
     \ingroup
 */
 
+#include <boost/algorithm/string/replace.hpp>
 #include <boost/range/adaptor/map.hpp>
 #include <ored/marketdata/basecorrelationcurve.hpp>
 #include <ored/marketdata/capfloorvolcurve.hpp>
@@ -64,13 +65,14 @@ TodaysMarket::TodaysMarket(const Date& asof, const TodaysMarketParameters& param
                            const CurveConfigurations& curveConfigs, const Conventions& conventions,
                            const bool continueOnError, bool loadFixings,
                            const boost::shared_ptr<ReferenceDataManager>& referenceData)
-    : MarketImpl(conventions) {
+    : MarketImpl(conventions), curveConfigs_(curveConfigs), referenceData_(referenceData),
+      continueOnError_(continueOnError), marketData_(boost::make_shared<MarketDataSnapshot>(asof)) {
 
     // Fixings
     if (loadFixings) {
         // Apply them now in case a curve builder needs them
         LOG("Todays Market Loading Fixings");
-        applyFixings(loader.loadFixings(), conventions);
+        applyFixings(*loader.loadFixingStore(), conventions);
         LOG("Todays Market Loading Fixing done.");
     }
 
@@ -82,7 +84,6 @@ TodaysMarket::TodaysMarket(const Date& asof, const TodaysMarketParameters& param
 
     // store all curves built, since they might appear in several configurations
     // and might therefore be reused
-    map<string, boost::shared_ptr<YieldCurve>> requiredYieldCurves;
     map<string, boost::shared_ptr<SwapIndex>> requiredSwapIndices;
     map<string, boost::shared_ptr<FXSpot>> requiredFxSpots;
     map<string, boost::shared_ptr<FXVolCurve>> requiredFxVolCurves;
@@ -105,14 +106,14 @@ TodaysMarket::TodaysMarket(const Date& asof, const TodaysMarketParameters& param
     // store all curve build errors
     map<string, string> buildErrors;
 
-    // fx triangulation
-    FXTriangulation fxT;
-    // Add all FX quotes from the loader to Triangulation
+    // Add all FX quotes from the loader to Triangulation, keep the quotes for updates
     for (auto& md : loader.loadQuotes(asof)) {
+        if (md->asofDate() == asof)
+            marketData_->add(md);
         if (md->asofDate() == asof && md->instrumentType() == MarketDatum::InstrumentType::FX_SPOT) {
             boost::shared_ptr<FXSpotQuote> q = boost::dynamic_pointer_cast<FXSpotQuote>(md);
             QL_REQUIRE(q, "Failed to cast " << md->name() << " to FXSpotQuote");
-            fxT.addQuote(q->unitCcy() + q->ccy(), q->quote());
+            fxT_.addQuote(q->unitCcy() + q->ccy(), q->quote());
         }
     }
 
@@ -141,6 +142,18 @@ TodaysMarket::TodaysMarket(const Date& asof, const TodaysMarketParameters& param
             auto spec = specs[count];
             LOG("Loading spec " << *spec);
 
+            // remember the quotes the spec depends on, for quote updates
+            if (requiredQuotes_.find(spec->name()) == requiredQuotes_.end()) {
+                requiredQuotes_[spec->name()];
+                specTypes_[spec->name()] = spec->baseType();
+                for (const auto& q : curveConfigs.quotes(*spec)) {
+                    if (q.find("*") == string::npos)
+                        requiredQuotes_[spec->name()].insert(q);
+                    else
+                        requiredQuotePatterns_[spec->name()].push_back(regex(boost::replace_all_copy(q, "*", ".*")));
+                }
+            }
+
             try {
                 switch (spec->baseType()) {
 
@@ -149,16 +162,26 @@ TodaysMarket::TodaysMarket(const Date& asof, const TodaysMarketParameters& param
                     QL_REQUIRE(ycspec, "Failed to convert spec " << *spec << " to yield curve spec");
 
                     // have we built the curve already ?
-                    auto itr = requiredYieldCurves.find(ycspec->name());
-                    if (itr == requiredYieldCurves.end()) {
+                    auto itr = requiredYieldCurves_.find(ycspec->name());
+                    if (itr == requiredYieldCurves_.end()) {
                         // build
                         LOG("Building YieldCurve for asof " << asof);
-                        boost::shared_ptr<YieldCurve> yieldCurve = boost::make_shared<YieldCurve>(
-                            asof, *ycspec, curveConfigs, loader, conventions, requiredYieldCurves, fxT, referenceData);
-                        itr = requiredYieldCurves.insert(make_pair(ycspec->name(), yieldCurve)).first;
+                        boost::shared_ptr<YieldCurve> yieldCurve =
+                            boost::make_shared<YieldCurve>(asof, *ycspec, curveConfigs, loader, conventions,
+                                                           requiredYieldCurves_, fxT_, referenceData);
+                        itr = requiredYieldCurves_.insert(make_pair(ycspec->name(), yieldCurve)).first;
+                        yieldCurveSpecs_.push_back(ycspec->name());
+                        // record the dependency on the yield curves used in the build
+                        for (const auto& id :
+                             curveConfigs.yieldCurveConfig(ycspec->curveConfigID())->requiredYieldCurveIDs()) {
+                            for (const auto& yc : requiredYieldCurves_) {
+                                if (yc.second->curveSpec().curveConfigID() == id)
+                                    dependentSpecs_[yc.first].insert(ycspec->name());
+                            }
+                        }
                     }
 
-                    DLOG("Added YieldCurve \"" << ycspec->name() << "\" to requiredYieldCurves map");
+                    DLOG("Added YieldCurve \"" << ycspec->name() << "\" to requiredYieldCurves_ map");
 
                     if (itr->second->currency().code() != ycspec->ccy()) {
                         WLOG("Warning: YieldCurve has ccy " << itr->second->currency() << " but spec has ccy "
@@ -206,9 +229,9 @@ TodaysMarket::TodaysMarket(const Date& asof, const TodaysMarketParameters& param
                     if (itr == requiredFxSpots.end()) {
                         // build the curve
                         LOG("Building FXSpot for asof " << asof);
-                        boost::shared_ptr<FXSpot> fxSpot = boost::make_shared<FXSpot>(asof, *fxspec, fxT);
+                        boost::shared_ptr<FXSpot> fxSpot = boost::make_shared<FXSpot>(asof, *fxspec, fxT_);
                         itr = requiredFxSpots.insert(make_pair(fxspec->name(), fxSpot)).first;
-                        fxT.addQuote(fxspec->subName().substr(0, 3) + fxspec->subName().substr(4, 3),
+                        fxT_.addQuote(fxspec->subName().substr(0, 3) + fxspec->subName().substr(4, 3),
                                      itr->second->handle());
                     }
 
@@ -235,7 +258,7 @@ TodaysMarket::TodaysMarket(const Date& asof, const TodaysMarketParameters& param
                         // build the curve
                         LOG("Building FXVolatility for asof " << asof);
                         boost::shared_ptr<FXVolCurve> fxVolCurve = boost::make_shared<FXVolCurve>(
-                            asof, *fxvolspec, loader, curveConfigs, fxT, requiredYieldCurves, conventions);
+                            asof, *fxvolspec, loader, curveConfigs, fxT_, requiredYieldCurves_, conventions);
                         itr = requiredFxVolCurves.insert(make_pair(fxvolspec->name(), fxVolCurve)).first;
                     }
 
@@ -331,8 +354,8 @@ TodaysMarket::TodaysMarket(const Date& asof, const TodaysMarketParameters& param
                         // Ibor index
                         Handle<IborIndex> iborIndex = MarketImpl::iborIndex(cfg->iborIndex(), configuration.first);
                         // Discount curve
-                        auto it = requiredYieldCurves.find(cfg->discountCurve());
-                        QL_REQUIRE(it != requiredYieldCurves.end(), "Discount curve with spec, "
+                        auto it = requiredYieldCurves_.find(cfg->discountCurve());
+                        QL_REQUIRE(it != requiredYieldCurves_.end(), "Discount curve with spec, "
                                                                         << cfg->discountCurve()
                                                                         << ", not found in loaded yield curves");
                         Handle<YieldTermStructure> discountCurve = it->second->handle();
@@ -366,7 +389,7 @@ TodaysMarket::TodaysMarket(const Date& asof, const TodaysMarketParameters& param
                         // build the curve
                         LOG("Building DefaultCurve for asof " << asof);
                         boost::shared_ptr<DefaultCurve> defaultCurve = boost::make_shared<DefaultCurve>(
-                            asof, *defaultspec, loader, curveConfigs, conventions, requiredYieldCurves);
+                            asof, *defaultspec, loader, curveConfigs, conventions, requiredYieldCurves_);
                         itr = requiredDefaultCurves.insert(make_pair(defaultspec->name(), defaultCurve)).first;
                     }
 
@@ -452,7 +475,7 @@ TodaysMarket::TodaysMarket(const Date& asof, const TodaysMarketParameters& param
                     if (itr == requiredInflationCurves.end()) {
                         LOG("Building InflationCurve " << inflationspec->name() << " for asof " << asof);
                         boost::shared_ptr<InflationCurve> inflationCurve = boost::make_shared<InflationCurve>(
-                            asof, *inflationspec, loader, curveConfigs, conventions, requiredYieldCurves);
+                            asof, *inflationspec, loader, curveConfigs, conventions, requiredYieldCurves_);
                         itr = requiredInflationCurves.insert(make_pair(inflationspec->name(), inflationCurve)).first;
                     }
                     // this try-catch is necessary to handle cases where no ZC inflation index curves exist in scope
@@ -512,8 +535,9 @@ TodaysMarket::TodaysMarket(const Date& asof, const TodaysMarketParameters& param
                     if (itr == requiredInflationCapFloorVolCurves.end()) {
                         LOG("Building InflationCapFloorVolatilitySurface for asof " << asof);
                         boost::shared_ptr<InflationCapFloorVolCurve> inflationCapFloorVolCurve =
-                            boost::make_shared<InflationCapFloorVolCurve>(asof, *infcapfloorspec, loader, curveConfigs,
-                                                                          requiredYieldCurves, requiredInflationCurves);
+                            boost::make_shared<InflationCapFloorVolCurve>(
+                                asof, *infcapfloorspec, loader, curveConfigs, requiredYieldCurves_,
+                                requiredInflationCurves);
                         itr = requiredInflationCapFloorVolCurves
                                   .insert(make_pair(infcapfloorspec->name(), inflationCapFloorVolCurve))
                                   .first;
@@ -563,7 +587,7 @@ TodaysMarket::TodaysMarket(const Date& asof, const TodaysMarketParameters& param
                         // build the curve
                         LOG("Building EquityCurve for asof " << asof);
                         boost::shared_ptr<EquityCurve> equityCurve = boost::make_shared<EquityCurve>(
-                            asof, *equityspec, loader, curveConfigs, conventions, requiredYieldCurves);
+                            asof, *equityspec, loader, curveConfigs, conventions, requiredYieldCurves_);
                         itr = requiredEquityCurves.insert(make_pair(equityspec->name(), equityCurve)).first;
                     }
 
@@ -676,7 +700,7 @@ TodaysMarket::TodaysMarket(const Date& asof, const TodaysMarketParameters& param
                         // build the curve
                         LOG("Building CommodityCurve for asof " << asof);
                         boost::shared_ptr<CommodityCurve> commodityCurve = boost::make_shared<CommodityCurve>(
-                            asof, *commodityCurveSpec, loader, curveConfigs, conventions, fxT, requiredYieldCurves,
+                            asof, *commodityCurveSpec, loader, curveConfigs, conventions, fxT_, requiredYieldCurves_,
                             requiredCommodityCurves);
                         itr =
                             requiredCommodityCurves.insert(make_pair(commodityCurveSpec->name(), commodityCurve)).first;
@@ -705,7 +729,7 @@ TodaysMarket::TodaysMarket(const Date& asof, const TodaysMarketParameters& param
                         LOG("Building commodity volatility for asof " << asof);
 
                         boost::shared_ptr<CommodityVolCurve> commodityVolCurve = boost::make_shared<CommodityVolCurve>(
-                            asof, *commodityVolSpec, loader, curveConfigs, conventions, requiredYieldCurves,
+                            asof, *commodityVolSpec, loader, curveConfigs, conventions, requiredYieldCurves_,
                             requiredCommodityCurves, requiredCommodityVolCurves);
                         itr = requiredCommodityVolCurves.insert(make_pair(commodityVolSpec->name(), commodityVolCurve))
                                   .first;
@@ -748,7 +772,7 @@ TodaysMarket::TodaysMarket(const Date& asof, const TodaysMarketParameters& param
                         LOG("Building CorrelationCurve for asof " << asof);
                         boost::shared_ptr<CorrelationCurve> corrCurve = boost::make_shared<CorrelationCurve>(
                             asof, *corrspec, loader, curveConfigs, conventions, requiredSwapIndices,
-                            requiredYieldCurves, requiredSwaptionVolCurves);
+                            requiredYieldCurves_, requiredSwaptionVolCurves);
                         itr = requiredCorrelationCurves.insert(make_pair(corrspec->name(), corrCurve)).first;
                     }
 
@@ -821,5 +845,151 @@ TodaysMarket::TodaysMarket(const Date& asof, const TodaysMarketParameters& param
     }
 
 } // CTOR
+
+set<string> TodaysMarket::updateQuotes(const vector<boost::shared_ptr<MarketDatum>>& data) {
+
+    LOG("TodaysMarket: updating " << data.size() << " quotes");
+
+    // Collect the quotes that actually change
+    map<string, pair<boost::shared_ptr<SimpleQuote>, Real>> changed;
+    for (const auto& md : data) {
+        QL_REQUIRE(md, "TodaysMarket::updateQuotes(): market datum is null");
+        if (md->asofDate() != asof_) {
+            WLOG("Skipping update of quote " << md->name() << ", its date " << io::iso_date(md->asofDate())
+                                             << " does not match the market date " << io::iso_date(asof_));
+            continue;
+        }
+        boost::shared_ptr<SimpleQuote> q = marketData_->quote(md->name());
+        if (!q) {
+            WLOG("Skipping update of quote " << md->name() << ", it is not used in TodaysMarket");
+            continue;
+        }
+        Real value = md->quote()->value();
+        if (!q->isValid() || q->value() != value)
+            changed[md->name()] = make_pair(q, value);
+    }
+    DLOG("TodaysMarket: " << changed.size() << " quotes changed");
+
+    // Collect the curve specs using the changed quotes ...
+    set<string> touched;
+    for (const auto& rq : requiredQuotes_) {
+        for (const auto& q : rq.second) {
+            if (changed.find(q) != changed.end()) {
+                touched.insert(rq.first);
+                break;
+            }
+        }
+    }
+    for (const auto& rp : requiredQuotePatterns_) {
+        if (touched.find(rp.first) != touched.end())
+            continue;
+        for (Size i = 0; i < rp.second.size() && touched.find(rp.first) == touched.end(); ++i) {
+            for (const auto& c : changed) {
+                if (regex_match(c.first, rp.second[i])) {
+                    touched.insert(rp.first);
+                    break;
+                }
+            }
+        }
+    }
+
+    // ... reject the update if any of them would not follow it ...
+    ostringstream unsupported;
+    for (const auto& name : touched) {
+        CurveSpec::CurveType type = specTypes_.at(name);
+        if (type != CurveSpec::CurveType::Yield && type != CurveSpec::CurveType::FX)
+            unsupported << (unsupported.tellp() > 0 ? ", " : "") << name;
+    }
+    QL_REQUIRE(unsupported.tellp() == 0, "TodaysMarket::updateQuotes(): only yield curves and FX spots can be "
+                                         "updated, the update affects "
+                                             << unsupported.str());
+
+    // ... and add the yield curves built on top of them
+    vector<string> stack(touched.begin(), touched.end());
+    while (!stack.empty()) {
+        string name = stack.back();
+        stack.pop_back();
+        auto d = dependentSpecs_.find(name);
+        if (d == dependentSpecs_.end())
+            continue;
+        for (const auto& s : d->second) {
+            if (touched.insert(s).second)
+                stack.push_back(s);
+        }
+    }
+
+    // Defer the notifications until all quotes are set and all affected curves are rebuilt
+    ObservableSettings::instance().disableUpdates(true);
+
+    try {
+        for (const auto& c : changed)
+            c.second.first->setValue(c.second.second);
+
+        // Bootstrapped yield curves are snapshots of their helpers (see YieldCurve::piecewisecurve()), so they do
+        // not follow the quotes. Rebuild the touched ones in build order and relink the existing handles.
+        for (const auto& name : yieldCurveSpecs_) {
+            if (touched.find(name) == touched.end())
+                continue;
+            boost::shared_ptr<YieldCurve> yieldCurve = requiredYieldCurves_.at(name);
+            try {
+                DLOG("Rebuilding YieldCurve " << name);
+                YieldCurve updated(asof_, yieldCurve->curveSpec(), curveConfigs_, *marketData_, conventions_,
+                                   requiredYieldCurves_, fxT_, referenceData_);
+                yieldCurve->relinkTo(updated);
+            } catch (const std::exception& e) {
+                ALOG(StructuredCurveErrorMessage(name, "Failed to Rebuild Curve", e.what()));
+                QL_REQUIRE(continueOnError_, "Cannot rebuild curve " << name << ": " << e.what());
+            }
+        }
+    } catch (...) {
+        ObservableSettings::instance().enableUpdates();
+        throw;
+    }
+
+    // Send the deferred notifications in one go
+    ObservableSettings::instance().enableUpdates();
+
+    LOG("TodaysMarket: quote update touched " << touched.size() << " curve specs");
+    return touched;
+}
+
+const vector<boost::shared_ptr<MarketDatum>>& TodaysMarket::MarketDataSnapshot::loadQuotes(const Date& d) const {
+    QL_REQUIRE(d == asof_, "There are no quotes available for date " << io::iso_date(d));
+    return data_;
+}
+
+const boost::shared_ptr<MarketDatum>& TodaysMarket::MarketDataSnapshot::get(const string& name, const Date& d) const {
+    QL_REQUIRE(d == asof_, "There are no quotes available for date " << io::iso_date(d));
+    auto it = index_.find(name);
+    QL_REQUIRE(it != index_.end(), "No datum for " << name << " on date " << io::iso_date(d));
+    return data_[it->second];
+}
+
+bool TodaysMarket::MarketDataSnapshot::has(const string& name, const Date& d) const {
+    return d == asof_ && index_.find(name) != index_.end();
+}
+
+const vector<Fixing>& TodaysMarket::MarketDataSnapshot::loadFixings() const {
+    static vector<Fixing> noFixings;
+    return noFixings;
+}
+
+void TodaysMarket::MarketDataSnapshot::add(const boost::shared_ptr<MarketDatum>& md) {
+    QL_REQUIRE(md->asofDate() == asof_, "Datum " << md->name() << " has date " << io::iso_date(md->asofDate())
+                                                 << ", expected " << io::iso_date(asof_));
+    if (index_.insert(make_pair(md->name(), data_.size())).second)
+        data_.push_back(md);
+}
+
+boost::shared_ptr<SimpleQuote> TodaysMarket::MarketDataSnapshot::quote(const string& name) const {
+    auto it = index_.find(name);
+    if (it == index_.end())
+        return boost::shared_ptr<SimpleQuote>();
+    boost::shared_ptr<SimpleQuote> q =
+        boost::dynamic_pointer_cast<SimpleQuote>(data_[it->second]->quote().currentLink());
+    QL_REQUIRE(q, "Quote " << name << " is not a SimpleQuote and cannot be updated");
+    return q;
+}
+
 } // namespace data
 } // namespace ore
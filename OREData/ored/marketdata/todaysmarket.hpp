@@ -28,9 +28,14 @@
 #include <ored/configuration/conventions.hpp>
 #include <ored/configuration/curveconfigurations.hpp>
 #include <ored/marketdata/curvespec.hpp>
+#include <ored/marketdata/fxtriangulation.hpp>
 #include <ored/marketdata/loader.hpp>
 #include <ored/marketdata/marketimpl.hpp>
 #include <ored/marketdata/todaysmarketparameters.hpp>
+#include <ored/marketdata/yieldcurve.hpp>
+#include <ql/quotes/simplequote.hpp>
+#include <regex>
+#include <set>
 
 namespace ore {
 namespace data {
@@ -71,6 +76,58 @@ public:
         bool loadFixings = true,
         //! Optional reference data manager, needed to build fitted bond curves
         const boost::shared_ptr<ReferenceDataManager>& referenceData = nullptr);
+
+    //! \name Quote updates
+    //@{
+    /*! Set the quotes the market was built from to the values of the given market data, e.g. for intraday
+        repricing without reloading the whole market.
+
+        Notifications are deferred until the whole batch is applied. FX spots follow their quotes through the
+        observer graph, bootstrapped yield curves using the changed quotes (directly or through another yield
+        curve) are rebuilt and their handles relinked. All other term structures copy their quotes when they are
+        built, an update changing a quote used by any of them is therefore rejected and leaves the market
+        unchanged. Data that is not used by the market or has a different date is skipped with a warning.
+
+        Returns the names of the curve specs affected by the update, so that dependent caches can be invalidated.
+    */
+    std::set<std::string> updateQuotes(const std::vector<boost::shared_ptr<MarketDatum>>& data);
+    //@}
+
+private:
+    //! Loader serving the quotes the market was built from, indexed by name
+    class MarketDataSnapshot : public Loader {
+    public:
+        explicit MarketDataSnapshot(const Date& asof) : asof_(asof) {}
+        const std::vector<boost::shared_ptr<MarketDatum>>& loadQuotes(const Date& d) const override;
+        const boost::shared_ptr<MarketDatum>& get(const std::string& name, const Date& d) const override;
+        bool has(const std::string& name, const Date& d) const override;
+        const std::vector<Fixing>& loadFixings() const override;
+        void add(const boost::shared_ptr<MarketDatum>& md);
+        //! Returns the quote for the given name or a null pointer if there is none
+        boost::shared_ptr<SimpleQuote> quote(const std::string& name) const;
+
+    private:
+        Date asof_;
+        std::vector<boost::shared_ptr<MarketDatum>> data_;
+        std::map<std::string, Size> index_;
+    };
+
+    CurveConfigurations curveConfigs_;
+    boost::shared_ptr<ReferenceDataManager> referenceData_;
+    bool continueOnError_;
+    boost::shared_ptr<MarketDataSnapshot> marketData_;
+    FXTriangulation fxT_;
+
+    //! Yield curves built, keyed by spec name, and the spec names in build order
+    std::map<std::string, boost::shared_ptr<YieldCurve>> requiredYieldCurves_;
+    std::vector<std::string> yieldCurveSpecs_;
+    //! Type of each spec
+    std::map<std::string, CurveSpec::CurveType> specTypes_;
+    //! Quotes required by each spec, plain names and wildcard patterns
+    std::map<std::string, std::set<std::string>> requiredQuotes_;
+    std::map<std::string, std::vector<std::regex>> requiredQuotePatterns_;
+    //! Yield curve specs built on top of a given yield curve spec
+    std::map<std::string, std::set<std::string>> dependentSpecs_;
 };
 } // namespace data
 } // namespace ore
@@ -16,6 +16,8 @@
  FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
 */
 
+#include <ql/cashflows/fixedratecoupon.hpp>
+#include <ql/cashflows/simplecashflow.hpp>
 #include <ql/currencies/exchangeratemanager.hpp>
 #include <ql/indexes/ibor/usdlibor.hpp>
 #include <ql/math/randomnumbers/haltonrsg.hpp>
@@ -58,6 +60,7 @@
 #include <ored/portfolio/referencedata.hpp>
 #include <ored/utilities/indexparser.hpp>
 #include <ored/utilities/log.hpp>
+#include <ored/utilities/parallel.hpp>
 #include <ored/utilities/parsers.hpp>
 
 using namespace QuantLib;
@@ -171,9 +174,10 @@ YieldCurve::YieldCurve(Date asof, YieldCurveSpec curveSpec, const CurveConfigura
                        const Loader& loader, const Conventions& conventions,
                        const map<string, boost::shared_ptr<YieldCurve>>& requiredYieldCurves,
                        const FXTriangulation& fxTriangulation,
-                       const boost::shared_ptr<ReferenceDataManager>& referenceData)
+                       const boost::shared_ptr<ReferenceDataManager>& referenceData, const Size nThreads)
     : asofDate_(asof), curveSpec_(curveSpec), loader_(loader), conventions_(conventions),
-      requiredYieldCurves_(requiredYieldCurves), fxTriangulation_(fxTriangulation), referenceData_(referenceData) {
+      requiredYieldCurves_(requiredYieldCurves), fxTriangulation_(fxTriangulation), referenceData_(referenceData),
+      nThreads_(nThreads) {
 
     try {
 
@@ -244,6 +248,12 @@ YieldCurve::YieldCurve(Date asof, YieldCurveSpec curveSpec, const CurveConfigura
     LOG("Yield curve " << curveSpec_.name() << " built");
 }
 
+void YieldCurve::relinkTo(const YieldCurve& curve) {
+    QL_REQUIRE(curve.p_, "cannot relink yield curve " << curveSpec_.name() << " to an empty term structure");
+    p_ = curve.p_;
+    h_.linkTo(p_);
+}
+
 boost::shared_ptr<YieldTermStructure>
 YieldCurve::piecewisecurve(const vector<boost::shared_ptr<RateHelper>>& instruments) {
 
@@ -900,9 +910,6 @@ void YieldCurve::buildFittedBondCurve() {
     }
 #endif
 
-    boost::shared_ptr<FittedBondDiscountCurve> tmp, current;
-    Real minError = QL_MAX_REAL;
-    HaltonRsg halton(method->size(), 42);
     // TODO randomised optimisation seeds are only implemented for NelsonSiegel so far
     Size trials = 1;
     if (interpolationMethod_ == InterpolationMethod::NelsonSiegel) {
@@ -912,36 +919,98 @@ void YieldCurve::buildFittedBondCurve() {
             WLOG("randomised optimisation seeds not implemented for given interpolation method");
         }
     }
-    for (Size i = 0; i < trials; ++i) {
-        Array guess;
+
+    // the guesses are drawn upfront, so that each trial has the same guess whatever the number of threads
+    std::vector<Array> guesses(trials);
+    HaltonRsg halton(method->size(), 42);
+    for (Size i = 1; i < trials; ++i) {
         // first guess is the default guess (empty array, will be set to a zero vector in
         // FittedBondDiscountCurve::calculate())
-        if (i > 0) {
-            auto seq = halton.nextSequence();
-            guess = Array(seq.value.begin(), seq.value.end());
-            if (interpolationMethod_ == InterpolationMethod::NelsonSiegel) {
-                guess[0] = guess[0] * 0.10 - 0.05; // long term yield
-                guess[1] = guess[1] * 0.10 - 0.05; // short term component
-                guess[2] = guess[2] * 0.10 - 0.05; // medium term component
-                guess[3] = guess[3] * 5.0;         // decay factor
-            } else {
-                QL_FAIL("randomised optimisation seed not implemented");
+        auto seq = halton.nextSequence();
+        guesses[i] = Array(seq.value.begin(), seq.value.end());
+        if (interpolationMethod_ == InterpolationMethod::NelsonSiegel) {
+            guesses[i][0] = guesses[i][0] * 0.10 - 0.05; // long term yield
+            guesses[i][1] = guesses[i][1] * 0.10 - 0.05; // short term component
+            guesses[i][2] = guesses[i][2] * 0.10 - 0.05; // medium term component
+            guesses[i][3] = guesses[i][3] * 5.0;         // decay factor
+        } else {
+            QL_FAIL("randomised optimisation seed not implemented");
+        }
+    }
+
+    /* The trials are run concurrently if possible. The fitting relinks the term structure handle of the bond
+       helpers, which notifies the helpers' bonds, so each trial gets its own copies of the bonds and helpers and
+       no observable is shared between the trials. The model prices are computed from the bond cashflows, which is
+       only safe for fixed cashflows. If notifications are disabled (e.g. during a batch quote update), deferred
+       notifications are collected globally, so the trials are run sequentially then. */
+    bool fixedCashflows = true;
+    for (auto const& b : bonds) {
+        for (auto const& c : b->cashflows()) {
+            if (!boost::dynamic_pointer_cast<FixedRateCoupon>(c) && !boost::dynamic_pointer_cast<SimpleCashFlow>(c))
+                fixedCashflows = false;
+        }
+    }
+    Size nThreads =
+        fixedCashflows && ObservableSettings::instance().updatesEnabled() ? numberOfThreads(trials, nThreads_) : 1;
+
+    std::vector<std::vector<boost::shared_ptr<BondHelper>>> trialHelpers(nThreads > 1 ? trials : 1, helpers);
+    for (Size i = 1; i < trialHelpers.size(); ++i) {
+        for (Size j = 0; j < helpers.size(); ++j)
+            trialHelpers[i][j] =
+                boost::make_shared<BondHelper>(helpers[j]->quote(), boost::make_shared<QuantLib::Bond>(*bonds[j]));
+    }
+    std::vector<boost::shared_ptr<FittedBondDiscountCurve>> curves(trials);
+    for (Size i = 0; i < trials; ++i) {
+        curves[i] = boost::make_shared<FittedBondDiscountCurve>(
+            asofDate_, trialHelpers[nThreads > 1 ? i : 0], zeroDayCounter_, *method, 1.0e-10, 10000, guesses[i]);
+    }
+
+    // trials after the first one reaching the desired accuracy are skipped, the earlier ones are always run,
+    // so that the result is the same as for a sequential run
+    Real accuracy = curveConfig_->bootstrapConfig().accuracy();
+    std::vector<Real> costs(trials, Null<Real>());
+    std::vector<std::exception_ptr> errors(trials);
+    std::atomic<Size> firstAccurate(trials);
+    auto fit = [&](Size i) {
+        if (i > firstAccurate)
+            return;
+        try {
+            costs[i] = std::sqrt(curves[i]->fitResults().minimumCostValue());
+        } catch (...) {
+            errors[i] = std::current_exception();
+            return;
+        }
+        if (costs[i] < accuracy) {
+            Size current = firstAccurate;
+            while (i < current && !firstAccurate.compare_exchange_weak(current, i)) {
             }
         }
-        current = boost::make_shared<FittedBondDiscountCurve>(asofDate_, helpers, zeroDayCounter_, *method, 1.0e-10,
-                                                              10000, guess);
-        Real cost = std::sqrt(current->fitResults().minimumCostValue());
-        if (cost < minError) {
-            minError = cost;
-            tmp = current;
+    };
+    if (nThreads > 1) {
+        DLOG("running " << trials << " calibration trials on " << nThreads << " threads");
+        parallelFor(trials, fit, nThreads);
+    } else {
+        for (Size i = 0; i < trials && i <= firstAccurate; ++i) {
+            fit(i);
+            if (errors[i])
+                break;
+        }
+    }
+
+    boost::shared_ptr<FittedBondDiscountCurve> tmp;
+    Real minError = QL_MAX_REAL;
+    for (Size i = 0; i < trials && i <= firstAccurate; ++i) {
+        if (errors[i])
+            std::rethrow_exception(errors[i]);
+        if (costs[i] < minError) {
+            minError = costs[i];
+            tmp = curves[i];
         }
-        DLOG("calibration trial #" << (i + 1) << " out of " << trials << ": cost = " << cost
+        DLOG("calibration trial #" << (i + 1) << " out of " << trials << ": cost = " << costs[i]
                                    << ", best so far = " << minError);
-        if (cost < curveConfig_->bootstrapConfig().accuracy()) {
-            DLOG("reached desired accuracy (" << curveConfig_->bootstrapConfig().accuracy()
-                                              << ") - do not attempt more calibrations");
-            break;
-        }
+    }
+    if (firstAccurate < trials) {
+        DLOG("reached desired accuracy (" << accuracy << ") - do not attempt more calibrations");
     }
     QL_REQUIRE(tmp, "no best solution found for fitted bond curve - this is unexpected.");
 
@@ -87,7 +87,9 @@ public:
         //! FxTriangultion to get FX rate from cross if needed
         const FXTriangulation& fxTriangulation = FXTriangulation(),
         //! optional pointer to reference data, needed to build fitted bond curves
-        const boost::shared_ptr<ReferenceDataManager>& referenceData = nullptr);
+        const boost::shared_ptr<ReferenceDataManager>& referenceData = nullptr,
+        //! maximum number of threads for the calibration trials of fitted bond curves, zero means hardware threads
+        const Size nThreads = 0);
 
     //! \name Inspectors
     //@{
@@ -96,6 +98,13 @@ public:
     const Date& asofDate() const { return asofDate_; }
     const Currency& currency() const { return currency_; }
     //@}
+
+    //! \name Modifiers
+    //@{
+    /*! Relink this curve's handle to the term structure built by \p curve, e.g. a rebuild of this curve on
+        updated quotes. Everything holding the handle picks up the new term structure. */
+    void relinkTo(const YieldCurve& curve);
+    //@}
 private:
     Date asofDate_;
     Currency currency_;
@@ -128,6 +137,7 @@ private:
     map<string, boost::shared_ptr<YieldCurve>> requiredYieldCurves_;
     const FXTriangulation& fxTriangulation_;
     const boost::shared_ptr<ReferenceDataManager> referenceData_;
+    const Size nThreads_;
 
     boost::shared_ptr<YieldTermStructure> piecewisecurve(const vector<boost::shared_ptr<RateHelper>>& instruments);
 
@@ -29,6 +29,14 @@
 #include <ql/cashflows/inflationcouponpricer.hpp>
 #include <qle/cashflows/cpicouponpricer.hpp>
 
+#include <boost/functional/hash.hpp>
+#include <boost/timer/timer.hpp>
+
+#include <exception>
+#include <future>
+#include <mutex>
+#include <unordered_map>
+
 namespace ore {
 namespace data {
 
@@ -41,7 +49,16 @@ namespace data {
  *  if so it is returned, otherwise a new engine or coupon pricer is created, stored and
  *  returned.
  *
- *  The first template argument is the cache key type (e.g. a std::string)
+ *  The cache can be used from several threads. The first request for a key inserts a placeholder for the engine
+ *  under a short lock on the cache of this builder and builds the engine without holding that lock. Later requests
+ *  for the same key wait for this build, so each key is built exactly once, while engines for different keys are
+ *  built concurrently. keyImpl() and engineImpl() must therefore not modify the state of the builder other than
+ *  through addModelBuilder() or under a lock of their own, and an engine must not request an engine for its own key
+ *  from the same builder. If a build fails, the requests waiting for
+ *  it see the same error and the next request builds the engine again. The numbers of hits and misses and the
+ *  time spent building engines are reported by statistics().
+ *
+ *  The first template argument is the cache key type (e.g. a std::string), it must be hashable by boost::hash.
  *  The second template argument is PricingEngine or FloatingRateCouponPricer
  *  The remaining variable arguments are to be passed to engine() and
  *  engineImpl(), these are the specific parameters required to build
@@ -58,23 +75,66 @@ public:
     CachingEngineBuilder(const string& model, const string& engine, const set<string>& tradeTypes)
         : EngineBuilder(model, engine, tradeTypes) {}
 
-    //! Return a PricingEngine or a FloatingRateCouponPricer
+    //! Return a PricingEngine or a FloatingRateCouponPricer, this method can be called from several threads
     boost::shared_ptr<U> engine(Args... params) {
         T key = keyImpl(params...);
-        if (engines_.find(key) == engines_.end()) {
-            // build first (in case it throws)
-            boost::shared_ptr<U> engine = engineImpl(params...);
-            // then add to map
-            engines_[key] = engine;
+        std::promise<boost::shared_ptr<U>> promise;
+        std::shared_future<boost::shared_ptr<U>> future;
+        {
+            std::lock_guard<std::mutex> cacheLock(cacheMutex_);
+            auto it = engines_.find(key);
+            if (it != engines_.end()) {
+                ++hits_;
+                future = it->second;
+            } else {
+                engines_.insert(std::make_pair(key, promise.get_future().share()));
+            }
         }
-        return engines_[key];
+        // the engine is built or being built by another request
+        if (future.valid())
+            return future.get();
+        boost::shared_ptr<U> engine;
+        try {
+            ActiveBuild build(*this);
+            boost::timer::cpu_timer timer;
+            engine = engineImpl(params...);
+            std::lock_guard<std::mutex> cacheLock(cacheMutex_);
+            buildTime_ += timer.elapsed().wall;
+            ++misses_;
+        } catch (...) {
+            // remove the placeholder, so that the next request builds the engine again
+            {
+                std::lock_guard<std::mutex> cacheLock(cacheMutex_);
+                engines_.erase(key);
+            }
+            promise.set_exception(std::current_exception());
+            throw;
+        }
+        promise.set_value(engine);
+        return engine;
+    }
+
+    EngineBuilderStatistics statistics() const override {
+        std::lock_guard<std::mutex> cacheLock(cacheMutex_);
+        EngineBuilderStatistics stats;
+        stats.hits = hits_;
+        stats.misses = misses_;
+        stats.engines = engines_.size();
+        stats.buildTime = static_cast<QuantLib::Real>(buildTime_) * 1.0E-9;
+        return stats;
     }
 
 protected:
     virtual T keyImpl(Args...) = 0;
     virtual boost::shared_ptr<U> engineImpl(Args...) = 0;
 
-    map<T, boost::shared_ptr<U>> engines_;
+private:
+    // guards all members below
+    mutable std::mutex cacheMutex_;
+    std::unordered_map<T, std::shared_future<boost::shared_ptr<U>>, boost::hash<T>> engines_;
+    QuantLib::Size hits_ = 0;
+    QuantLib::Size misses_ = 0;
+    boost::timer::nanosecond_type buildTime_ = 0;
 };
 
 template <class T, typename... Args>
@@ -29,19 +29,12 @@ namespace data {
 boost::shared_ptr<FloatingRateCouponPricer>
 CapFlooredOvernightIndexedCouponLegEngineBuilder::engineImpl(const Currency& ccy) {
 
-    // Check if we already have a pricer for this ccy
+    // the pricer is cached by ccy in CachingEngineBuilder::engine()
     const string& ccyCode = ccy.code();
-    if (engines_.find(ccyCode) == engines_.end()) {
-        Handle<YieldTermStructure> yts = market_->discountCurve(ccyCode, configuration(MarketContext::pricing));
-        QL_REQUIRE(!yts.empty(), "engineFactory error: yield term structure not found for currency " << ccyCode);
-        Handle<OptionletVolatilityStructure> ovs = market_->capFloorVol(ccyCode, configuration(MarketContext::pricing));
-        boost::shared_ptr<FloatingRateCouponPricer> pricer =
-            boost::make_shared<QuantExt::BlackOvernightIndexedCouponPricer>(ovs);
-        engines_[ccyCode] = pricer;
-    }
-
-    // Return the cached pricer
-    return engines_[ccyCode];
+    Handle<YieldTermStructure> yts = market_->discountCurve(ccyCode, configuration(MarketContext::pricing));
+    QL_REQUIRE(!yts.empty(), "engineFactory error: yield term structure not found for currency " << ccyCode);
+    Handle<OptionletVolatilityStructure> ovs = market_->capFloorVol(ccyCode, configuration(MarketContext::pricing));
+    return boost::make_shared<QuantExt::BlackOvernightIndexedCouponPricer>(ovs);
 }
 } // namespace data
 } // namespace ore
@@ -93,6 +93,15 @@ inline bool operator==(const CDSEngineKey& lhs, const CDSEngineKey& rhs) {
     }
 }
 
+//! Hash of a CDSEngineKey, consistent with operator== which compares recovery rates up to a tolerance
+inline std::size_t hash_value(const CDSEngineKey& key) {
+    std::size_t seed = 0;
+    boost::hash_combine(seed, key.creditCurveId());
+    boost::hash_combine(seed, key.currency().code());
+    boost::hash_combine(seed, key.recoveryRate() == QuantLib::Null<QuantLib::Real>());
+    return seed;
+}
+
 inline bool operator<(const CDSEngineKey& lhs, const CDSEngineKey& rhs) {
 
     // Check equality first
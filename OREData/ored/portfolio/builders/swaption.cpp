@@ -46,15 +46,58 @@ boost::shared_ptr<PricingEngine> EuropeanSwaptionEngineBuilder::engineImpl(const
     }
 }
 
+string LGMBermudanSwaptionEngineBuilder::modelKey(const string& id, const string& ccy,
+                                                  const std::vector<Date>& expiries, const Date& maturity,
+                                                  const std::vector<Real>& strikes) {
+    string sharing = modelParameter("ModelSharing", "", false, "Trade");
+    if (sharing == "Trade")
+        return id;
+    if (sharing == "Currency")
+        return ccy;
+    QL_REQUIRE(sharing == "Basket", "ModelSharing (" << sharing << ") must be Trade, Basket or Currency");
+    std::ostringstream key;
+    key << ccy << "_" << QuantLib::io::iso_date(maturity);
+    for (auto const& d : expiries)
+        key << "_" << QuantLib::io::iso_date(d);
+    if (parseCalibrationStrategy(modelParameter("CalibrationStrategy")) == CalibrationStrategy::CoterminalDealStrike) {
+        for (auto const& k : strikes)
+            key << "_" << (k == Null<Real>() ? string("ATM") : std::to_string(k));
+    }
+    return key.str();
+}
+
+string LGMBermudanSwaptionEngineBuilder::keyImpl(const string& id, const bool isNonStandard, const string& ccy,
+                                                 const std::vector<Date>& dates, const Date& maturity,
+                                                 const std::vector<Real>& strikes) {
+    string key = modelKey(id, ccy, dates, maturity, strikes);
+    // a trade specific engine is keyed by the trade id as before, shared engines by model and engine type
+    if (key == id)
+        return key;
+    return key + (isNonStandard ? "_NonStandard" : "_Standard");
+}
+
 boost::shared_ptr<QuantExt::LGM> LGMBermudanSwaptionEngineBuilder::model(const string& id, bool isNonStandard,
                                                                          const string& ccy,
                                                                          const std::vector<Date>& expiries,
                                                                          const Date& maturity,
                                                                          const std::vector<Real>& strikes) {
 
+    string key = modelKey(id, ccy, expiries, maturity, strikes);
+    {
+        std::lock_guard<std::mutex> lock(modelsMutex_);
+        auto m = models_.find(key);
+        if (m != models_.end()) {
+            DLOG("Use shared LGM model " << key << " for trade " << id);
+            return m->second;
+        }
+    }
+
     DLOG("Get model data");
     auto calibration = parseCalibrationType(modelParameter("Calibration"));
     auto calibrationStrategy = parseCalibrationStrategy(modelParameter("CalibrationStrategy"));
+    QL_REQUIRE(modelParameter("ModelSharing", "", false, "Trade") != "Currency" ||
+                   calibration == CalibrationType::None,
+               "ModelSharing Currency requires Calibration None, got " << calibration);
     std::string referenceCalibrationGrid = modelParameter("ReferenceCalibrationGrid", "", false, "");
     Real lambda = parseReal(modelParameter("Reversion", ccy));
     vector<Real> sigma = parseListOfValues<Real>(modelParameter("Volatility"), &parseReal);
@@ -159,9 +202,11 @@ boost::shared_ptr<QuantExt::LGM> LGMBermudanSwaptionEngineBuilder::model(const s
         model = calib->model();
         calib->unfreeze();
     }
-    modelBuilders_.insert(std::make_pair(id, calib));
+    addModelBuilder(key, calib);
 
-    return model;
+    // the engines of a standard and a non-standard swaption may have built the same model concurrently
+    std::lock_guard<std::mutex> lock(modelsMutex_);
+    return models_.insert(std::make_pair(key, model)).first->second;
 }
 
 boost::shared_ptr<PricingEngine> LGMGridBermudanSwaptionEngineBuilder::engineImpl(const string& id, bool isNonStandard,
@@ -182,11 +227,15 @@ boost::shared_ptr<PricingEngine> LGMGridBermudanSwaptionEngineBuilder::engineImp
     // Build engine
     DLOG("Build engine (configuration " << configuration(MarketContext::pricing) << ")");
     Handle<YieldTermStructure> dscCurve = market_->discountCurve(ccy, configuration(MarketContext::pricing));
+    // the convolution matrices are only reused if the engine is shared by several trades
+    bool cacheConvolutions = modelKey(id, ccy, expiries, maturity, strikes) != id;
     boost::shared_ptr<PricingEngine> p;
     if (isNonStandard)
-        return boost::make_shared<QuantExt::NumericLgmNonstandardSwaptionEngine>(lgm, sy, ny, sx, nx, dscCurve);
+        return boost::make_shared<QuantExt::NumericLgmNonstandardSwaptionEngine>(lgm, sy, ny, sx, nx, dscCurve,
+                                                                                  cacheConvolutions);
     else
-        return boost::make_shared<QuantExt::NumericLgmSwaptionEngine>(lgm, sy, ny, sx, nx, dscCurve);
+        return boost::make_shared<QuantExt::NumericLgmSwaptionEngine>(lgm, sy, ny, sx, nx, dscCurve,
+                                                                       cacheConvolutions);
 }
 
 } // namespace data
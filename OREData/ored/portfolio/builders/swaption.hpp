@@ -31,6 +31,8 @@
 
 #include <boost/make_shared.hpp>
 
+#include <mutex>
+
 namespace ore {
 namespace data {
 
@@ -79,6 +81,15 @@ protected:
 //! Abstract LGMBermudanSwaptionEngineBuilder class
 /*! This defines the interface for LGM Bermudan Swaption Builders
 
+    The optional model parameter ModelSharing controls which trades share a model and an engine
+    - Trade (default): each trade gets its own model and engine
+    - Basket: trades with the same currency and calibration basket (expiries, underlying maturity and, for
+      CoterminalDealStrike calibration, strikes) share one model and engine
+    - Currency: all trades in a currency share one model and engine, this requires Calibration None
+
+    Trades sharing an engine also share its grid and convolution matrices, see QuantExt::LgmConvolutionSolver. The
+    convolution matrices are only cached by shared engines.
+
 \ingroup builders
 */
 class LGMBermudanSwaptionEngineBuilder : public BermudanSwaptionEngineBuilder {
@@ -86,9 +97,21 @@ public:
     LGMBermudanSwaptionEngineBuilder(const string& engine) : BermudanSwaptionEngineBuilder("LGM", engine) {}
 
 protected:
+    virtual string keyImpl(const string& id, const bool isNonStandard, const string& ccy,
+                           const std::vector<Date>& dates, const Date& maturity,
+                           const std::vector<Real>& strikes) override;
+
     boost::shared_ptr<QuantExt::LGM> model(const string& id, bool isNonStandard, const string& ccy,
                                            const std::vector<Date>& dates, const Date& maturity,
                                            const std::vector<Real>& strikes);
+
+    //! the key identifying the model of a trade, depending on ModelSharing, this is the trade id if it is not shared
+    string modelKey(const string& id, const string& ccy, const std::vector<Date>& dates, const Date& maturity,
+                    const std::vector<Real>& strikes);
+
+private:
+    std::map<string, boost::shared_ptr<QuantExt::LGM>> models_;
+    std::mutex modelsMutex_;
 };
 
 //! Implementation of BermudanSwaptionEngineBuilder using LGM Grid pricer
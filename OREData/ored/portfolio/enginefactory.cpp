@@ -42,6 +42,8 @@
 #include <ored/portfolio/legbuilders.hpp>
 #include <ored/utilities/log.hpp>
 
+#include <sstream>
+
 namespace ore {
 namespace data {
 
@@ -121,6 +123,27 @@ boost::shared_ptr<EngineBuilder> EngineFactory::builder(const string& tradeType)
     return builder;
 }
 
+map<tuple<string, string, set<string>>, EngineBuilderStatistics> EngineFactory::statistics() const {
+    map<tuple<string, string, set<string>>, EngineBuilderStatistics> result;
+    for (auto const& b : builders_)
+        result[b.first] = b.second->statistics();
+    return result;
+}
+
+void EngineFactory::logStatistics() const {
+    for (auto const& s : statistics()) {
+        const EngineBuilderStatistics& stats = s.second;
+        if (stats.hits + stats.misses == 0)
+            continue;
+        std::ostringstream tradeTypes;
+        for (auto const& t : std::get<2>(s.first))
+            tradeTypes << (tradeTypes.tellp() > 0 ? "," : "") << t;
+        LOG("EngineBuilder " << std::get<0>(s.first) << "/" << std::get<1>(s.first) << " (" << tradeTypes.str()
+                             << "): " << stats.engines << " engines, " << stats.hits << " hits, " << stats.misses
+                             << " misses, build time " << stats.buildTime << "s");
+    }
+}
+
 void EngineFactory::registerLegBuilder(const boost::shared_ptr<LegBuilder>& legBuilder) {
     DLOG("EngineFactory registering builder for leg type " << legBuilder->legType());
     legBuilders_[legBuilder->legType()] = legBuilder;
@@ -33,7 +33,9 @@
 
 #include <boost/shared_ptr.hpp>
 
+#include <condition_variable>
 #include <map>
+#include <mutex>
 #include <set>
 #include <vector>
 
@@ -58,6 +60,18 @@ class ReferenceDataManager;
   portfolio subset. */
 enum class MarketContext { irCalibration, fxCalibration, eqCalibration, pricing };
 
+//! Statistics on the engine requests served by an EngineBuilder
+struct EngineBuilderStatistics {
+    //! Number of requests served from the builder's cache
+    QuantLib::Size hits = 0;
+    //! Number of requests that built a new engine
+    QuantLib::Size misses = 0;
+    //! Number of engines held by the builder
+    QuantLib::Size engines = 0;
+    //! Total time spent building engines, in seconds
+    QuantLib::Real buildTime = 0.0;
+};
+
 //! Base PricingEngine Builder class for a specific model and engine
 /*!
  *  The EngineBuilder is responsible for building pricing engines for a specific
@@ -127,6 +141,13 @@ public:
     void init(const boost::shared_ptr<Market> market, const map<MarketContext, string>& configurations,
               const map<string, string>& modelParameters, const map<string, string>& engineParameters,
               const std::map<std::string, std::string>& globalParameters = {}) {
+        // the builder may be building engines on other threads (see CachingEngineBuilder), its state is only
+        // changed once these builds are done
+        std::unique_lock<std::mutex> lock(stateMutex_);
+        if (market_ == market && configurations_ == configurations && modelParameters_ == modelParameters &&
+            engineParameters_ == engineParameters && globalParameters_ == globalParameters)
+            return;
+        buildsDone_.wait(lock, [this] { return activeBuilds_ == 0; });
         market_ = market;
         configurations_ = configurations;
         modelParameters_ = modelParameters;
@@ -137,6 +158,9 @@ public:
     //! return model builders
     const set<std::pair<string, boost::shared_ptr<ModelBuilder>>>& modelBuilders() const { return modelBuilders_; }
 
+    //! Return statistics on the engines requested from this builder, if the builder keeps track of them
+    virtual EngineBuilderStatistics statistics() const { return EngineBuilderStatistics(); }
+
 protected:
     /*! retrieve engine parameter p, first look for p_qualifier, if this does not exist fall back to p */
     std::string engineParameter(const std::string& p, const std::string qualifier = "", const bool mandatory = true,
@@ -144,6 +168,30 @@ protected:
     /*! retrieve model parameter p, first look for p_qualifier, if this does not exist fall back to p */
     std::string modelParameter(const std::string& p, const std::string qualifier = "", const bool mandatory = true,
                                const std::string& defaultValue = "");
+
+    //! Adds a model builder, this can be called while engines are built on several threads
+    void addModelBuilder(const string& key, const boost::shared_ptr<ModelBuilder>& modelBuilder) {
+        std::lock_guard<std::mutex> lock(stateMutex_);
+        modelBuilders_.insert(std::make_pair(key, modelBuilder));
+    }
+
+    //! Marks an engine build in progress, init() does not change the builder state until it is destroyed
+    class ActiveBuild {
+    public:
+        explicit ActiveBuild(EngineBuilder& builder) : builder_(builder) {
+            std::lock_guard<std::mutex> lock(builder_.stateMutex_);
+            ++builder_.activeBuilds_;
+        }
+        ~ActiveBuild() {
+            std::lock_guard<std::mutex> lock(builder_.stateMutex_);
+            if (--builder_.activeBuilds_ == 0)
+                builder_.buildsDone_.notify_all();
+        }
+
+    private:
+        EngineBuilder& builder_;
+    };
+
     string model_;
     string engine_;
     set<string> tradeTypes_;
@@ -153,6 +201,12 @@ protected:
     map<string, string> engineParameters_;
     std::map<std::string, std::string> globalParameters_;
     set<std::pair<string, boost::shared_ptr<ModelBuilder>>> modelBuilders_;
+
+private:
+    // guards activeBuilds_, the assignments in init() and addModelBuilder()
+    std::mutex stateMutex_;
+    std::condition_variable buildsDone_;
+    QuantLib::Size activeBuilds_ = 0;
 };
 
 //! Pricing Engine Factory class
@@ -234,6 +288,11 @@ public:
     //! return model builders
     Disposable<set<std::pair<string, boost::shared_ptr<ModelBuilder>>>> modelBuilders() const;
 
+    //! Return the engine statistics of the registered builders, keyed by model, engine and trade types
+    map<tuple<string, string, set<string>>, EngineBuilderStatistics> statistics() const;
+    //! Write the engine statistics of all builders that have been asked for engines to the log
+    void logStatistics() const;
+
 private:
     boost::shared_ptr<Market> market_;
     boost::shared_ptr<EngineData> engineData_;
@@ -23,6 +23,9 @@
 
 #pragma once
 
+#include <boost/serialization/map.hpp>
+#include <boost/serialization/set.hpp>
+#include <boost/serialization/string.hpp>
 #include <map>
 #include <ored/utilities/xmlutils.hpp>
 #include <set>
@@ -89,6 +92,14 @@ private:
     string nettingSetId_;
     set<string> portfolioIds_;
     map<string, string> additionalFields_;
+    //! Serialization
+    friend class boost::serialization::access;
+    template <class Archive> void serialize(Archive& ar, const unsigned int version) {
+        ar& counterparty_;
+        ar& nettingSetId_;
+        ar& portfolioIds_;
+        ar& additionalFields_;
+    }
 };
 } // namespace data
 } // namespace ore
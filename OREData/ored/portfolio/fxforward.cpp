@@ -16,6 +16,8 @@
  FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
 */
 
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
 #include <boost/make_shared.hpp>
 #include <ored/portfolio/builders/fxforward.hpp>
 #include <ored/portfolio/enginefactory.hpp>
@@ -101,3 +103,5 @@ XMLNode* FxForward::toXML(XMLDocument& doc) {
 }
 } // namespace data
 } // namespace ore
+
+BOOST_CLASS_EXPORT_GUID(ore::data::FxForward, "FxForward");
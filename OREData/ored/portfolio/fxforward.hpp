@@ -69,6 +69,17 @@ private:
     string soldCurrency_;
     double soldAmount_;
     string settlement_;
+    //! Serialization
+    friend class boost::serialization::access;
+    template <class Archive> void serialize(Archive& ar, const unsigned int version) {
+        ar& boost::serialization::base_object<Trade>(*this);
+        ar& maturityDate_;
+        ar& boughtCurrency_;
+        ar& boughtAmount_;
+        ar& soldCurrency_;
+        ar& soldAmount_;
+        ar& settlement_;
+    }
 };
 } // namespace data
 } // namespace ore
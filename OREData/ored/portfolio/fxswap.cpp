@@ -16,6 +16,8 @@
  FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
 */
 
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
 #include <ored/portfolio/builders/fxforward.hpp>
 #include <ored/portfolio/enginefactory.hpp>
 #include <ored/portfolio/fxswap.hpp>
@@ -132,3 +134,5 @@ XMLNode* FxSwap::toXML(XMLDocument& doc) {
 }
 } // namespace data
 } // namespace ore
+
+BOOST_CLASS_EXPORT_GUID(ore::data::FxSwap, "FxSwap");
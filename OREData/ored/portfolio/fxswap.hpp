@@ -82,6 +82,20 @@ private:
     double farBoughtAmount_;
     double farSoldAmount_;
     string settlement_;
+    //! Serialization
+    friend class boost::serialization::access;
+    template <class Archive> void serialize(Archive& ar, const unsigned int version) {
+        ar& boost::serialization::base_object<Trade>(*this);
+        ar& nearDate_;
+        ar& farDate_;
+        ar& nearBoughtCurrency_;
+        ar& nearBoughtAmount_;
+        ar& nearSoldCurrency_;
+        ar& nearSoldAmount_;
+        ar& farBoughtAmount_;
+        ar& farSoldAmount_;
+        ar& settlement_;
+    }
 };
 } // namespace data
 } // namespace ore
@@ -113,6 +113,24 @@ private:
     string fixingCalendar_;
     string fixingConvention_;
     bool inArrearsFixing_;
+    //! Serialization
+    friend class boost::serialization::access;
+    template <class Archive> void serialize(Archive& ar, const unsigned int version) {
+        ar& hasData_;
+        ar& quantity_;
+        ar& index_;
+        ar& indexFixingDays_;
+        ar& indexFixingCalendar_;
+        ar& indexIsDirty_;
+        ar& indexIsRelative_;
+        ar& indexIsConditionalOnSurvival_;
+        ar& initialFixing_;
+        ar& valuationSchedule_;
+        ar& fixingDays_;
+        ar& fixingCalendar_;
+        ar& fixingConvention_;
+        ar& inArrearsFixing_;
+    }
 };
 
 } // namespace data
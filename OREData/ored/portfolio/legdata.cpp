@@ -29,6 +29,8 @@
 #include <ored/utilities/marketdata.hpp>
 #include <ored/utilities/to_string.hpp>
 
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
 #include <boost/make_shared.hpp>
 #include <ql/cashflow.hpp>
 #include <ql/cashflows/averagebmacoupon.hpp>
@@ -711,7 +713,8 @@ Leg makeFixedLeg(const LegData& data) {
     boost::shared_ptr<FixedLegData> fixedLegData = boost::dynamic_pointer_cast<FixedLegData>(data.concreteLegData());
     QL_REQUIRE(fixedLegData, "Wrong LegType, expected Fixed, got " << data.legType());
 
-    Schedule schedule = makeSchedule(data.schedule());
+    boost::shared_ptr<const Schedule> sharedSchedule = makeSharedSchedule(data.schedule());
+    const Schedule& schedule = *sharedSchedule;
     DayCounter dc = parseDayCounter(data.dayCounter());
     BusinessDayConvention bdc = parseBusinessDayConvention(data.paymentConvention());
     Calendar paymentCalendar = schedule.calendar();
@@ -733,7 +736,8 @@ Leg makeZCFixedLeg(const LegData& data) {
         boost::dynamic_pointer_cast<ZeroCouponFixedLegData>(data.concreteLegData());
     QL_REQUIRE(zcFixedLegData, "Wrong LegType, expected Zero Coupon Fixed, got " << data.legType());
 
-    Schedule schedule = makeSchedule(data.schedule());
+    boost::shared_ptr<const Schedule> sharedSchedule = makeSharedSchedule(data.schedule());
+    const Schedule& schedule = *sharedSchedule;
     DayCounter dc = parseDayCounter(data.dayCounter());
     BusinessDayConvention bdc = parseBusinessDayConvention(data.paymentConvention());
     // check we have a single notional and two dates in the schedule
@@ -789,7 +793,8 @@ Leg makeIborLeg(const LegData& data, const boost::shared_ptr<IborIndex>& index,
     boost::shared_ptr<FloatingLegData> floatData = boost::dynamic_pointer_cast<FloatingLegData>(data.concreteLegData());
     QL_REQUIRE(floatData, "Wrong LegType, expected Floating, got " << data.legType());
 
-    Schedule schedule = makeSchedule(data.schedule());
+    boost::shared_ptr<const Schedule> sharedSchedule = makeSharedSchedule(data.schedule());
+    const Schedule& schedule = *sharedSchedule;
     DayCounter dc = parseDayCounter(data.dayCounter());
     BusinessDayConvention bdc = parseBusinessDayConvention(data.paymentConvention());
 
@@ -922,7 +927,8 @@ Leg makeOISLeg(const LegData& data, const boost::shared_ptr<OvernightIndex>& ind
     boost::shared_ptr<FloatingLegData> floatData = boost::dynamic_pointer_cast<FloatingLegData>(data.concreteLegData());
     QL_REQUIRE(floatData, "Wrong LegType, expected Floating, got " << data.legType());
 
-    Schedule schedule = makeSchedule(data.schedule());
+    boost::shared_ptr<const Schedule> sharedSchedule = makeSharedSchedule(data.schedule());
+    const Schedule& schedule = *sharedSchedule;
     DayCounter dc = parseDayCounter(data.dayCounter());
     BusinessDayConvention bdc = parseBusinessDayConvention(data.paymentConvention());
     Natural paymentLag = data.paymentLag();
@@ -1003,7 +1009,8 @@ Leg makeBMALeg(const LegData& data, const boost::shared_ptr<QuantExt::BMAIndexWr
     if (floatData->caps().size() > 0 || floatData->floors().size() > 0)
         QL_FAIL("Caps and floors are not supported for BMA legs");
 
-    Schedule schedule = makeSchedule(data.schedule());
+    boost::shared_ptr<const Schedule> sharedSchedule = makeSharedSchedule(data.schedule());
+    const Schedule& schedule = *sharedSchedule;
     DayCounter dc = parseDayCounter(data.dayCounter());
     BusinessDayConvention bdc = parseBusinessDayConvention(data.paymentConvention());
 
@@ -1086,7 +1093,8 @@ Leg makeCPILeg(const LegData& data, const boost::shared_ptr<ZeroInflationIndex>&
     boost::shared_ptr<CPILegData> cpiLegData = boost::dynamic_pointer_cast<CPILegData>(data.concreteLegData());
     QL_REQUIRE(cpiLegData, "Wrong LegType, expected CPI, got " << data.legType());
 
-    Schedule schedule = makeSchedule(data.schedule());
+    boost::shared_ptr<const Schedule> sharedSchedule = makeSharedSchedule(data.schedule());
+    const Schedule& schedule = *sharedSchedule;
     DayCounter dc = parseDayCounter(data.dayCounter());
     BusinessDayConvention bdc = parseBusinessDayConvention(data.paymentConvention());
     Period observationLag = parsePeriod(cpiLegData->observationLag());
@@ -1206,7 +1214,8 @@ Leg makeYoYLeg(const LegData& data, const boost::shared_ptr<YoYInflationIndex>&
     boost::shared_ptr<YoYLegData> yoyLegData = boost::dynamic_pointer_cast<YoYLegData>(data.concreteLegData());
     QL_REQUIRE(yoyLegData, "Wrong LegType, expected YoY, got " << data.legType());
 
-    Schedule schedule = makeSchedule(data.schedule());
+    boost::shared_ptr<const Schedule> sharedSchedule = makeSharedSchedule(data.schedule());
+    const Schedule& schedule = *sharedSchedule;
     DayCounter dc = parseDayCounter(data.dayCounter());
     BusinessDayConvention bdc = parseBusinessDayConvention(data.paymentConvention());
     Period observationLag = parsePeriod(yoyLegData->observationLag());
@@ -1273,7 +1282,8 @@ Leg makeCMSLeg(const LegData& data, const boost::shared_ptr<QuantLib::SwapIndex>
     boost::shared_ptr<CMSLegData> cmsData = boost::dynamic_pointer_cast<CMSLegData>(data.concreteLegData());
     QL_REQUIRE(cmsData, "Wrong LegType, expected CMS, got " << data.legType());
 
-    Schedule schedule = makeSchedule(data.schedule());
+    boost::shared_ptr<const Schedule> sharedSchedule = makeSharedSchedule(data.schedule());
+    const Schedule& schedule = *sharedSchedule;
     DayCounter dc = parseDayCounter(data.dayCounter());
     BusinessDayConvention bdc = parseBusinessDayConvention(data.paymentConvention());
     bool couponCapFloor = cmsData->caps().size() > 0 || cmsData->floors().size() > 0;
@@ -1350,7 +1360,8 @@ Leg makeCMSSpreadLeg(const LegData& data, const boost::shared_ptr<QuantLib::Swap
         boost::dynamic_pointer_cast<CMSSpreadLegData>(data.concreteLegData());
     QL_REQUIRE(cmsSpreadData, "Wrong LegType, expected CMSSpread, got " << data.legType());
 
-    Schedule schedule = makeSchedule(data.schedule());
+    boost::shared_ptr<const Schedule> sharedSchedule = makeSharedSchedule(data.schedule());
+    const Schedule& schedule = *sharedSchedule;
     DayCounter dc = parseDayCounter(data.dayCounter());
     BusinessDayConvention bdc = parseBusinessDayConvention(data.paymentConvention());
     vector<double> spreads = ore::data::buildScheduledVectorNormalised(cmsSpreadData->spreads(),
@@ -1423,7 +1434,8 @@ Leg makeDigitalCMSSpreadLeg(const LegData& data, const boost::shared_ptr<QuantLi
     auto cmsSpreadData = boost::dynamic_pointer_cast<CMSSpreadLegData>(digitalCmsSpreadData->underlying());
     QL_REQUIRE(cmsSpreadData, "Incomplete DigitalCmsSpread Leg, expected CMSSpread data");
 
-    Schedule schedule = makeSchedule(data.schedule());
+    boost::shared_ptr<const Schedule> sharedSchedule = makeSharedSchedule(data.schedule());
+    const Schedule& schedule = *sharedSchedule;
     DayCounter dc = parseDayCounter(data.dayCounter());
     BusinessDayConvention bdc = parseBusinessDayConvention(data.paymentConvention());
     vector<double> spreads = ore::data::buildScheduledVectorNormalised(cmsSpreadData->spreads(),
@@ -1502,7 +1514,8 @@ Leg makeEquityLeg(const LegData& data, const boost::shared_ptr<EquityIndex>& equ
     boost::shared_ptr<EquityLegData> eqLegData = boost::dynamic_pointer_cast<EquityLegData>(data.concreteLegData());
     QL_REQUIRE(eqLegData, "Wrong LegType, expected Equity, got " << data.legType());
 
-    Schedule schedule = makeSchedule(data.schedule());
+    boost::shared_ptr<const Schedule> sharedSchedule = makeSharedSchedule(data.schedule());
+    const Schedule& schedule = *sharedSchedule;
     DayCounter dc = parseDayCounter(data.dayCounter());
     BusinessDayConvention bdc = parseBusinessDayConvention(data.paymentConvention());
     bool isTotalReturn = eqLegData->returnType() == "Total";
@@ -1892,3 +1905,9 @@ Leg joinLegs(const std::vector<Leg>& legs) {
 
 } // namespace data
 } // namespace ore
+
+BOOST_CLASS_EXPORT_GUID(ore::data::CashflowData, "CashflowLegData");
+BOOST_CLASS_EXPORT_GUID(ore::data::FixedLegData, "FixedLegData");
+BOOST_CLASS_EXPORT_GUID(ore::data::ZeroCouponFixedLegData, "ZeroCouponFixedLegData");
+BOOST_CLASS_EXPORT_GUID(ore::data::FloatingLegData, "FloatingLegData");
+BOOST_CLASS_EXPORT_GUID(ore::data::CMSLegData, "CMSLegData");
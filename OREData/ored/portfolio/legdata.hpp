@@ -24,12 +24,17 @@
 #pragma once
 
 #include <boost/make_shared.hpp>
+#include <boost/serialization/base_object.hpp>
+#include <boost/serialization/export.hpp>
+#include <boost/serialization/set.hpp>
+#include <boost/serialization/shared_ptr.hpp>
 #include <ored/portfolio/indexing.hpp>
 #include <ored/portfolio/legdatafactory.hpp>
 #include <ored/portfolio/schedule.hpp>
 #include <ored/portfolio/underlying.hpp>
 #include <ored/utilities/indexparser.hpp>
 #include <ored/utilities/parsers.hpp>
+#include <ored/utilities/serializationperiod.hpp>
 
 #include <ql/cashflow.hpp>
 #include <ql/experimental/coupons/swapspreadindex.hpp>
@@ -74,6 +79,13 @@ protected:
 private:
     string legType_;
     string legNodeName_; // the XML node name
+    //! Serialization
+    friend class boost::serialization::access;
+    template <class Archive> void serialize(Archive& ar, const unsigned int version) {
+        ar& indices_;
+        ar& legType_;
+        ar& legNodeName_;
+    }
 };
 
 //! Serializable Cashflow Leg Data
@@ -105,6 +117,13 @@ private:
     vector<string> dates_;
 
     static LegDataRegister<CashflowData> reg_;
+    //! Serialization
+    friend class boost::serialization::access;
+    template <class Archive> void serialize(Archive& ar, const unsigned int version) {
+        ar& boost::serialization::base_object<LegAdditionalData>(*this);
+        ar& amounts_;
+        ar& dates_;
+    }
 };
 
 //! Serializable Fixed Leg Data
@@ -135,6 +154,13 @@ private:
     vector<string> rateDates_;
 
     static LegDataRegister<FixedLegData> reg_;
+    //! Serialization
+    friend class boost::serialization::access;
+    template <class Archive> void serialize(Archive& ar, const unsigned int version) {
+        ar& boost::serialization::base_object<LegAdditionalData>(*this);
+        ar& rates_;
+        ar& rateDates_;
+    }
 };
 
 //! Serializable Fixed Leg Data
@@ -171,6 +197,15 @@ private:
     bool subtractNotional_;
 
     static LegDataRegister<ZeroCouponFixedLegData> reg_;
+    //! Serialization
+    friend class boost::serialization::access;
+    template <class Archive> void serialize(Archive& ar, const unsigned int version) {
+        ar& boost::serialization::base_object<LegAdditionalData>(*this);
+        ar& rates_;
+        ar& rateDates_;
+        ar& compounding_;
+        ar& subtractNotional_;
+    }
 };
 
 //! Serializable Floating Leg Data
@@ -255,6 +290,28 @@ private:
     bool nakedOption_;
 
     static LegDataRegister<FloatingLegData> reg_;
+    //! Serialization
+    friend class boost::serialization::access;
+    template <class Archive> void serialize(Archive& ar, const unsigned int version) {
+        ar& boost::serialization::base_object<LegAdditionalData>(*this);
+        ar& index_;
+        ar& fixingDays_;
+        ar& lookback_;
+        ar& rateCutoff_;
+        ar& isInArrears_;
+        ar& isAveraged_;
+        ar& hasSubPeriods_;
+        ar& includeSpread_;
+        ar& spreads_;
+        ar& spreadDates_;
+        ar& caps_;
+        ar& capDates_;
+        ar& floors_;
+        ar& floorDates_;
+        ar& gearings_;
+        ar& gearingDates_;
+        ar& nakedOption_;
+    }
 };
 
 //! Serializable CPI Leg Data
@@ -436,6 +493,23 @@ private:
     bool nakedOption_;
 
     static LegDataRegister<CMSLegData> reg_;
+    //! Serialization
+    friend class boost::serialization::access;
+    template <class Archive> void serialize(Archive& ar, const unsigned int version) {
+        ar& boost::serialization::base_object<LegAdditionalData>(*this);
+        ar& swapIndex_;
+        ar& fixingDays_;
+        ar& isInArrears_;
+        ar& spreads_;
+        ar& spreadDates_;
+        ar& caps_;
+        ar& capDates_;
+        ar& floors_;
+        ar& floorDates_;
+        ar& gearings_;
+        ar& gearingDates_;
+        ar& nakedOption_;
+    }
 };
 
 //! Serializable CMS Spread Leg Data
@@ -668,6 +742,17 @@ private:
     string frequency_;
     bool underflow_;
     bool initialized_;
+    //! Serialization
+    friend class boost::serialization::access;
+    template <class Archive> void serialize(Archive& ar, const unsigned int version) {
+        ar& type_;
+        ar& value_;
+        ar& startDate_;
+        ar& endDate_;
+        ar& frequency_;
+        ar& underflow_;
+        ar& initialized_;
+    }
 };
 
 //! Serializable object holding leg data
@@ -773,6 +858,35 @@ private:
     std::vector<std::string> paymentDates_;
     std::vector<Indexing> indexing_;
     bool indexingFromAssetLeg_;
+    //! Serialization
+    friend class boost::serialization::access;
+    template <class Archive> void serialize(Archive& ar, const unsigned int version) {
+        ar& indices_;
+        ar& concreteLegData_;
+        ar& isPayer_;
+        ar& currency_;
+        ar& legType_;
+        ar& schedule_;
+        ar& dayCounter_;
+        ar& notionals_;
+        ar& notionalDates_;
+        ar& paymentConvention_;
+        ar& notionalInitialExchange_;
+        ar& notionalFinalExchange_;
+        ar& notionalAmortizingExchange_;
+        ar& isNotResetXCCY_;
+        ar& foreignCurrency_;
+        ar& foreignAmount_;
+        ar& fxIndex_;
+        ar& fixingDays_;
+        ar& fixingCalendar_;
+        ar& amortizationData_;
+        ar& paymentLag_;
+        ar& paymentCalendar_;
+        ar& paymentDates_;
+        ar& indexing_;
+        ar& indexingFromAssetLeg_;
+    }
 };
 
 //! \name Utilities for building QuantLib Legs
@@ -23,6 +23,7 @@
 
 #pragma once
 
+#include <boost/serialization/optional.hpp>
 #include <ored/portfolio/optionexercisedata.hpp>
 #include <ored/portfolio/optionpaymentdata.hpp>
 #include <ored/portfolio/schedule.hpp>
@@ -121,6 +122,34 @@ private:
     boost::optional<bool> automaticExercise_;
     boost::optional<OptionExerciseData> exerciseData_;
     boost::optional<OptionPaymentData> paymentData_;
+    //! Serialization
+    friend class boost::serialization::access;
+    template <class Archive> void serialize(Archive& ar, const unsigned int version) {
+        ar& longShort_;
+        ar& callPut_;
+        ar& payoffType_;
+        ar& style_;
+        ar& payoffAtExpiry_;
+        ar& exerciseDates_;
+        ar& noticePeriod_;
+        ar& noticeCalendar_;
+        ar& noticeConvention_;
+        ar& settlement_;
+        ar& settlementMethod_;
+        ar& premium_;
+        ar& premiumCcy_;
+        ar& premiumPayDate_;
+        ar& exerciseFees_;
+        ar& exerciseFeeDates_;
+        ar& exerciseFeeTypes_;
+        ar& exerciseFeeSettlementPeriod_;
+        ar& exerciseFeeSettlementCalendar_;
+        ar& exerciseFeeSettlementConvention_;
+        ar& exercisePrices_;
+        ar& automaticExercise_;
+        ar& exerciseData_;
+        ar& paymentData_;
+    }
 };
 } // namespace data
 } // namespace ore
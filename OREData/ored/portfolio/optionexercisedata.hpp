@@ -23,6 +23,8 @@
 
 #pragma once
 
+#include <boost/serialization/split_member.hpp>
+#include <boost/serialization/string.hpp>
 #include <ored/utilities/xmlutils.hpp>
 #include <ql/time/date.hpp>
 
@@ -61,6 +63,18 @@ private:
 
     //! Initialisation
     void init();
+    //! Serialization
+    friend class boost::serialization::access;
+    template <class Archive> void save(Archive& ar, const unsigned int version) const {
+        ar& strDate_;
+        ar& strPrice_;
+    }
+    template <class Archive> void load(Archive& ar, const unsigned int version) {
+        ar& strDate_;
+        ar& strPrice_;
+        init();
+    }
+    BOOST_SERIALIZATION_SPLIT_MEMBER()
 };
 
 } // namespace data
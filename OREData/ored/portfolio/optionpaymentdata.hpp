@@ -23,6 +23,9 @@
 
 #pragma once
 
+#include <boost/serialization/split_member.hpp>
+#include <boost/serialization/string.hpp>
+#include <boost/serialization/vector.hpp>
 #include <ored/utilities/xmlutils.hpp>
 #include <ql/time/calendar.hpp>
 #include <ql/time/date.hpp>
@@ -87,6 +90,26 @@ private:
 
     //! Populate the value of relativeTo_ member from string.
     void populateRelativeTo();
+    //! Serialization
+    friend class boost::serialization::access;
+    template <class Archive> void save(Archive& ar, const unsigned int version) const {
+        ar& rulesBased_;
+        ar& strDates_;
+        ar& strLag_;
+        ar& strCalendar_;
+        ar& strConvention_;
+        ar& strRelativeTo_;
+    }
+    template <class Archive> void load(Archive& ar, const unsigned int version) {
+        ar& rulesBased_;
+        ar& strDates_;
+        ar& strLag_;
+        ar& strCalendar_;
+        ar& strConvention_;
+        ar& strRelativeTo_;
+        init();
+    }
+    BOOST_SERIALIZATION_SPLIT_MEMBER()
 };
 
 //! Print RelativeTo enum values.
@@ -16,16 +16,28 @@
  FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
 */
 
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/serialization/vector.hpp>
 #include <ored/portfolio/fxforward.hpp>
 #include <ored/portfolio/portfolio.hpp>
 #include <ored/portfolio/structuredtradeerror.hpp>
 #include <ored/portfolio/swap.hpp>
 #include <ored/portfolio/swaption.hpp>
 #include <ored/utilities/log.hpp>
+#include <ored/utilities/parallel.hpp>
+#include <ored/utilities/xmlelementreader.hpp>
 #include <ored/utilities/xmlutils.hpp>
+#include <ored/version.hpp>
 #include <ql/errors.hpp>
 #include <ql/time/date.hpp>
 
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <unordered_map>
+
 using namespace QuantLib;
 using namespace std;
 
@@ -34,6 +46,8 @@ namespace data {
 
 using namespace data;
 
+Portfolio::Portfolio(Size nThreads) : nThreads_(nThreads) {}
+
 void Portfolio::reset() {
     LOG("Reset portfolio of size " << trades_.size());
     for (auto t : trades_)
@@ -58,35 +72,96 @@ void Portfolio::loadFromXMLString(const string& xmlString, const boost::shared_p
     fromXML(node, factory);
 }
 
+void Portfolio::loadStreaming(const string& fileName, const boost::shared_ptr<TradeFactory>& factory,
+                              const boost::shared_ptr<EngineFactory>& engineFactory) {
+    LOG("Streaming trades from XML " << fileName.c_str());
+    XMLElementReader reader(fileName, "Trade");
+    std::unordered_set<string> ids;
+    for (auto const& t : trades_)
+        ids.insert(t->id());
+
+    // the trades are read in batches, so that they can be parsed on several threads
+    const Size batchSize = 64 * std::max<Size>(nThreads_, 1);
+    vector<string> elements(batchSize);
+    Size n = batchSize;
+    while (n == batchSize) {
+        n = 0;
+        while (n < batchSize && reader.next(elements[n]))
+            ++n;
+        vector<boost::shared_ptr<XMLDocument>> docs(n);
+        vector<XMLNode*> nodes(n);
+        parallelFor(n,
+                    [&elements, &docs, &nodes](Size i) {
+                        docs[i] = boost::make_shared<XMLDocument>();
+                        docs[i]->fromXMLString(elements[i]);
+                        nodes[i] = docs[i]->getFirstNode("Trade");
+                    },
+                    nThreads_);
+        Size first = trades_.size();
+        addTrades(nodes, factory, ids);
+        if (engineFactory)
+            buildTrades(tradeIndices(first), engineFactory);
+    }
+    LOG("Finished streaming " << reader.elementsRead() << " trades from XML, portfolio size now " << trades_.size());
+}
+
 void Portfolio::fromXML(XMLNode* node, const boost::shared_ptr<TradeFactory>& factory) {
     XMLUtils::checkNode(node, "Portfolio");
     vector<XMLNode*> nodes = XMLUtils::getChildrenNodes(node, "Trade");
-    for (Size i = 0; i < nodes.size(); i++) {
-        string tradeType = XMLUtils::getChildValue(nodes[i], "TradeType", true);
-
-        // Get the id attribute
-        string id = XMLUtils::getAttribute(nodes[i], "id");
-        QL_REQUIRE(id != "", "No id attribute in Trade Node");
-        DLOG("Parsing trade id:" << id);
-
-        boost::shared_ptr<Trade> trade = factory->build(tradeType);
-
-        if (trade) {
-            try {
-                trade->fromXML(nodes[i]);
-                trade->id() = id;
-                add(trade);
-
-                DLOG("Added Trade " << id << " (" << trade->id() << ")"
-                                    << " type:" << tradeType);
-            } catch (std::exception& ex) {
-                ALOG(StructuredTradeErrorMessage(id, tradeType, "Error parsing Trade XML", ex.what()));
+    // check for duplicate ids with a set, add() would be quadratic in the number of trades
+    std::unordered_set<string> ids;
+    for (auto const& t : trades_)
+        ids.insert(t->id());
+    addTrades(nodes, factory, ids);
+    LOG("Finished Parsing XML doc");
+}
+
+void Portfolio::addTrades(const vector<XMLNode*>& nodes, const boost::shared_ptr<TradeFactory>& factory,
+                          std::unordered_set<string>& ids) {
+    // parse the trades, possibly concurrently, the results are logged and added in the order of the nodes below
+    struct ParsedTrade {
+        string id, tradeType, error;
+        bool failed = false;
+        boost::shared_ptr<Trade> trade;
+    };
+    vector<ParsedTrade> parsed(nodes.size());
+    parallelFor(nodes.size(),
+                [&nodes, &parsed, &factory](Size i) {
+                    ParsedTrade& p = parsed[i];
+                    p.tradeType = XMLUtils::getChildValue(nodes[i], "TradeType", true);
+                    p.id = XMLUtils::getAttribute(nodes[i], "id");
+                    p.trade = factory->build(p.tradeType);
+                    if (p.trade && p.id != "") {
+                        try {
+                            p.trade->fromXML(nodes[i]);
+                            p.trade->id() = p.id;
+                        } catch (std::exception& ex) {
+                            p.failed = true;
+                            p.error = ex.what();
+                        }
+                    }
+                },
+                nThreads_);
+
+    for (auto const& p : parsed) {
+        QL_REQUIRE(p.id != "", "No id attribute in Trade Node");
+        DLOG("Parsing trade id:" << p.id);
+        if (p.trade) {
+            if (p.failed) {
+                ALOG(StructuredTradeErrorMessage(p.id, p.tradeType, "Error parsing Trade XML", p.error));
+            } else if (!ids.insert(p.id).second) {
+                ALOG(StructuredTradeErrorMessage(
+                    p.id, p.tradeType, "Error parsing Trade XML",
+                    "Attempted to add a trade to the portfolio with an id, which already exists."));
+            } else {
+                trades_.push_back(p.trade);
+                DLOG("Added Trade " << p.id << " (" << p.trade->id() << ")"
+                                    << " type:" << p.tradeType);
             }
         } else {
-            WLOG("Unable to build Trade for tradeType=" << tradeType);
+            WLOG("Unable to build Trade for tradeType=" << p.tradeType);
         }
     }
-    LOG("Finished Parsing XML doc");
 }
 
 void Portfolio::save(const string& fileName) const {
@@ -101,6 +176,159 @@ void Portfolio::save(const string& fileName) const {
     doc.toFile(fileName);
 }
 
+namespace {
+// a trade in the portfolio cache, either as a boost archive or as XML
+struct CachedTrade {
+    string id, tradeType;
+    bool binary = false;
+    string data;
+
+    template <class Archive> void serialize(Archive& ar, const unsigned int version) {
+        ar& id;
+        ar& tradeType;
+        ar& binary;
+        ar& data;
+    }
+};
+
+/* identifies the layout of the cache file and the build which wrote it, binary archives are not self-describing, so
+   the schema version must be increased whenever the serialization of a trade or of one of its data classes changes,
+   caches written by another ORE, boost or boost archive version are not used either */
+const Size portfolioCacheSchemaVersion = 2;
+
+string portfolioCacheVersion() {
+    std::ostringstream os;
+    os << "ORE portfolio cache " << portfolioCacheSchemaVersion << ", ORE " << OPEN_SOURCE_RISK_VERSION << ", boost "
+       << BOOST_LIB_VERSION << ", archive " << static_cast<unsigned int>(boost::archive::BOOST_ARCHIVE_VERSION());
+    return os.str();
+}
+} // namespace
+
+void Portfolio::saveCache(const string& fileName, const string& sourceHash) const {
+    LOG("Saving Portfolio cache to " << fileName);
+    vector<CachedTrade> cached(trades_.size());
+    Size nBinary = 0;
+    for (Size i = 0; i < trades_.size(); ++i) {
+        CachedTrade& c = cached[i];
+        c.id = trades_[i]->id();
+        c.tradeType = trades_[i]->tradeType();
+        try {
+            std::ostringstream os;
+            {
+                boost::archive::binary_oarchive oa(os);
+                oa << trades_[i];
+            }
+            c.data = os.str();
+            c.binary = true;
+            ++nBinary;
+        } catch (const boost::archive::archive_exception& e) {
+            // the trade type or one of its data classes (e.g. a leg type) does not support boost serialization
+            DLOG("Trade " << c.id << " (" << c.tradeType << ") is cached as XML: " << e.what());
+            XMLDocument doc;
+            doc.appendNode(trades_[i]->toXML(doc));
+            c.data = doc.toString();
+        }
+    }
+
+    std::ofstream ofs(fileName, std::ios::binary);
+    QL_REQUIRE(ofs.is_open(), "Portfolio::saveCache(): error opening file " << fileName);
+    boost::archive::binary_oarchive oa(ofs);
+    oa << portfolioCacheVersion() << sourceHash << cached;
+    LOG("Saved " << trades_.size() << " trades to Portfolio cache, " << nBinary << " in binary form");
+}
+
+bool Portfolio::loadCache(const string& fileName, const string& sourceHash,
+                          const boost::shared_ptr<TradeFactory>& factory) {
+    std::ifstream ifs(fileName, std::ios::binary);
+    if (!ifs.is_open()) {
+        LOG("Portfolio cache " << fileName << " not found");
+        return false;
+    }
+
+    vector<boost::shared_ptr<Trade>> trades;
+    try {
+        boost::archive::binary_iarchive ia(ifs);
+        string version, hash;
+        ia >> version >> hash;
+        if (version != portfolioCacheVersion() || hash != sourceHash) {
+            LOG("Portfolio cache " << fileName << " is out of date (" << version << ")");
+            return false;
+        }
+        vector<CachedTrade> cached;
+        ia >> cached;
+        trades.resize(cached.size());
+        for (Size i = 0; i < cached.size(); ++i) {
+            if (cached[i].binary) {
+                std::istringstream is(cached[i].data);
+                boost::archive::binary_iarchive tia(is);
+                tia >> trades[i];
+            }
+        }
+        // the trades stored as XML are parsed, possibly concurrently, as in fromXML()
+        parallelFor(cached.size(),
+                    [&cached, &trades, &factory](Size i) {
+                        const CachedTrade& c = cached[i];
+                        if (c.binary)
+                            return;
+                        XMLDocument doc;
+                        doc.fromXMLString(c.data);
+                        trades[i] = factory->build(c.tradeType);
+                        QL_REQUIRE(trades[i], "Unable to build Trade for tradeType=" << c.tradeType);
+                        trades[i]->fromXML(doc.getFirstNode("Trade"));
+                        trades[i]->id() = c.id;
+                    },
+                    nThreads_);
+    } catch (std::exception& e) {
+        WLOG("Failed to load Portfolio cache " << fileName << ": " << e.what());
+        return false;
+    } catch (...) {
+        WLOG("Failed to load Portfolio cache " << fileName << ": unknown error");
+        return false;
+    }
+
+    std::unordered_set<string> ids;
+    for (auto const& t : trades_)
+        ids.insert(t->id());
+    for (auto const& t : trades) {
+        if (!ids.insert(t->id()).second) {
+            ALOG(StructuredTradeErrorMessage(t->id(), t->tradeType(), "Error loading Trade from cache",
+                                             "Attempted to add a trade to the portfolio with an id, which already "
+                                             "exists."));
+        } else {
+            trades_.push_back(t);
+        }
+    }
+    LOG("Loaded " << trades.size() << " trades from Portfolio cache " << fileName);
+    return true;
+}
+
+string Portfolio::contentHash(const vector<string>& fileNames) {
+    // 64 bit FNV-1a hash over the file contents, the file sizes separate the files
+    boost::uint64_t hash = 14695981039346656037ULL;
+    auto mix = [&hash](const char* data, Size n) {
+        for (Size i = 0; i < n; ++i) {
+            hash ^= static_cast<unsigned char>(data[i]);
+            hash *= 1099511628211ULL;
+        }
+    };
+    vector<char> buffer(1 << 16);
+    for (auto const& fileName : fileNames) {
+        std::ifstream file(fileName, std::ios::binary);
+        QL_REQUIRE(file.is_open(), "Portfolio::contentHash(): error opening file " << fileName);
+        boost::uint64_t size = 0;
+        while (file) {
+            file.read(&buffer[0], buffer.size());
+            Size n = static_cast<Size>(file.gcount());
+            mix(&buffer[0], n);
+            size += n;
+        }
+        mix(reinterpret_cast<const char*>(&size), sizeof(size));
+    }
+    std::ostringstream os;
+    os << std::hex << std::setw(16) << std::setfill('0') << hash;
+    return os.str();
+}
+
 bool Portfolio::remove(const std::string& tradeID) {
     for (auto it = trades_.begin(); it != trades_.end(); ++it) {
         if ((*it)->id() == tradeID) {
@@ -124,21 +352,121 @@ void Portfolio::removeMatured(const Date& asof) {
 
 void Portfolio::build(const boost::shared_ptr<EngineFactory>& engineFactory) {
     LOG("Building Portfolio of size " << trades_.size());
-    auto trade = trades_.begin();
-    while (trade != trades_.end()) {
+    buildTrades(tradeIndices(0), engineFactory);
+    LOG("Built Portfolio. Size now " << trades_.size());
+    engineFactory->logStatistics();
+
+    QL_REQUIRE(trades_.size() > 0, "Portfolio does not contain any built trades");
+}
+
+void Portfolio::buildTrades(const vector<Size>& indices, const boost::shared_ptr<EngineFactory>& engineFactory) {
+    // The trades are built on the calling thread. Building a trade registers observers with process wide
+    // singletons (e.g. the IndexManager notifiers) and triggers the lazy calculation of shared term structures
+    // (bootstraps, calibrations), neither of which is safe to do concurrently, even with the thread safe observer
+    // pattern. Errors are logged and failed trades removed in the original order.
+    vector<Size> removed;
+    for (Size k = 0; k < indices.size(); ++k) {
+        QL_REQUIRE(k == 0 || indices[k] > indices[k - 1], "Portfolio::buildTrades(): indices must be increasing");
+        const boost::shared_ptr<Trade>& trade = trades_[indices[k]];
         try {
-            (*trade)->build(engineFactory);
-            TLOG("Required Fixings for trade " << (*trade)->id() << ":");
-            TLOGGERSTREAM << (*trade)->requiredFixings();
-            ++trade;
+            trade->build(engineFactory);
+            TLOG("Required Fixings for trade " << trade->id() << ":");
+            TLOGGERSTREAM << trade->requiredFixings();
         } catch (std::exception& e) {
-            ALOG(StructuredTradeErrorMessage(*trade, "Error building trade", e.what()));
-            trade = trades_.erase(trade);
+            ALOG(StructuredTradeErrorMessage(trade, "Error building trade", e.what()));
+            removed.push_back(indices[k]);
         }
     }
-    LOG("Built Portfolio. Size now " << trades_.size());
 
-    QL_REQUIRE(trades_.size() > 0, "Portfolio does not contain any built trades");
+    // only the trades from the first failed one on are moved
+    if (removed.empty())
+        return;
+    Size last = removed.front();
+    auto r = removed.begin();
+    for (Size i = removed.front(); i < trades_.size(); ++i) {
+        if (r != removed.end() && *r == i)
+            ++r;
+        else
+            trades_[last++] = trades_[i];
+    }
+    trades_.resize(last);
+}
+
+namespace {
+// the XML serialisation of a trade, used to detect amended trades
+string tradeXml(const boost::shared_ptr<Trade>& trade) {
+    XMLDocument doc;
+    doc.appendNode(trade->toXML(doc));
+    return doc.toString();
+}
+} // namespace
+
+PortfolioDiff Portfolio::update(const Portfolio& portfolio, const boost::shared_ptr<EngineFactory>& engineFactory) {
+    LOG("Updating Portfolio of size " << trades_.size() << " to a portfolio of size " << portfolio.size());
+    std::unordered_map<string, Size> existing;
+    for (Size i = 0; i < trades_.size(); ++i)
+        existing[trades_[i]->id()] = i;
+
+    // compare the trades in both portfolios, possibly concurrently
+    const vector<boost::shared_ptr<Trade>>& newTrades = portfolio.trades();
+    vector<Size> match(newTrades.size(), Null<Size>());
+    vector<char> modified(newTrades.size(), false);
+    parallelFor(newTrades.size(),
+                [this, &existing, &newTrades, &match, &modified](Size i) {
+                    auto it = existing.find(newTrades[i]->id());
+                    if (it != existing.end()) {
+                        match[i] = it->second;
+                        modified[i] = tradeXml(trades_[it->second]) != tradeXml(newTrades[i]);
+                    }
+                },
+                nThreads_);
+
+    PortfolioDiff diff;
+    vector<boost::shared_ptr<Trade>> trades;
+    vector<Size> toBuild;
+    vector<char> kept(trades_.size(), false);
+    trades.reserve(newTrades.size());
+    for (Size i = 0; i < newTrades.size(); ++i) {
+        const string& id = newTrades[i]->id();
+        if (match[i] == Null<Size>()) {
+            DLOG("Trade " << id << " added");
+            diff.added.push_back(id);
+        } else if (modified[i]) {
+            DLOG("Trade " << id << " modified");
+            diff.modified.push_back(id);
+            kept[match[i]] = true;
+        } else {
+            diff.unchanged.push_back(id);
+            kept[match[i]] = true;
+            trades.push_back(trades_[match[i]]);
+            continue;
+        }
+        toBuild.push_back(trades.size());
+        trades.push_back(newTrades[i]);
+    }
+    for (Size i = 0; i < trades_.size(); ++i) {
+        if (!kept[i]) {
+            DLOG("Trade " << trades_[i]->id() << " removed");
+            diff.removed.push_back(trades_[i]->id());
+        }
+    }
+    trades_.swap(trades);
+    underlyingIndicesCache_.clear();
+
+    if (engineFactory)
+        buildTrades(toBuild, engineFactory);
+
+    LOG("Updated Portfolio, " << diff.added.size() << " trades added, " << diff.modified.size() << " modified, "
+                              << diff.removed.size() << " removed and " << diff.unchanged.size()
+                              << " unchanged. Size now " << trades_.size());
+    return diff;
+}
+
+vector<Size> Portfolio::tradeIndices(Size first) const {
+    vector<Size> indices(trades_.size() - std::min(first, trades_.size()));
+    for (Size k = 0; k < indices.size(); ++k)
+        indices[k] = first + k;
+    return indices;
 }
 
 Date Portfolio::maturity() const {
@@ -29,19 +29,41 @@
 #include <ored/portfolio/tradefactory.hpp>
 #include <ql/time/date.hpp>
 #include <ql/types.hpp>
+#include <unordered_set>
 #include <vector>
 
 namespace ore {
 namespace data {
 
+//! Changes applied to a portfolio by Portfolio::update()
+/*!
+  \ingroup portfolio
+*/
+struct PortfolioDiff {
+    //! Ids of the trades which are only in the new portfolio
+    std::vector<std::string> added;
+    //! Ids of the trades in both portfolios whose content differs
+    std::vector<std::string> modified;
+    //! Ids of the trades which are no longer in the new portfolio
+    std::vector<std::string> removed;
+    //! Ids of the trades in both portfolios with identical content
+    std::vector<std::string> unchanged;
+    //! True if the portfolio was not changed
+    bool empty() const { return added.empty() && modified.empty() && removed.empty(); }
+};
+
 //! Serializable portfolio
 /*!
   \ingroup portfolio
 */
 class Portfolio {
 public:
-    //! Default constructor
-    Portfolio() {}
+    /*! Constructor, \p nThreads is the number of threads used to parse the trades
+
+        The trades are parsed in the same order and with the same error handling as in the single threaded case.
+        They are always built on the calling thread: trade builders register with process wide singletons such as
+        the IndexManager and trigger the lazy calculation of shared term structures, which is not thread safe. */
+    Portfolio(QuantLib::Size nThreads = 1);
 
     //! Add a trade to the portfoliio
     void add(const boost::shared_ptr<Trade>& trade);
@@ -72,21 +94,69 @@ public:
     void loadFromXMLString(const std::string& xmlString,
                            const boost::shared_ptr<TradeFactory>& tf = boost::make_shared<TradeFactory>());
 
+    /*! Load from a file reading one trade at a time, using a default or user supplied TradeFactory, existing trades
+        are kept
+
+        Unlike load() the file is not parsed into a single XML document, the trades are read in small batches which
+        are parsed and discarded before the next batch is read. If an \p engineFactory is given, the trades of each
+        batch are built while the rest of the file is still to be read and trades that fail to build are removed,
+        as in build().
+    */
+    void loadStreaming(const std::string& fileName,
+                       const boost::shared_ptr<TradeFactory>& tf = boost::make_shared<TradeFactory>(),
+                       const boost::shared_ptr<EngineFactory>& engineFactory = nullptr);
+
     //! Load from XML Node
     void fromXML(XMLNode* node, const boost::shared_ptr<TradeFactory>& tf = boost::make_shared<TradeFactory>());
 
     //! Save portfolio to an XML file
     void save(const std::string& fileName) const;
 
+    /*! Save the trades to a binary cache file, tagged with \p sourceHash, usually the contentHash() of the files the
+        portfolio was loaded from
+
+        Trades supporting boost serialization are stored in binary form, these are Swap, Swaption, FxForward and
+        FxSwap trades whose legs are Fixed, Floating, ZeroCouponFixed, CMS or Cashflow legs. All other trades, including
+        the supported trade types with any other leg type, are stored as XML, each such trade is logged with DLOG. The
+        file is tagged with a cache schema version as well, which has to be increased in portfolio.cpp whenever the
+        serialization of a trade or of its data classes changes.
+    */
+    void saveCache(const std::string& fileName, const std::string& sourceHash) const;
+
+    /*! Load the trades from a binary cache file written by saveCache(), existing trades are kept
+
+        Returns false and leaves the portfolio unchanged if the file does not exist, can not be read or was saved with
+        a different \p sourceHash, cache schema version or ORE / boost version. The caller then loads the portfolio
+        from XML. The TradeFactory is only used for the trades stored as XML.
+    */
+    bool loadCache(const std::string& fileName, const std::string& sourceHash,
+                   const boost::shared_ptr<TradeFactory>& tf = boost::make_shared<TradeFactory>());
+
+    //! Hash of the contents of the given files, used as the source hash of a portfolio cache
+    static std::string contentHash(const std::vector<std::string>& fileNames);
+
     //! Remove specified trade from the portfolio
     bool remove(const std::string& tradeID);
 
     //! Remove matured trades from portfolio for a given date, each removal is logged with an Alert
     void removeMatured(const QuantLib::Date& asof);
 
-    //! Call build on all trades in the portfolio
+    //! Call build on all trades in the portfolio, trades that fail to build are removed
     void build(const boost::shared_ptr<EngineFactory>&);
 
+    /*! Update the portfolio to the trades in \p portfolio, the trade order is taken from \p portfolio
+
+        Trades are matched by id and compared by their XML serialisation. Trades with unchanged content are kept,
+        together with their instruments if they were built, added and modified trades are taken from \p portfolio.
+        If an \p engineFactory is given, only the added and modified trades are built and trades that fail to build
+        are removed, as in build(). The returned diff can be used to keep the results of unchanged trades, e.g. their
+        rows in an NPV cube.
+    */
+    PortfolioDiff update(const Portfolio& portfolio, const boost::shared_ptr<EngineFactory>& engineFactory = nullptr);
+
+    //! Number of threads used to parse the trades
+    QuantLib::Size nThreads() const { return nThreads_; }
+
     //! Calculates the maturity of the portfolio
     QuantLib::Date maturity() const;
 
@@ -115,6 +185,12 @@ public:
     std::set<std::string> underlyingIndices(AssetClass assetClass);
 
 private:
+    void addTrades(const std::vector<XMLNode*>& nodes, const boost::shared_ptr<TradeFactory>& tf,
+                   std::unordered_set<std::string>& ids);
+    void buildTrades(const std::vector<QuantLib::Size>& indices, const boost::shared_ptr<EngineFactory>& engineFactory);
+    std::vector<QuantLib::Size> tradeIndices(QuantLib::Size first) const;
+
+    QuantLib::Size nThreads_;
     std::vector<boost::shared_ptr<Trade>> trades_;
     std::map<AssetClass, std::set<std::string>> underlyingIndicesCache_;
 };
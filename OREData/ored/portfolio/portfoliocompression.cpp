@@ -0,0 +1,318 @@
+/*
+ Copyright (C) 2020 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <ored/portfolio/builders/fxforward.hpp>
+#include <ored/portfolio/builders/swap.hpp>
+#include <ored/portfolio/portfoliocompression.hpp>
+#include <ored/utilities/log.hpp>
+#include <ored/utilities/parsers.hpp>
+
+#include <ql/cashflows/fixedratecoupon.hpp>
+#include <ql/cashflows/couponpricer.hpp>
+#include <ql/cashflows/iborcoupon.hpp>
+#include <ql/cashflows/simplecashflow.hpp>
+#include <ql/instruments/swap.hpp>
+#include <ql/math/comparison.hpp>
+#include <qle/instruments/fxforward.hpp>
+
+#include <boost/make_shared.hpp>
+
+#include <algorithm>
+#include <sstream>
+#include <tuple>
+#include <typeinfo>
+
+using namespace QuantLib;
+
+namespace ore {
+namespace data {
+
+namespace {
+// Ibor coupons that differ in nominal and spread only can be merged
+typedef std::tuple<IborIndex*, const void*, std::string, Date, Date, Date, Date, Date, Natural, bool, std::string>
+    IborCouponKey;
+
+IborCouponKey iborCouponKey(const boost::shared_ptr<IborCoupon>& c) {
+    // each plain Ibor leg gets its own default pricer, pricers of the same type on the same (possibly empty) caplet
+    // volatility give the same rate for coupons fixing in advance; in arrears coupons are only merged if they share
+    // the pricer, since the convexity adjustment depends on the pricer settings
+    const void* pricer = c->pricer().get();
+    std::string pricerType;
+    auto iborPricer = boost::dynamic_pointer_cast<IborCouponPricer>(c->pricer());
+    if (iborPricer && !c->isInArrears()) {
+        pricer = iborPricer->capletVolatility().empty() ? nullptr : iborPricer->capletVolatility().currentLink().get();
+        pricerType = typeid(*iborPricer).name();
+    }
+    return std::make_tuple(c->iborIndex().get(), pricer, pricerType, c->date(), c->accrualStartDate(),
+                           c->accrualEndDate(), c->referencePeriodStart(), c->referencePeriodEnd(), c->fixingDays(),
+                           c->isInArrears(), c->dayCounter().name());
+}
+
+void sortByDate(Leg& leg) {
+    std::stable_sort(leg.begin(), leg.end(),
+                     [](const boost::shared_ptr<CashFlow>& a, const boost::shared_ptr<CashFlow>& b) {
+                         return a->date() < b->date();
+                     });
+}
+
+// the key of the group a compressible trade belongs to, also used to derive the id of the compressed trade
+std::string compressionKey(const boost::shared_ptr<Trade>& trade) {
+    std::ostringstream key;
+    key << trade->envelope().counterparty() << "_" << trade->envelope().nettingSetId() << "_" << trade->tradeType();
+    if (trade->tradeType() == "FxForward") {
+        std::vector<std::string> ccys = trade->legCurrencies();
+        std::sort(ccys.begin(), ccys.end());
+        key << "_" << ccys[0] << ccys[1] << "_" << QuantLib::io::iso_date(trade->maturity());
+    } else {
+        key << "_" << trade->legCurrencies().front();
+    }
+    return key.str();
+}
+} // namespace
+
+CompressedTrade::CompressedTrade(const string& id, const Envelope& env,
+                                 const std::vector<boost::shared_ptr<Trade>>& trades)
+    : Trade("CompressedTrade", env), trades_(trades) {
+    this->id() = id;
+    QL_REQUIRE(!trades_.empty(), "CompressedTrade " << id << " requires at least one trade");
+}
+
+void CompressedTrade::build(const boost::shared_ptr<EngineFactory>& engineFactory) {
+    DLOG("CompressedTrade::build() called for trade " << id() << " representing " << trades_.size() << " trades");
+
+    const string& type = trades_.front()->tradeType();
+    requiredFixings_.clear();
+    for (auto const& t : trades_) {
+        QL_REQUIRE(t->tradeType() == type, "CompressedTrade " << id() << ": trade " << t->id() << " has type "
+                                                              << t->tradeType() << ", expected " << type);
+        QL_REQUIRE(t->instrument(), "CompressedTrade " << id() << ": trade " << t->id() << " is not built");
+        requiredFixings_.addData(t->requiredFixings());
+    }
+
+    if (type == "Swap")
+        buildSwap(engineFactory);
+    else if (type == "FxForward")
+        buildFxForward(engineFactory);
+    else {
+        QL_FAIL("CompressedTrade " << id() << ": trade type " << type << " not supported");
+    }
+}
+
+void CompressedTrade::buildSwap(const boost::shared_ptr<EngineFactory>& engineFactory) {
+    const string& ccy = trades_.front()->legCurrencies().front();
+
+    // deterministic flows by payment date, merged Ibor coupons and all other flows
+    std::map<Date, Real> fixedFlows;
+    std::map<IborCouponKey, std::pair<boost::shared_ptr<IborCoupon>, Real>> iborCoupons;
+    Leg received, paid;
+
+    notional_ = 0.0;
+    maturity_ = Date::minDate();
+    for (auto const& t : trades_) {
+        for (Size i = 0; i < t->legs().size(); ++i) {
+            QL_REQUIRE(t->legCurrencies()[i] == ccy, "CompressedTrade " << id() << ": leg " << i << " of trade "
+                                                                        << t->id() << " is not in " << ccy);
+            Real sign = t->legPayers()[i] ? -1.0 : 1.0;
+            for (auto const& cf : t->legs()[i]) {
+                const std::type_info& cfType = typeid(*cf);
+                if (cfType == typeid(FixedRateCoupon) || cfType == typeid(SimpleCashFlow)) {
+                    fixedFlows[cf->date()] += sign * cf->amount();
+                    continue;
+                }
+                if (cfType == typeid(IborCoupon)) {
+                    auto c = boost::static_pointer_cast<IborCoupon>(cf);
+                    if (close_enough(c->gearing(), 1.0)) {
+                        auto& merged = iborCoupons[iborCouponKey(c)];
+                        if (!merged.first)
+                            merged.first = c;
+                        merged.second += sign * c->nominal();
+                        fixedFlows[c->date()] += sign * c->nominal() * c->spread() * c->accrualPeriod();
+                        continue;
+                    }
+                }
+                (t->legPayers()[i] ? paid : received).push_back(cf);
+            }
+        }
+        if (t->notional() != Null<Real>() && t->notionalCurrency() == ccy)
+            notional_ += t->notional();
+        maturity_ = std::max(maturity_, t->maturity());
+    }
+
+    Leg merged;
+    for (auto const& f : fixedFlows) {
+        if (!close_enough(f.second, 0.0))
+            merged.push_back(boost::make_shared<SimpleCashFlow>(f.second, f.first));
+    }
+    for (auto const& m : iborCoupons) {
+        if (close_enough(m.second.second, 0.0))
+            continue;
+        const boost::shared_ptr<IborCoupon>& c = m.second.first;
+        auto coupon = boost::make_shared<IborCoupon>(c->date(), m.second.second, c->accrualStartDate(),
+                                                     c->accrualEndDate(), c->fixingDays(), c->iborIndex(), 1.0, 0.0,
+                                                     c->referencePeriodStart(), c->referencePeriodEnd(),
+                                                     c->dayCounter(), c->isInArrears());
+        coupon->setPricer(c->pricer());
+        merged.push_back(coupon);
+    }
+    merged.insert(merged.end(), received.begin(), received.end());
+    sortByDate(merged);
+    sortByDate(paid);
+
+    legs_ = {merged};
+    legPayers_ = {false};
+    if (!paid.empty()) {
+        legs_.push_back(paid);
+        legPayers_.push_back(true);
+    }
+    legCurrencies_ = vector<string>(legs_.size(), ccy);
+    npvCurrency_ = notionalCurrency_ = ccy;
+
+    boost::shared_ptr<QuantLib::Swap> swap = boost::make_shared<QuantLib::Swap>(legs_, legPayers_);
+    boost::shared_ptr<SwapEngineBuilderBase> swapBuilder =
+        boost::dynamic_pointer_cast<SwapEngineBuilderBase>(engineFactory->builder("Swap"));
+    QL_REQUIRE(swapBuilder, "No Builder found for Swap " << id());
+    swap->setPricingEngine(swapBuilder->engine(parseCurrency(ccy)));
+    instrument_.reset(new VanillaInstrument(swap));
+
+    DLOG("CompressedTrade " << id() << ": " << trades_.size() << " swaps represented by " << merged.size() << " + "
+                            << paid.size() << " flows");
+}
+
+void CompressedTrade::buildFxForward(const boost::shared_ptr<EngineFactory>& engineFactory) {
+    std::vector<string> ccys = trades_.front()->legCurrencies();
+    std::sort(ccys.begin(), ccys.end());
+    Date maturity = trades_.front()->maturity();
+
+    // net amounts received in each currency
+    Real net1 = 0.0, net2 = 0.0;
+    for (auto const& t : trades_) {
+        QL_REQUIRE(t->maturity() == maturity, "CompressedTrade " << id() << ": trade " << t->id() << " matures on "
+                                                                 << t->maturity() << ", expected " << maturity);
+        for (Size i = 0; i < t->legs().size(); ++i) {
+            Real amount = (t->legPayers()[i] ? -1.0 : 1.0) * t->legs()[i].front()->amount();
+            if (t->legCurrencies()[i] == ccys[0])
+                net1 += amount;
+            else if (t->legCurrencies()[i] == ccys[1])
+                net2 += amount;
+            else {
+                QL_FAIL("CompressedTrade " << id() << ": unexpected currency " << t->legCurrencies()[i]
+                                           << " in trade " << t->id());
+            }
+        }
+    }
+    QL_REQUIRE((net1 > 0.0 && net2 < 0.0) || (net1 < 0.0 && net2 > 0.0),
+               "CompressedTrade " << id() << ": net amounts " << net1 << " " << ccys[0] << " and " << net2 << " "
+                                  << ccys[1] << " can not be represented by an FX Forward");
+
+    string boughtCurrency = net1 > 0.0 ? ccys[0] : ccys[1];
+    string soldCurrency = net1 > 0.0 ? ccys[1] : ccys[0];
+    Real boughtAmount = net1 > 0.0 ? net1 : net2;
+    Real soldAmount = net1 > 0.0 ? -net2 : -net1;
+    Currency boughtCcy = parseCurrency(boughtCurrency);
+    Currency soldCcy = parseCurrency(soldCurrency);
+
+    boost::shared_ptr<QuantLib::Instrument> instrument =
+        boost::make_shared<QuantExt::FxForward>(boughtAmount, boughtCcy, soldAmount, soldCcy, maturity, false);
+    boost::shared_ptr<FxForwardEngineBuilder> fxBuilder =
+        boost::dynamic_pointer_cast<FxForwardEngineBuilder>(engineFactory->builder("FxForward"));
+    QL_REQUIRE(fxBuilder, "No Builder found for FxForward " << id());
+    instrument->setPricingEngine(fxBuilder->engine(boughtCcy, soldCcy));
+    instrument_.reset(new VanillaInstrument(instrument));
+
+    npvCurrency_ = notionalCurrency_ = soldCurrency;
+    notional_ = soldAmount;
+    maturity_ = maturity;
+    legs_ = {{boost::make_shared<SimpleCashFlow>(boughtAmount, maturity)},
+             {boost::make_shared<SimpleCashFlow>(soldAmount, maturity)}};
+    legCurrencies_ = {boughtCurrency, soldCurrency};
+    legPayers_ = {false, true};
+}
+
+void CompressedTrade::fromXML(XMLNode*) { QL_FAIL("CompressedTrade " << id() << " can not be read from XML"); }
+
+bool isCompressible(const boost::shared_ptr<Trade>& trade) {
+    const boost::shared_ptr<InstrumentWrapper>& wrapper = trade->instrument();
+    if (!wrapper || !trade->tradeActions().empty() || wrapper->multiplier() != 1.0 ||
+        !wrapper->additionalInstruments().empty() || trade->legs().empty())
+        return false;
+    const std::vector<string>& ccys = trade->legCurrencies();
+    if (trade->tradeType() == "Swap") {
+        // single currency swaps priced as a QuantLib::Swap
+        return boost::dynamic_pointer_cast<QuantLib::Swap>(wrapper->qlInstrument()) != nullptr &&
+               std::all_of(ccys.begin(), ccys.end(), [&ccys](const string& c) { return c == ccys.front(); });
+    } else if (trade->tradeType() == "FxForward") {
+        return trade->legs().size() == 2 && trade->legs()[0].size() == 1 && trade->legs()[1].size() == 1 &&
+               ccys.size() == 2 && ccys[0] != ccys[1];
+    }
+    return false;
+}
+
+boost::shared_ptr<Portfolio> compressPortfolio(const boost::shared_ptr<Portfolio>& portfolio,
+                                               const boost::shared_ptr<EngineFactory>& engineFactory,
+                                               Size minGroupSize) {
+    LOG("Compressing portfolio of size " << portfolio->size());
+
+    boost::shared_ptr<Portfolio> result = boost::make_shared<Portfolio>(portfolio->nThreads());
+    std::map<std::string, std::vector<boost::shared_ptr<Trade>>> groups;
+    for (auto const& t : portfolio->trades()) {
+        if (isCompressible(t))
+            groups[compressionKey(t)].push_back(t);
+        else
+            result->add(t);
+    }
+
+    Size compressed = 0;
+    for (auto const& g : groups) {
+        const std::vector<boost::shared_ptr<Trade>>& trades = g.second;
+        if (trades.size() >= minGroupSize) {
+            std::set<string> portfolioIds;
+            for (auto const& t : trades)
+                portfolioIds.insert(t->portfolioIds().begin(), t->portfolioIds().end());
+            const Envelope& env = trades.front()->envelope();
+            boost::shared_ptr<CompressedTrade> trade = boost::make_shared<CompressedTrade>(
+                "Compressed_" + g.first, Envelope(env.counterparty(), env.nettingSetId(), portfolioIds), trades);
+            try {
+                trade->build(engineFactory);
+                result->add(trade);
+                compressed += trades.size();
+                continue;
+            } catch (std::exception& e) {
+                WLOG("Trades of group " << g.first << " are not compressed: " << e.what());
+            }
+        }
+        for (auto const& t : trades)
+            result->add(t);
+    }
+
+    LOG("Compressed " << compressed << " trades, portfolio size now " << result->size());
+    return result;
+}
+
+std::map<std::string, std::string> compressionMap(const Portfolio& portfolio) {
+    std::map<std::string, std::string> result;
+    for (auto const& t : portfolio.trades()) {
+        if (auto c = boost::dynamic_pointer_cast<CompressedTrade>(t)) {
+            for (auto const& u : c->trades())
+                result[u->id()] = c->id();
+        }
+    }
+    return result;
+}
+
+} // namespace data
+} // namespace ore
@@ -0,0 +1,85 @@
+/*
+ Copyright (C) 2020 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file portfolio/portfoliocompression.hpp
+    \brief compression of linear trades into representative trades
+    \ingroup tradedata
+*/
+
+#pragma once
+
+#include <ored/portfolio/portfolio.hpp>
+#include <ored/portfolio/trade.hpp>
+
+namespace ore {
+namespace data {
+
+//! Trade representing a group of compressed linear trades
+/*! The trade holds the constituent trades it replaces and builds a single instrument whose value is the sum of the
+    constituent values:
+    - single currency Swaps of a netting set are represented by one QuantLib::Swap. Fixed coupons and simple cash
+      flows are summed by payment date, plain Ibor coupons with the same index, fixing, accrual and payment dates are
+      merged into one coupon on the summed nominal, their spreads being moved to the fixed flows. All other cash
+      flows are carried over unchanged.
+    - FX Forwards of a netting set with the same currency pair and value date are represented by one FX Forward on
+      the net amounts.
+
+    The constituent trades must be built with the same engine factory before the compressed trade is built.
+
+    \ingroup tradedata
+*/
+class CompressedTrade : public Trade {
+public:
+    CompressedTrade(const string& id, const Envelope& env, const std::vector<boost::shared_ptr<Trade>>& trades);
+
+    void build(const boost::shared_ptr<EngineFactory>& engineFactory) override;
+
+    //! The trades represented by this trade
+    const std::vector<boost::shared_ptr<Trade>>& trades() const { return trades_; }
+
+    //! Serialisation is not supported, a compressed trade is derived from a built portfolio
+    void fromXML(XMLNode* node) override;
+
+private:
+    void buildSwap(const boost::shared_ptr<EngineFactory>& engineFactory);
+    void buildFxForward(const boost::shared_ptr<EngineFactory>& engineFactory);
+    std::vector<boost::shared_ptr<Trade>> trades_;
+};
+
+//! Check whether a built trade can be part of a compressed trade
+bool isCompressible(const boost::shared_ptr<Trade>& trade);
+
+//! Compress the linear trades of a built portfolio
+/*! Compressible trades (see isCompressible()) with the same counterparty, netting set and trade type are grouped, FX
+    Forwards in addition by currency pair and value date, Swaps by currency. Each group with at least \p minGroupSize
+    trades is replaced by a CompressedTrade built with \p engineFactory, the other trades are carried over as they are.
+    FX Forward groups whose net amounts are both received or both paid cannot be represented by a single FX Forward
+    and are not compressed either.
+
+    The portfolio must have been built with \p engineFactory. The constituents of each compressed trade are available
+    from CompressedTrade::trades(), which allows to allocate results to the original trades afterwards.
+*/
+boost::shared_ptr<Portfolio> compressPortfolio(const boost::shared_ptr<Portfolio>& portfolio,
+                                               const boost::shared_ptr<EngineFactory>& engineFactory,
+                                               QuantLib::Size minGroupSize = 2);
+
+//! Map from the ids of the original trades to the ids of the compressed trades representing them
+std::map<std::string, std::string> compressionMap(const Portfolio& portfolio);
+
+} // namespace data
+} // namespace ore
@@ -16,7 +16,9 @@
  FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
 */
 
+#include <boost/make_shared.hpp>
 #include <ored/portfolio/schedule.hpp>
+#include <ored/utilities/calendaradjustmentconfig.hpp>
 #include <ored/utilities/log.hpp>
 #include <ored/utilities/parsers.hpp>
 
@@ -182,9 +184,9 @@ void updateData(const std::string& s, T& t, bool& hasT, bool& hasConsistentT, co
 }
 // local wrapper function to get around optional parameter in parseCalendar
 Calendar parseCalendarTemp(const string& s) { return parseCalendar(s); }
-} // namespace
 
-Schedule makeSchedule(const ScheduleData& data) {
+// build a schedule from the date and rule based sub-schedules, used by the ScheduleCache
+Schedule buildSchedule(const ScheduleData& data) {
     // build all the date and rule based sub-schedules we have
     vector<Schedule> schedules;
     for (auto& d : data.dates())
@@ -272,5 +274,89 @@ Schedule makeSchedule(const ScheduleData& data) {
                         isRegular);
     }
 }
+
+// append a field to a schedule key, fields are separated by a character that does not appear in them
+void appendKey(std::string& key, const std::string& s) {
+    key += s;
+    key += '\x1f';
+}
+
+// the content of the schedule data as a string, used as key in the ScheduleCache, the version of the calendar
+// adjustments is part of the key, since they change the calendars the schedules are built with
+std::string scheduleKey(const ScheduleData& data) {
+    std::string key;
+    appendKey(key, std::to_string(CalendarAdjustments::instance().version()));
+    for (auto& d : data.dates()) {
+        appendKey(key, "D");
+        appendKey(key, d.calendar());
+        appendKey(key, d.convention());
+        appendKey(key, d.tenor());
+        appendKey(key, d.endOfMonth());
+        for (auto& date : d.dates())
+            appendKey(key, date);
+    }
+    for (auto& r : data.rules()) {
+        appendKey(key, "R");
+        appendKey(key, r.startDate());
+        appendKey(key, r.endDate());
+        appendKey(key, r.tenor());
+        appendKey(key, r.calendar());
+        appendKey(key, r.convention());
+        appendKey(key, r.termConvention());
+        appendKey(key, r.rule());
+        appendKey(key, r.endOfMonth());
+        appendKey(key, r.firstDate());
+        appendKey(key, r.lastDate());
+    }
+    return key;
+}
+} // namespace
+
+boost::shared_ptr<const Schedule> ScheduleCache::schedule(const ScheduleData& data) {
+    std::string key = scheduleKey(data);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = schedules_.find(key);
+        if (it != schedules_.end())
+            return it->second;
+    }
+    // build outside the lock, if another thread builds the same schedule meanwhile, the first one inserted is kept
+    boost::shared_ptr<const Schedule> schedule = boost::make_shared<const Schedule>(buildSchedule(data));
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (schedules_.size() >= maxSize_ && schedules_.find(key) == schedules_.end()) {
+        DLOG("ScheduleCache: maximum size " << maxSize_ << " reached, clearing the cache");
+        schedules_.clear();
+    }
+    return schedules_.insert(std::make_pair(key, schedule)).first->second;
+}
+
+Size ScheduleCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return schedules_.size();
+}
+
+Size ScheduleCache::maxSize() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return maxSize_;
+}
+
+void ScheduleCache::setMaxSize(Size maxSize) {
+    QL_REQUIRE(maxSize > 0, "ScheduleCache::setMaxSize(): maximum size must be positive");
+    std::lock_guard<std::mutex> lock(mutex_);
+    maxSize_ = maxSize;
+    if (schedules_.size() > maxSize_)
+        schedules_.clear();
+}
+
+void ScheduleCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    schedules_.clear();
+}
+
+Schedule makeSchedule(const ScheduleData& data) { return *ScheduleCache::instance().schedule(data); }
+
+boost::shared_ptr<const Schedule> makeSharedSchedule(const ScheduleData& data) {
+    return ScheduleCache::instance().schedule(data);
+}
 } // namespace data
 } // namespace ore
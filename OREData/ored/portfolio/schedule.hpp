@@ -23,9 +23,17 @@
 
 #pragma once
 
+#include <boost/serialization/string.hpp>
+#include <boost/serialization/vector.hpp>
 #include <ored/utilities/xmlutils.hpp>
+#include <ql/patterns/singleton.hpp>
 #include <ql/time/schedule.hpp>
 
+#include <boost/shared_ptr.hpp>
+
+#include <mutex>
+#include <unordered_map>
+
 namespace ore {
 namespace data {
 
@@ -75,6 +83,20 @@ private:
     string endOfMonth_;
     string firstDate_;
     string lastDate_;
+    //! Serialization
+    friend class boost::serialization::access;
+    template <class Archive> void serialize(Archive& ar, const unsigned int version) {
+        ar& startDate_;
+        ar& endDate_;
+        ar& tenor_;
+        ar& calendar_;
+        ar& convention_;
+        ar& termConvention_;
+        ar& rule_;
+        ar& endOfMonth_;
+        ar& firstDate_;
+        ar& lastDate_;
+    }
 };
 
 //! Serializable object holding schedule dates data
@@ -110,6 +132,15 @@ private:
     string tenor_;
     string endOfMonth_;
     vector<string> dates_;
+    //! Serialization
+    friend class boost::serialization::access;
+    template <class Archive> void serialize(Archive& ar, const unsigned int version) {
+        ar& calendar_;
+        ar& convention_;
+        ar& tenor_;
+        ar& endOfMonth_;
+        ar& dates_;
+    }
 };
 
 //! Serializable schedule data
@@ -146,10 +177,53 @@ public:
 private:
     vector<ScheduleDates> dates_;
     vector<ScheduleRules> rules_;
+    //! Serialization
+    friend class boost::serialization::access;
+    template <class Archive> void serialize(Archive& ar, const unsigned int version) {
+        ar& dates_;
+        ar& rules_;
+    }
+};
+
+//! Cache of schedules shared between trades
+/*! Large portfolios contain many trades with identical schedule data. The cache builds the schedule for each distinct
+    ScheduleData content once and hands out the same immutable instance afterwards. The cache can be used from several
+    threads.
+
+    Schedules only depend on the schedule data and the calendars. Calendar adjustments set via CalendarAdjustments
+    are part of the cache key, the cache must be cleared if holidays are added to or removed from a calendar directly
+    after schedules have been built. The cache holds at most maxSize() schedules, it is cleared when it is full.
+
+    \ingroup tradedata
+*/
+class ScheduleCache : public QuantLib::Singleton<ScheduleCache> {
+
+    friend class QuantLib::Singleton<ScheduleCache>;
+
+public:
+    //! Return the schedule for \p data, building it if it is not in the cache yet
+    boost::shared_ptr<const QuantLib::Schedule> schedule(const ScheduleData& data);
+    //! Number of distinct schedules in the cache
+    QuantLib::Size size() const;
+    //! Maximum number of schedules in the cache
+    QuantLib::Size maxSize() const;
+    //! Set the maximum number of schedules in the cache (default 100000)
+    void setMaxSize(QuantLib::Size maxSize);
+    //! Remove all schedules from the cache
+    void clear();
+
+private:
+    ScheduleCache() : maxSize_(100000) {}
+    mutable std::mutex mutex_;
+    QuantLib::Size maxSize_;
+    std::unordered_map<std::string, boost::shared_ptr<const QuantLib::Schedule>> schedules_;
 };
 
 //! Functions
+/*! Schedules built from ScheduleData are taken from the ScheduleCache */
 QuantLib::Schedule makeSchedule(const ScheduleData& data);
+/*! The schedule instance of the ScheduleCache, which avoids copying the dates */
+boost::shared_ptr<const QuantLib::Schedule> makeSharedSchedule(const ScheduleData& data);
 QuantLib::Schedule makeSchedule(const ScheduleDates& dates);
 QuantLib::Schedule makeSchedule(const ScheduleRules& rules);
 } // namespace data
@@ -16,6 +16,8 @@
  FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
 */
 
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
 #include <ored/portfolio/builders/swap.hpp>
 #include <ored/portfolio/fixingdates.hpp>
 #include <ored/portfolio/legbuilders.hpp>
@@ -339,3 +341,5 @@ XMLNode* Swap::toXML(XMLDocument& doc) {
 }
 } // namespace data
 } // namespace ore
+
+BOOST_CLASS_EXPORT_GUID(ore::data::Swap, "Swap");
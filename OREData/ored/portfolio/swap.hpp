@@ -74,6 +74,13 @@ protected:
 
 private:
     string settlement_;
+    //! Serialization
+    friend class boost::serialization::access;
+    template <class Archive> void serialize(Archive& ar, const unsigned int version) {
+        ar& boost::serialization::base_object<Trade>(*this);
+        ar& legData_;
+        ar& settlement_;
+    }
 };
 } // namespace data
 } // namespace ore
@@ -85,6 +85,14 @@ private:
 
     //! Store the underlying swap's floating leg
     QuantLib::Leg underlyingLeg_;
+
+    //! Serialization
+    friend class boost::serialization::access;
+    template <class Archive> void serialize(Archive& ar, const unsigned int version) {
+        ar& boost::serialization::base_object<Trade>(*this);
+        ar& option_;
+        ar& swap_;
+    }
 };
 } // namespace data
 } // namespace ore
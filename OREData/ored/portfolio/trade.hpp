@@ -23,6 +23,9 @@
 
 #pragma once
 
+#include <boost/serialization/base_object.hpp>
+#include <boost/serialization/export.hpp>
+#include <boost/serialization/string.hpp>
 #include <ored/portfolio/enginefactory.hpp>
 #include <ored/portfolio/envelope.hpp>
 #include <ored/portfolio/fixingdates.hpp>
@@ -47,6 +50,8 @@ using std::string;
     - contain additional serializable data classes
     - implement a build() function that parses data and constructs QuantLib
       and QuantExt objects
+    - optionally implement a boost serialize() function for the trade data and export
+      the class, so that the trade can be stored in a binary portfolio cache
  \ingroup portfolio
 */
 class Trade : public XMLSerializable {
@@ -186,6 +191,14 @@ private:
     string id_;
     Envelope envelope_;
     TradeActions tradeActions_;
+    //! Serialization, changes require a new schema version of the portfolio cache, see Portfolio::saveCache()
+    friend class boost::serialization::access;
+    template <class Archive> void serialize(Archive& ar, const unsigned int version) {
+        ar& tradeType_;
+        ar& id_;
+        ar& envelope_;
+        ar& tradeActions_;
+    }
 };
 } // namespace data
 } // namespace ore
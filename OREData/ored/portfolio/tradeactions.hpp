@@ -23,6 +23,7 @@
 
 #pragma once
 
+#include <boost/serialization/vector.hpp>
 #include <ored/portfolio/schedule.hpp>
 #include <ored/utilities/xmlutils.hpp>
 
@@ -65,6 +66,13 @@ private:
     string type_;
     string owner_;
     ScheduleData schedule_;
+    //! Serialization
+    friend class boost::serialization::access;
+    template <class Archive> void serialize(Archive& ar, const unsigned int version) {
+        ar& type_;
+        ar& owner_;
+        ar& schedule_;
+    }
 };
 
 //! Serializable object holding generic trade actions
@@ -87,6 +95,11 @@ public:
 
 private:
     vector<TradeAction> actions_;
+    //! Serialization
+    friend class boost::serialization::access;
+    template <class Archive> void serialize(Archive& ar, const unsigned int version) {
+        ar& actions_;
+    }
 };
 } // namespace data
 } // namespace ore
@@ -81,12 +81,19 @@ public:
     const CalendarAdjustmentConfig& config() const { return config_; }
 
     //! set the global config
-    void setConfig(const CalendarAdjustmentConfig& c) { config_ = c; }
+    void setConfig(const CalendarAdjustmentConfig& c) {
+        config_ = c;
+        ++version_;
+    }
+
+    //! number of times the global config was set, used to invalidate cached calendars
+    QuantLib::Size version() const { return version_; }
 
 private:
     CalendarAdjustmentConfig config_;
+    QuantLib::Size version_;
 
-    CalendarAdjustments() {}
+    CalendarAdjustments() : version_(0) {}
 };
 
 } // namespace data
@@ -41,6 +41,7 @@
 #include <boost/algorithm/string.hpp>
 #include <boost/shared_ptr.hpp>
 #include <map>
+#include <mutex>
 #include <ql/qldefines.hpp>
 #include <queue>
 
@@ -197,7 +198,8 @@ private:
   Once a message is recieved, it is imediatly dispatched to each of the registered loggers, the order in which
   the loggers are called is not guarenteed.
 
-  Logging is done by the calling thread and the LOG call blocks until all the loggers have returned.
+  Logging is done by the calling thread and the LOG call blocks until all the loggers have returned. Messages
+  from several threads are serialised.
 
   At start up, the Log class has no loggers and so will ignore any LOG() messages until it is configured.
 
@@ -275,6 +277,9 @@ public:
     //! if a PID is set for the logger, messages are tagged with [1234] if pid = 1234
     void setPid(const int pid) { pid_ = pid; }
 
+    //! macro utility function - do not use directly, the lock must be held while a message is logged
+    std::recursive_mutex& mutex() { return mutex_; }
+
 private:
     Log();
 
@@ -282,6 +287,7 @@ private:
     bool enabled_;
     unsigned mask_;
     std::ostringstream ls_;
+    std::recursive_mutex mutex_;
 
     int pid_ = 0;
 };
@@ -291,6 +297,7 @@ private:
  */
 #define MLOG(mask, text)                                                                                               \
     if (ore::data::Log::instance().enabled() && ore::data::Log::instance().filter(mask)) {                             \
+        std::lock_guard<std::recursive_mutex> oreLogLock(ore::data::Log::instance().mutex());                          \
         ore::data::Log::instance().header(mask, __FILE__, __LINE__);                                                   \
         ore::data::Log::instance().logStream() << text;                                                                \
         ore::data::Log::instance().log(mask);                                                                          \
@@ -314,6 +321,7 @@ private:
 //! Logging macro specifically for logging memory usage
 #define MEM_LOG                                                                                                        \
     if (ore::data::Log::instance().enabled() && ore::data::Log::instance().filter(ORE_MEMORY)) {                       \
+        std::lock_guard<std::recursive_mutex> oreLogLock(ore::data::Log::instance().mutex());                          \
         ore::data::Log::instance().header(ORE_MEMORY, __FILE__, __LINE__);                                             \
         ore::data::Log::instance().logStream() << std::to_string(ore::data::os::getPeakMemoryUsageBytes()) << "|";     \
         ore::data::Log::instance().logStream() << std::to_string(ore::data::os::getMemoryUsageBytes());                \
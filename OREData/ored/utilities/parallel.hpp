@@ -0,0 +1,88 @@
+/*
+ Copyright (C) 2020 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file ored/utilities/parallel.hpp
+    \brief utilities for running independent tasks on several threads
+    \ingroup utilities
+*/
+
+#pragma once
+
+#include <ql/types.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace ore {
+namespace data {
+
+//! Number of threads to use for \p tasks independent tasks
+/*! If \p maxThreads is zero, the number of hardware threads is used as the upper bound. The result is
+    at least one and at most \p tasks (unless \p tasks is zero).
+
+    \ingroup utilities
+*/
+inline QuantLib::Size numberOfThreads(QuantLib::Size tasks, QuantLib::Size maxThreads = 0) {
+    if (maxThreads == 0)
+        maxThreads = std::max<QuantLib::Size>(std::thread::hardware_concurrency(), 1);
+    return std::max<QuantLib::Size>(std::min(tasks, maxThreads), 1);
+}
+
+//! Calls \p f(i) for i = 0, ..., n-1 on up to \p maxThreads threads
+/*! The indices are handed out to the threads in ascending order. If one or more calls throw, all
+    remaining calls are still made and the exception of the call with the lowest index is rethrown
+    after all threads have finished. With a single thread, the calls are made on the calling thread.
+
+    \p f must be safe to call concurrently for different indices. In particular, QuantLib observables
+    shared between the calls must not be modified while the calls are running.
+
+    \ingroup utilities
+*/
+template <class F> void parallelFor(QuantLib::Size n, F f, QuantLib::Size maxThreads = 0) {
+    std::vector<std::exception_ptr> errors(n);
+    std::atomic<QuantLib::Size> next(0);
+    auto worker = [&]() {
+        for (QuantLib::Size i = next++; i < n; i = next++) {
+            try {
+                f(i);
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+        }
+    };
+    QuantLib::Size nThreads = numberOfThreads(n, maxThreads);
+    if (nThreads == 1) {
+        worker();
+    } else {
+        std::vector<std::thread> threads;
+        for (QuantLib::Size t = 0; t < nThreads; ++t)
+            threads.emplace_back(worker);
+        for (auto& t : threads)
+            t.join();
+    }
+    for (auto const& e : errors) {
+        if (e)
+            std::rethrow_exception(e);
+    }
+}
+
+} // namespace data
+} // namespace ore
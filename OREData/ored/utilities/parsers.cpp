@@ -23,6 +23,7 @@
 
 #include <boost/algorithm/string.hpp>
 #include <map>
+#include <mutex>
 #include <ored/utilities/calendaradjustmentconfig.hpp>
 #include <ored/utilities/parsers.hpp>
 #include <ql/currencies/all.hpp>
@@ -34,6 +35,7 @@
 #include <ql/version.hpp>
 #include <qle/calendars/austria.hpp>
 #include <qle/calendars/belgium.hpp>
+#include <qle/calendars/cachedcalendar.hpp>
 #include <qle/calendars/chile.hpp>
 #include <qle/calendars/cme.hpp>
 #include <qle/calendars/colombia.hpp>
@@ -168,7 +170,10 @@ bool parseBool(const string& s) {
     }
 }
 
-Calendar parseCalendar(const string& s, bool adjustCalendar) {
+namespace {
+// Builds the calendar for parseCalendar(), adjusted is set to true if calendar adjustments were applied.
+// Only called while parseCalendar() holds its lock.
+Calendar buildCalendar(const string& s, bool adjustCalendar, bool& adjusted) {
     static map<string, Calendar> m = {
         {"TGT", TARGET()},
         {"TARGET", TARGET()},
@@ -447,17 +452,20 @@ Calendar parseCalendar(const string& s, bool adjustCalendar) {
     auto it = m.find(s);
     if (it != m.end()) {
         Calendar cal = it->second;
-        if (adjustCalendar) {
-            // add custom holidays from populated calendar adjustments
-            const CalendarAdjustmentConfig& config = CalendarAdjustments::instance().config();
-            for (auto h : config.getHolidays(s)) {
-                cal.addHoliday(h);
-            }
-            for (auto b : config.getBusinessDays(s)) {
-                cal.removeHoliday(b);
-            }
+        if (!adjustCalendar)
+            return cal;
+        // add custom holidays from populated calendar adjustments
+        const CalendarAdjustmentConfig& config = CalendarAdjustments::instance().config();
+        for (auto h : config.getHolidays(s)) {
+            cal.addHoliday(h);
+            adjusted = true;
         }
-        return cal;
+        for (auto b : config.getBusinessDays(s)) {
+            cal.removeHoliday(b);
+            adjusted = true;
+        }
+        // precompute the business days of the adjusted calendar
+        return CachedCalendar(cal);
 
     } else {
         // Try to split them up
@@ -488,6 +496,36 @@ Calendar parseCalendar(const string& s, bool adjustCalendar) {
         return LargeJointCalendar(calendars);
     }
 }
+} // namespace
+
+Calendar parseCalendar(const string& s, bool adjustCalendar) {
+    // parsed calendars are shared, so that the business days of each calendar are computed only once
+    // the lock is recursive, since the calendar adjustments call back into parseCalendar()
+    static std::recursive_mutex mutex;
+    static map<pair<string, bool>, Calendar> cache;
+    static Size cacheVersion = 0;
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    Size version = CalendarAdjustments::instance().version();
+    if (version != cacheVersion) {
+        cache.clear();
+        cacheVersion = version;
+    }
+    auto c = cache.find(make_pair(s, adjustCalendar));
+    if (c != cache.end())
+        return c->second;
+    bool adjusted = false;
+    Calendar cal = buildCalendar(s, adjustCalendar, adjusted);
+    if (adjusted) {
+        // the adjustments are applied to the underlying calendars, cached unadjusted calendars are outdated
+        for (auto it = cache.begin(); it != cache.end();) {
+            if (!it->first.second)
+                it = cache.erase(it);
+            else
+                ++it;
+        }
+    }
+    return cache.emplace(make_pair(s, adjustCalendar), cal).first->second;
+}
 
 Period parsePeriod(const string& s) { return PeriodParser::parse(s); }
 
@@ -0,0 +1,161 @@
+/*
+ Copyright (C) 2020 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <ored/utilities/xmlelementreader.hpp>
+
+#include <ql/errors.hpp>
+
+#include <algorithm>
+#include <cctype>
+
+namespace ore {
+namespace data {
+
+XMLElementReader::XMLElementReader(const std::string& fileName, const std::string& elementName, Size bufferSize)
+    : fileName_(fileName), elementName_(elementName), bufferSize_(std::max<Size>(bufferSize, 1)), pos_(0),
+      elementsRead_(0) {
+    QL_REQUIRE(!elementName.empty(), "XMLElementReader: element name must not be empty");
+    file_.open(fileName, std::ios::binary);
+    QL_REQUIRE(file_.is_open(), "XMLElementReader: error opening file " << fileName);
+}
+
+bool XMLElementReader::next(std::string& element) {
+    QL_REQUIRE(file_.is_open(), "XMLElementReader: file is not open, can not read next element");
+    Size depth = 0, start = std::string::npos, p = pos_;
+    while (true) {
+        p = find("<", p);
+        if (p == std::string::npos) {
+            QL_REQUIRE(depth == 0,
+                       "XMLElementReader: unexpected end of file " << fileName_ << " in element " << elementName_);
+            close();
+            return false;
+        }
+        if (startsWith(p, "<!--")) {
+            p = find("-->", p + 4);
+            QL_REQUIRE(p != std::string::npos, "XMLElementReader: unterminated comment in file " << fileName_);
+            p += 3;
+        } else if (startsWith(p, "<![CDATA[")) {
+            p = find("]]>", p + 9);
+            QL_REQUIRE(p != std::string::npos, "XMLElementReader: unterminated CDATA section in file " << fileName_);
+            p += 3;
+        } else if (startsWith(p, "<?") || startsWith(p, "<!")) {
+            p = tagEnd(p) + 1;
+        } else {
+            Size e = tagEnd(p);
+            bool closing = buffer_[p + 1] == '/';
+            bool selfClosing = !closing && buffer_[e - 1] == '/';
+            Size n = p + (closing ? 2 : 1), nEnd = n;
+            while (nEnd < e && buffer_[nEnd] != '/' && !std::isspace(static_cast<unsigned char>(buffer_[nEnd])))
+                ++nEnd;
+            if (buffer_.compare(n, nEnd - n, elementName_) == 0) {
+                if (closing) {
+                    QL_REQUIRE(depth > 0, "XMLElementReader: unexpected closing tag </"
+                                              << elementName_ << "> in file " << fileName_);
+                    --depth;
+                } else {
+                    if (depth == 0)
+                        start = p;
+                    if (!selfClosing)
+                        ++depth;
+                }
+                if (depth == 0) {
+                    element.assign(buffer_, start, e + 1 - start);
+                    pos_ = e + 1;
+                    compact();
+                    ++elementsRead_;
+                    return true;
+                }
+            }
+            p = e + 1;
+        }
+        // outside of an element nothing before p is needed anymore
+        if (depth == 0) {
+            pos_ = p;
+            compact();
+            p = pos_;
+        }
+    }
+}
+
+void XMLElementReader::close() {
+    if (file_.is_open())
+        file_.close();
+    buffer_.clear();
+    pos_ = 0;
+}
+
+bool XMLElementReader::read() {
+    if (!file_.is_open() || file_.eof())
+        return false;
+    Size size = buffer_.size();
+    buffer_.resize(size + bufferSize_);
+    file_.read(&buffer_[size], bufferSize_);
+    buffer_.resize(size + static_cast<Size>(file_.gcount()));
+    return buffer_.size() > size;
+}
+
+bool XMLElementReader::ensure(Size p, Size n) {
+    while (buffer_.size() < p + n) {
+        if (!read())
+            return false;
+    }
+    return true;
+}
+
+bool XMLElementReader::startsWith(Size p, const std::string& s) {
+    return ensure(p, s.size()) && buffer_.compare(p, s.size(), s) == 0;
+}
+
+Size XMLElementReader::find(const std::string& s, Size p) {
+    while (true) {
+        Size r = buffer_.find(s, p);
+        if (r != std::string::npos)
+            return r;
+        // a match may start in the last s.size() - 1 characters and continue in the next chunk
+        if (buffer_.size() >= s.size())
+            p = std::max(p, buffer_.size() - s.size() + 1);
+        if (!read())
+            return std::string::npos;
+    }
+}
+
+Size XMLElementReader::tagEnd(Size p) {
+    char quote = 0;
+    for (Size i = p + 1;; ++i) {
+        QL_REQUIRE(ensure(i, 1), "XMLElementReader: unterminated tag in file " << fileName_);
+        char c = buffer_[i];
+        if (quote != 0) {
+            if (c == quote)
+                quote = 0;
+        } else if (c == '"' || c == '\'') {
+            quote = c;
+        } else if (c == '>') {
+            return i;
+        }
+    }
+}
+
+void XMLElementReader::compact() {
+    if (pos_ >= bufferSize_) {
+        buffer_.erase(0, pos_);
+        pos_ = 0;
+    }
+}
+
+} // namespace data
+} // namespace ore
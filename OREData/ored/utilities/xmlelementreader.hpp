@@ -0,0 +1,79 @@
+/*
+ Copyright (C) 2020 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file ored/utilities/xmlelementreader.hpp
+    \brief utility class to read the elements with a given name from an XML file one at a time
+    \ingroup utilities
+*/
+
+#pragma once
+
+#include <ql/types.hpp>
+
+#include <fstream>
+#include <string>
+
+namespace ore {
+namespace data {
+using QuantLib::Size;
+
+//! Reads the elements with a given name from an XML file one at a time
+/*! The file is read in chunks of \p bufferSize bytes and only the part of the file belonging to the current
+    element is kept in memory, so that arbitrarily large files can be processed. The elements are found by a
+    light weight scan of the tags, which skips comments, processing instructions and CDATA sections. The
+    elements are returned as strings, they are not checked to be well formed XML beyond the matching of the
+    opening and closing tags with the given name. Elements with the given name nested in a matching element are
+    returned as part of the outer element.
+
+    \ingroup utilities
+*/
+class XMLElementReader {
+public:
+    /*! Ctor */
+    XMLElementReader(const std::string& fileName, const std::string& elementName, Size bufferSize = 1 << 20);
+
+    /*! Read the next element into \p element, returns false if there are no more elements in the file */
+    bool next(std::string& element);
+    /*! Number of elements read so far */
+    Size elementsRead() const { return elementsRead_; }
+    /*! Close the file */
+    void close();
+
+private:
+    // read the next chunk of the file into the buffer, returns false at the end of the file
+    bool read();
+    // make sure that the buffer contains at least n characters starting at p, returns false otherwise
+    bool ensure(Size p, Size n);
+    // true if the buffer contains s at p
+    bool startsWith(Size p, const std::string& s);
+    // position of the next occurrence of s at or after p, npos if there is none
+    Size find(const std::string& s, Size p);
+    // position of the '>' closing the tag starting at p, ignoring quoted attribute values
+    Size tagEnd(Size p);
+    // drop the part of the buffer before pos_ once it is large enough
+    void compact();
+
+    const std::string fileName_, elementName_;
+    const Size bufferSize_;
+    std::ifstream file_;
+    std::string buffer_;
+    Size pos_, elementsRead_;
+};
+
+} // namespace data
+} // namespace ore
@@ -0,0 +1,131 @@
+/*
+ Copyright (C) 2020 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <boost/make_shared.hpp>
+#include <boost/test/unit_test.hpp>
+#include <ored/portfolio/builders/cachingenginebuilder.hpp>
+#include <ored/portfolio/enginedata.hpp>
+#include <ored/portfolio/enginefactory.hpp>
+#include <ored/utilities/parallel.hpp>
+#include <oret/toplevelfixture.hpp>
+#include <ql/pricingengines/swap/discountingswapengine.hpp>
+
+#include <atomic>
+
+using namespace QuantLib;
+using namespace boost::unit_test_framework;
+using namespace std;
+using namespace ore::data;
+
+namespace {
+
+// builder that counts the engines it builds, keyed by a string
+class CountingEngineBuilder : public CachingPricingEngineBuilder<string, const string&> {
+public:
+    CountingEngineBuilder() : CachingEngineBuilder("TestModel", "TestEngine", {"TestTrade"}), built(0) {}
+    std::atomic<Size> built;
+
+protected:
+    string keyImpl(const string& key) override { return key; }
+    boost::shared_ptr<PricingEngine> engineImpl(const string&) override {
+        ++built;
+        return boost::make_shared<DiscountingSwapEngine>();
+    }
+};
+
+// builder that fails to build the first engine requested from it
+class FailingEngineBuilder : public CachingPricingEngineBuilder<string, const string&> {
+public:
+    FailingEngineBuilder() : CachingEngineBuilder("TestModel", "TestEngine", {"TestTrade"}), failures(1) {}
+    std::atomic<int> failures;
+
+protected:
+    string keyImpl(const string& key) override { return key; }
+    boost::shared_ptr<PricingEngine> engineImpl(const string&) override {
+        QL_REQUIRE(failures-- <= 0, "engine build failed");
+        return boost::make_shared<DiscountingSwapEngine>();
+    }
+};
+
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(OREDataTestSuite, ore::test::TopLevelFixture)
+
+BOOST_AUTO_TEST_SUITE(EngineFactoryTests)
+
+BOOST_AUTO_TEST_CASE(testCachingEngineBuilderStatistics) {
+
+    BOOST_TEST_MESSAGE("Testing the engine cache and statistics of a CachingEngineBuilder");
+
+    boost::shared_ptr<EngineData> engineData = boost::make_shared<EngineData>();
+    engineData->model("TestTrade") = "TestModel";
+    engineData->engine("TestTrade") = "TestEngine";
+    boost::shared_ptr<CountingEngineBuilder> counting = boost::make_shared<CountingEngineBuilder>();
+    std::vector<boost::shared_ptr<EngineBuilder>> extraBuilders = {counting};
+    boost::shared_ptr<EngineFactory> factory =
+        boost::make_shared<EngineFactory>(engineData, nullptr, std::map<MarketContext, string>(), extraBuilders);
+
+    // request 10 distinct engines 100 times each, possibly from several threads
+    const Size nKeys = 10, nRequests = 1000;
+    vector<boost::shared_ptr<PricingEngine>> engines(nRequests);
+    parallelFor(nRequests, [&factory, &engines, nKeys](Size i) {
+        auto builder = boost::dynamic_pointer_cast<CountingEngineBuilder>(factory->builder("TestTrade"));
+        engines[i] = builder->engine("key_" + std::to_string(i % nKeys));
+    });
+
+    // each key is built once and the same engine is returned for the same key
+    BOOST_CHECK_EQUAL(counting->built, nKeys);
+    for (Size i = 0; i < nRequests; ++i)
+        BOOST_CHECK(engines[i] == engines[i % nKeys]);
+
+    EngineBuilderStatistics stats = counting->statistics();
+    BOOST_CHECK_EQUAL(stats.misses, nKeys);
+    BOOST_CHECK_EQUAL(stats.hits, nRequests - nKeys);
+    BOOST_CHECK_EQUAL(stats.engines, nKeys);
+    BOOST_CHECK(stats.buildTime >= 0.0);
+
+    // the factory reports the same statistics for the builder
+    auto all = factory->statistics();
+    auto it = all.find(std::make_tuple(string("TestModel"), string("TestEngine"), set<string>{"TestTrade"}));
+    BOOST_REQUIRE(it != all.end());
+    BOOST_CHECK_EQUAL(it->second.hits, stats.hits);
+    BOOST_CHECK_EQUAL(it->second.misses, stats.misses);
+    BOOST_CHECK_EQUAL(it->second.engines, stats.engines);
+}
+
+BOOST_AUTO_TEST_CASE(testCachingEngineBuilderFailure) {
+
+    BOOST_TEST_MESSAGE("Testing that a CachingEngineBuilder builds an engine again after a failed build");
+
+    FailingEngineBuilder builder;
+    BOOST_CHECK_THROW(builder.engine("key"), QuantLib::Error);
+    BOOST_CHECK_EQUAL(builder.statistics().engines, 0);
+
+    boost::shared_ptr<PricingEngine> engine = builder.engine("key");
+    BOOST_CHECK(engine);
+    BOOST_CHECK(builder.engine("key") == engine);
+
+    EngineBuilderStatistics stats = builder.statistics();
+    BOOST_CHECK_EQUAL(stats.misses, 1);
+    BOOST_CHECK_EQUAL(stats.hits, 1);
+    BOOST_CHECK_EQUAL(stats.engines, 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
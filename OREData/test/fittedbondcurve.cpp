@@ -21,9 +21,13 @@
 #include <oret/datapaths.hpp>
 #include <oret/toplevelfixture.hpp>
 
+#include <ored/configuration/curveconfigurations.hpp>
 #include <ored/marketdata/fittedbondcurvehelpermarket.hpp>
+#include <ored/marketdata/inmemoryloader.hpp>
+#include <ored/marketdata/yieldcurve.hpp>
 #include <ored/portfolio/enginefactory.hpp>
 #include <ored/portfolio/portfolio.hpp>
+#include <ored/portfolio/referencedata.hpp>
 
 #include <ql/math/initializers.hpp>
 #include <ql/pricingengines/bond/discountingbondengine.hpp>
@@ -86,6 +90,43 @@ BOOST_AUTO_TEST_CASE(testCurveFromFixedRateBonds) {
 #endif
 }
 
+BOOST_AUTO_TEST_CASE(testCalibrationTrialsThreads) {
+
+#if QL_HEX_VERSION >= 0x01190000 || defined(QL_ORE_PATCH)
+    Date asof(6, April, 2020);
+    Settings::instance().evaluationDate() = asof;
+
+    BOOST_TEST_MESSAGE("set up bond reference data, quotes and a Nelson-Siegel curve config with 8 trials");
+    auto referenceData = boost::make_shared<BasicReferenceDataManager>(TEST_INPUT_FILE("referencedata.xml"));
+    InMemoryLoader loader;
+    std::vector<std::string> quotes;
+    for (auto const& q : std::vector<std::pair<std::string, Real>>{
+             {"SECURITY_1Y", 1.028}, {"SECURITY_2Y", 1.066}, {"SECURITY_3Y", 1.115}, {"SECURITY_5Y", 1.24}}) {
+        quotes.push_back("BOND/PRICE/" + q.first);
+        loader.add(asof, quotes.back(), q.second);
+    }
+    // the accuracy is not reached, so that all trials are run
+    CurveConfigurations curveConfigs;
+    curveConfigs.yieldCurveConfig("BOND_CURVE") = boost::make_shared<YieldCurveConfig>(
+        "BOND_CURVE", "fitted bond curve", "EUR", "",
+        std::vector<boost::shared_ptr<YieldCurveSegment>>{boost::make_shared<FittedBondYieldCurveSegment>(
+            "FittedBond", quotes, std::map<std::string, std::string>(), false, 8)},
+        "Discount", "NelsonSiegel", "A365", true, BootstrapConfig(1.0E-20, Null<Real>(), true, 8));
+    Conventions conventions;
+
+    BOOST_TEST_MESSAGE("build the curve with one and with several threads");
+    YieldCurve sequential(asof, YieldCurveSpec("EUR", "BOND_CURVE"), curveConfigs, loader, conventions, {},
+                          FXTriangulation(), referenceData, 1);
+    YieldCurve parallel(asof, YieldCurveSpec("EUR", "BOND_CURVE"), curveConfigs, loader, conventions, {},
+                        FXTriangulation(), referenceData, 4);
+    for (Size y = 1; y <= 10; ++y) {
+        Date d = asof + y * Years;
+        BOOST_TEST_MESSAGE("discount factor " << d << ": " << sequential.handle()->discount(d));
+        BOOST_CHECK_EQUAL(sequential.handle()->discount(d), parallel.handle()->discount(d));
+    }
+#endif
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
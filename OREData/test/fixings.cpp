@@ -25,6 +25,7 @@
 #include <ored/configuration/curveconfigurations.hpp>
 #include <ored/marketdata/csvloader.hpp>
 #include <ored/marketdata/fixings.hpp>
+#include <ored/marketdata/fixingstore.hpp>
 #include <ored/marketdata/todaysmarket.hpp>
 #include <ored/marketdata/todaysmarketparameters.hpp>
 #include <ored/portfolio/enginefactory.hpp>
@@ -388,6 +389,62 @@ BOOST_FIXTURE_TEST_CASE(testDividends, F) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(testFixingStore) {
+
+    BOOST_TEST_MESSAGE("Testing the columnar fixing store");
+
+    // fixings out of date order and with a duplicate, the last fixing wins
+    vector<Fixing> fixings = {Fixing(Date(4, Feb, 2019), "EUR-EURIBOR-6M", 0.01),
+                              Fixing(Date(1, Feb, 2019), "EUR-EURIBOR-6M", 0.02),
+                              Fixing(Date(5, Feb, 2019), "EUR-EURIBOR-6M", 0.03),
+                              Fixing(Date(1, Feb, 2019), "USD-LIBOR-3M", 0.04),
+                              Fixing(Date(4, Feb, 2019), "EUR-EURIBOR-6M", 0.05),
+                              Fixing(Date(2, Feb, 2019), "EUR-EURIBOR-6M", 0.06)};
+    FixingStore store(fixings);
+
+    BOOST_CHECK_EQUAL(store.size(), 5);
+    BOOST_CHECK(store.names() == set<string>({"EUR-EURIBOR-6M", "USD-LIBOR-3M"}));
+    vector<Date> expDates = {Date(1, Feb, 2019), Date(2, Feb, 2019), Date(4, Feb, 2019), Date(5, Feb, 2019)};
+    vector<Real> expValues = {0.02, 0.06, 0.05, 0.03};
+    BOOST_CHECK_EQUAL_COLLECTIONS(store.dates("EUR-EURIBOR-6M").begin(), store.dates("EUR-EURIBOR-6M").end(),
+                                  expDates.begin(), expDates.end());
+    BOOST_CHECK_EQUAL_COLLECTIONS(store.values("EUR-EURIBOR-6M").begin(), store.values("EUR-EURIBOR-6M").end(),
+                                  expValues.begin(), expValues.end());
+    BOOST_CHECK_EQUAL(store.fixing("EUR-EURIBOR-6M", Date(4, Feb, 2019)), 0.05);
+    BOOST_CHECK(store.fixing("EUR-EURIBOR-6M", Date(3, Feb, 2019)) == Null<Real>());
+    BOOST_CHECK(store.fixing("GBP-LIBOR-6M", Date(4, Feb, 2019)) == Null<Real>());
+
+    // date range queries
+    TimeSeries<Real> ts = store.timeSeries("EUR-EURIBOR-6M", Date(2, Feb, 2019), Date(4, Feb, 2019));
+    BOOST_CHECK_EQUAL(ts.size(), 2);
+    BOOST_CHECK_EQUAL(ts[Date(2, Feb, 2019)], 0.06);
+    BOOST_CHECK_EQUAL(ts[Date(4, Feb, 2019)], 0.05);
+    BOOST_CHECK(store.timeSeries("EUR-EURIBOR-6M", Date(6, Feb, 2019), Date(10, Feb, 2019)).empty());
+    BOOST_CHECK_EQUAL(store.timeSeries("EUR-EURIBOR-6M").size(), 4);
+
+    // binary round trip
+    string fileName = TEST_OUTPUT_FILE("fixingstore.bin");
+    store.save(fileName);
+    FixingStore loaded(fileName);
+    vector<Fixing> f1 = store.fixings(), f2 = loaded.fixings();
+    BOOST_REQUIRE_EQUAL(f1.size(), f2.size());
+    for (Size i = 0; i < f1.size(); ++i) {
+        BOOST_CHECK_EQUAL(f1[i].date, f2[i].date);
+        BOOST_CHECK_EQUAL(f1[i].name, f2[i].name);
+        BOOST_CHECK_EQUAL(f1[i].fixing, f2[i].fixing);
+    }
+
+    // bulk load into the index manager, 2 Feb 2019 is a Saturday and is skipped
+    IndexManager::instance().clearHistories();
+    applyFixings(loaded, Conventions());
+    TimeSeries<Real> history = parseIndex("EUR-EURIBOR-6M")->timeSeries();
+    BOOST_CHECK_EQUAL(history.size(), 3);
+    BOOST_CHECK_EQUAL(history[Date(1, Feb, 2019)], 0.02);
+    BOOST_CHECK_EQUAL(history[Date(4, Feb, 2019)], 0.05);
+    BOOST_CHECK_EQUAL(history[Date(5, Feb, 2019)], 0.03);
+    BOOST_CHECK_EQUAL(parseIndex("USD-LIBOR-3M")->timeSeries().size(), 1);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
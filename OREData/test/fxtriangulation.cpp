@@ -113,13 +113,34 @@ BOOST_AUTO_TEST_CASE(testMoreThanOneStep) {
     // Larger tolerance for multiple steps
     Real tol = 1e-8;
 
-    // Check that we don't handle more than one step
     // EURUSD + EURAUD + AUDNZD => USDNZD
-    BOOST_CHECK_THROW(fx.getQuote("USDNZD"), QuantLib::Error);
-    // but if we cache EURNZD first....
-    BOOST_CHECK_CLOSE(fx.getQuote("EURNZD")->value(), 1.6450, tol);
-    // then we should be able to get it with one step
     BOOST_CHECK_CLOSE(fx.getQuote("USDNZD")->value(), 1.6450 / 1.0861, tol);
+    BOOST_CHECK_CLOSE(fx.getQuote("NZDUSD")->value(), 1.0861 / 1.6450, tol);
+    BOOST_CHECK_CLOSE(fx.getQuote("EURNZD")->value(), 1.6450, tol);
+    // ZZZEUR + EURAUD + AUDNZD => ZZZNZD
+    BOOST_CHECK_CLOSE(fx.getQuote("ZZZNZD")->value(), 3.141 * 1.6450, tol);
+}
+
+BOOST_AUTO_TEST_CASE(testQuoteChanges) {
+
+    Real tol = 1e-12;
+
+    // constructed quotes follow the original quotes
+    boost::shared_ptr<SimpleQuote> eurUsd = boost::make_shared<SimpleQuote>(1.0861);
+    fx.addQuote("EURUSD", Handle<Quote>(eurUsd));
+    Handle<Quote> usdJpy = fx.getQuote("USDJPY");
+    BOOST_CHECK_CLOSE(usdJpy->value(), 128.51 / 1.0861, tol);
+    eurUsd->setValue(1.2);
+    BOOST_CHECK_CLOSE(usdJpy->value(), 128.51 / 1.2, tol);
+
+    // added quotes take precedence over constructed ones
+    fx.addQuote("USDJPY", Handle<Quote>(boost::make_shared<SimpleQuote>(110.0)));
+    BOOST_CHECK_EQUAL(fx.getQuote("USDJPY")->value(), 110.0);
+    BOOST_CHECK_CLOSE(fx.getQuote("JPYUSD")->value(), 1.0 / 110.0, tol);
+
+    // a copy holds the same quotes
+    FXTriangulation copy(fx);
+    BOOST_CHECK_CLOSE(copy.getQuote("GBPUSD")->value(), fx.getQuote("GBPUSD")->value(), tol);
 }
 
 BOOST_AUTO_TEST_CASE(testBadInputsThrow) {
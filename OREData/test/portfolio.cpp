@@ -16,17 +16,70 @@
  FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
 */
 
+#include <boost/archive/binary_oarchive.hpp>
 #include <boost/make_shared.hpp>
 #include <boost/test/unit_test.hpp>
+#include <ored/marketdata/marketimpl.hpp>
+#include <ored/portfolio/builders/fxforward.hpp>
+#include <ored/portfolio/enginedata.hpp>
 #include <ored/portfolio/fxforward.hpp>
 #include <ored/portfolio/portfolio.hpp>
+#include <ored/portfolio/swap.hpp>
+#include <ored/utilities/xmlelementreader.hpp>
+#include <oret/datapaths.hpp>
 #include <oret/toplevelfixture.hpp>
+#include <ql/termstructures/yield/flatforward.hpp>
+#include <ql/time/daycounters/actual360.hpp>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <typeinfo>
 
 using namespace QuantLib;
 using namespace boost::unit_test_framework;
 using namespace std;
 using namespace ore::data;
 
+namespace {
+// fx forwards, trades with a missing mandatory field (i % 17 == 3) and a duplicate id (150) are skipped on loading
+string testPortfolioXml() {
+    std::ostringstream xml;
+    xml << "<?xml version=\"1.0\"?>\n<!-- <Trade id=\"commented out\"/> -->\n<Portfolio>\n";
+    for (Size i = 0; i < 200; ++i) {
+        xml << "  <Trade id=\"" << (i == 150 ? 100 : i) << "\"><TradeType>FxForward</TradeType>"
+            << "<Envelope><CounterParty>CP</CounterParty></Envelope><FxForwardData>"
+            << "<ValueDate>2030-01-01</ValueDate><BoughtCurrency>EUR</BoughtCurrency>"
+            << "<SoldCurrency>USD</SoldCurrency>" << (i % 17 == 3 ? "" : "<BoughtAmount>1000000</BoughtAmount>")
+            << "<SoldAmount>1100000</SoldAmount></FxForwardData></Trade>\n";
+    }
+    xml << "</Portfolio>\n";
+    return xml.str();
+}
+
+// flat EUR and USD discount curves and a EURUSD spot, enough to price fx forwards
+class TestMarket : public MarketImpl {
+public:
+    TestMarket() {
+        asof_ = Date(3, Feb, 2020);
+        yieldCurves_[make_tuple(Market::defaultConfiguration, YieldCurveType::Discount, "EUR")] = flatCurve(0.01);
+        yieldCurves_[make_tuple(Market::defaultConfiguration, YieldCurveType::Discount, "USD")] = flatCurve(0.02);
+        fxSpots_[Market::defaultConfiguration].addQuote("EURUSD", Handle<Quote>(boost::make_shared<SimpleQuote>(1.1)));
+    }
+
+private:
+    Handle<YieldTermStructure> flatCurve(Rate rate) {
+        return Handle<YieldTermStructure>(boost::make_shared<FlatForward>(asof_, rate, Actual360()));
+    }
+};
+
+boost::shared_ptr<Trade> fxForward(const string& id, Real boughtAmount) {
+    boost::shared_ptr<Trade> trade =
+        boost::make_shared<FxForward>(Envelope("CP"), "2030-01-01", "EUR", boughtAmount, "USD", 1100000.0);
+    trade->id() = id;
+    return trade;
+}
+} // namespace
+
 BOOST_FIXTURE_TEST_SUITE(OREDataTestSuite, ore::test::TopLevelFixture)
 
 BOOST_AUTO_TEST_SUITE(PortfolioTests)
@@ -119,6 +172,222 @@ BOOST_AUTO_TEST_CASE(testIds) {
     BOOST_CHECK(portfolio->ids() == trade_ids);
 }
 
+BOOST_AUTO_TEST_CASE(testParallelLoad) {
+
+    BOOST_TEST_MESSAGE("Testing that a portfolio loaded on several threads matches the single threaded one");
+
+    Portfolio sequential, parallel(4);
+    sequential.loadFromXMLString(testPortfolioXml());
+    parallel.loadFromXMLString(testPortfolioXml());
+
+    BOOST_CHECK_EQUAL(sequential.size(), 200 - 12 - 1);
+    BOOST_CHECK(sequential.ids() == parallel.ids());
+}
+
+BOOST_AUTO_TEST_CASE(testStreamingLoad) {
+
+    BOOST_TEST_MESSAGE("Testing that a portfolio streamed from file matches the one loaded from the XML document");
+
+    string fileName = TEST_OUTPUT_FILE("streamed_portfolio.xml");
+    std::ofstream file(fileName);
+    file << testPortfolioXml();
+    file.close();
+
+    Portfolio loaded, streamed, streamedParallel(3);
+    loaded.load(fileName);
+    streamed.loadStreaming(fileName);
+    streamedParallel.loadStreaming(fileName);
+
+    BOOST_CHECK_EQUAL(streamed.size(), 200 - 12 - 1);
+    BOOST_CHECK(streamed.ids() == loaded.ids());
+    BOOST_CHECK(streamedParallel.ids() == loaded.ids());
+
+    // the reader returns the trade elements one at a time, regardless of the buffer size
+    XMLElementReader reader(fileName, "Trade", 7);
+    string element;
+    Size n = 0;
+    while (reader.next(element)) {
+        BOOST_CHECK(element.compare(0, 7, "<Trade ") == 0);
+        BOOST_CHECK(element.compare(element.size() - 8, 8, "</Trade>") == 0);
+        ++n;
+    }
+    BOOST_CHECK_EQUAL(n, 200);
+}
+
+BOOST_AUTO_TEST_CASE(testPortfolioCache) {
+
+    BOOST_TEST_MESSAGE("Testing that a portfolio loaded from its binary cache matches the one loaded from XML");
+
+    // swaps with fixed and floating legs, a swaption and a fx forward are cached in binary form, the swap with a CPI
+    // leg and the cap floor are cached as XML
+    string portfolioFile = TEST_INPUT_FILE("portfolio_cache.xml");
+    string cacheFile = TEST_OUTPUT_FILE("portfolio_cache.bin");
+    string hash = Portfolio::contentHash({ portfolioFile });
+    BOOST_CHECK(hash != Portfolio::contentHash({ portfolioFile, portfolioFile }));
+
+    Portfolio portfolio;
+    portfolio.load(portfolioFile);
+    BOOST_REQUIRE_EQUAL(portfolio.size(), 5);
+    portfolio.saveCache(cacheFile, hash);
+
+    Portfolio cached;
+    BOOST_CHECK(!cached.loadCache(cacheFile, "another hash"));
+    BOOST_CHECK_EQUAL(cached.size(), 0);
+    BOOST_REQUIRE(cached.loadCache(cacheFile, hash));
+    BOOST_REQUIRE(cached.ids() == portfolio.ids());
+
+    for (Size i = 0; i < portfolio.size(); ++i) {
+        boost::shared_ptr<Trade> t1 = portfolio.trades()[i], t2 = cached.trades()[i];
+        BOOST_CHECK(typeid(*t1) == typeid(*t2));
+        BOOST_CHECK_EQUAL(t1->tradeType(), t2->tradeType());
+        XMLDocument doc1, doc2;
+        doc1.appendNode(t1->toXML(doc1));
+        doc2.appendNode(t2->toXML(doc2));
+        BOOST_CHECK_EQUAL(doc1.toString(), doc2.toString());
+    }
+
+    BOOST_TEST_MESSAGE("Testing that outdated and corrupt portfolio caches are not used");
+
+    // a cache written with an outdated layout version
+    string outdatedFile = TEST_OUTPUT_FILE("portfolio_cache_outdated.bin");
+    {
+        std::ofstream ofs(outdatedFile, std::ios::binary);
+        boost::archive::binary_oarchive oa(ofs);
+        string version = "ORE portfolio cache 1";
+        oa << version << hash;
+    }
+    Portfolio outdated;
+    BOOST_CHECK(!outdated.loadCache(outdatedFile, hash));
+    BOOST_CHECK_EQUAL(outdated.size(), 0);
+
+    // a cache which is cut off in the middle of the trades
+    string corruptFile = TEST_OUTPUT_FILE("portfolio_cache_corrupt.bin");
+    {
+        std::ifstream ifs(cacheFile, std::ios::binary);
+        string content((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+        std::ofstream ofs(corruptFile, std::ios::binary);
+        ofs << content.substr(0, content.size() / 2);
+    }
+    Portfolio corrupt;
+    BOOST_CHECK(!corrupt.loadCache(corruptFile, hash));
+    BOOST_CHECK_EQUAL(corrupt.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(testPortfolioCacheXmlFallback) {
+
+    BOOST_TEST_MESSAGE("Testing that trades with non serializable data are cached as XML and loaded correctly");
+
+    string portfolioFile = TEST_INPUT_FILE("portfolio_cache.xml");
+    string cacheFile = TEST_OUTPUT_FILE("portfolio_cache_fallback.bin");
+    string hash = Portfolio::contentHash({ portfolioFile });
+
+    Portfolio portfolio;
+    portfolio.load(portfolioFile);
+    BOOST_REQUIRE(portfolio.has("CPI_Swap_SingleFlow"));
+
+    // the swap itself is serializable, but its CPI leg is not, so the swap has to fall back to XML
+    boost::shared_ptr<Trade> cpiSwap = portfolio.get("CPI_Swap_SingleFlow");
+    BOOST_REQUIRE_EQUAL(cpiSwap->tradeType(), "Swap");
+    auto swap = boost::dynamic_pointer_cast<ore::data::Swap>(cpiSwap);
+    BOOST_REQUIRE(swap);
+    BOOST_REQUIRE_EQUAL(swap->legData().size(), 2);
+    BOOST_CHECK_EQUAL(swap->legData()[1].legType(), "CPI");
+    std::ostringstream os;
+    boost::archive::binary_oarchive oa(os);
+    BOOST_CHECK_THROW(oa << cpiSwap, boost::archive::archive_exception);
+
+    portfolio.saveCache(cacheFile, hash);
+    Portfolio cached;
+    BOOST_REQUIRE(cached.loadCache(cacheFile, hash));
+    BOOST_REQUIRE(cached.has("CPI_Swap_SingleFlow"));
+    boost::shared_ptr<Trade> loaded = cached.get("CPI_Swap_SingleFlow");
+    auto loadedSwap = boost::dynamic_pointer_cast<ore::data::Swap>(loaded);
+    BOOST_REQUIRE(loadedSwap);
+    BOOST_REQUIRE_EQUAL(loadedSwap->legData().size(), 2);
+    BOOST_CHECK(boost::dynamic_pointer_cast<CPILegData>(loadedSwap->legData()[1].concreteLegData()));
+    BOOST_CHECK_EQUAL(loaded->envelope().counterparty(), cpiSwap->envelope().counterparty());
+    XMLDocument doc1, doc2;
+    doc1.appendNode(cpiSwap->toXML(doc1));
+    doc2.appendNode(loaded->toXML(doc2));
+    BOOST_CHECK_EQUAL(doc1.toString(), doc2.toString());
+}
+
+BOOST_AUTO_TEST_CASE(testUpdate) {
+
+    BOOST_TEST_MESSAGE("Testing the update of a portfolio from an amended portfolio");
+
+    Portfolio portfolio, amended;
+    for (Size i = 0; i < 10; ++i)
+        portfolio.add(fxForward("trade_" + std::to_string(i), 1000000.0));
+    for (Size i = 0; i < 11; ++i) {
+        if (i != 5)
+            amended.add(fxForward("trade_" + std::to_string(i), i == 3 ? 2000000.0 : 1000000.0));
+    }
+    boost::shared_ptr<Trade> unchanged = portfolio.get("trade_0");
+
+    PortfolioDiff diff = portfolio.update(amended);
+    BOOST_CHECK(!diff.empty());
+    BOOST_CHECK(diff.added == vector<string>({ "trade_10" }));
+    BOOST_CHECK(diff.modified == vector<string>({ "trade_3" }));
+    BOOST_CHECK(diff.removed == vector<string>({ "trade_5" }));
+    BOOST_CHECK_EQUAL(diff.unchanged.size(), 8);
+    BOOST_CHECK(portfolio.ids() == amended.ids());
+
+    // unchanged trades are kept, modified ones replaced
+    BOOST_CHECK(portfolio.get("trade_0") == unchanged);
+    BOOST_CHECK(portfolio.get("trade_3") == amended.get("trade_3"));
+
+    BOOST_CHECK(portfolio.update(amended).empty());
+}
+
+BOOST_AUTO_TEST_CASE(testUpdateBuiltPortfolio) {
+
+    BOOST_TEST_MESSAGE("Testing the update of a built portfolio, rebuilding the added and modified trades");
+
+    boost::shared_ptr<Market> market = boost::make_shared<TestMarket>();
+    Settings::instance().evaluationDate() = market->asofDate();
+
+    boost::shared_ptr<EngineData> engineData = boost::make_shared<EngineData>();
+    engineData->model("FxForward") = "DiscountedCashflows";
+    engineData->engine("FxForward") = "DiscountingFxForwardEngine";
+    boost::shared_ptr<EngineFactory> engineFactory = boost::make_shared<EngineFactory>(engineData, market);
+
+    Portfolio portfolio, amended, expected;
+    for (Size i = 0; i < 10; ++i)
+        portfolio.add(fxForward("trade_" + std::to_string(i), 1000000.0));
+    for (Size i = 0; i < 11; ++i) {
+        if (i != 5) {
+            Real boughtAmount = i == 3 ? 2000000.0 : 1000000.0;
+            amended.add(fxForward("trade_" + std::to_string(i), boughtAmount));
+            expected.add(fxForward("trade_" + std::to_string(i), boughtAmount));
+        }
+    }
+    portfolio.build(engineFactory);
+    expected.build(engineFactory);
+    BOOST_REQUIRE_EQUAL(portfolio.size(), 10);
+    BOOST_REQUIRE_EQUAL(expected.size(), 10);
+
+    boost::shared_ptr<Trade> unchanged = portfolio.get("trade_0");
+    boost::shared_ptr<Instrument> unchangedInstrument = unchanged->instrument()->qlInstrument();
+    Real modifiedNpv = portfolio.get("trade_3")->instrument()->NPV();
+
+    PortfolioDiff diff = portfolio.update(amended, engineFactory);
+    BOOST_CHECK(diff.added == vector<string>({ "trade_10" }));
+    BOOST_CHECK(diff.modified == vector<string>({ "trade_3" }));
+    BOOST_CHECK(diff.removed == vector<string>({ "trade_5" }));
+    BOOST_CHECK_EQUAL(diff.unchanged.size(), 8);
+    BOOST_CHECK(portfolio.ids() == expected.ids());
+
+    // unchanged trades keep their instruments, the others are priced as if the portfolio was built from scratch
+    BOOST_CHECK(portfolio.get("trade_0") == unchanged);
+    BOOST_CHECK(portfolio.get("trade_0")->instrument()->qlInstrument() == unchangedInstrument);
+    for (auto const& id : expected.ids()) {
+        BOOST_REQUIRE(portfolio.get(id)->instrument());
+        BOOST_CHECK_CLOSE(portfolio.get(id)->instrument()->NPV(), expected.get(id)->instrument()->NPV(), 1e-10);
+    }
+    BOOST_CHECK(std::fabs(portfolio.get("trade_3")->instrument()->NPV() - modifiedNpv) > 1.0);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,166 @@
+/*
+ Copyright (C) 2020 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <boost/make_shared.hpp>
+#include <boost/test/unit_test.hpp>
+#include <ored/marketdata/marketimpl.hpp>
+#include <ored/portfolio/builders/fxforward.hpp>
+#include <ored/portfolio/builders/swap.hpp>
+#include <ored/portfolio/enginedata.hpp>
+#include <ored/portfolio/fxforward.hpp>
+#include <ored/portfolio/portfoliocompression.hpp>
+#include <ored/portfolio/swap.hpp>
+#include <ored/utilities/indexparser.hpp>
+#include <oret/toplevelfixture.hpp>
+#include <ql/cashflows/iborcoupon.hpp>
+#include <ql/termstructures/yield/flatforward.hpp>
+#include <ql/time/daycounters/actual360.hpp>
+
+using namespace QuantLib;
+using namespace boost::unit_test_framework;
+using namespace ore::data;
+using std::vector;
+
+namespace {
+
+class TestMarket : public MarketImpl {
+public:
+    TestMarket() {
+        asof_ = Date(3, Feb, 2020);
+        Handle<YieldTermStructure> eur = flatCurve(0.01);
+        Handle<YieldTermStructure> usd = flatCurve(0.02);
+        yieldCurves_[make_tuple(Market::defaultConfiguration, YieldCurveType::Discount, "EUR")] = eur;
+        yieldCurves_[make_tuple(Market::defaultConfiguration, YieldCurveType::Discount, "USD")] = usd;
+        iborIndices_[make_pair(Market::defaultConfiguration, "EUR-EURIBOR-6M")] =
+            Handle<IborIndex>(parseIborIndex("EUR-EURIBOR-6M", flatCurve(0.015)));
+        iborIndices_[make_pair(Market::defaultConfiguration, "USD-LIBOR-3M")] =
+            Handle<IborIndex>(parseIborIndex("USD-LIBOR-3M", flatCurve(0.025)));
+        fxSpots_[Market::defaultConfiguration].addQuote("EURUSD", Handle<Quote>(boost::make_shared<SimpleQuote>(1.1)));
+    }
+
+private:
+    Handle<YieldTermStructure> flatCurve(Rate rate) {
+        return Handle<YieldTermStructure>(boost::make_shared<FlatForward>(asof_, rate, Actual360()));
+    }
+};
+
+boost::shared_ptr<Trade> vanillaSwap(const string& id, const string& ccy, const string& index, const string& tenor,
+                                     bool payFixed, Real notional, Real rate, Real spread) {
+    ScheduleData schedule(ScheduleRules("2020-06-01", "2025-06-01", tenor, "TARGET", "MF", "MF", "Forward"));
+    LegData fixedLeg(boost::make_shared<FixedLegData>(vector<Real>(1, rate)), payFixed, ccy, schedule, "30/360",
+                     vector<Real>(1, notional));
+    LegData floatingLeg(boost::make_shared<FloatingLegData>(index, 2, false, vector<Real>(1, spread)), !payFixed, ccy,
+                        schedule, "A360", vector<Real>(1, notional));
+    boost::shared_ptr<Trade> trade = boost::make_shared<ore::data::Swap>(Envelope("CP", "NS"), fixedLeg, floatingLeg);
+    trade->id() = id;
+    return trade;
+}
+
+boost::shared_ptr<Trade> fxForward(const string& id, const string& valueDate, const string& boughtCcy,
+                                   Real boughtAmount, const string& soldCcy, Real soldAmount) {
+    Envelope env("CP", "NS");
+    boost::shared_ptr<Trade> trade =
+        boost::make_shared<FxForward>(env, valueDate, boughtCcy, boughtAmount, soldCcy, soldAmount);
+    trade->id() = id;
+    return trade;
+}
+
+// NPV of a trade in USD
+Real npvUsd(const boost::shared_ptr<Trade>& trade, const boost::shared_ptr<Market>& market) {
+    Real npv = trade->instrument()->NPV();
+    return trade->npvCurrency() == "USD" ? npv : npv * market->fxSpot(trade->npvCurrency() + "USD")->value();
+}
+
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(OREDataTestSuite, ore::test::TopLevelFixture)
+
+BOOST_AUTO_TEST_SUITE(PortfolioCompressionTests)
+
+BOOST_AUTO_TEST_CASE(testCompressSwapsAndFxForwards) {
+
+    BOOST_TEST_MESSAGE("Testing compression of swaps and FX forwards...");
+
+    boost::shared_ptr<Market> market = boost::make_shared<TestMarket>();
+    Settings::instance().evaluationDate() = market->asofDate();
+
+    boost::shared_ptr<EngineData> engineData = boost::make_shared<EngineData>();
+    engineData->model("Swap") = "DiscountedCashflows";
+    engineData->engine("Swap") = "DiscountingSwapEngine";
+    engineData->model("FxForward") = "DiscountedCashflows";
+    engineData->engine("FxForward") = "DiscountingFxForwardEngine";
+    boost::shared_ptr<EngineFactory> engineFactory = boost::make_shared<EngineFactory>(engineData, market);
+
+    boost::shared_ptr<Portfolio> portfolio = boost::make_shared<Portfolio>();
+    portfolio->add(vanillaSwap("swap_1", "EUR", "EUR-EURIBOR-6M", "6M", true, 10000000.0, 0.010, 0.0));
+    portfolio->add(vanillaSwap("swap_2", "EUR", "EUR-EURIBOR-6M", "6M", false, 4000000.0, 0.012, 0.001));
+    portfolio->add(vanillaSwap("swap_3", "EUR", "EUR-EURIBOR-6M", "6M", true, 2500000.0, 0.008, -0.0005));
+    // the only USD swap, not compressed
+    portfolio->add(vanillaSwap("swap_4", "USD", "USD-LIBOR-3M", "3M", true, 10000000.0, 0.020, 0.0));
+    portfolio->add(fxForward("fxfwd_1", "2021-02-03", "EUR", 1000000.0, "USD", 1120000.0));
+    portfolio->add(fxForward("fxfwd_2", "2021-02-03", "USD", 560000.0, "EUR", 500000.0));
+    portfolio->add(fxForward("fxfwd_3", "2021-02-03", "EUR", 2000000.0, "USD", 2250000.0));
+    // different value date, not compressed
+    portfolio->add(fxForward("fxfwd_4", "2021-08-03", "EUR", 1000000.0, "USD", 1130000.0));
+    portfolio->build(engineFactory);
+    BOOST_REQUIRE_EQUAL(portfolio->size(), 8);
+
+    boost::shared_ptr<Portfolio> compressed = compressPortfolio(portfolio, engineFactory);
+    BOOST_REQUIRE_EQUAL(compressed->size(), 4);
+    BOOST_CHECK(compressed->has("swap_4"));
+    BOOST_CHECK(compressed->has("fxfwd_4"));
+
+    std::map<std::string, std::string> mapping = compressionMap(*compressed);
+    BOOST_CHECK_EQUAL(mapping.size(), 6);
+
+    for (auto const& t : compressed->trades()) {
+        auto c = boost::dynamic_pointer_cast<CompressedTrade>(t);
+        if (!c)
+            continue;
+        BOOST_CHECK_EQUAL(c->envelope().nettingSetId(), "NS");
+        BOOST_CHECK_EQUAL(c->trades().size(), 3);
+        Real expected = 0.0;
+        for (auto const& u : c->trades()) {
+            BOOST_CHECK_EQUAL(mapping[u->id()], c->id());
+            expected += npvUsd(u, market);
+        }
+        BOOST_TEST_MESSAGE("Compressed trade " << c->id() << " NPV " << npvUsd(c, market) << " USD, expected "
+                                               << expected << " USD");
+        BOOST_CHECK_SMALL(npvUsd(c, market) - expected, 1.0E-6);
+
+        if (c->trades().front()->tradeType() == "Swap") {
+            // one merged Ibor coupon and one net fixed flow per period, nothing is paid
+            Size periods = c->trades().front()->legs().front().size();
+            BOOST_REQUIRE_EQUAL(c->legs().size(), 1);
+            Size iborCoupons = 0;
+            for (auto const& cf : c->legs().front())
+                iborCoupons += boost::dynamic_pointer_cast<IborCoupon>(cf) ? 1 : 0;
+            BOOST_CHECK_EQUAL(iborCoupons, periods);
+            BOOST_CHECK_EQUAL(c->legs().front().size(), 2 * periods);
+        } else {
+            // net 2500000 EUR bought against 2810000 USD
+            BOOST_CHECK_EQUAL(c->legCurrencies()[0], "EUR");
+            BOOST_CHECK_CLOSE(c->legs()[0].front()->amount(), 2500000.0, 1.0E-10);
+            BOOST_CHECK_CLOSE(c->legs()[1].front()->amount(), 2810000.0, 1.0E-10);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -18,6 +18,7 @@
 
 #include <boost/test/unit_test.hpp>
 #include <ored/portfolio/schedule.hpp>
+#include <ored/utilities/calendaradjustmentconfig.hpp>
 #include <oret/toplevelfixture.hpp>
 
 using namespace boost::unit_test_framework;
@@ -69,6 +70,55 @@ BOOST_AUTO_TEST_CASE(testScheduleData) {
         BOOST_CHECK_EQUAL(s[i], s3[i]);
 }
 
+BOOST_AUTO_TEST_CASE(testScheduleCache) {
+
+    BOOST_TEST_MESSAGE("Testing ScheduleCache...");
+
+    ScheduleCache::instance().clear();
+
+    ScheduleRules rules1("2015-01-09", "2018-01-09", "3M", "TARGET", "MF", "MF", "Forward");
+    ScheduleRules rules2("2015-01-09", "2018-01-09", "6M", "TARGET", "MF", "MF", "Forward");
+
+    // identical schedule data gives the same schedule instance
+    boost::shared_ptr<const QuantLib::Schedule> s1 = ScheduleCache::instance().schedule(ScheduleData(rules1));
+    boost::shared_ptr<const QuantLib::Schedule> s2 = ScheduleCache::instance().schedule(ScheduleData(rules1));
+    BOOST_CHECK(s1 == s2);
+    BOOST_CHECK_EQUAL(ScheduleCache::instance().size(), 1);
+
+    // different schedule data gives a different schedule
+    boost::shared_ptr<const QuantLib::Schedule> s3 = ScheduleCache::instance().schedule(ScheduleData(rules2));
+    BOOST_CHECK(s1 != s3);
+    BOOST_CHECK_EQUAL(s1->size(), 13);
+    BOOST_CHECK_EQUAL(s3->size(), 7);
+    BOOST_CHECK_EQUAL(ScheduleCache::instance().size(), 2);
+
+    // makeSchedule returns the cached schedule
+    QuantLib::Schedule s4 = makeSchedule(ScheduleData(rules1));
+    BOOST_CHECK(s4.dates() == s1->dates());
+    BOOST_CHECK(s4.dates() == makeSchedule(rules1).dates());
+    BOOST_CHECK_EQUAL(ScheduleCache::instance().size(), 2);
+
+    // makeSharedSchedule returns the cached instance itself
+    BOOST_CHECK(makeSharedSchedule(ScheduleData(rules1)) == s1);
+
+    // new calendar adjustments give new schedules
+    CalendarAdjustments::instance().setConfig(CalendarAdjustments::instance().config());
+    BOOST_CHECK(ScheduleCache::instance().schedule(ScheduleData(rules1)) != s1);
+    BOOST_CHECK_EQUAL(ScheduleCache::instance().size(), 3);
+
+    // the cache is cleared when it is full
+    Size maxSize = ScheduleCache::instance().maxSize();
+    ScheduleCache::instance().setMaxSize(3);
+    ScheduleCache::instance().schedule(ScheduleData(rules1));
+    BOOST_CHECK_EQUAL(ScheduleCache::instance().size(), 3);
+    ScheduleCache::instance().schedule(ScheduleData(rules2));
+    BOOST_CHECK_EQUAL(ScheduleCache::instance().size(), 1);
+    ScheduleCache::instance().setMaxSize(maxSize);
+
+    ScheduleCache::instance().clear();
+    BOOST_CHECK_EQUAL(ScheduleCache::instance().size(), 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
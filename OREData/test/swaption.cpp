@@ -148,4 +148,83 @@ BOOST_AUTO_TEST_CASE(testEuropeanSwaptionPrice) {
 
 BOOST_AUTO_TEST_SUITE_END()
 
+BOOST_AUTO_TEST_SUITE(BermudanSwaptionTests)
+
+BOOST_AUTO_TEST_CASE(testBermudanSwaptionModelSharing) {
+
+    BOOST_TEST_MESSAGE("Testing Bermudan Swaption prices with shared LGM models...");
+
+    boost::shared_ptr<Market> market = boost::make_shared<TestMarket>();
+    Settings::instance().evaluationDate() = market->asofDate();
+
+    // Bermudan swaptions with annual exercise, two underlying maturities and different strikes, so that Basket
+    // sharing groups them by maturity and Currency sharing puts all of them on one model
+    Calendar calendar = TARGET();
+    Date startDate = calendar.adjust(market->asofDate() + 2 * Years);
+    auto buildSwaptions = [&calendar, &startDate](const boost::shared_ptr<EngineFactory>& engineFactory) {
+        vector<boost::shared_ptr<ore::data::Swaption>> swaptions;
+        for (Size term : {5, 10}) {
+            string start = ore::data::to_string(startDate);
+            string end = ore::data::to_string(calendar.adjust(startDate + term * Years));
+            ScheduleData floatSchedule(ScheduleRules(start, end, "6M", "TARGET", "MF", "MF", "Forward"));
+            ScheduleData fixedSchedule(ScheduleRules(start, end, "1Y", "TARGET", "MF", "MF", "Forward"));
+            vector<string> exerciseDates;
+            for (Size i = 0; i < term; ++i)
+                exerciseDates.push_back(ore::data::to_string(calendar.adjust(startDate + i * Years)));
+            for (Real strike : {0.02, 0.03, 0.04}) {
+                LegData fixedLeg(boost::make_shared<FixedLegData>(vector<Real>(1, strike)), true, "EUR",
+                                 fixedSchedule, "30/360", vector<Real>(1, 10000.0));
+                LegData floatingLeg(
+                    boost::make_shared<FloatingLegData>("EUR-EURIBOR-6M", 2, false, vector<Real>(1, 0.0)), false,
+                    "EUR", floatSchedule, "A360", vector<Real>(1, 10000.0));
+                OptionData optionData("Long", "Call", "Bermudan", true, exerciseDates, "Physical");
+                auto swaption = boost::make_shared<ore::data::Swaption>(Envelope("CP1"), optionData,
+                                                                        vector<LegData>{fixedLeg, floatingLeg});
+                swaption->id() = "Swaption_" + std::to_string(term) + "Y_" + std::to_string(strike);
+                swaption->build(engineFactory);
+                swaptions.push_back(swaption);
+            }
+        }
+        return swaptions;
+    };
+
+    auto makeEngineFactory = [&market](const string& modelSharing) {
+        boost::shared_ptr<EngineData> engineData = boost::make_shared<EngineData>();
+        engineData->model("BermudanSwaption") = "LGM";
+        engineData->modelParameters("BermudanSwaption") = {
+            {"Calibration", "None"},      {"CalibrationStrategy", "None"}, {"Reversion", "0.03"},
+            {"ReversionType", "HullWhite"}, {"Volatility", "0.01"},        {"VolatilityType", "Hagan"},
+            {"Tolerance", "0.0001"},      {"ModelSharing", modelSharing}};
+        engineData->engine("BermudanSwaption") = "Grid";
+        engineData->engineParameters("BermudanSwaption") = {{"sy", "5.0"}, {"ny", "10"}, {"sx", "5.0"}, {"nx", "10"}};
+        engineData->model("Swap") = "DiscountedCashflows";
+        engineData->engine("Swap") = "DiscountingSwapEngine";
+        boost::shared_ptr<EngineFactory> engineFactory = boost::make_shared<EngineFactory>(engineData, market);
+        engineFactory->registerBuilder(boost::make_shared<LGMGridBermudanSwaptionEngineBuilder>());
+        engineFactory->registerBuilder(boost::make_shared<SwapEngineBuilder>());
+        return engineFactory;
+    };
+
+    vector<Real> expectedNpvs;
+    for (auto const& s : buildSwaptions(makeEngineFactory("Trade")))
+        expectedNpvs.push_back(s->instrument()->NPV());
+
+    for (string modelSharing : {"Basket", "Currency"}) {
+        auto swaptions = buildSwaptions(makeEngineFactory(modelSharing));
+        BOOST_REQUIRE_EQUAL(swaptions.size(), expectedNpvs.size());
+        // price twice, in the second round the shared engines use cached convolution matrices only
+        for (Size round = 0; round < 2; ++round) {
+            for (Size i = 0; i < swaptions.size(); ++i) {
+                swaptions[i]->instrument()->qlInstrument()->recalculate();
+                Real npv = swaptions[i]->instrument()->NPV();
+                BOOST_TEST_MESSAGE(modelSharing << " " << swaptions[i]->id() << " round " << round << ": " << npv
+                                                << " (Trade: " << expectedNpvs[i] << ")");
+                BOOST_CHECK_SMALL(npv - expectedNpvs[i], 1.0E-8);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -359,6 +359,9 @@ MarketDataLoader::MarketDataLoader() {
         ("20160226 SWAPTION/RATE_LNVOL/USD/7Y/9Y/ATM 0.384089")
         ("20160226 SWAPTION/RATE_LNVOL/USD/3M/9Y/ATM 0.569119")
         ("20160226 SWAPTION/RATE_LNVOL/USD/25Y/9Y/ATM 0.278568")
+        // EUR USD ATM fx option quotes
+        ("20160226 FX_OPTION/RATE_LNVOL/EUR/USD/1Y/ATM 0.10")
+        ("20160226 FX_OPTION/RATE_LNVOL/EUR/USD/2Y/ATM 0.11")
         // USD lognormal capfloor quotes
         ("20160226 CAPFLOOR/RATE_LNVOL/USD/1Y/3M/0/0/0.015 0.44451")
         ("20160226 CAPFLOOR/RATE_LNVOL/USD/1Y/3M/0/0/0.010 0.447381")
@@ -781,7 +784,15 @@ class F : public TopLevelFixture {
 public:
     boost::shared_ptr<TodaysMarket> market;
 
-    F() {
+    F() : F(false) {}
+
+    ~F() {
+        BOOST_TEST_MESSAGE("Destroying TodaysMarket instance");
+        market.reset();
+    }
+
+protected:
+    explicit F(bool withFxVol) {
         Date asof(26, February, 2016);
         Settings::instance().evaluationDate() = asof;
 
@@ -790,14 +801,23 @@ public:
         CurveConfigurations configs = *curveConfigurations();
         Conventions convs = *conventions();
 
+        if (withFxVol) {
+            // EUR USD ATM fx volatility
+            params.addMarketObject(MarketObject::FXVol, "ois", {{"EURUSD", "FXVolatility/EUR/USD/EURUSD"}});
+            configs.fxVolCurveConfig("EURUSD") = boost::make_shared<FXVolatilityCurveConfig>(
+                "EURUSD", "EUR USD ATM volatilities", FXVolatilityCurveConfig::Dimension::ATM,
+                vector<string>{"1Y", "2Y"}, vector<string>(), "FX/EUR/USD");
+        }
+
         BOOST_TEST_MESSAGE("Creating TodaysMarket Instance");
         market = boost::make_shared<TodaysMarket>(asof, params, loader, configs, convs);
     }
+};
 
-    ~F() {
-        BOOST_TEST_MESSAGE("Destroying TodaysMarket instance");
-        market.reset();
-    }
+// Fixture with an additional EUR USD fx volatility, for the tests that need one
+class FxVolF : public F {
+public:
+    FxVolF() : F(true) {}
 };
 
 } // namespace
@@ -1045,6 +1065,76 @@ BOOST_AUTO_TEST_CASE(testCorrelationCurve) {
     BOOST_CHECK_SMALL(npvCash - expectedNpv2Y, 0.000001);
 }
 
+BOOST_AUTO_TEST_CASE(testQuoteUpdate) {
+
+    BOOST_TEST_MESSAGE("Testing quote updates on a built market...");
+
+    Handle<YieldTermStructure> eurDts = market->discountCurve("EUR");
+    Handle<YieldTermStructure> eurLend = market->yieldCurve("EUR_LEND");
+    Handle<YieldTermStructure> usdDts = market->discountCurve("USD");
+
+    Date asof = market->asofDate();
+    Date d = asof + 5 * Years;
+    DayCounter dc = Actual365Fixed();
+    Real eurZero = eurDts->zeroRate(d, dc, Continuous);
+    Real usdZero = usdDts->zeroRate(d, dc, Continuous);
+
+    // shift the EUR 5Y OIS quote by 10bp, the unknown quote should be skipped
+    vector<boost::shared_ptr<MarketDatum>> data;
+    data.push_back(parseMarketDatum(asof, "IR_SWAP/RATE/EUR/2D/1D/5Y", -0.0029 + 0.0010));
+    data.push_back(parseMarketDatum(asof, "IR_SWAP/RATE/EUR/2D/1D/50Y", 0.01));
+    set<string> touched = market->updateQuotes(data);
+
+    // the EUR Eonia curve and the spread curves built on it are touched, the USD curves are not
+    BOOST_CHECK(touched.count("Yield/EUR/EUR1D") == 1);
+    BOOST_CHECK(touched.count("Yield/EUR/BANK_EUR_LEND") == 1);
+    BOOST_CHECK(touched.count("Yield/EUR/BANK_EUR_BORROW") == 1);
+    BOOST_CHECK(touched.count("Yield/USD/USD1D") == 0);
+
+    // the existing handles see the rebuilt curves
+    Real eurZeroUpdated = eurDts->zeroRate(d, dc, Continuous);
+    BOOST_CHECK_GT(eurZeroUpdated - eurZero, 0.0005);
+    BOOST_CHECK_SMALL(eurLend->zeroRate(d, dc, Continuous) - eurZeroUpdated - 0.005, 1.0e-5);
+    BOOST_CHECK_CLOSE(usdDts->zeroRate(d, dc, Continuous), usdZero, 1.0e-10);
+
+    // setting the same values again touches nothing
+    touched = market->updateQuotes(data);
+    BOOST_CHECK(touched.empty());
+}
+
+BOOST_FIXTURE_TEST_CASE(testQuoteUpdateRejected, FxVolF) {
+
+    BOOST_TEST_MESSAGE("Testing that quote updates of term structures copying their quotes are rejected...");
+
+    Handle<YieldTermStructure> eurDts = market->discountCurve("EUR");
+    Handle<OptionletVolatilityStructure> ovs = market->capFloorVol("USD");
+    Handle<BlackVolTermStructure> fxVol = market->fxVol("EURUSD");
+
+    Date asof = market->asofDate();
+    Date d = asof + 5 * Years;
+    DayCounter dc = Actual365Fixed();
+    Real eurZero = eurDts->zeroRate(d, dc, Continuous);
+    Volatility vol = ovs->volatility(2 * Years, 0.015);
+    Volatility atmVol = fxVol->blackVol(1.0, 1.0);
+
+    // the fx and cap floor volatilities are built from copies of the quotes and would not see the updates
+    vector<boost::shared_ptr<MarketDatum>> data;
+    data.push_back(parseMarketDatum(asof, "IR_SWAP/RATE/EUR/2D/1D/5Y", -0.0029 + 0.0010));
+    data.push_back(parseMarketDatum(asof, "FX_OPTION/RATE_LNVOL/EUR/USD/1Y/ATM", 0.12));
+    BOOST_CHECK_THROW(market->updateQuotes(data), QuantLib::Error);
+    data.back() = parseMarketDatum(asof, "CAPFLOOR/RATE_LNVOL/USD/2Y/3M/0/0/0.015", 0.55);
+    BOOST_CHECK_THROW(market->updateQuotes(data), QuantLib::Error);
+
+    // the whole batch is rejected, the market is unchanged
+    BOOST_CHECK_CLOSE(eurDts->zeroRate(d, dc, Continuous), eurZero, 1.0e-10);
+    BOOST_CHECK_CLOSE(ovs->volatility(2 * Years, 0.015), vol, 1.0e-10);
+    BOOST_CHECK_CLOSE(fxVol->blackVol(1.0, 1.0), atmVol, 1.0e-10);
+    data.pop_back();
+    set<string> touched = market->updateQuotes(data);
+    BOOST_CHECK(touched.count("Yield/EUR/EUR1D") == 1);
+    BOOST_CHECK_GT(eurDts->zeroRate(d, dc, Continuous) - eurZero, 0.0005);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
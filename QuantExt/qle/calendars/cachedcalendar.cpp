@@ -0,0 +1,60 @@
+/*
+ Copyright (C) 2020 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <ql/errors.hpp>
+#include <qle/calendars/cachedcalendar.hpp>
+
+using namespace QuantLib;
+
+namespace QuantExt {
+
+BusinessDayBitset::BusinessDayBitset(const Calendar& calendar, Year firstYear, Year lastYear)
+    : first_(1, January, firstYear), last_(31, December, lastYear) {
+    QL_REQUIRE(firstYear <= lastYear, "BusinessDayBitset: first year (" << firstYear << ") is after last year ("
+                                                                        << lastYear << ")");
+    Size n = static_cast<Size>(last_ - first_) + 1;
+    bits_.resize((n + 63) / 64, 0);
+    Date d = first_;
+    for (Size i = 0; i < n; ++i, ++d) {
+        if (calendar.isBusinessDay(d))
+            bits_[i >> 6] |= boost::uint64_t(1) << (i & 63);
+    }
+}
+
+BusinessDayBitset& BusinessDayBitset::operator&=(const BusinessDayBitset& other) {
+    QL_REQUIRE(first_ == other.first_ && last_ == other.last_, "BusinessDayBitset: can not join different ranges");
+    for (Size i = 0; i < bits_.size(); ++i)
+        bits_[i] &= other.bits_[i];
+    return *this;
+}
+
+BusinessDayBitset& BusinessDayBitset::operator|=(const BusinessDayBitset& other) {
+    QL_REQUIRE(first_ == other.first_ && last_ == other.last_, "BusinessDayBitset: can not join different ranges");
+    for (Size i = 0; i < bits_.size(); ++i)
+        bits_[i] |= other.bits_[i];
+    return *this;
+}
+
+CachedCalendar::Impl::Impl(const Calendar& calendar, Year firstYear, Year lastYear)
+    : calendar_(calendar), businessDays_(calendar, firstYear, lastYear) {}
+
+CachedCalendar::CachedCalendar(const Calendar& calendar, Year firstYear, Year lastYear) {
+    impl_ = ext::shared_ptr<Calendar::Impl>(new CachedCalendar::Impl(calendar, firstYear, lastYear));
+}
+
+} // namespace QuantExt
@@ -0,0 +1,97 @@
+/*
+ Copyright (C) 2020 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file cachedcalendar.hpp
+    \brief Calendar with precomputed business days
+*/
+
+#ifndef quantext_cached_calendar_h
+#define quantext_cached_calendar_h
+
+#include <boost/cstdint.hpp>
+#include <ql/time/calendar.hpp>
+#include <vector>
+
+namespace QuantExt {
+
+//! Business days of a calendar between two years, stored as a bitset
+/*! \ingroup calendars
+ */
+class BusinessDayBitset {
+public:
+    BusinessDayBitset() {}
+    //! Business days of \p calendar from the first day of \p firstYear to the last day of \p lastYear
+    BusinessDayBitset(const QuantLib::Calendar& calendar, QuantLib::Year firstYear, QuantLib::Year lastYear);
+
+    //! Returns true if the date is in the range covered by the bitset
+    bool covers(const QuantLib::Date& d) const { return !bits_.empty() && d >= first_ && d <= last_; }
+    //! Business day lookup, the date must be covered by the bitset
+    bool isBusinessDay(const QuantLib::Date& d) const {
+        QuantLib::Size i = d.serialNumber() - first_.serialNumber();
+        return (bits_[i >> 6] >> (i & 63)) & 1;
+    }
+
+    //! \name Joining business days, the bitsets must cover the same range
+    //@{
+    BusinessDayBitset& operator&=(const BusinessDayBitset& other);
+    BusinessDayBitset& operator|=(const BusinessDayBitset& other);
+    //@}
+
+private:
+    QuantLib::Date first_, last_;
+    std::vector<boost::uint64_t> bits_;
+};
+
+//! Calendar with precomputed business days
+/*! Wraps a calendar and stores its business days between the first and the last year as a bitset, so that
+    isBusinessDay() is a lookup for dates in this range, and advance(), adjust() etc. loop over lookups.
+    Other dates are forwarded to the wrapped calendar. The name is the one of the wrapped calendar, so that
+    both compare equal.
+
+    Holidays added to or removed from the wrapped calendar after construction are not reflected, holidays
+    added to or removed from the cached calendar are.
+
+    \ingroup calendars
+*/
+class CachedCalendar : public QuantLib::Calendar {
+private:
+    class Impl : public Calendar::Impl {
+    public:
+        Impl(const QuantLib::Calendar& calendar, QuantLib::Year firstYear, QuantLib::Year lastYear);
+        std::string name() const { return calendar_.name(); }
+        bool isWeekend(QuantLib::Weekday w) const { return calendar_.isWeekend(w); }
+        bool isBusinessDay(const QuantLib::Date& d) const {
+            return businessDays_.covers(d) ? businessDays_.isBusinessDay(d) : calendar_.isBusinessDay(d);
+        }
+
+    private:
+        QuantLib::Calendar calendar_;
+        BusinessDayBitset businessDays_;
+    };
+
+public:
+    //! Default range of years for which the business days are precomputed
+    static const QuantLib::Year defaultFirstYear = 1970, defaultLastYear = 2100;
+
+    CachedCalendar(const QuantLib::Calendar& calendar, QuantLib::Year firstYear = defaultFirstYear,
+                   QuantLib::Year lastYear = defaultLastYear);
+};
+
+} // namespace QuantExt
+
+#endif
@@ -65,6 +65,8 @@ bool LargeJointCalendar::Impl::isWeekend(Weekday w) const {
 }
 
 bool LargeJointCalendar::Impl::isBusinessDay(const Date& date) const {
+    if (businessDays_.covers(date))
+        return businessDays_.isBusinessDay(date);
     std::vector<Calendar>::const_iterator i;
     switch (rule_) {
     case JoinHolidays:
@@ -84,14 +86,32 @@ bool LargeJointCalendar::Impl::isBusinessDay(const Date& date) const {
     }
 }
 
-LargeJointCalendar::Impl::Impl(const std::vector<Calendar>& calendars, JointCalendarRule r) : rule_(r) {
+LargeJointCalendar::Impl::Impl(const std::vector<Calendar>& calendars, JointCalendarRule r, Year firstYear,
+                               Year lastYear)
+    : rule_(r) {
+    QL_REQUIRE(!calendars.empty(), "LargeJointCalendar: no calendars given");
     for (auto c : calendars) {
         calendars_.push_back(c);
     }
+    // precompute the joint business days
+    businessDays_ = BusinessDayBitset(calendars_.front(), firstYear, lastYear);
+    for (auto c = calendars_.begin() + 1; c != calendars_.end(); ++c) {
+        switch (rule_) {
+        case JoinHolidays:
+            businessDays_ &= BusinessDayBitset(*c, firstYear, lastYear);
+            break;
+        case JoinBusinessDays:
+            businessDays_ |= BusinessDayBitset(*c, firstYear, lastYear);
+            break;
+        default:
+            QL_FAIL("unknown joint calendar rule");
+        }
+    }
 }
 
-LargeJointCalendar::LargeJointCalendar(const std::vector<Calendar>& calendars, JointCalendarRule r) {
-    impl_ = ext::shared_ptr<Calendar::Impl>(new LargeJointCalendar::Impl(calendars, r));
+LargeJointCalendar::LargeJointCalendar(const std::vector<Calendar>& calendars, JointCalendarRule r, Year firstYear,
+                                       Year lastYear) {
+    impl_ = ext::shared_ptr<Calendar::Impl>(new LargeJointCalendar::Impl(calendars, r, firstYear, lastYear));
 }
 
 } // namespace QuantExt
@@ -25,6 +25,7 @@
 
 #include <ql/time/calendar.hpp>
 #include <ql/time/calendars/jointcalendar.hpp>
+#include <qle/calendars/cachedcalendar.hpp>
 
 namespace QuantExt {
 
@@ -32,6 +33,10 @@ namespace QuantExt {
 /*! Similar to QuantLib's "JointCalendar" but allows a larger number of
     underlying calendars.
 
+    The joint business days between the first and the last year are precomputed
+    as the bitwise and (JoinHolidays) resp. or (JoinBusinessDays) of the business
+    days of the underlying calendars, see CachedCalendar.
+
     \ingroup calendars
 
     \test the correctness of the returned results is tested by
@@ -41,7 +46,8 @@ class LargeJointCalendar : public QuantLib::Calendar {
 private:
     class Impl : public Calendar::Impl {
     public:
-        Impl(const std::vector<QuantLib::Calendar>& calendar, QuantLib::JointCalendarRule rule);
+        Impl(const std::vector<QuantLib::Calendar>& calendar, QuantLib::JointCalendarRule rule,
+             QuantLib::Year firstYear, QuantLib::Year lastYear);
         std::string name() const;
         bool isWeekend(QuantLib::Weekday) const;
         bool isBusinessDay(const QuantLib::Date&) const;
@@ -49,10 +55,13 @@ private:
     private:
         QuantLib::JointCalendarRule rule_;
         std::vector<QuantLib::Calendar> calendars_;
+        BusinessDayBitset businessDays_;
     };
 
 public:
-    LargeJointCalendar(const std::vector<QuantLib::Calendar>&, QuantLib::JointCalendarRule = QuantLib::JoinHolidays);
+    LargeJointCalendar(const std::vector<QuantLib::Calendar>&, QuantLib::JointCalendarRule = QuantLib::JoinHolidays,
+                       QuantLib::Year firstYear = CachedCalendar::defaultFirstYear,
+                       QuantLib::Year lastYear = CachedCalendar::defaultLastYear);
 };
 
 } // namespace QuantExt
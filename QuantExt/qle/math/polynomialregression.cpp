@@ -0,0 +1,176 @@
+/*
+ Copyright (C) 2020 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include <qle/math/polynomialregression.hpp>
+
+#include <ql/math/comparison.hpp>
+#include <ql/math/matrixutilities/choleskydecomposition.hpp>
+#include <ql/math/matrixutilities/qrdecomposition.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace QuantExt {
+
+namespace {
+
+// append the exponents of all monomials of the given total degree in e.size() variables
+void addMonomials(Size degree, Size pos, std::vector<Size>& e, std::vector<Size>& result) {
+    if (pos == e.size() - 1) {
+        e[pos] = degree;
+        result.insert(result.end(), e.begin(), e.end());
+        return;
+    }
+    for (Size p = degree + 1; p-- > 0;) {
+        e[pos] = p;
+        addMonomials(degree - p, pos + 1, e, result);
+    }
+}
+
+// shift and multiplier such that (u + shift) * multiplier has mean zero and unit variance
+void meanStdDev(const std::vector<Real>& u, Real& shift, Real& multiplier) {
+    Real m = 0.0, v = 0.0;
+    for (auto const& x : u)
+        m += x;
+    m /= u.size();
+    for (auto const& x : u)
+        v += (x - m) * (x - m);
+    v /= u.size();
+    shift = -m;
+    multiplier = close_enough(v, 0.0) ? 1.0 : 1.0 / std::sqrt(v);
+}
+
+} // namespace
+
+PolynomialRegression::PolynomialRegression(Size order, Size dimension, Solver solver)
+    : order_(order), dimension_(dimension), solver_(solver), yMultiplier_(1.0), yShift_(0.0) {
+    QL_REQUIRE(dimension_ > 0, "PolynomialRegression: dimension must be positive");
+    std::vector<Size> e(dimension_, 0);
+    for (Size d = 0; d <= order_; ++d)
+        addMonomials(d, 0, e, exponents_);
+}
+
+void PolynomialRegression::basis(const Array& x, Real* powers, Real* row) const {
+    // powers of the transformed regression variables, dimension_ blocks of size order_ + 1
+    for (Size d = 0; d < dimension_; ++d) {
+        Real u = (x[d] + xShift_[d]) * xMultiplier_[d];
+        Real* p = &powers[d * (order_ + 1)];
+        p[0] = 1.0;
+        for (Size k = 1; k <= order_; ++k)
+            p[k] = p[k - 1] * u;
+    }
+    for (Size b = 0; b < basisSize(); ++b) {
+        const Size* e = &exponents_[b * dimension_];
+        Real r = 1.0;
+        for (Size d = 0; d < dimension_; ++d)
+            r *= powers[d * (order_ + 1) + e[d]];
+        row[b] = r;
+    }
+}
+
+void PolynomialRegression::fit(const std::vector<Array>& x, const std::vector<Real>& y) {
+    Size n = x.size(), p = basisSize();
+    QL_REQUIRE(y.size() == n, "PolynomialRegression: x size (" << n << ") does not match y size (" << y.size() << ")");
+    QL_REQUIRE(n >= p, "PolynomialRegression: not enough points (" << n << ") for " << p << " basis functions");
+
+    // standardise regression variables and regressand
+    xShift_ = Array(dimension_, 0.0);
+    xMultiplier_ = Array(dimension_, 1.0);
+    std::vector<Real> u(n);
+    for (Size i = 0; i < n; ++i) {
+        QL_REQUIRE(x[i].size() == dimension_, "PolynomialRegression: point " << i << " has dimension " << x[i].size()
+                                                                             << ", expected " << dimension_);
+    }
+    for (Size d = 0; d < dimension_; ++d) {
+        for (Size i = 0; i < n; ++i)
+            u[i] = x[i][d];
+        meanStdDev(u, xShift_[d], xMultiplier_[d]);
+    }
+    meanStdDev(y, yShift_, yMultiplier_);
+    Array yt(n);
+    for (Size i = 0; i < n; ++i)
+        yt[i] = (y[i] + yShift_) * yMultiplier_;
+
+    // assemble the design matrix
+    design_ = Matrix(n, p);
+    std::vector<Real> powers(dimension_ * (order_ + 1));
+    for (Size i = 0; i < n; ++i)
+        basis(x[i], &powers[0], &*design_.row_begin(i));
+
+    if (solver_ == Solver::NormalEquations) {
+        // lower triangle of A^T A and A^T y in one pass over the design matrix
+        Matrix g(p, p, 0.0);
+        Array b(p, 0.0);
+        for (Size i = 0; i < n; ++i) {
+            const Real* row = &*design_.row_begin(i);
+            for (Size j = 0; j < p; ++j) {
+                b[j] += row[j] * yt[i];
+                for (Size k = 0; k <= j; ++k)
+                    g[j][k] += row[j] * row[k];
+            }
+        }
+        for (Size j = 0; j < p; ++j)
+            for (Size k = 0; k < j; ++k)
+                g[k][j] = g[j][k];
+        Matrix l = CholeskyDecomposition(g, true);
+        Real maxDiag = 0.0, minDiag = QL_MAX_REAL;
+        for (Size j = 0; j < p; ++j) {
+            maxDiag = std::max(maxDiag, l[j][j]);
+            minDiag = std::min(minDiag, l[j][j]);
+        }
+        if (minDiag > std::sqrt(QL_EPSILON) * maxDiag) {
+            // solve L z = b and L^T c = z
+            coefficients_ = Array(p);
+            for (Size j = 0; j < p; ++j) {
+                Real s = b[j];
+                for (Size k = 0; k < j; ++k)
+                    s -= l[j][k] * coefficients_[k];
+                coefficients_[j] = s / l[j][j];
+            }
+            for (Size j = p; j-- > 0;) {
+                Real s = coefficients_[j];
+                for (Size k = j + 1; k < p; ++k)
+                    s -= l[k][j] * coefficients_[k];
+                coefficients_[j] = s / l[j][j];
+            }
+            return;
+        }
+    }
+
+    coefficients_ = qrSolve(design_, yt, true);
+}
+
+Real PolynomialRegression::fittedValue(Size i) const {
+    QL_REQUIRE(i < design_.rows(), "PolynomialRegression: point " << i << " out of range, fitted "
+                                                                  << design_.rows() << " points");
+    Real s = std::inner_product(design_.row_begin(i), design_.row_end(i), coefficients_.begin(), 0.0);
+    return s / yMultiplier_ - yShift_;
+}
+
+Real PolynomialRegression::operator()(const Array& x) const {
+    QL_REQUIRE(x.size() == dimension_, "PolynomialRegression: point has dimension " << x.size() << ", expected "
+                                                                                    << dimension_);
+    QL_REQUIRE(coefficients_.size() == basisSize(), "PolynomialRegression: no fit performed");
+    std::vector<Real> powers(dimension_ * (order_ + 1)), row(basisSize());
+    basis(x, &powers[0], &row[0]);
+    Real s = std::inner_product(row.begin(), row.end(), coefficients_.begin(), 0.0);
+    return s / yMultiplier_ - yShift_;
+}
+
+} // namespace QuantExt
@@ -0,0 +1,89 @@
+/*
+ Copyright (C) 2020 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+/*! \file qle/math/polynomialregression.hpp
+    \brief Least squares regression on a multivariate monomial basis
+    \ingroup math
+*/
+
+#ifndef quantext_polynomial_regression_hpp
+#define quantext_polynomial_regression_hpp
+
+#include <ql/math/array.hpp>
+#include <ql/math/matrix.hpp>
+
+#include <vector>
+
+namespace QuantExt {
+using namespace QuantLib;
+
+//! Least squares regression on a multivariate monomial basis
+/*! The basis consists of all monomials in the regression variables up to the given total order, i.e. it spans the
+    same space as LsmBasisSystem::multiPathBasisSystem() with LsmBasisSystem::Monomial. As in StabilisedGLLS with
+    the MeanStdDev method the regression variables and the regressand are shifted by their mean and divided by
+    their standard deviation before the fit.
+
+    The design matrix is assembled in one contiguous block of memory and kept after the fit, so that the regression
+    function can be evaluated at the sample points without evaluating the basis functions again. The coefficients
+    are found either by a Cholesky decomposition of the normal equations, which is the fastest method, or by a
+    pivoted QR decomposition of the design matrix, which is slower but more robust for badly conditioned problems.
+    If the normal equations turn out to be numerically singular we fall back to the QR decomposition.
+
+    \ingroup math
+*/
+class PolynomialRegression {
+public:
+    enum class Solver { NormalEquations, QR };
+
+    PolynomialRegression(Size order, Size dimension, Solver solver = Solver::NormalEquations);
+
+    //! Fit the regression function to the given points x (each of size dimension) and values y
+    void fit(const std::vector<Array>& x, const std::vector<Real>& y);
+
+    //! Regression function at the i-th point of the last fit, in terms of the original y
+    Real fittedValue(Size i) const;
+    //! Regression function at an arbitrary point, in terms of the original x and y
+    Real operator()(const Array& x) const;
+
+    //! Number of basis functions
+    Size basisSize() const { return exponents_.size() / dimension_; }
+    //! Coefficients w.r.t. the transformed data
+    const Array& transformedCoefficients() const { return coefficients_; }
+
+    //! Transformation parameters (u => (u + shift) * multiplier for u = x, y)
+    const Array& xMultiplier() const { return xMultiplier_; }
+    const Array& xShift() const { return xShift_; }
+    Real yMultiplier() const { return yMultiplier_; }
+    Real yShift() const { return yShift_; }
+
+private:
+    void basis(const Array& x, Real* powers, Real* row) const;
+
+    Size order_, dimension_;
+    Solver solver_;
+    // exponents of the basis functions, basisSize() blocks of size dimension_
+    std::vector<Size> exponents_;
+    Array xMultiplier_, xShift_, coefficients_;
+    Real yMultiplier_, yShift_;
+    // samples x basisSize()
+    Matrix design_;
+};
+
+} // namespace QuantExt
+
+#endif
@@ -20,6 +20,8 @@
 
 #include <ql/math/distributions/normaldistribution.hpp>
 
+#include <algorithm>
+
 namespace QuantExt {
 
 //! Numerical convolution solver for the LGM model
@@ -28,8 +30,8 @@ namespace QuantExt {
 */
 
 LgmConvolutionSolver::LgmConvolutionSolver(const boost::shared_ptr<LinearGaussMarkovModel>& model, const Real sy,
-                                           const Size ny, const Real sx, const Size nx)
-    : model_(model), nx_(nx) {
+                                           const Size ny, const Real sx, const Size nx, const bool cacheConvolutions)
+    : model_(model), nx_(nx), cacheConvolutions_(cacheConvolutions) {
 
     // precompute weights
 
@@ -73,4 +75,57 @@ std::vector<Real> LgmConvolutionSolver::stateGrid(const Real t) const {
     return x;
 }
 
+const std::vector<LgmConvolutionSolver::ConvolutionRow>& LgmConvolutionSolver::convolution(const Real t1,
+                                                                                         const Real t0) const {
+    // the model parameters may change (recalibration), so we key the cache on the variances, not the times
+    bool toZero = close_enough(t0, 0.0);
+    Real zeta1 = model_->parametrization()->zeta(t1);
+    Real zeta0 = toZero ? -1.0 : model_->parametrization()->zeta(t0);
+    auto key = std::make_pair(zeta1, zeta0);
+    auto c = convolutions_.find(key);
+    if (c != convolutions_.end())
+        return c->second;
+
+    // without caching we only keep the matrix of the current rollback step, otherwise we limit the memory used for
+    // models which are recalibrated frequently
+    if (!cacheConvolutions_ || convolutions_.size() >= 256)
+        convolutions_.clear();
+
+    Real sigma = std::sqrt(zeta1);
+    Real dx = sigma / static_cast<Real>(nx_);
+    Real stdDev = toZero ? sigma : std::sqrt(zeta1 - zeta0);
+    Real dx2 = toZero ? 0.0 : std::sqrt(zeta0) / static_cast<Real>(nx_);
+
+    std::vector<ConvolutionRow> conv(toZero ? 1 : 2 * mx_ + 1);
+    std::vector<Real> dense(2 * mx_ + 1);
+    for (int k = 0; k < static_cast<int>(conv.size()); ++k) {
+        std::fill(dense.begin(), dense.end(), 0.0);
+        for (int i = 0; i <= 2 * my_; i++) {
+            // Map y index to x index, not integer in general
+            Real kp = (toZero ? y_[i] * sigma : dx2 * (k - mx_) + y_[i] * stdDev) / dx + mx_;
+            // Adjacent integer x index <= k
+            int kk = int(floor(kp));
+            // Get value at kp by linear interpolation on
+            // kk <= kp <= kk + 1 with flat extrapolation
+            if (kk < 0)
+                dense[0] += w_[i];
+            else if (kk + 1 > 2 * mx_)
+                dense[2 * mx_] += w_[i];
+            else {
+                dense[kk + 1] += w_[i] * (kp - kk);
+                dense[kk] += w_[i] * (1.0 + kk - kp);
+            }
+        }
+        // store the non-zero band only
+        Size first = 0, last = dense.size();
+        while (first < last && dense[first] == 0.0)
+            ++first;
+        while (last > first && dense[last - 1] == 0.0)
+            --last;
+        conv[k].first = first;
+        conv[k].weights.assign(dense.begin() + first, dense.begin() + last);
+    }
+    return convolutions_[key] = conv;
+}
+
 } // namespace QuantExt
@@ -26,17 +26,23 @@
 
 #include <qle/models/lgm.hpp>
 
+#include <map>
+
 namespace QuantExt {
 
 //! Numerical convolution solver for the LGM model
 /*! Reference: Hagan, Methodology for callable swaps and Bermudan
                exercise into swaptions
+
+    If cacheConvolutions is true, the convolution matrices of the rollback steps are kept, so that all instruments
+    priced with this solver and sharing exercise dates also share the matrices. This only pays off if the solver
+    is shared by several instruments, otherwise only the matrix of the current rollback step is kept.
 */
 
 class LgmConvolutionSolver {
 public:
     LgmConvolutionSolver(const boost::shared_ptr<LinearGaussMarkovModel>& model, const Real sy, const Size ny,
-                         const Real sx, const Size nx);
+                         const Real sx, const Size nx, const bool cacheConvolutions = false);
 
     /* get grid size */
     Size gridSize() const { return 2 * mx_ + 1; }
@@ -53,10 +59,21 @@ public:
     const boost::shared_ptr<LinearGaussMarkovModel>& model() const { return model_; }
 
 private:
+    /* convolution weights for one point k of the t0 grid, v0[k] = sum_j weights[j] * v1[first + j] */
+    struct ConvolutionRow {
+        Size first;
+        std::vector<Real> weights;
+    };
+    /* the convolution matrix for a rollback from t1 to t0, it only depends on zeta(t0) and zeta(t1) and is cached
+       if cacheConvolutions_ is true */
+    const std::vector<ConvolutionRow>& convolution(const Real t1, const Real t0) const;
+
     boost::shared_ptr<LinearGaussMarkovModel> model_;
     int mx_, my_, nx_;
+    bool cacheConvolutions_;
     Real h_;
     std::vector<Real> y_, w_;
+    mutable std::map<std::pair<Real, Real>, std::vector<ConvolutionRow>> convolutions_;
 };
 
 // rollback implementation
@@ -67,43 +84,17 @@ std::vector<ValueType> LgmConvolutionSolver::rollback(const std::vector<ValueTyp
     if (close_enough(t0, t1))
         return v;
     QL_REQUIRE(t0 < t1, "LgmConvolutionSolver::rollback(): t0 (" << t0 << ") < t1 (" << t1 << ") required.");
-    Real sigma = std::sqrt(model_->parametrization()->zeta(t1));
-    Real dx = sigma / static_cast<Real>(nx_);
-    if (close_enough(t0, 0.0)) {
-        // rollback from t1 to t0 = 0
-        ValueType value(zero);
-        for (int i = 0; i <= 2 * my_; i++) {
-            // Map y index to x index, not integer in general
-            Real kp = y_[i] * sigma / dx + mx_;
-            // Adjacent integer x index <= k
-            int kk = int(floor(kp));
-            // Get value at kp by linear interpolation on
-            // kk <= kp <= kk + 1 with flat extrapolation
-            value +=
-                w_[i] *
-                (kk < 0 ? v[0] : (kk + 1 > 2 * mx_ ? v[2 * mx_] : (kp - kk) * v[kk + 1] + (1.0 + kk - kp) * v[kk]));
-        }
-        return std::vector<ValueType>(2 * mx_ + 1, value);
-    } else {
-        std::vector<ValueType> value(2 * mx_ + 1, zero);
-        // rollback from t1 to t0 > 0
-        Real std = std::sqrt(model_->parametrization()->zeta(t1) - model_->parametrization()->zeta(t0));
-        Real dx2 = std::sqrt(model_->parametrization()->zeta(t0)) / static_cast<Real>(nx_);
-        for (int k = 0; k <= 2 * mx_; k++) {
-            for (int i = 0; i <= 2 * my_; i++) {
-                // Map y index to x index, not integer in generalTo
-                Real kp = (dx2 * (k - mx_) + y_[i] * std) / dx + mx_;
-                // Adjacent integer x index <= k
-                int kk = int(floor(kp));
-                // Get value at kp by linear interpolation on
-                // kk <= kp <= kk + 1 with flat extrapolation
-                value[k] +=
-                    w_[i] *
-                    (kk < 0 ? v[0] : (kk + 1 > 2 * mx_ ? v[2 * mx_] : (kp - kk) * v[kk + 1] + (1.0 + kk - kp) * v[kk]));
-            }
-        }
-        return value;
+    const std::vector<ConvolutionRow>& conv = convolution(t1, t0);
+    std::vector<ValueType> value(conv.size(), zero);
+    for (Size k = 0; k < conv.size(); ++k) {
+        const ConvolutionRow& row = conv[k];
+        for (Size j = 0; j < row.weights.size(); ++j)
+            value[k] += row.weights[j] * v[row.first + j];
     }
+    // rollback to t0 = 0 yields a single value
+    if (conv.size() == 1)
+        return std::vector<ValueType>(2 * mx_ + 1, value[0]);
+    return value;
 }
 
 } // namespace QuantExt
@@ -27,8 +27,9 @@ namespace QuantExt {
 
 NumericLgmSwaptionEngineBase::NumericLgmSwaptionEngineBase(const boost::shared_ptr<LinearGaussMarkovModel>& model,
                                                            const Real sy, const Size ny, const Real sx, const Size nx,
-                                                           const Handle<YieldTermStructure>& discountCurve)
-    : LgmConvolutionSolver(model, sy, ny, sx, nx) {}
+                                                           const Handle<YieldTermStructure>& discountCurve,
+                                                           const bool cacheConvolutions)
+    : LgmConvolutionSolver(model, sy, ny, sx, nx, cacheConvolutions) {}
 
 Real NumericLgmSwaptionEngineBase::rebatePv(const Real x, const Real t, const Size exerciseIndex) const {
     boost::shared_ptr<QuantExt::RebatedExercise> rebatedExercise =
@@ -57,7 +57,8 @@ namespace QuantExt {
 class NumericLgmSwaptionEngineBase : protected LgmConvolutionSolver {
 protected:
     NumericLgmSwaptionEngineBase(const boost::shared_ptr<LinearGaussMarkovModel>& model, const Real sy, const Size ny,
-                                 const Real sx, const Size nx, const Handle<YieldTermStructure>& discountCurve);
+                                 const Real sx, const Size nx, const Handle<YieldTermStructure>& discountCurve,
+                                 const bool cacheConvolutions);
 
     virtual ~NumericLgmSwaptionEngineBase() {}
 
@@ -81,9 +82,10 @@ class NumericLgmSwaptionEngine : public GenericEngine<Swaption::arguments, Swapt
 public:
     NumericLgmSwaptionEngine(const boost::shared_ptr<LinearGaussMarkovModel>& model, const Real sy, const Size ny,
                              const Real sx, const Size nx,
-                             const Handle<YieldTermStructure>& discountCurve = Handle<YieldTermStructure>())
+                             const Handle<YieldTermStructure>& discountCurve = Handle<YieldTermStructure>(),
+                             const bool cacheConvolutions = false)
         : GenericEngine<Swaption::arguments, Swaption::results>(),
-          NumericLgmSwaptionEngineBase(model, sy, ny, sx, nx, discountCurve) {
+          NumericLgmSwaptionEngineBase(model, sy, ny, sx, nx, discountCurve, cacheConvolutions) {
         if (!discountCurve_.empty())
             registerWith(discountCurve_);
         registerWith(LgmConvolutionSolver::model());
@@ -103,9 +105,10 @@ class NumericLgmNonstandardSwaptionEngine
 public:
     NumericLgmNonstandardSwaptionEngine(const boost::shared_ptr<LinearGaussMarkovModel>& model, const Real sy,
                                         const Size ny, const Real sx, const Size nx,
-                                        const Handle<YieldTermStructure>& discountCurve = Handle<YieldTermStructure>())
+                                        const Handle<YieldTermStructure>& discountCurve = Handle<YieldTermStructure>(),
+                                        const bool cacheConvolutions = false)
         : GenericEngine<NonstandardSwaption::arguments, NonstandardSwaption::results>(),
-          NumericLgmSwaptionEngineBase(model, sy, ny, sx, nx, discountCurve) {
+          NumericLgmSwaptionEngineBase(model, sy, ny, sx, nx, discountCurve, cacheConvolutions) {
         if (!discountCurve_.empty())
             registerWith(discountCurve_);
         registerWith(LgmConvolutionSolver::model());
@@ -287,6 +287,51 @@ BOOST_AUTO_TEST_CASE(testNonstandardBermudanSwaption) {
                     << (npv - ns_npv) << ", tolerance is " << tol);
 } // testNonstandardBermudanSwaption
 
+BOOST_AUTO_TEST_CASE(testSharedNumericLgmSwaptionEngine) {
+
+    BOOST_TEST_MESSAGE("Testing numeric LGM swaption engine shared by several swaptions...");
+
+    BermudanTestData d;
+
+    boost::shared_ptr<IrLgm1fParametrization> lgm_p = boost::make_shared<IrLgm1fPiecewiseConstantHullWhiteAdaptor>(
+        EURCurrency(), d.yts, d.stepTimes_a, d.sigmas_a, d.stepTimes_a, d.kappas_a);
+
+    boost::shared_ptr<LinearGaussMarkovModel> lgm = boost::make_shared<LinearGaussMarkovModel>(lgm_p);
+
+    // swaptions with the same exercise dates and different strikes
+    std::vector<boost::shared_ptr<Swaption>> swaptions;
+    for (Real strike : {0.01, 0.02, 0.03}) {
+        boost::shared_ptr<VanillaSwap> underlying = boost::make_shared<VanillaSwap>(
+            VanillaSwap::Payer, 1.0, d.fixedSchedule, strike, Thirty360(), d.floatingSchedule, d.euribor6m, 0.0,
+            Actual360());
+        swaptions.push_back(boost::make_shared<Swaption>(underlying, d.exercise));
+    }
+
+    // reference prices with one engine per swaption
+    std::vector<Real> npvs;
+    for (auto const& s : swaptions) {
+        s->setPricingEngine(boost::make_shared<NumericLgmSwaptionEngine>(lgm, 7.0, 16, 7.0, 32));
+        npvs.push_back(s->NPV());
+    }
+
+    // one engine for all swaptions, which reuses the convolution matrices across them; we price twice to
+    // use cached matrices for all swaptions in the second round
+    boost::shared_ptr<PricingEngine> engine =
+        boost::make_shared<NumericLgmSwaptionEngine>(lgm, 7.0, 16, 7.0, 32, Handle<YieldTermStructure>(), true);
+    for (Size round = 0; round < 2; ++round) {
+        for (Size i = 0; i < swaptions.size(); ++i) {
+            swaptions[i]->setPricingEngine(engine);
+            Real npv = swaptions[i]->NPV();
+            Real tol = 1.0E-12;
+            if (std::fabs(npv - npvs[i]) >= tol)
+                BOOST_ERROR("Failed to verify Bermudan swaption price with shared engine ("
+                            << npv << ") against price with own engine (" << npvs[i] << "), swaption " << i
+                            << ", round " << round << ", difference is " << (npv - npvs[i]) << ", tolerance is "
+                            << tol);
+        }
+    }
+} // testSharedNumericLgmSwaptionEngine
+
 BOOST_AUTO_TEST_CASE(testLgm1fCalibration) {
 
     BOOST_TEST_MESSAGE("Testing calibration of LGM 1F model (analytic engine) "
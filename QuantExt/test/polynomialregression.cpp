@@ -0,0 +1,101 @@
+/*
+ Copyright (C) 2020 Quaternion Risk Management Ltd
+ All rights reserved.
+
+ This file is part of ORE, a free-software/open-source library
+ for transparent pricing and risk analysis - http://opensourcerisk.org
+
+ ORE is free software: you can redistribute it and/or modify it
+ under the terms of the Modified BSD License.  You should have received a
+ copy of the license along with this program.
+ The license is also available online at <http://opensourcerisk.org>
+
+ This program is distributed on the basis that it will form a useful
+ contribution to risk analytics and model standardisation, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the license for more details.
+*/
+
+#include "toplevelfixture.hpp"
+#include <boost/test/unit_test.hpp>
+#include <ql/math/randomnumbers/mt19937uniformrng.hpp>
+#include <ql/methods/montecarlo/lsmbasissystem.hpp>
+#include <ql/version.hpp>
+#include <qle/math/polynomialregression.hpp>
+#include <qle/math/stabilisedglls.hpp>
+
+using namespace boost::unit_test_framework;
+using namespace QuantLib;
+using namespace QuantExt;
+
+BOOST_FIXTURE_TEST_SUITE(QuantExtTestSuite, qle::test::TopLevelFixture)
+
+BOOST_AUTO_TEST_SUITE(PolynomialRegressionTest)
+
+BOOST_AUTO_TEST_CASE(testAgainstStabilisedGLLS) {
+
+    BOOST_TEST_MESSAGE("Testing QuantExt::PolynomialRegression against QuantExt::StabilisedGLLS (2D)");
+
+    std::vector<Array> x;
+    std::vector<Real> y;
+
+    MersenneTwisterUniformRng mt(42);
+    for (Size n = 0; n < 1000; ++n) {
+        Array xa(2);
+        xa[0] = mt.nextReal() * 1000.0;
+        xa[1] = mt.nextReal() * 2000.0;
+        Real yt = -4982.0 + xa[0] * 43.0 + xa[1] * 142.0 + xa[0] * xa[1] * 0.8 - xa[0] * xa[0] * 0.02948 +
+                  xa[1] * xa[1] * 1533.0 + xa[0] * xa[0] * xa[1] * 0.01 + (mt.nextReal() - 0.5) * 1.0E6;
+        x.push_back(xa);
+        y.push_back(yt);
+    }
+
+#if QL_HEX_VERSION > 0x01150000
+    std::vector<ext::function<Real(Array)> > basis =
+        LsmBasisSystem::multiPathBasisSystem(2, 2, LsmBasisSystem::Monomial);
+#else // QL 1.14 and below
+    std::vector<boost::function1<Real, Array> > basis =
+        LsmBasisSystem::multiPathBasisSystem(2, 2, LsmBasisSystem::Monomial);
+#endif
+
+    StabilisedGLLS ls(x, y, basis, StabilisedGLLS::MeanStdDev);
+
+    Real tol = 1.0E-8;
+    for (auto solver : {PolynomialRegression::Solver::NormalEquations, PolynomialRegression::Solver::QR}) {
+        PolynomialRegression pr(2, 2, solver);
+        pr.fit(x, y);
+        BOOST_CHECK_EQUAL(pr.basisSize(), basis.size());
+        for (Size i = 0; i < x.size(); ++i) {
+            Real expected = ls.eval(x[i], basis);
+            BOOST_CHECK_CLOSE(pr.fittedValue(i), expected, tol);
+            BOOST_CHECK_CLOSE(pr(x[i]), expected, tol);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testDegenerateRegressor) {
+
+    BOOST_TEST_MESSAGE("Testing QuantExt::PolynomialRegression with a constant regression variable");
+
+    // the second regression variable is constant, so that the normal equations are singular
+    std::vector<Array> x;
+    std::vector<Real> y;
+    for (Size n = 0; n < 100; ++n) {
+        Array xa(2);
+        xa[0] = -5.0 + 0.1 * n;
+        xa[1] = 3.0;
+        x.push_back(xa);
+        y.push_back(1.0 - 2.0 * xa[0] + 0.5 * xa[0] * xa[0] * xa[0]);
+    }
+
+    for (auto solver : {PolynomialRegression::Solver::NormalEquations, PolynomialRegression::Solver::QR}) {
+        PolynomialRegression pr(3, 2, solver);
+        pr.fit(x, y);
+        for (Size i = 0; i < x.size(); ++i)
+            BOOST_CHECK_SMALL(pr.fittedValue(i) - y[i], 1.0E-8);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -20,11 +20,18 @@
 #include <boost/test/unit_test.hpp>
 #include <ql/time/calendar.hpp>
 #include <ql/time/calendars/austria.hpp>
+#include <ql/time/calendars/japan.hpp>
+#include <ql/time/calendars/jointcalendar.hpp>
+#include <ql/time/calendars/target.hpp>
+#include <ql/time/calendars/unitedkingdom.hpp>
+#include <ql/time/calendars/unitedstates.hpp>
 #include <qle/calendars/belgium.hpp>
+#include <qle/calendars/cachedcalendar.hpp>
 #include <qle/calendars/chile.hpp>
 #include <qle/calendars/colombia.hpp>
 #include <qle/calendars/france.hpp>
 #include <qle/calendars/israel.hpp>
+#include <qle/calendars/largejointcalendar.hpp>
 #include <qle/calendars/luxembourg.hpp>
 #include <qle/calendars/malaysia.hpp>
 #include <qle/calendars/netherlands.hpp>
@@ -400,6 +407,37 @@ BOOST_AUTO_TEST_CASE(testBelgianCalendar) {
     check::checkCalendars(expectedHolidays, hol);
 }
 
+BOOST_AUTO_TEST_CASE(testCachedCalendars) {
+
+    BOOST_TEST_MESSAGE("Testing cached and large joint calendars against QuantLib calendars");
+
+    std::vector<Calendar> cals = {TARGET(), UnitedKingdom(), UnitedStates(), Japan()};
+    Calendar jointHolidays = JointCalendar(cals[0], cals[1], cals[2], cals[3], JoinHolidays);
+    Calendar jointBusinessDays = JointCalendar(cals[0], cals[1], cals[2], cals[3], JoinBusinessDays);
+    Calendar largeJointHolidays = LargeJointCalendar(cals, JoinHolidays, 2000, 2030);
+    Calendar largeJointBusinessDays = LargeJointCalendar(cals, JoinBusinessDays, 2000, 2030);
+    Calendar cached = CachedCalendar(cals[1], 2000, 2030);
+
+    BOOST_CHECK(cached == cals[1]);
+    BOOST_CHECK_EQUAL(largeJointHolidays.name(), jointHolidays.name());
+
+    // check inside and outside of the cached range
+    for (Date d(1, January, 1995); d <= Date(31, December, 2035); ++d) {
+        BOOST_REQUIRE_MESSAGE(cached.isBusinessDay(d) == cals[1].isBusinessDay(d), "cached calendar fails on " << d);
+        BOOST_REQUIRE_MESSAGE(largeJointHolidays.isBusinessDay(d) == jointHolidays.isBusinessDay(d),
+                              "large joint calendar (JoinHolidays) fails on " << d);
+        BOOST_REQUIRE_MESSAGE(largeJointBusinessDays.isBusinessDay(d) == jointBusinessDays.isBusinessDay(d),
+                              "large joint calendar (JoinBusinessDays) fails on " << d);
+    }
+
+    // holidays added to the cached calendar are taken into account
+    Date d(15, June, 2020);
+    BOOST_CHECK(cached.isBusinessDay(d));
+    cached.addHoliday(d);
+    BOOST_CHECK(!cached.isBusinessDay(d));
+    BOOST_CHECK(cals[1].isBusinessDay(d));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
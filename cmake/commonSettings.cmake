@@ -54,6 +54,9 @@ else()
     add_compiler_flag("-Wmaybe-uninitialized" supportsMaybeUninitialized)
     add_compiler_flag("-Wno-unknown-pragmas" supportsNoUnknownPragmas)
     add_compiler_flag("-DBOOST_ENABLE_ASSERT_HANDLER" enableAssertionHandler)
+
+    # std::mutex and std::thread need the threading runtime
+    add_compiler_flag("-pthread" supportsPthread)
 endif()
 
 # set library locations